@@ -42,6 +42,7 @@ SOFTWARE.
 #include <Engine/Geometry/BV/BvhTree.h>
 #include <Engine/Image/ImageEncoders.h>
 #include <Engine/Core/HashFunc.h>
+#include <Engine/Runtime/Engine.h>
 
 #include <cgltf/cgltf.h>
 #include <fast_obj/fast_obj.h>
@@ -714,6 +715,10 @@ bool AssetImporter::ImportGLTF(AssetImportSettings const& Settings)
     String const& Source = Settings.ImportFile;
 
     m_Settings = Settings;
+    if (!m_Settings.pJobList && GEngine)
+    {
+        m_Settings.pJobList = GEngine->pAssetImporterJobList;
+    }
 
     m_Path = PathUtils::GetFilePath(Settings.ImportFile);
     m_Path += "/";
@@ -1568,7 +1573,8 @@ void AssetImporter::ReadMesh(cgltf_node* Node, cgltf_mesh* Mesh, Float3x4 const&
 
             if (texcoord)
             {
-                Geometry::CalcTangentSpace(m_Vertices.ToPtr() + meshInfo->BaseVertex, m_Vertices.Size() - meshInfo->BaseVertex, m_Indices.ToPtr() + firstIndex, indexCount);
+                AsyncJobDispatcher jobDispatcher(m_Settings.pJobList);
+                Geometry::CalcTangentSpace(m_Vertices.ToPtr() + meshInfo->BaseVertex, m_Vertices.Size() - meshInfo->BaseVertex, m_Indices.ToPtr() + firstIndex, indexCount, Geometry::TANGENT_SPACE_MIKKTSPACE, m_Settings.pJobList ? &jobDispatcher : nullptr);
             }
             else
             {
@@ -2241,6 +2247,11 @@ void AssetImporter::WriteSingleModel()
     else
     {
         f.FormattedPrint("Skeleton \"{}\"\n", "/Default/Skeleton/Default");
+
+        if (m_Settings.bPackedVertices)
+        {
+            f.FormattedPrint("bPackedVertices \"1\"\n");
+        }
     }
     f.FormattedPrint("Subparts [\n");
     String dummy;
@@ -2371,6 +2382,11 @@ void AssetImporter::WriteMesh(MeshInfo const& Mesh)
     else
     {
         f.FormattedPrint("Skeleton \"{}\"\n", "/Default/Skeleton/Default");
+
+        if (m_Settings.bPackedVertices)
+        {
+            f.FormattedPrint("bPackedVertices \"1\"\n");
+        }
     }
     f.FormattedPrint("Subparts [\n");
     String        dummy;
@@ -2473,6 +2489,10 @@ bool AssetImporter::ImportOBJ(AssetImportSettings const& Settings)
     String const& Source = Settings.ImportFile;
 
     m_Settings = Settings;
+    if (!m_Settings.pJobList && GEngine)
+    {
+        m_Settings.pJobList = GEngine->pAssetImporterJobList;
+    }
 
     m_Path = PathUtils::GetFilePath(Settings.ImportFile);
     m_Path += "/";
@@ -2673,7 +2693,8 @@ bool AssetImporter::ReadOBJ(fastObjMesh* pMesh)
         baseVertex += vertexCount;
         firstIndex += indexCount;
 
-        Geometry::CalcTangentSpace(m_Vertices.ToPtr() + meshInfo.BaseVertex, meshInfo.VertexCount, m_Indices.ToPtr() + meshInfo.FirstIndex, meshInfo.IndexCount);
+        AsyncJobDispatcher jobDispatcher(m_Settings.pJobList);
+        Geometry::CalcTangentSpace(m_Vertices.ToPtr() + meshInfo.BaseVertex, meshInfo.VertexCount, m_Indices.ToPtr() + meshInfo.FirstIndex, meshInfo.IndexCount, Geometry::TANGENT_SPACE_MIKKTSPACE, m_Settings.pJobList ? &jobDispatcher : nullptr);
     }
 
     m_bSkeletal = false;
@@ -56,6 +56,8 @@ struct AssetImportSettings
         Rotation                      = Quat::Identity();
         bCreateSkyboxMaterialInstance = true;
         bAllowUnlitMaterials          = true;
+        bPackedVertices               = false;
+        pJobList                      = nullptr;
     }
 
     /** Source file name */
@@ -95,6 +97,9 @@ struct AssetImportSettings
     /** Allow to create unlit materials */
     bool bAllowUnlitMaterials;
 
+    /** Store vertices of static meshes on the GPU in the compact packed format */
+    bool bPackedVertices;
+
     /** Scale units */
     float Scale;
 
@@ -102,6 +107,9 @@ struct AssetImportSettings
     Quat Rotation;
 
     SkyboxImportSettings SkyboxImport;
+
+    /** Job list for parallel tangent space generation. If null, the engine's importer job list is used. Without the engine, import runs on the calling thread. */
+    class AsyncJobList* pJobList;
 };
 
 bool ImportGLTF(AssetImportSettings const& Settings);
@@ -33,6 +33,8 @@ out gl_PerVertex
     vec4 gl_Position;
 };
 
+#include "instance_packed_vertex.glsl"
+
 #if defined MATERIAL_PASS_SHADOWMAP
 
 #   include "$SHADOWMAP_PASS_VERTEX_OUTPUT_VARYINGS$"
@@ -34,6 +34,8 @@ out gl_PerVertex
     vec4 gl_Position;
 };
 
+#include "instance_packed_vertex.glsl"
+
 // Built-in samplers
 #include "$COLOR_PASS_VERTEX_SAMPLERS$"
 
@@ -37,4 +37,6 @@ layout( binding = 1, std140 ) uniform DrawCall
     uint DrawCall_Pad0;
     uint DrawCall_Pad1;
     uint DrawCall_Pad2;
+    vec4 PackedPositionScale;
+    vec4 PackedPositionBias;
 };
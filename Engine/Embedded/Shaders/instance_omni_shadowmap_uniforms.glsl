@@ -36,4 +36,6 @@ layout( binding = 1, std140 ) uniform UniformBuffer1
     vec4 uaddr_2;
     vec4 uaddr_3;
     uvec4 CascadeMask;
+    vec4 PackedPositionScale;
+    vec4 PackedPositionBias;
 };
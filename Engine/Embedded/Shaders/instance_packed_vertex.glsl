@@ -0,0 +1,49 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+
+// Decoding of packed mesh vertices (see MeshVertexPacked). Positions are quantized to the mesh bounds,
+// normals and tangents are octahedral encoded, handedness is stored in the w component of the position.
+
+#ifdef PACKED_VERTEX
+
+vec3 OctahedralDecode( vec2 Oct )
+{
+    vec3 v = vec3( Oct, 1.0 - abs( Oct.x ) - abs( Oct.y ) );
+
+    float t = max( -v.z, 0.0 );
+    v.xy += mix( vec2( t ), vec2( -t ), greaterThanEqual( v.xy, vec2( 0.0 ) ) );
+    return normalize( v );
+}
+
+#define InPosition   ( PackedPositionBias.xyz + InPackedPosition.xyz * PackedPositionScale.xyz )
+#define InHandedness ( InPackedPosition.w * 2.0 - 1.0 )
+#define InNormal     OctahedralDecode( InPackedNormalTangent.xy )
+#define InTangent    OctahedralDecode( InPackedNormalTangent.zw )
+
+#endif
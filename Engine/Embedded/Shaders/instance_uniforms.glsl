@@ -46,4 +46,33 @@ layout( binding = 1, std140 ) uniform DrawCall
     uint DrawCall_Pad0;
     uint DrawCall_Pad1;
     uint DrawCall_Pad2;
+    vec4 PackedPositionScale; // Dequantization of packed vertex positions
+    vec4 PackedPositionBias;
 };
+
+#ifdef INSTANCED_MESH
+
+#define MAX_MESH_INSTANCES 64
+
+struct MeshInstance
+{
+    mat4 InstanceTransformMatrix;
+    mat4 InstanceTransformMatrixP;
+    vec4 InstanceModelNormalToViewSpace0;
+    vec4 InstanceModelNormalToViewSpace1;
+    vec4 InstanceModelNormalToViewSpace2;
+};
+
+// Per-instance transforms of automatically instanced draw calls. Other draw call constants are shared by all instances.
+layout( binding = 2, std140 ) uniform MeshInstances
+{
+    MeshInstance Instances[MAX_MESH_INSTANCES];
+};
+
+#define TransformMatrix         Instances[gl_InstanceID].InstanceTransformMatrix
+#define TransformMatrixP        Instances[gl_InstanceID].InstanceTransformMatrixP
+#define ModelNormalToViewSpace0 Instances[gl_InstanceID].InstanceModelNormalToViewSpace0
+#define ModelNormalToViewSpace1 Instances[gl_InstanceID].InstanceModelNormalToViewSpace1
+#define ModelNormalToViewSpace2 Instances[gl_InstanceID].InstanceModelNormalToViewSpace2
+
+#endif
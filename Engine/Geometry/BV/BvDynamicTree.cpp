@@ -0,0 +1,404 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "BvDynamicTree.h"
+
+HK_NAMESPACE_BEGIN
+
+namespace
+{
+
+HK_FORCEINLINE BvAxisAlignedBox CombineBounds(BvAxisAlignedBox const& A, BvAxisAlignedBox const& B)
+{
+    return BvAxisAlignedBox(Math::Min(A.Mins, B.Mins), Math::Max(A.Maxs, B.Maxs));
+}
+
+HK_FORCEINLINE bool ContainsBounds(BvAxisAlignedBox const& Outer, BvAxisAlignedBox const& Inner)
+{
+    return Outer.Mins.X <= Inner.Mins.X && Outer.Mins.Y <= Inner.Mins.Y && Outer.Mins.Z <= Inner.Mins.Z &&
+        Outer.Maxs.X >= Inner.Maxs.X && Outer.Maxs.Y >= Inner.Maxs.Y && Outer.Maxs.Z >= Inner.Maxs.Z;
+}
+
+/** Surface area heuristic cost (half of the box surface area) */
+HK_FORCEINLINE float SurfaceCost(BvAxisAlignedBox const& Bounds)
+{
+    Float3 size = Bounds.Size();
+    return size.X * size.Y + size.Y * size.Z + size.Z * size.X;
+}
+
+} // namespace
+
+BvDynamicTree::BvDynamicTree(float FatMargin) :
+    m_FatMargin(FatMargin)
+{}
+
+int BvDynamicTree::AllocateNode()
+{
+    int nodeIndex;
+
+    if (m_FreeList != NullNode)
+    {
+        nodeIndex = m_FreeList;
+        m_FreeList = m_Nodes[nodeIndex].Next;
+    }
+    else
+    {
+        nodeIndex = m_Nodes.Size();
+        m_Nodes.Add();
+    }
+
+    Node& node = m_Nodes[nodeIndex];
+    node.UserData = nullptr;
+    node.Parent = NullNode;
+    node.Children[0] = NullNode;
+    node.Children[1] = NullNode;
+    node.Height = 0;
+    return nodeIndex;
+}
+
+void BvDynamicTree::FreeNode(int NodeIndex)
+{
+    Node& node = m_Nodes[NodeIndex];
+    node.Next = m_FreeList;
+    node.Height = -1;
+    m_FreeList = NodeIndex;
+}
+
+int BvDynamicTree::CreateProxy(BvAxisAlignedBox const& Bounds, void* UserData)
+{
+    int proxyId = AllocateNode();
+
+    Node& node = m_Nodes[proxyId];
+    node.Bounds = Bounds;
+    node.Bounds.Inflate(m_FatMargin);
+    node.UserData = UserData;
+
+    InsertLeaf(proxyId);
+
+    m_ProxyCount++;
+
+    return proxyId;
+}
+
+void BvDynamicTree::DestroyProxy(int ProxyId)
+{
+    HK_ASSERT(ProxyId >= 0 && ProxyId < m_Nodes.Size());
+    HK_ASSERT(m_Nodes[ProxyId].IsLeaf() && m_Nodes[ProxyId].Height == 0);
+
+    RemoveLeaf(ProxyId);
+    FreeNode(ProxyId);
+
+    m_ProxyCount--;
+}
+
+bool BvDynamicTree::MoveProxy(int ProxyId, BvAxisAlignedBox const& Bounds)
+{
+    HK_ASSERT(ProxyId >= 0 && ProxyId < m_Nodes.Size());
+    HK_ASSERT(m_Nodes[ProxyId].IsLeaf());
+
+    BvAxisAlignedBox const& treeBounds = m_Nodes[ProxyId].Bounds;
+
+    if (ContainsBounds(treeBounds, Bounds))
+    {
+        // Reinsert the proxy if it became much smaller than its fat bounds
+        BvAxisAlignedBox hugeBounds = Bounds;
+        hugeBounds.Inflate(m_FatMargin * 4);
+
+        if (ContainsBounds(hugeBounds, treeBounds))
+            return false;
+    }
+
+    RemoveLeaf(ProxyId);
+
+    m_Nodes[ProxyId].Bounds = Bounds;
+    m_Nodes[ProxyId].Bounds.Inflate(m_FatMargin);
+
+    InsertLeaf(ProxyId);
+
+    return true;
+}
+
+void BvDynamicTree::Clear()
+{
+    m_Nodes.Clear();
+    m_Root = NullNode;
+    m_FreeList = NullNode;
+    m_ProxyCount = 0;
+}
+
+void BvDynamicTree::InsertLeaf(int Leaf)
+{
+    if (m_Root == NullNode)
+    {
+        m_Root = Leaf;
+        m_Nodes[m_Root].Parent = NullNode;
+        return;
+    }
+
+    BvAxisAlignedBox const leafBounds = m_Nodes[Leaf].Bounds;
+
+    // Find the best sibling
+    int index = m_Root;
+    while (!m_Nodes[index].IsLeaf())
+    {
+        Node const& node = m_Nodes[index];
+
+        float area = SurfaceCost(node.Bounds);
+        float combinedArea = SurfaceCost(CombineBounds(node.Bounds, leafBounds));
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        for (int i = 0; i < 2; i++)
+        {
+            Node const& child = m_Nodes[node.Children[i]];
+
+            float newArea = SurfaceCost(CombineBounds(child.Bounds, leafBounds));
+            if (child.IsLeaf())
+                childCost[i] = newArea + inheritanceCost;
+            else
+                childCost[i] = newArea - SurfaceCost(child.Bounds) + inheritanceCost;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1])
+            break;
+
+        index = childCost[0] < childCost[1] ? node.Children[0] : node.Children[1];
+    }
+
+    int sibling = index;
+
+    // Create a new parent
+    int oldParent = m_Nodes[sibling].Parent;
+    int newParent = AllocateNode();
+
+    Node& parent = m_Nodes[newParent];
+    parent.Parent = oldParent;
+    parent.Bounds = CombineBounds(leafBounds, m_Nodes[sibling].Bounds);
+    parent.Height = m_Nodes[sibling].Height + 1;
+    parent.Children[0] = sibling;
+    parent.Children[1] = Leaf;
+
+    if (oldParent != NullNode)
+    {
+        Node& op = m_Nodes[oldParent];
+        if (op.Children[0] == sibling)
+            op.Children[0] = newParent;
+        else
+            op.Children[1] = newParent;
+    }
+    else
+    {
+        m_Root = newParent;
+    }
+
+    m_Nodes[sibling].Parent = newParent;
+    m_Nodes[Leaf].Parent = newParent;
+
+    // Walk back up the tree fixing heights and bounds
+    Refit(m_Nodes[Leaf].Parent);
+}
+
+void BvDynamicTree::RemoveLeaf(int Leaf)
+{
+    if (Leaf == m_Root)
+    {
+        m_Root = NullNode;
+        return;
+    }
+
+    int parent = m_Nodes[Leaf].Parent;
+    int grandParent = m_Nodes[parent].Parent;
+    int sibling = m_Nodes[parent].Children[0] == Leaf ? m_Nodes[parent].Children[1] : m_Nodes[parent].Children[0];
+
+    if (grandParent != NullNode)
+    {
+        // Destroy parent and connect sibling to grand parent
+        Node& gp = m_Nodes[grandParent];
+        if (gp.Children[0] == parent)
+            gp.Children[0] = sibling;
+        else
+            gp.Children[1] = sibling;
+        m_Nodes[sibling].Parent = grandParent;
+        FreeNode(parent);
+
+        Refit(grandParent);
+    }
+    else
+    {
+        m_Root = sibling;
+        m_Nodes[sibling].Parent = NullNode;
+        FreeNode(parent);
+    }
+}
+
+void BvDynamicTree::Refit(int NodeIndex)
+{
+    while (NodeIndex != NullNode)
+    {
+        NodeIndex = Balance(NodeIndex);
+
+        Node& node = m_Nodes[NodeIndex];
+        Node const& child0 = m_Nodes[node.Children[0]];
+        Node const& child1 = m_Nodes[node.Children[1]];
+
+        node.Height = 1 + Math::Max(child0.Height, child1.Height);
+        node.Bounds = CombineBounds(child0.Bounds, child1.Bounds);
+
+        NodeIndex = node.Parent;
+    }
+}
+
+int BvDynamicTree::Balance(int iA)
+{
+    Node* A = &m_Nodes[iA];
+    if (A->IsLeaf() || A->Height < 2)
+        return iA;
+
+    int iB = A->Children[0];
+    int iC = A->Children[1];
+    Node* B = &m_Nodes[iB];
+    Node* C = &m_Nodes[iC];
+
+    int balance = C->Height - B->Height;
+
+    // Rotate C up
+    if (balance > 1)
+    {
+        int iF = C->Children[0];
+        int iG = C->Children[1];
+        Node* F = &m_Nodes[iF];
+        Node* G = &m_Nodes[iG];
+
+        // Swap A and C
+        C->Children[0] = iA;
+        C->Parent = A->Parent;
+        A->Parent = iC;
+
+        // A's old parent should point to C
+        if (C->Parent != NullNode)
+        {
+            Node& cp = m_Nodes[C->Parent];
+            if (cp.Children[0] == iA)
+                cp.Children[0] = iC;
+            else
+                cp.Children[1] = iC;
+        }
+        else
+        {
+            m_Root = iC;
+        }
+
+        // Rotate
+        if (F->Height > G->Height)
+        {
+            C->Children[1] = iF;
+            A->Children[1] = iG;
+            G->Parent = iA;
+            A->Bounds = CombineBounds(B->Bounds, G->Bounds);
+            C->Bounds = CombineBounds(A->Bounds, F->Bounds);
+            A->Height = 1 + Math::Max(B->Height, G->Height);
+            C->Height = 1 + Math::Max(A->Height, F->Height);
+        }
+        else
+        {
+            C->Children[1] = iG;
+            A->Children[1] = iF;
+            F->Parent = iA;
+            A->Bounds = CombineBounds(B->Bounds, F->Bounds);
+            C->Bounds = CombineBounds(A->Bounds, G->Bounds);
+            A->Height = 1 + Math::Max(B->Height, F->Height);
+            C->Height = 1 + Math::Max(A->Height, G->Height);
+        }
+
+        return iC;
+    }
+
+    // Rotate B up
+    if (balance < -1)
+    {
+        int iD = B->Children[0];
+        int iE = B->Children[1];
+        Node* D = &m_Nodes[iD];
+        Node* E = &m_Nodes[iE];
+
+        // Swap A and B
+        B->Children[0] = iA;
+        B->Parent = A->Parent;
+        A->Parent = iB;
+
+        // A's old parent should point to B
+        if (B->Parent != NullNode)
+        {
+            Node& bp = m_Nodes[B->Parent];
+            if (bp.Children[0] == iA)
+                bp.Children[0] = iB;
+            else
+                bp.Children[1] = iB;
+        }
+        else
+        {
+            m_Root = iB;
+        }
+
+        // Rotate
+        if (D->Height > E->Height)
+        {
+            B->Children[1] = iD;
+            A->Children[0] = iE;
+            E->Parent = iA;
+            A->Bounds = CombineBounds(C->Bounds, E->Bounds);
+            B->Bounds = CombineBounds(A->Bounds, D->Bounds);
+            A->Height = 1 + Math::Max(C->Height, E->Height);
+            B->Height = 1 + Math::Max(A->Height, D->Height);
+        }
+        else
+        {
+            B->Children[1] = iE;
+            A->Children[0] = iD;
+            D->Parent = iA;
+            A->Bounds = CombineBounds(C->Bounds, D->Bounds);
+            B->Bounds = CombineBounds(A->Bounds, E->Bounds);
+            A->Height = 1 + Math::Max(C->Height, D->Height);
+            B->Height = 1 + Math::Max(A->Height, E->Height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+HK_NAMESPACE_END
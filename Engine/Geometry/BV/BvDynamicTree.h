@@ -0,0 +1,147 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include "BvAxisAlignedBox.h"
+#include <Engine/Core/Containers/Vector.h>
+
+HK_NAMESPACE_BEGIN
+
+/**
+
+BvDynamicTree
+
+Incremental AABB tree for moving objects. Leafs store fattened bounds, so small movements
+don't change the tree. Tree is kept balanced with AVL-like rotations.
+
+*/
+class BvDynamicTree : public Noncopyable
+{
+public:
+    static constexpr int NullNode = -1;
+
+    /** Margin added to the proxy bounds */
+    static constexpr float DefaultFatMargin = 0.2f;
+
+    BvDynamicTree(float FatMargin = DefaultFatMargin);
+
+    /** Create a proxy. Returns proxy id */
+    int CreateProxy(BvAxisAlignedBox const& Bounds, void* UserData);
+
+    /** Destroy the proxy */
+    void DestroyProxy(int ProxyId);
+
+    /** Update proxy bounds. The proxy is reinserted only if it leaves its fat bounds. Returns true if the proxy was reinserted. */
+    bool MoveProxy(int ProxyId, BvAxisAlignedBox const& Bounds);
+
+    /** Remove all proxies */
+    void Clear();
+
+    void* GetUserData(int ProxyId) const
+    {
+        HK_ASSERT(ProxyId >= 0 && ProxyId < m_Nodes.Size());
+        return m_Nodes[ProxyId].UserData;
+    }
+
+    BvAxisAlignedBox const& GetFatBounds(int ProxyId) const
+    {
+        HK_ASSERT(ProxyId >= 0 && ProxyId < m_Nodes.Size());
+        return m_Nodes[ProxyId].Bounds;
+    }
+
+    int GetProxyCount() const { return m_ProxyCount; }
+
+    int GetHeight() const { return m_Root == NullNode ? 0 : m_Nodes[m_Root].Height; }
+
+    /** Traverse the tree. NodeTest( BvAxisAlignedBox const& ) returns false to skip the subtree, Callback( void* UserData ) is called for each passed leaf. */
+    template <typename NodeTestFunc, typename CallbackFunc>
+    void Query(NodeTestFunc NodeTest, CallbackFunc Callback) const
+    {
+        if (m_Root == NullNode)
+            return;
+
+        TSmallVector<int, 256> stack;
+        stack.Add(m_Root);
+
+        while (!stack.IsEmpty())
+        {
+            int index = stack.Last();
+            stack.RemoveLast();
+
+            Node const& node = m_Nodes[index];
+
+            if (!NodeTest(node.Bounds))
+                continue;
+
+            if (node.IsLeaf())
+            {
+                Callback(node.UserData);
+            }
+            else
+            {
+                stack.Add(node.Children[0]);
+                stack.Add(node.Children[1]);
+            }
+        }
+    }
+
+private:
+    struct Node
+    {
+        BvAxisAlignedBox Bounds;
+        void*            UserData;
+        union
+        {
+            int Parent;
+            int Next;
+        };
+        int Children[2];
+        int Height; // Leaf height is 0, free node height is -1
+
+        bool IsLeaf() const { return Children[0] == NullNode; }
+    };
+
+    int  AllocateNode();
+    void FreeNode(int NodeIndex);
+    void InsertLeaf(int Leaf);
+    void RemoveLeaf(int Leaf);
+    int  Balance(int NodeIndex);
+    void Refit(int NodeIndex);
+
+    TVector<Node> m_Nodes;
+    int           m_Root{NullNode};
+    int           m_FreeList{NullNode};
+    int           m_ProxyCount{};
+    float         m_FatMargin;
+};
+
+HK_NAMESPACE_END
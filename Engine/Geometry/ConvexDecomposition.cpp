@@ -195,7 +195,8 @@ bool PerformConvexDecomposition(Float3 const* vertices,
                                 int indexCount,
                                 TVector<Float3>& outVertices,
                                 TVector<unsigned int>& outIndices,
-                                TVector<ConvexHullDesc>& outHulls)
+                                TVector<ConvexHullDesc>& outHulls,
+                                ConvexDecompositionProgress* pProgress)
 {
     outVertices.Clear();
     outIndices.Clear();
@@ -245,8 +246,28 @@ bool PerformConvexDecomposition(Float3 const* vertices,
     hacd.SetAddNeighboursDistPoints(true); // recommended false
     hacd.SetAddFacesPoints(true);          // recommended false
 
+    // HACD callback has no user data, so pass the progress through the thread local
+    static thread_local ConvexDecompositionProgress* tlsProgress;
+    tlsProgress = pProgress;
+    if (pProgress)
+    {
+        hacd.SetCallBack([](const char*, double progress, double, size_t) -> bool
+                         {
+                             tlsProgress->Percent.Store((int)progress);
+                             return true;
+                         });
+    }
+
     hacd.Compute();
 
+    tlsProgress = nullptr;
+
+    // HACD can't be interrupted, so just drop the result
+    if (pProgress && pProgress->bCancel.Load())
+    {
+        return false;
+    }
+
     int maxPointsPerCluster = 0;
     int maxTrianglesPerCluster = 0;
     int totalPoints = 0;
@@ -332,16 +353,27 @@ bool PerformConvexDecompositionVHACD(Float3 const* vertices,
                                      TVector<Float3>& outVertices,
                                      TVector<unsigned int>& outIndices,
                                      TVector<ConvexHullDesc>& outHulls,
-                                     Float3& centerOfMass)
+                                     Float3& centerOfMass,
+                                     ConvexDecompositionProgress* pProgress)
 {
     class Callback : public VHACD::IVHACD::IUserCallback
     {
     public:
+        VHACD::IVHACD*               pVHACD{};
+        ConvexDecompositionProgress* pProgress{};
+
         void Update(const double overallProgress,
                     const double stageProgress,
                     const char* const stage,
                     const char* operation) override
         {
+            if (pProgress)
+            {
+                pProgress->Percent.Store((int)overallProgress);
+                if (pProgress->bCancel.Load())
+                    pVHACD->Cancel();
+                return;
+            }
             LOG("Overall progress {}, {} progress {}, operation: {}\n", overallProgress, stage, stageProgress, operation);
         }
     };
@@ -359,6 +391,9 @@ bool PerformConvexDecompositionVHACD(Float3 const* vertices,
 
     VHACD::IVHACD* vhacd = VHACD::CreateVHACD();
 
+    callback.pVHACD    = vhacd;
+    callback.pProgress = pProgress;
+
     VHACD::IVHACD::Parameters params;
     params.m_callback = &callback;                   // Optional user provided callback interface for progress
     params.m_logger = &logger;                       // Optional user provided callback interface for log messages
@@ -389,6 +424,15 @@ bool PerformConvexDecompositionVHACD(Float3 const* vertices,
     }
     bool bResult = vhacd->Compute(&tempVertices[0][0], vertexCount, indices, indexCount / 3, params);
 
+    if (pProgress && pProgress->bCancel.Load())
+    {
+        bResult = false;
+    }
+    else if (!bResult)
+    {
+        LOG("PerformConvexDecompositionVHACD: convex decomposition error\n");
+    }
+
     if (bResult)
     {
         double dcenterOfMass[3];
@@ -449,10 +493,6 @@ bool PerformConvexDecompositionVHACD(Float3 const* vertices,
             }
         }
     }
-    else
-    {
-        LOG("PerformConvexDecompositionVHACD: convex decomposition error\n");
-    }
 
     vhacd->Clean();
     vhacd->Release();
@@ -31,6 +31,7 @@ SOFTWARE.
 #pragma once
 
 #include <Engine/Core/Containers/Vector.h>
+#include <Engine/Core/Platform/Atomic.h>
 #include <Engine/Geometry/Plane.h>
 
 HK_NAMESPACE_BEGIN
@@ -42,6 +43,34 @@ struct ConvexHullDesc
     int    FirstIndex;
     int    IndexCount;
     Float3 Centroid;
+
+    void Write(IBinaryStreamWriteInterface& stream) const
+    {
+        stream.WriteInt32(FirstVertex);
+        stream.WriteInt32(VertexCount);
+        stream.WriteInt32(FirstIndex);
+        stream.WriteInt32(IndexCount);
+        stream.WriteObject(Centroid);
+    }
+
+    void Read(IBinaryStreamReadInterface& stream)
+    {
+        FirstVertex = stream.ReadInt32();
+        VertexCount = stream.ReadInt32();
+        FirstIndex  = stream.ReadInt32();
+        IndexCount  = stream.ReadInt32();
+        stream.ReadObject(Centroid);
+    }
+};
+
+/** Progress and cancellation state of a convex decomposition. Can be accessed from another thread. */
+struct ConvexDecompositionProgress
+{
+    /** Progress in percent */
+    AtomicInt Percent{0};
+
+    /** Set to abort the decomposition */
+    AtomicBool bCancel{false};
 };
 
 namespace Geometry
@@ -56,7 +85,8 @@ bool PerformConvexDecomposition(Float3 const* vertices,
                                 int indexCount,
                                 TVector<Float3>& outVertices,
                                 TVector<unsigned int>& outIndices,
-                                TVector<ConvexHullDesc>& outHulls);
+                                TVector<ConvexHullDesc>& outHulls,
+                                ConvexDecompositionProgress* pProgress = nullptr);
 
 bool PerformConvexDecompositionVHACD(Float3 const* vertices,
                                      int vertexCount,
@@ -66,7 +96,8 @@ bool PerformConvexDecompositionVHACD(Float3 const* vertices,
                                      TVector<Float3>& outVertices,
                                      TVector<unsigned int>& outIndices,
                                      TVector<ConvexHullDesc>& outHulls,
-                                     Float3& centerOfMass);
+                                     Float3& centerOfMass,
+                                     ConvexDecompositionProgress* pProgress = nullptr);
 
 void ConvexHullPlanesFromVertices(Float3 const* vertices, int vertexCount, TVector<PlaneF>& planes);
 
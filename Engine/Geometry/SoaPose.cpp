@@ -0,0 +1,420 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "SoaPose.h"
+
+HK_NAMESPACE_BEGIN
+
+namespace
+{
+
+enum
+{
+    SOA_POSITION_X,
+    SOA_POSITION_Y,
+    SOA_POSITION_Z,
+    SOA_ROTATION_X,
+    SOA_ROTATION_Y,
+    SOA_ROTATION_Z,
+    SOA_ROTATION_W,
+    SOA_SCALE_X,
+    SOA_SCALE_Y,
+    SOA_SCALE_Z
+};
+
+HK_FORCEINLINE float& SoaLane(SoaTransform& group, int component, int lane)
+{
+    return reinterpret_cast<float*>(&group)[component * 4 + lane];
+}
+
+HK_FORCEINLINE float SoaLane(SoaTransform const& group, int component, int lane)
+{
+    return reinterpret_cast<float const*>(&group)[component * 4 + lane];
+}
+
+HK_FORCEINLINE __m128 Lerp4(__m128 a, __m128 b, __m128 t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+HK_FORCEINLINE __m128 Dot4(__m128 ax, __m128 ay, __m128 az, __m128 aw, __m128 bx, __m128 by, __m128 bz, __m128 bw)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+}
+
+HK_FORCEINLINE __m128 Select4(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+HK_FORCEINLINE void NormalizeQuat4(__m128& x, __m128& y, __m128& z, __m128& w)
+{
+    __m128 lenSqr = Dot4(x, y, z, w, x, y, z, w);
+    __m128 valid = _mm_cmpgt_ps(lenSqr, _mm_set1_ps(1e-12f));
+    __m128 invLen = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(lenSqr, _mm_set1_ps(1e-12f))));
+
+    x = _mm_and_ps(valid, _mm_mul_ps(x, invLen));
+    y = _mm_and_ps(valid, _mm_mul_ps(y, invLen));
+    z = _mm_and_ps(valid, _mm_mul_ps(z, invLen));
+    w = Select4(valid, _mm_mul_ps(w, invLen), _mm_set1_ps(1.0f));
+}
+
+void InterpolatePoses(SoaPose const& a, SoaPose const& b, float t, bool bSlerp, SoaPose& result)
+{
+    HK_ASSERT(a.GetGroupsCount() == b.GetGroupsCount() && a.GetGroupsCount() == result.GetGroupsCount());
+
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 tt = _mm_set1_ps(t);
+
+    SoaTransform const* pa = a.GetGroups();
+    SoaTransform const* pb = b.GetGroups();
+    SoaTransform* pr = result.GetGroups();
+
+    for (int i = 0, count = result.GetGroupsCount(); i < count; i++)
+    {
+        SoaTransform const& ga = pa[i];
+        SoaTransform const& gb = pb[i];
+        SoaTransform& gr = pr[i];
+
+        __m128 cosOmega = Dot4(ga.RotationX, ga.RotationY, ga.RotationZ, ga.RotationW, gb.RotationX, gb.RotationY, gb.RotationZ, gb.RotationW);
+
+        // Take the shortest path
+        __m128 sign = _mm_and_ps(cosOmega, signMask);
+        __m128 bx = _mm_xor_ps(gb.RotationX, sign);
+        __m128 by = _mm_xor_ps(gb.RotationY, sign);
+        __m128 bz = _mm_xor_ps(gb.RotationZ, sign);
+        __m128 bw = _mm_xor_ps(gb.RotationW, sign);
+
+        __m128 rt = tt;
+        if (bSlerp)
+        {
+            // Correct the nlerp parameter to approximate constant angular velocity
+            __m128 d = _mm_andnot_ps(signMask, cosOmega);
+            __m128 ka = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+            __m128 kb = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+            __m128 th = _mm_sub_ps(tt, half);
+            __m128 k = _mm_add_ps(_mm_mul_ps(ka, _mm_mul_ps(th, th)), kb);
+            rt = _mm_add_ps(tt, _mm_mul_ps(_mm_mul_ps(tt, th), _mm_mul_ps(_mm_sub_ps(tt, _mm_set1_ps(1.0f)), k)));
+        }
+
+        __m128 rx = Lerp4(ga.RotationX, bx, rt);
+        __m128 ry = Lerp4(ga.RotationY, by, rt);
+        __m128 rz = Lerp4(ga.RotationZ, bz, rt);
+        __m128 rw = Lerp4(ga.RotationW, bw, rt);
+        NormalizeQuat4(rx, ry, rz, rw);
+
+        gr.PositionX = Lerp4(ga.PositionX, gb.PositionX, tt);
+        gr.PositionY = Lerp4(ga.PositionY, gb.PositionY, tt);
+        gr.PositionZ = Lerp4(ga.PositionZ, gb.PositionZ, tt);
+        gr.RotationX = rx;
+        gr.RotationY = ry;
+        gr.RotationZ = rz;
+        gr.RotationW = rw;
+        gr.ScaleX = Lerp4(ga.ScaleX, gb.ScaleX, tt);
+        gr.ScaleY = Lerp4(ga.ScaleY, gb.ScaleY, tt);
+        gr.ScaleZ = Lerp4(ga.ScaleZ, gb.ScaleZ, tt);
+    }
+}
+
+HK_FORCEINLINE void MulTransforms(float const* a, float const* b, float* result)
+{
+    const __m128 b0 = _mm_loadu_ps(b);
+    const __m128 b1 = _mm_loadu_ps(b + 4);
+    const __m128 b2 = _mm_loadu_ps(b + 8);
+    const __m128 b3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+    for (int row = 0; row < 3; row++)
+    {
+        __m128 ar = _mm_loadu_ps(a + row * 4);
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(ar, ar, _MM_SHUFFLE(0, 0, 0, 0)), b0),
+                                         _mm_mul_ps(_mm_shuffle_ps(ar, ar, _MM_SHUFFLE(1, 1, 1, 1)), b1)),
+                              _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(ar, ar, _MM_SHUFFLE(2, 2, 2, 2)), b2),
+                                         _mm_mul_ps(_mm_shuffle_ps(ar, ar, _MM_SHUFFLE(3, 3, 3, 3)), b3)));
+        _mm_storeu_ps(result + row * 4, r);
+    }
+}
+
+} // namespace
+
+void SoaPose::Resize(int jointsCount)
+{
+    m_JointsCount = jointsCount;
+    m_Groups.Resize((jointsCount + 3) >> 2);
+    SetIdentity();
+}
+
+void SoaPose::SetIdentity()
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (SoaTransform& group : m_Groups)
+    {
+        group.PositionX = group.PositionY = group.PositionZ = zero;
+        group.RotationX = group.RotationY = group.RotationZ = zero;
+        group.RotationW = one;
+        group.ScaleX = group.ScaleY = group.ScaleZ = one;
+    }
+}
+
+void SoaPose::SetZero()
+{
+    Platform::ZeroMem(m_Groups.ToPtr(), m_Groups.Size() * sizeof(SoaTransform));
+}
+
+void SoaPose::SetJoint(int jointIndex, Transform const& transform)
+{
+    HK_ASSERT(jointIndex >= 0 && jointIndex < m_JointsCount);
+
+    SoaTransform& group = m_Groups[jointIndex >> 2];
+    int lane = jointIndex & 3;
+
+    SoaLane(group, SOA_POSITION_X, lane) = transform.Position.X;
+    SoaLane(group, SOA_POSITION_Y, lane) = transform.Position.Y;
+    SoaLane(group, SOA_POSITION_Z, lane) = transform.Position.Z;
+    SoaLane(group, SOA_ROTATION_X, lane) = transform.Rotation.X;
+    SoaLane(group, SOA_ROTATION_Y, lane) = transform.Rotation.Y;
+    SoaLane(group, SOA_ROTATION_Z, lane) = transform.Rotation.Z;
+    SoaLane(group, SOA_ROTATION_W, lane) = transform.Rotation.W;
+    SoaLane(group, SOA_SCALE_X, lane) = transform.Scale.X;
+    SoaLane(group, SOA_SCALE_Y, lane) = transform.Scale.Y;
+    SoaLane(group, SOA_SCALE_Z, lane) = transform.Scale.Z;
+}
+
+void SoaPose::GetJoint(int jointIndex, Transform& transform) const
+{
+    HK_ASSERT(jointIndex >= 0 && jointIndex < m_JointsCount);
+
+    SoaTransform const& group = m_Groups[jointIndex >> 2];
+    int lane = jointIndex & 3;
+
+    transform.Position.X = SoaLane(group, SOA_POSITION_X, lane);
+    transform.Position.Y = SoaLane(group, SOA_POSITION_Y, lane);
+    transform.Position.Z = SoaLane(group, SOA_POSITION_Z, lane);
+    transform.Rotation.X = SoaLane(group, SOA_ROTATION_X, lane);
+    transform.Rotation.Y = SoaLane(group, SOA_ROTATION_Y, lane);
+    transform.Rotation.Z = SoaLane(group, SOA_ROTATION_Z, lane);
+    transform.Rotation.W = SoaLane(group, SOA_ROTATION_W, lane);
+    transform.Scale.X = SoaLane(group, SOA_SCALE_X, lane);
+    transform.Scale.Y = SoaLane(group, SOA_SCALE_Y, lane);
+    transform.Scale.Z = SoaLane(group, SOA_SCALE_Z, lane);
+}
+
+namespace Geometry
+{
+
+void NlerpPoses(SoaPose const& a, SoaPose const& b, float t, SoaPose& result)
+{
+    InterpolatePoses(a, b, t, false, result);
+}
+
+void SlerpPoses(SoaPose const& a, SoaPose const& b, float t, SoaPose& result)
+{
+    InterpolatePoses(a, b, t, true, result);
+}
+
+void AccumulatePose(SoaPose const& pose, float const* weights, SoaPose& result)
+{
+    HK_ASSERT(pose.GetGroupsCount() == result.GetGroupsCount());
+
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    SoaTransform const* pp = pose.GetGroups();
+    SoaTransform* pr = result.GetGroups();
+
+    for (int i = 0, count = result.GetGroupsCount(); i < count; i++)
+    {
+        SoaTransform const& gp = pp[i];
+        SoaTransform& gr = pr[i];
+
+        __m128 w = _mm_loadu_ps(weights + i * 4);
+
+        __m128 sign = _mm_and_ps(Dot4(gr.RotationX, gr.RotationY, gr.RotationZ, gr.RotationW, gp.RotationX, gp.RotationY, gp.RotationZ, gp.RotationW), signMask);
+        __m128 ws = _mm_xor_ps(w, sign);
+
+        gr.PositionX = _mm_add_ps(gr.PositionX, _mm_mul_ps(gp.PositionX, w));
+        gr.PositionY = _mm_add_ps(gr.PositionY, _mm_mul_ps(gp.PositionY, w));
+        gr.PositionZ = _mm_add_ps(gr.PositionZ, _mm_mul_ps(gp.PositionZ, w));
+        gr.RotationX = _mm_add_ps(gr.RotationX, _mm_mul_ps(gp.RotationX, ws));
+        gr.RotationY = _mm_add_ps(gr.RotationY, _mm_mul_ps(gp.RotationY, ws));
+        gr.RotationZ = _mm_add_ps(gr.RotationZ, _mm_mul_ps(gp.RotationZ, ws));
+        gr.RotationW = _mm_add_ps(gr.RotationW, _mm_mul_ps(gp.RotationW, ws));
+        gr.ScaleX = _mm_add_ps(gr.ScaleX, _mm_mul_ps(gp.ScaleX, w));
+        gr.ScaleY = _mm_add_ps(gr.ScaleY, _mm_mul_ps(gp.ScaleY, w));
+        gr.ScaleZ = _mm_add_ps(gr.ScaleZ, _mm_mul_ps(gp.ScaleZ, w));
+    }
+}
+
+void NormalizePose(SoaPose& pose, float const* weightSums)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    SoaTransform* pr = pose.GetGroups();
+
+    for (int i = 0, count = pose.GetGroupsCount(); i < count; i++)
+    {
+        SoaTransform& gr = pr[i];
+
+        __m128 sum = _mm_loadu_ps(weightSums + i * 4);
+        __m128 valid = _mm_cmpgt_ps(sum, zero);
+        __m128 inv = _mm_and_ps(valid, _mm_div_ps(one, _mm_max_ps(sum, _mm_set1_ps(1e-12f))));
+
+        gr.PositionX = _mm_mul_ps(gr.PositionX, inv);
+        gr.PositionY = _mm_mul_ps(gr.PositionY, inv);
+        gr.PositionZ = _mm_mul_ps(gr.PositionZ, inv);
+        gr.ScaleX = Select4(valid, _mm_mul_ps(gr.ScaleX, inv), one);
+        gr.ScaleY = Select4(valid, _mm_mul_ps(gr.ScaleY, inv), one);
+        gr.ScaleZ = Select4(valid, _mm_mul_ps(gr.ScaleZ, inv), one);
+
+        // Invalid lanes have zero rotation and become identity
+        gr.RotationX = _mm_and_ps(valid, gr.RotationX);
+        gr.RotationY = _mm_and_ps(valid, gr.RotationY);
+        gr.RotationZ = _mm_and_ps(valid, gr.RotationZ);
+        gr.RotationW = _mm_and_ps(valid, gr.RotationW);
+        NormalizeQuat4(gr.RotationX, gr.RotationY, gr.RotationZ, gr.RotationW);
+    }
+}
+
+void AddPose(SoaPose const& additive, float const* weights, SoaPose& result)
+{
+    HK_ASSERT(additive.GetGroupsCount() == result.GetGroupsCount());
+
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    SoaTransform const* pa = additive.GetGroups();
+    SoaTransform* pr = result.GetGroups();
+
+    for (int i = 0, count = result.GetGroupsCount(); i < count; i++)
+    {
+        SoaTransform const& ga = pa[i];
+        SoaTransform& gr = pr[i];
+
+        __m128 w = _mm_loadu_ps(weights + i * 4);
+
+        // nlerp(identity, additive, w) in the hemisphere of identity
+        __m128 sign = _mm_and_ps(ga.RotationW, signMask);
+        __m128 bx = _mm_mul_ps(_mm_xor_ps(ga.RotationX, sign), w);
+        __m128 by = _mm_mul_ps(_mm_xor_ps(ga.RotationY, sign), w);
+        __m128 bz = _mm_mul_ps(_mm_xor_ps(ga.RotationZ, sign), w);
+        __m128 bw = Lerp4(one, _mm_xor_ps(ga.RotationW, sign), w);
+        NormalizeQuat4(bx, by, bz, bw);
+
+        __m128 ax = gr.RotationX;
+        __m128 ay = gr.RotationY;
+        __m128 az = gr.RotationZ;
+        __m128 aw = gr.RotationW;
+
+        gr.RotationW = _mm_sub_ps(_mm_mul_ps(aw, bw), _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz)));
+        gr.RotationX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bx), _mm_mul_ps(ax, bw)), _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)));
+        gr.RotationY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, by), _mm_mul_ps(ay, bw)), _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)));
+        gr.RotationZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bz), _mm_mul_ps(az, bw)), _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx)));
+
+        gr.PositionX = _mm_add_ps(gr.PositionX, _mm_mul_ps(ga.PositionX, w));
+        gr.PositionY = _mm_add_ps(gr.PositionY, _mm_mul_ps(ga.PositionY, w));
+        gr.PositionZ = _mm_add_ps(gr.PositionZ, _mm_mul_ps(ga.PositionZ, w));
+        gr.ScaleX = _mm_mul_ps(gr.ScaleX, Lerp4(one, ga.ScaleX, w));
+        gr.ScaleY = _mm_mul_ps(gr.ScaleY, Lerp4(one, ga.ScaleY, w));
+        gr.ScaleZ = _mm_mul_ps(gr.ScaleZ, Lerp4(one, ga.ScaleZ, w));
+    }
+}
+
+void PoseToMatrices(SoaPose const& pose, Float3x4* matrices)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    SoaTransform const* pp = pose.GetGroups();
+    int jointsCount = pose.GetJointsCount();
+
+    for (int i = 0, count = pose.GetGroupsCount(); i < count; i++)
+    {
+        SoaTransform const& g = pp[i];
+
+        __m128 x2 = _mm_add_ps(g.RotationX, g.RotationX);
+        __m128 y2 = _mm_add_ps(g.RotationY, g.RotationY);
+        __m128 z2 = _mm_add_ps(g.RotationZ, g.RotationZ);
+
+        __m128 xx = _mm_mul_ps(g.RotationX, x2);
+        __m128 yy = _mm_mul_ps(g.RotationY, y2);
+        __m128 zz = _mm_mul_ps(g.RotationZ, z2);
+        __m128 xy = _mm_mul_ps(g.RotationX, y2);
+        __m128 xz = _mm_mul_ps(g.RotationX, z2);
+        __m128 yz = _mm_mul_ps(g.RotationY, z2);
+        __m128 wx = _mm_mul_ps(g.RotationW, x2);
+        __m128 wy = _mm_mul_ps(g.RotationW, y2);
+        __m128 wz = _mm_mul_ps(g.RotationW, z2);
+
+        // Same layout as Float3x4::Compose(position, rotation.ToMatrix3x3(), scale)
+        __m128 r0[4] = {_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), g.ScaleX),
+                        _mm_mul_ps(_mm_sub_ps(xy, wz), g.ScaleY),
+                        _mm_mul_ps(_mm_add_ps(xz, wy), g.ScaleZ),
+                        g.PositionX};
+        __m128 r1[4] = {_mm_mul_ps(_mm_add_ps(xy, wz), g.ScaleX),
+                        _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), g.ScaleY),
+                        _mm_mul_ps(_mm_sub_ps(yz, wx), g.ScaleZ),
+                        g.PositionY};
+        __m128 r2[4] = {_mm_mul_ps(_mm_sub_ps(xz, wy), g.ScaleX),
+                        _mm_mul_ps(_mm_add_ps(yz, wx), g.ScaleY),
+                        _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), g.ScaleZ),
+                        g.PositionZ};
+
+        _MM_TRANSPOSE4_PS(r0[0], r0[1], r0[2], r0[3]);
+        _MM_TRANSPOSE4_PS(r1[0], r1[1], r1[2], r1[3]);
+        _MM_TRANSPOSE4_PS(r2[0], r2[1], r2[2], r2[3]);
+
+        int first = i * 4;
+        int lanes = Math::Min(4, jointsCount - first);
+        for (int lane = 0; lane < lanes; lane++)
+        {
+            float* m = reinterpret_cast<float*>(&matrices[first + lane]);
+            _mm_storeu_ps(m, r0[lane]);
+            _mm_storeu_ps(m + 4, r1[lane]);
+            _mm_storeu_ps(m + 8, r2[lane]);
+        }
+    }
+}
+
+void LocalToModel(SkeletonJoint const* joints, int jointsCount, Float3x4 const* local, Float3x4* model)
+{
+    for (int j = 0; j < jointsCount; j++)
+    {
+        HK_ASSERT(joints[j].Parent < j);
+
+        MulTransforms(reinterpret_cast<float const*>(&model[joints[j].Parent + 1]),
+                      reinterpret_cast<float const*>(&local[j]),
+                      reinterpret_cast<float*>(&model[j + 1]));
+    }
+}
+
+} // namespace Geometry
+
+HK_NAMESPACE_END
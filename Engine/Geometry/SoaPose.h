@@ -0,0 +1,119 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Engine/Geometry/Skinning.h>
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+HK_NAMESPACE_BEGIN
+
+/**
+
+SoaTransform
+
+Four joint transforms in structure-of-arrays layout
+
+*/
+struct alignas(16) SoaTransform
+{
+    __m128 PositionX, PositionY, PositionZ;
+    __m128 RotationX, RotationY, RotationZ, RotationW;
+    __m128 ScaleX, ScaleY, ScaleZ;
+};
+
+/**
+
+SoaPose
+
+Skeleton pose packed by four joints. Padding lanes of the last group are kept as identity.
+
+*/
+class SoaPose
+{
+public:
+    void Resize(int jointsCount);
+
+    int GetJointsCount() const { return m_JointsCount; }
+
+    int GetGroupsCount() const { return m_Groups.Size(); }
+
+    SoaTransform* GetGroups() { return m_Groups.ToPtr(); }
+
+    SoaTransform const* GetGroups() const { return m_Groups.ToPtr(); }
+
+    /** Set all joints to identity */
+    void SetIdentity();
+
+    /** Set all joints to zero. Used as a start for weighted accumulation. */
+    void SetZero();
+
+    void SetJoint(int jointIndex, Transform const& transform);
+
+    void GetJoint(int jointIndex, Transform& transform) const;
+
+private:
+    TVector<SoaTransform> m_Groups;
+    int m_JointsCount{};
+};
+
+namespace Geometry
+{
+
+/** Per-joint normalized lerp. Result may alias the inputs. */
+void NlerpPoses(SoaPose const& a, SoaPose const& b, float t, SoaPose& result);
+
+/** Per-joint slerp. Uses nlerp with a corrected interpolation parameter, angular error stays below 0.1 degree. */
+void SlerpPoses(SoaPose const& a, SoaPose const& b, float t, SoaPose& result);
+
+/** result += pose * weights[joint]. Rotations are accumulated in the hemisphere of the accumulated value.
+Weights array must hold GetGroupsCount() * 4 values. */
+void AccumulatePose(SoaPose const& pose, float const* weights, SoaPose& result);
+
+/** Divide the accumulated pose by the summed weights and renormalize rotations.
+Joints with zero summed weight become identity. */
+void NormalizePose(SoaPose& pose, float const* weightSums);
+
+/** Apply additive pose: rotation = rotation * nlerp(identity, additive, w), position += additive * w,
+scale *= lerp(1, additive, w). */
+void AddPose(SoaPose const& additive, float const* weights, SoaPose& result);
+
+/** Convert the pose to joint local matrices. Matrices array must hold GetJointsCount() values. */
+void PoseToMatrices(SoaPose const& pose, Float3x4* matrices);
+
+/** Batch local-to-model pass. Model array holds JointsCount + 1 matrices, model[0] is the parent of root joints
+and must be set by caller. Parents must precede children. */
+void LocalToModel(SkeletonJoint const* joints, int jointsCount, Float3x4 const* local, Float3x4* model);
+
+} // namespace Geometry
+
+HK_NAMESPACE_END
@@ -79,24 +79,74 @@ void CalcTangentSpaceLegacy(MeshVertex* VertexArray, unsigned int NumVerts, unsi
     }
 }
 
-bool CalcTangentSpaceMikkTSpace(MeshVertex* VertexArray, unsigned int const* IndexArray, unsigned int NumIndices)
+void CalcTangentSpaceFast(MeshVertex* VertexArray, unsigned int NumVerts, unsigned int const* IndexArray, unsigned int NumIndices)
 {
-    struct GeometryData
+    // xyz - accumulated tangent, w - accumulated handedness
+    TVector<Float4> tangents(NumVerts);
+
+    for (unsigned int i = 0; i < NumIndices; i += 3)
     {
-        MeshVertex* VertexArray;
-        unsigned int const* IndexArray;
-        unsigned int NumFaces;
-    };
+        const unsigned int a = IndexArray[i];
+        const unsigned int b = IndexArray[i + 1];
+        const unsigned int c = IndexArray[i + 2];
+
+        Float3 e1  = VertexArray[b].Position - VertexArray[a].Position;
+        Float3 e2  = VertexArray[c].Position - VertexArray[a].Position;
+        Float2 et1 = VertexArray[b].GetTexCoord() - VertexArray[a].GetTexCoord();
+        Float2 et2 = VertexArray[c].GetTexCoord() - VertexArray[a].GetTexCoord();
+
+        const float denom = et1.X * et2.Y - et1.Y * et2.X;
+        if (Math::Abs(denom) < 1e-8f)
+        {
+            // Degenerate texture mapping
+            continue;
+        }
+
+        const float scale = 1.0f / denom;
+
+        Float3 tangent  = (e1 * et2.Y - e2 * et1.Y) * scale;
+        Float3 binormal = (e2 * et1.X - e1 * et2.X) * scale;
+
+        Float4 t(tangent, CalcHandedness(tangent, binormal, Math::Cross(e1, e2)));
+
+        tangents[a] += t;
+        tangents[b] += t;
+        tangents[c] += t;
+    }
+
+    for (unsigned int i = 0; i < NumVerts; i++)
+    {
+        const Float3 n = VertexArray[i].GetNormal();
+        Float3       t = Float3(tangents[i].X, tangents[i].Y, tangents[i].Z);
+
+        t -= n * Math::Dot(n, t);
+        if (t.LengthSqr() < 1e-12f)
+            t = n.Perpendicular();
+
+        VertexArray[i].SetTangent(t.Normalized());
+        VertexArray[i].Handedness = tangents[i].W < 0.0f ? -1 : 1;
+    }
+}
+
+namespace
+{
 
-    GeometryData data;
-    data.VertexArray = VertexArray;
-    data.IndexArray = IndexArray;
-    data.NumFaces = NumIndices / 3;
+struct MikkTSpaceGeometry
+{
+    MeshVertex*         VertexArray;
+    unsigned int const* IndexArray;
+    unsigned int        NumFaces;
+
+    // Per face-vertex output (xyz - tangent, w - sign). If null, the result is written to the vertices.
+    Float4* CornerTangents;
+};
 
+bool GenerateMikkTSpace(MikkTSpaceGeometry& data)
+{
     SMikkTSpaceInterface iface = {};
     iface.m_getNumFaces = [](SMikkTSpaceContext const* context) -> int
     {
-        GeometryData* data = (GeometryData*)context->m_pUserData;
+        MikkTSpaceGeometry* data = (MikkTSpaceGeometry*)context->m_pUserData;
         return data->NumFaces;
     };
     iface.m_getNumVerticesOfFace = [](SMikkTSpaceContext const* context, const int faceNum) -> int
@@ -105,32 +155,52 @@ bool CalcTangentSpaceMikkTSpace(MeshVertex* VertexArray, unsigned int const* Ind
     };
     iface.m_getPosition = [](SMikkTSpaceContext const* context, float posOut[], const int faceNum, const int vertNum)
     {
-        GeometryData* data = (GeometryData*)context->m_pUserData;
+        MikkTSpaceGeometry* data = (MikkTSpaceGeometry*)context->m_pUserData;
         MeshVertex const& vertex = data->VertexArray[data->IndexArray[faceNum * 3 + vertNum]];
         *((Float3*)&posOut[0]) = vertex.Position;
     };
     iface.m_getNormal = [](SMikkTSpaceContext const* context, float normOut[], const int faceNum, const int vertNum)
     {
-        GeometryData* data = (GeometryData*)context->m_pUserData;
+        MikkTSpaceGeometry* data = (MikkTSpaceGeometry*)context->m_pUserData;
         MeshVertex const& vertex = data->VertexArray[data->IndexArray[faceNum * 3 + vertNum]];
         *((Float3*)&normOut[0]) = vertex.GetNormal();
     };
     iface.m_getTexCoord = [](SMikkTSpaceContext const* context, float texCoordOut[], const int faceNum, const int vertNum)
     {
-        GeometryData* data = (GeometryData*)context->m_pUserData;
+        MikkTSpaceGeometry* data = (MikkTSpaceGeometry*)context->m_pUserData;
         MeshVertex const& vertex = data->VertexArray[data->IndexArray[faceNum * 3 + vertNum]];
         *((Float2*)&texCoordOut[0]) = vertex.GetTexCoord();
     };
     iface.m_setTSpaceBasic = [](SMikkTSpaceContext const* context, const float tangent[], const float fSign, const int faceNum, const int vertNum)
     {
-        GeometryData* data = (GeometryData*)context->m_pUserData;
-        MeshVertex& vertex = data->VertexArray[data->IndexArray[faceNum * 3 + vertNum]];
-        vertex.SetTangent(tangent[0], tangent[1], tangent[2]);
-        vertex.Handedness = (int8_t)fSign;
+        MikkTSpaceGeometry* data = (MikkTSpaceGeometry*)context->m_pUserData;
+        if (data->CornerTangents)
+        {
+            data->CornerTangents[faceNum * 3 + vertNum] = Float4(tangent[0], tangent[1], tangent[2], fSign);
+        }
+        else
+        {
+            MeshVertex& vertex = data->VertexArray[data->IndexArray[faceNum * 3 + vertNum]];
+            vertex.SetTangent(tangent[0], tangent[1], tangent[2]);
+            vertex.Handedness = (int8_t)fSign;
+        }
     };
 
     SMikkTSpaceContext ctx{&iface, &data};
-    if (!genTangSpaceDefault(&ctx))
+    return genTangSpaceDefault(&ctx) != 0;
+}
+
+} // namespace
+
+bool CalcTangentSpaceMikkTSpace(MeshVertex* VertexArray, unsigned int const* IndexArray, unsigned int NumIndices)
+{
+    MikkTSpaceGeometry data;
+    data.VertexArray    = VertexArray;
+    data.IndexArray     = IndexArray;
+    data.NumFaces       = NumIndices / 3;
+    data.CornerTangents = nullptr;
+
+    if (!GenerateMikkTSpace(data))
     {
         LOG("Failed on tangent space calculation\n");
         return false;
@@ -138,6 +208,118 @@ bool CalcTangentSpaceMikkTSpace(MeshVertex* VertexArray, unsigned int const* Ind
     return true;
 }
 
+bool CalcTangentSpaceMikkTSpaceParallel(MeshVertex* VertexArray, unsigned int NumVerts, unsigned int const* IndexArray, unsigned int NumIndices, IJobDispatcher* JobDispatcher)
+{
+    constexpr unsigned int MinFacesPerChunk = 32768;
+    constexpr unsigned int MaxChunks        = 16;
+
+    if (!JobDispatcher)
+        return CalcTangentSpaceMikkTSpace(VertexArray, IndexArray, NumIndices);
+
+    const unsigned int numFaces  = NumIndices / 3;
+    const unsigned int numChunks = Math::Min(Math::Min(numFaces / MinFacesPerChunk, MaxChunks), (unsigned int)Math::Max(JobDispatcher->GetMaxParallelJobs(), 1));
+
+    if (numChunks < 2)
+        return CalcTangentSpaceMikkTSpace(VertexArray, IndexArray, NumIndices);
+
+    TVector<Float4> cornerTangents(numFaces * 3);
+
+    struct ChunkJob
+    {
+        MikkTSpaceGeometry Geometry;
+        bool               bResult;
+    };
+
+    ChunkJob jobs[MaxChunks];
+
+    const unsigned int facesPerChunk = numFaces / numChunks;
+    unsigned int       firstFace     = 0;
+
+    for (unsigned int i = 0; i < numChunks; i++)
+    {
+        jobs[i].Geometry.VertexArray    = VertexArray;
+        jobs[i].Geometry.IndexArray     = IndexArray + firstFace * 3;
+        jobs[i].Geometry.NumFaces       = (i == numChunks - 1) ? numFaces - firstFace : facesPerChunk;
+        jobs[i].Geometry.CornerTangents = cornerTangents.ToPtr() + firstFace * 3;
+        firstFace += facesPerChunk;
+
+        jobs[i].bResult = false;
+
+        JobDispatcher->AddJob(
+            [](void* pData)
+            {
+                ChunkJob* job = (ChunkJob*)pData;
+                job->bResult  = GenerateMikkTSpace(job->Geometry);
+            },
+            &jobs[i]);
+    }
+
+    JobDispatcher->SubmitAndWait();
+
+    for (unsigned int i = 0; i < numChunks; i++)
+    {
+        if (!jobs[i].bResult)
+        {
+            LOG("Failed on tangent space calculation\n");
+            return false;
+        }
+    }
+
+    // Find vertices referenced by more than one chunk
+    const int SharedVertex = -2;
+
+    TVector<int> vertexChunk(NumVerts, -1);
+    for (unsigned int i = 0; i < numChunks; i++)
+    {
+        unsigned int const* indices = jobs[i].Geometry.IndexArray;
+        for (unsigned int n = 0, count = jobs[i].Geometry.NumFaces * 3; n < count; n++)
+        {
+            HK_ASSERT(indices[n] < NumVerts);
+            int& owner = vertexChunk[indices[n]];
+            if (owner == -1)
+                owner = i;
+            else if (owner != (int)i)
+                owner = SharedVertex;
+        }
+    }
+
+    // Merge in index order. Vertices owned by a single chunk get exactly what the serial version would write,
+    // vertices on chunk seams get the average of all face-vertices that reference them.
+    TVector<Float4> seamTangents(NumVerts);
+    for (unsigned int n = 0, count = numFaces * 3; n < count; n++)
+    {
+        const unsigned int v = IndexArray[n];
+        Float4 const&      t = cornerTangents[n];
+
+        if (vertexChunk[v] == SharedVertex)
+        {
+            seamTangents[v] += t;
+        }
+        else
+        {
+            VertexArray[v].SetTangent(t.X, t.Y, t.Z);
+            VertexArray[v].Handedness = (int8_t)t.W;
+        }
+    }
+
+    for (unsigned int v = 0; v < NumVerts; v++)
+    {
+        if (vertexChunk[v] != SharedVertex)
+            continue;
+
+        const Float3 n = VertexArray[v].GetNormal();
+        Float3       t = Float3(seamTangents[v].X, seamTangents[v].Y, seamTangents[v].Z);
+
+        t -= n * Math::Dot(n, t);
+        if (t.LengthSqr() < 1e-12f)
+            t = n.Perpendicular();
+
+        VertexArray[v].SetTangent(t.Normalized());
+        VertexArray[v].Handedness = seamTangents[v].W < 0.0f ? -1 : 1;
+    }
+    return true;
+}
+
 } // namespace Geometry
 
 HK_NAMESPACE_END
@@ -31,24 +31,44 @@ SOFTWARE.
 #pragma once
 
 #include <Engine/Geometry/VertexFormat.h>
+#include <Engine/Geometry/JobDispatcher.h>
 
 HK_NAMESPACE_BEGIN
 
 namespace Geometry
 {
 
+enum TANGENT_SPACE_MODE
+{
+    /** MikkTSpace. Large meshes are split into triangle ranges and processed in parallel if a job dispatcher is given. */
+    TANGENT_SPACE_MIKKTSPACE,
+    /** Fast approximate per-vertex accumulation. Use for runtime procedural geometry. */
+    TANGENT_SPACE_FAST
+};
+
 void CalcTangentSpaceLegacy(MeshVertex* VertexArray, unsigned int NumVerts, unsigned int const* IndexArray, unsigned int NumIndices);
 
+/** Approximate per-vertex tangent space. Not compatible with MikkTSpace baked normal maps, but much faster. */
+void CalcTangentSpaceFast(MeshVertex* VertexArray, unsigned int NumVerts, unsigned int const* IndexArray, unsigned int NumIndices);
+
 bool CalcTangentSpaceMikkTSpace(MeshVertex* VertexArray, unsigned int const* IndexArray, unsigned int NumIndices);
 
-HK_FORCEINLINE void CalcTangentSpace(MeshVertex* VertexArray, unsigned int NumVerts, unsigned int const* IndexArray, unsigned int NumIndices)
+/** Chunked MikkTSpace. Chunks run as jobs of the JobDispatcher. Falls back to CalcTangentSpaceMikkTSpace for small meshes
+or if JobDispatcher is null. Vertices shared between chunks are merged in a fixed order, so the result does not depend on
+thread scheduling. Don't pass a dispatcher over the job list the caller is running on. */
+bool CalcTangentSpaceMikkTSpaceParallel(MeshVertex* VertexArray, unsigned int NumVerts, unsigned int const* IndexArray, unsigned int NumIndices, IJobDispatcher* JobDispatcher);
+
+HK_FORCEINLINE void CalcTangentSpace(MeshVertex* VertexArray, unsigned int NumVerts, unsigned int const* IndexArray, unsigned int NumIndices, TANGENT_SPACE_MODE Mode = TANGENT_SPACE_MIKKTSPACE, IJobDispatcher* JobDispatcher = nullptr)
 {
-    #if 1
-    HK_UNUSED(NumVerts);
-    CalcTangentSpaceMikkTSpace(VertexArray, IndexArray, NumIndices);
-    #else
-    CalcTangentSpaceLegacy(VertexArray, NumVerts, IndexArray, NumIndices);
-    #endif
+    switch (Mode)
+    {
+        case TANGENT_SPACE_MIKKTSPACE:
+            CalcTangentSpaceMikkTSpaceParallel(VertexArray, NumVerts, IndexArray, NumIndices, JobDispatcher);
+            break;
+        case TANGENT_SPACE_FAST:
+            CalcTangentSpaceFast(VertexArray, NumVerts, IndexArray, NumIndices);
+            break;
+    }
 }
 
 /** binormal = cross( normal, tangent ) * handedness */
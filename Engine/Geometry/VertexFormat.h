@@ -156,6 +156,110 @@ HK_FORCEINLINE MeshVertex MeshVertex::Lerp(MeshVertex const& Vertex1, MeshVertex
     return Result;
 }
 
+/** Octahedral mapping of unit vector to [-1,1] square */
+HK_FORCEINLINE Float2 OctahedralEncode(Float3 const& Vec)
+{
+    float invL1 = 1.0f / (Math::Abs(Vec.X) + Math::Abs(Vec.Y) + Math::Abs(Vec.Z));
+
+    Float2 p(Vec.X * invL1, Vec.Y * invL1);
+    if (Vec.Z < 0.0f)
+    {
+        p = Float2((1.0f - Math::Abs(p.Y)) * (p.X >= 0.0f ? 1.0f : -1.0f),
+                   (1.0f - Math::Abs(p.X)) * (p.Y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return p;
+}
+
+/** Unit vector from octahedral mapping */
+HK_FORCEINLINE Float3 OctahedralDecode(Float2 const& Oct)
+{
+    Float3 v(Oct.X, Oct.Y, 1.0f - Math::Abs(Oct.X) - Math::Abs(Oct.Y));
+
+    float t = Math::Max(-v.Z, 0.0f);
+    v.X += v.X >= 0.0f ? -t : t;
+    v.Y += v.Y >= 0.0f ? -t : t;
+    return v.Normalized();
+}
+
+/** Dequantization of packed vertex positions: Position = Bias + Quantized / 65535 * Scale */
+struct VertexQuantization
+{
+    Float3 Scale = Float3(1.0f);
+    Float3 Bias;
+
+    static VertexQuantization FromBounds(Float3 const& Mins, Float3 const& Maxs)
+    {
+        VertexQuantization q;
+        Float3 extents = Maxs - Mins;
+        q.Scale.X = extents.X > 0.0f ? extents.X : 1.0f;
+        q.Scale.Y = extents.Y > 0.0f ? extents.Y : 1.0f;
+        q.Scale.Z = extents.Z > 0.0f ? extents.Z : 1.0f;
+        q.Bias    = Mins;
+        return q;
+    }
+
+    bool operator==(VertexQuantization const& Rhs) const
+    {
+        return Scale == Rhs.Scale && Bias == Rhs.Bias;
+    }
+
+    bool operator!=(VertexQuantization const& Rhs) const
+    {
+        return !(operator==(Rhs));
+    }
+};
+
+/**
+
+MeshVertexPacked
+
+Compact GPU vertex format (16 bytes) for static meshes. Position is quantized to 16 bits relative to the mesh bounds
+(see VertexQuantization), handedness is stored in the fourth position component. Normal and tangent are octahedral
+encoded to 8 bits per component. Decoded by the material vertex shaders when PACKED_VERTEX is defined.
+
+*/
+struct MeshVertexPacked
+{
+    uint16_t Position[4]; // 2 * 4 = 8 bytes    xyz - quantized position, w - handedness (0 or 65535)
+    Half     TexCoord[2]; // 2 * 2 = 4 bytes
+    int8_t   Normal[2];   // 1 * 2 = 2 bytes
+    int8_t   Tangent[2];  // 1 * 2 = 2 bytes
+
+    void Pack(MeshVertex const& Vertex, VertexQuantization const& Quantization)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            float q     = (Vertex.Position[i] - Quantization.Bias[i]) / Quantization.Scale[i] * 65535.0f;
+            Position[i] = (uint16_t)Math::Clamp(Math::Round(q), 0.0f, 65535.0f);
+        }
+        Position[3] = Vertex.Handedness > 0 ? 65535 : 0;
+
+        TexCoord[0] = Vertex.TexCoord[0];
+        TexCoord[1] = Vertex.TexCoord[1];
+
+        Float2 n = OctahedralEncode(Vertex.GetNormal());
+        Float2 t = OctahedralEncode(Vertex.GetTangent());
+
+        Normal[0]  = (int8_t)Math::Round(Math::Clamp(n.X, -1.0f, 1.0f) * 127.0f);
+        Normal[1]  = (int8_t)Math::Round(Math::Clamp(n.Y, -1.0f, 1.0f) * 127.0f);
+        Tangent[0] = (int8_t)Math::Round(Math::Clamp(t.X, -1.0f, 1.0f) * 127.0f);
+        Tangent[1] = (int8_t)Math::Round(Math::Clamp(t.Y, -1.0f, 1.0f) * 127.0f);
+    }
+
+    void Unpack(MeshVertex& Vertex, VertexQuantization const& Quantization) const
+    {
+        Vertex.Position.X = Quantization.Bias.X + Position[0] / 65535.0f * Quantization.Scale.X;
+        Vertex.Position.Y = Quantization.Bias.Y + Position[1] / 65535.0f * Quantization.Scale.Y;
+        Vertex.Position.Z = Quantization.Bias.Z + Position[2] / 65535.0f * Quantization.Scale.Z;
+        Vertex.Handedness = Position[3] ? 1 : -1;
+        Vertex.SetTexCoord(TexCoord[0], TexCoord[1]);
+        Vertex.SetNormal(OctahedralDecode(Float2(Normal[0], Normal[1]) / 127.0f));
+        Vertex.SetTangent(OctahedralDecode(Float2(Tangent[0], Tangent[1]) / 127.0f));
+    }
+};
+
+static_assert(sizeof(MeshVertexPacked) == 16, "Keep 16b packed vertex size");
+
 struct MeshVertexUV
 {
     Float2 TexCoord;
@@ -216,6 +216,19 @@ HK_FORCEINLINE bool IsDepthStencilFormat(TEXTURE_FORMAT Format)
     return info.bHasDepth || info.bHasStencil;
 }
 
+/** Formats of the same size class can reinterpret the storage of each other with a texture view (e.g. RGBA8, R32F and RG16F).
+Compressed and depth-stencil formats are view compatible only with themselves. */
+HK_FORCEINLINE bool IsViewCompatibleFormat(TEXTURE_FORMAT A, TEXTURE_FORMAT B)
+{
+    if (A == B)
+        return true;
+
+    if (IsCompressedFormat(A) || IsCompressedFormat(B) || IsDepthStencilFormat(A) || IsDepthStencilFormat(B))
+        return false;
+
+    return GetTextureFormatInfo(A).BytesPerBlock == GetTextureFormatInfo(B).BytesPerBlock;
+}
+
 enum IMAGE_STORAGE_FLAGS
 {
     IMAGE_STORAGE_FLAGS_DEFAULT       = 0,
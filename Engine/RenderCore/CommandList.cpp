@@ -0,0 +1,110 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "CommandList.h"
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+void CommandList::Reset()
+{
+    m_Data.Clear();
+    m_NumCommands = 0;
+}
+
+void CommandList::BindPipeline(IPipeline* pPipeline)
+{
+    CommandPacket_BindPipeline* packet = AddPacket<CommandPacket_BindPipeline>(COMMAND_PACKET_BIND_PIPELINE);
+    packet->pPipeline = pPipeline;
+}
+
+void CommandList::BindVertexBuffer(unsigned int InputSlot, IBuffer const* pVertexBuffer, unsigned int Offset)
+{
+    CommandPacket_BindVertexBuffer* packet = AddPacket<CommandPacket_BindVertexBuffer>(COMMAND_PACKET_BIND_VERTEX_BUFFER);
+    packet->InputSlot = InputSlot;
+    packet->pBuffer   = pVertexBuffer;
+    packet->Offset    = Offset;
+}
+
+void CommandList::BindIndexBuffer(IBuffer const* pIndexBuffer, INDEX_TYPE Type, unsigned int Offset)
+{
+    CommandPacket_BindIndexBuffer* packet = AddPacket<CommandPacket_BindIndexBuffer>(COMMAND_PACKET_BIND_INDEX_BUFFER);
+    packet->IndexType = Type;
+    packet->pBuffer   = pIndexBuffer;
+    packet->Offset    = Offset;
+}
+
+void CommandList::BindTexture(unsigned int Slot, ITextureView* pShaderResourceView)
+{
+    CommandPacket_BindTexture* packet = AddPacket<CommandPacket_BindTexture>(COMMAND_PACKET_BIND_TEXTURE);
+    packet->Slot  = Slot;
+    packet->pView = pShaderResourceView;
+}
+
+void CommandList::BindBuffer(int Slot, IBuffer const* pBuffer, size_t Offset, size_t Size)
+{
+    CommandPacket_BindBuffer* packet = AddPacket<CommandPacket_BindBuffer>(COMMAND_PACKET_BIND_BUFFER);
+    packet->Slot    = Slot;
+    packet->pBuffer = pBuffer;
+    packet->Offset  = Offset;
+    packet->Size    = Size;
+}
+
+void CommandList::SetViewport(Viewport const& Viewport)
+{
+    AddPacket<CommandPacket_SetViewport>(COMMAND_PACKET_SET_VIEWPORT)->Rect = Viewport;
+}
+
+void CommandList::SetScissor(Rect2D const& Scissor)
+{
+    AddPacket<CommandPacket_SetScissor>(COMMAND_PACKET_SET_SCISSOR)->Scissor = Scissor;
+}
+
+void CommandList::DynamicState_StencilRef(uint32_t StencilRef)
+{
+    AddPacket<CommandPacket_StencilRef>(COMMAND_PACKET_STENCIL_REF)->StencilRef = StencilRef;
+}
+
+void CommandList::Draw(DrawCmd const* pCmd)
+{
+    AddPacket<CommandPacket_Draw>(COMMAND_PACKET_DRAW)->Cmd = *pCmd;
+}
+
+void CommandList::Draw(DrawIndexedCmd const* pCmd)
+{
+    AddPacket<CommandPacket_DrawIndexed>(COMMAND_PACKET_DRAW_INDEXED)->Cmd = *pCmd;
+}
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
@@ -0,0 +1,192 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include "ImmediateContext.h"
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+enum COMMAND_PACKET_TYPE : uint32_t
+{
+    COMMAND_PACKET_BIND_PIPELINE,
+    COMMAND_PACKET_BIND_VERTEX_BUFFER,
+    COMMAND_PACKET_BIND_INDEX_BUFFER,
+    COMMAND_PACKET_BIND_TEXTURE,
+    COMMAND_PACKET_BIND_BUFFER,
+    COMMAND_PACKET_SET_VIEWPORT,
+    COMMAND_PACKET_SET_SCISSOR,
+    COMMAND_PACKET_STENCIL_REF,
+    COMMAND_PACKET_DRAW,
+    COMMAND_PACKET_DRAW_INDEXED
+};
+
+struct CommandPacket
+{
+    COMMAND_PACKET_TYPE Type;
+};
+
+struct CommandPacket_BindPipeline : CommandPacket
+{
+    IPipeline* pPipeline;
+};
+
+struct CommandPacket_BindVertexBuffer : CommandPacket
+{
+    unsigned int   InputSlot;
+    IBuffer const* pBuffer;
+    unsigned int   Offset;
+};
+
+struct CommandPacket_BindIndexBuffer : CommandPacket
+{
+    INDEX_TYPE     IndexType;
+    IBuffer const* pBuffer;
+    unsigned int   Offset;
+};
+
+struct CommandPacket_BindTexture : CommandPacket
+{
+    unsigned int  Slot;
+    ITextureView* pView;
+};
+
+struct CommandPacket_BindBuffer : CommandPacket
+{
+    int            Slot;
+    IBuffer const* pBuffer;
+    size_t         Offset;
+    size_t         Size;
+};
+
+struct CommandPacket_SetViewport : CommandPacket
+{
+    Viewport Rect;
+};
+
+struct CommandPacket_SetScissor : CommandPacket
+{
+    Rect2D Scissor;
+};
+
+struct CommandPacket_StencilRef : CommandPacket
+{
+    uint32_t StencilRef;
+};
+
+struct CommandPacket_Draw : CommandPacket
+{
+    DrawCmd Cmd;
+};
+
+struct CommandPacket_DrawIndexed : CommandPacket
+{
+    DrawIndexedCmd Cmd;
+};
+
+/**
+Backend-agnostic deferred command list. Commands are stored as compact packets in a linear buffer
+and replayed in recording order by IImmediateContext::ExecuteCommandList. Recording does not touch the
+device, so separate command lists can be filled from worker threads. Texture and buffer bindings go to
+the root resource table of the context that executes the list. All referenced objects must stay alive
+until the list is executed.
+*/
+class CommandList
+{
+public:
+    static constexpr size_t PACKET_ALIGNMENT = 8;
+
+    /** Remove recorded commands. Keeps the allocated memory. */
+    void Reset();
+
+    bool IsEmpty() const { return m_NumCommands == 0; }
+
+    uint32_t GetCommandCount() const { return m_NumCommands; }
+
+    size_t GetSizeInBytes() const { return m_Data.Size(); }
+
+    void BindPipeline(IPipeline* pPipeline);
+
+    void BindVertexBuffer(unsigned int InputSlot, /* optional */ IBuffer const* pVertexBuffer, unsigned int Offset = 0);
+
+    void BindIndexBuffer(IBuffer const* pIndexBuffer, INDEX_TYPE Type, unsigned int Offset = 0);
+
+    void BindTexture(unsigned int Slot, ITextureView* pShaderResourceView);
+
+    void BindTexture(unsigned int Slot, ITexture* pTexture)
+    {
+        BindTexture(Slot, pTexture->GetShaderResourceView());
+    }
+
+    void BindBuffer(int Slot, IBuffer const* pBuffer, size_t Offset = 0, size_t Size = 0);
+
+    void SetViewport(Viewport const& Viewport);
+
+    void SetScissor(Rect2D const& Scissor);
+
+    void DynamicState_StencilRef(uint32_t StencilRef);
+
+    void Draw(DrawCmd const* pCmd);
+
+    void Draw(DrawIndexedCmd const* pCmd);
+
+    /** Recorded packets. Each packet starts with CommandPacket and occupies GetPacketSize<T>() bytes. */
+    uint8_t const* GetData() const { return m_Data.ToPtr(); }
+
+    template <typename T>
+    static constexpr size_t GetPacketSize()
+    {
+        return (sizeof(T) + PACKET_ALIGNMENT - 1) & ~(PACKET_ALIGNMENT - 1);
+    }
+
+private:
+    template <typename T>
+    T* AddPacket(COMMAND_PACKET_TYPE Type)
+    {
+        size_t offset = m_Data.Size();
+        m_Data.Resize(offset + GetPacketSize<T>());
+        m_NumCommands++;
+
+        T* packet    = reinterpret_cast<T*>(m_Data.ToPtr() + offset);
+        packet->Type = Type;
+        return packet;
+    }
+
+    TVector<uint8_t> m_Data;
+    uint32_t         m_NumCommands{};
+};
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
@@ -30,6 +30,7 @@ SOFTWARE.
 
 #include "Device.h"
 #include "OpenGL45/DeviceGLImpl.h"
+#include "Null/DeviceNullImpl.h"
 
 HK_NAMESPACE_BEGIN
 
@@ -84,6 +85,10 @@ void CreateLogicalDevice(const char*              Backend,
     {
         *ppDevice = MakeRef<DeviceGLImpl>(pAllocator);
     }
+    else if (!Platform::Stricmp(Backend, "Null"))
+    {
+        *ppDevice = MakeRef<DeviceNullImpl>(pAllocator);
+    }
     else
     {
         *ppDevice = nullptr;
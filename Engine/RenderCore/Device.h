@@ -127,6 +127,9 @@ public:
 
     virtual void CreateTexture(TextureDesc const& Desc, TRef<ITexture>* ppTexture) = 0;
 
+    /** Create texture that shares the storage of pStorage (texture view). Descriptors must be storage compatible, see TextureDesc::IsStorageCompatible. */
+    virtual void CreateTextureAlias(TextureDesc const& Desc, ITexture* pStorage, TRef<ITexture>* ppTexture) = 0;
+
     /** FEATURE_SPARSE_TEXTURES must be supported */
     virtual void CreateSparseTexture(SparseTextureDesc const& Desc, TRef<ISparseTexture>* ppTexture) = 0;
 
@@ -44,7 +44,7 @@ ITexture* FGRenderTargetCache::Acquire(TextureDesc const& TextureDesc)
     // Find free appropriate texture
     for (auto it = FreeTextures.Begin(); it != FreeTextures.End(); it++)
     {
-        ITexture* tex = *it;
+        ITexture* tex = it->Texture;
 
         if (tex->GetDesc() == TextureDesc)
         {
@@ -54,6 +54,40 @@ ITexture* FGRenderTargetCache::Acquire(TextureDesc const& TextureDesc)
         }
     }
 
+    return CreateTexture(TextureDesc);
+}
+
+ITexture* FGRenderTargetCache::AcquireStorage(TextureDesc const& TextureDesc)
+{
+    auto compatible = FreeTextures.End();
+    for (auto it = FreeTextures.Begin(); it != FreeTextures.End(); it++)
+    {
+        ITexture* tex = it->Texture;
+
+        if (tex->GetDesc() == TextureDesc)
+        {
+            FreeTextures.Erase(it);
+            return tex;
+        }
+
+        if (compatible == FreeTextures.End() && tex->GetDesc().IsStorageCompatible(TextureDesc))
+        {
+            compatible = it;
+        }
+    }
+
+    if (compatible != FreeTextures.End())
+    {
+        ITexture* tex = compatible->Texture;
+        FreeTextures.Erase(compatible);
+        return tex;
+    }
+
+    return CreateTexture(TextureDesc);
+}
+
+ITexture* FGRenderTargetCache::CreateTexture(TextureDesc const& TextureDesc)
+{
     // Create new texture
     //LOG( "Create new texture ( in use {}, free {} )\n", Textures.Size()+1, FreeTextures.Size() );
     TRef<ITexture> texture;
@@ -62,6 +96,7 @@ ITexture* FGRenderTargetCache::Acquire(TextureDesc const& TextureDesc)
     texture->SetDebugName("Render Target");
     #endif
     Textures.Add(texture);
+    TextureMemory += CalcTextureMemory(TextureDesc);
     return texture;
 }
 
@@ -72,7 +107,77 @@ void FGRenderTargetCache::Release(ITexture* pTexture)
     {
         pTexture->Invalidate(mipLevel);
     }
-    FreeTextures.Add(pTexture);
+    FreeTextures.Add({pTexture, FrameIndex});
+}
+
+ITexture* FGRenderTargetCache::GetAlias(ITexture* pStorage, TextureDesc const& TextureDesc)
+{
+    for (TextureAlias const& alias : Aliases)
+    {
+        if (alias.Storage == pStorage && alias.Texture->GetDesc() == TextureDesc)
+        {
+            return alias.Texture;
+        }
+    }
+
+    TRef<ITexture> texture;
+    pDevice->CreateTextureAlias(TextureDesc, pStorage, &texture);
+    #ifdef HK_DEBUG
+    texture->SetDebugName("Render Target Alias");
+    #endif
+    Aliases.Add({pStorage, texture});
+    return texture;
+}
+
+void FGRenderTargetCache::CleanupUnusedTextures(uint32_t MaxUnusedFrames)
+{
+    for (int i = 0; i < FreeTextures.Size();)
+    {
+        if (FrameIndex - FreeTextures[i].ReleaseFrame > MaxUnusedFrames)
+        {
+            auto texture = std::find(Textures.Begin(), Textures.End(), FreeTextures[i].Texture);
+            HK_ASSERT(texture != Textures.End());
+            TextureMemory -= CalcTextureMemory((*texture)->GetDesc());
+
+            // Aliases of the texture are not used anymore
+            for (int n = 0; n < Aliases.Size();)
+            {
+                if (Aliases[n].Storage == FreeTextures[i].Texture)
+                {
+                    Aliases.Erase(Aliases.Begin() + n);
+                    continue;
+                }
+                n++;
+            }
+
+            Textures.Erase(texture);
+
+            FreeTextures.Erase(FreeTextures.Begin() + i);
+            continue;
+        }
+        i++;
+    }
+
+    FrameIndex++;
+}
+
+size_t FGRenderTargetCache::CalcTextureMemory(TextureDesc const& Desc)
+{
+    TextureFormatInfo const& info = GetTextureFormatInfo(Desc.Format);
+
+    bool b1D = Desc.Type == TEXTURE_1D || Desc.Type == TEXTURE_1D_ARRAY;
+    bool b3D = Desc.Type == TEXTURE_3D;
+
+    size_t size = 0;
+    for (uint16_t mipLevel = 0; mipLevel < Desc.NumMipLevels; mipLevel++)
+    {
+        size_t width  = Math::Max(1u, Desc.Resolution.Width >> mipLevel);
+        size_t height = b1D ? 1 : Math::Max(1u, Desc.Resolution.Height >> mipLevel);
+        size_t slices = b3D ? Math::Max(1u, Desc.Resolution.SliceCount >> mipLevel) : Desc.Resolution.SliceCount;
+
+        size += (width + info.BlockSize - 1) / info.BlockSize * ((height + info.BlockSize - 1) / info.BlockSize) * slices * info.BytesPerBlock;
+    }
+    return size * Math::Max<size_t>(1, Desc.Multisample.NumSamples);
 }
 
 } // namespace RenderCore
@@ -44,12 +44,48 @@ public:
 
     ITexture* Acquire(TextureDesc const& TextureDesc);
 
+    /** Acquire texture with the storage compatible to the descriptor (see TextureDesc::IsStorageCompatible).
+    A free texture of the same descriptor is preferred. */
+    ITexture* AcquireStorage(TextureDesc const& TextureDesc);
+
     void Release(ITexture* pTexture);
 
+    /** Get texture that reinterprets the storage of the acquired texture with a storage compatible descriptor.
+    Aliases are kept while the storage texture exists. */
+    ITexture* GetAlias(ITexture* pStorage, TextureDesc const& TextureDesc);
+
+    /** Destroy free textures that were not used during the given number of frames. Call it once per frame. */
+    void CleanupUnusedTextures(uint32_t MaxUnusedFrames);
+
+    int GetTextureCount() const { return Textures.Size(); }
+
+    /** Memory of all textures owned by the cache, including free ones */
+    size_t GetTextureMemory() const { return TextureMemory; }
+
+    /** Approximate memory size of the texture */
+    static size_t CalcTextureMemory(TextureDesc const& Desc);
+
 private:
+    ITexture* CreateTexture(TextureDesc const& TextureDesc);
+
+    struct FreeTexture
+    {
+        ITexture* Texture;
+        uint32_t  ReleaseFrame;
+    };
+
+    struct TextureAlias
+    {
+        ITexture*      Storage;
+        TRef<ITexture> Texture;
+    };
+
     TRef<IDevice>           pDevice;
     TVector<TRef<ITexture>> Textures;     // All textures
-    TVector<ITexture*>      FreeTextures; // Free list
+    TVector<FreeTexture>    FreeTextures; // Free list
+    TVector<TextureAlias>   Aliases;
+    uint32_t                FrameIndex{};
+    size_t                  TextureMemory{};
 };
 
 } // namespace RenderCore
@@ -30,20 +30,237 @@ SOFTWARE.
 
 #include "FrameGraph.h"
 #include <Engine/Core/IO.h>
+#include <Engine/Core/HashFunc.h>
+#include <Engine/Core/Platform/Platform.h>
+#include <Engine/Image/Image.h>
 
 HK_NAMESPACE_BEGIN
 
 namespace RenderCore
 {
 
+namespace
+{
+
+// Limit the number of different topologies kept in the cache
+constexpr int MAX_COMPILED_GRAPHS = 32;
+
+HK_FORCEINLINE void AddKey64(TVector<uint32_t>& Key, uint64_t Value)
+{
+    Key.Add(uint32_t(Value));
+    Key.Add(uint32_t(Value >> 32));
+}
+
+// Keys are compared exactly on lookup, so the hash only has to be cheap
+HK_FORCEINLINE uint32_t HashKey(TVector<uint32_t> const& Key)
+{
+    // FNV-1a in four independent lanes
+    uint32_t lanes[4] = {2166136261u, 2166136261u, 2166136261u, 2166136261u};
+
+    uint32_t const* words = Key.ToPtr();
+    int count = Key.Size();
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        lanes[0] = (lanes[0] ^ words[i]) * 16777619u;
+        lanes[1] = (lanes[1] ^ words[i + 1]) * 16777619u;
+        lanes[2] = (lanes[2] ^ words[i + 2]) * 16777619u;
+        lanes[3] = (lanes[3] ^ words[i + 3]) * 16777619u;
+    }
+    for (; i < count; i++)
+        lanes[0] = (lanes[0] ^ words[i]) * 16777619u;
+
+    uint32_t hash = HashTraits::Murmur3Hash32(lanes[0]);
+    hash = HashTraits::HashCombine(hash, lanes[1]);
+    hash = HashTraits::HashCombine(hash, lanes[2]);
+    hash = HashTraits::HashCombine(hash, lanes[3]);
+    return hash;
+}
+
+HK_FORCEINLINE bool CompareKeys(TVector<uint32_t> const& A, TVector<uint32_t> const& B)
+{
+    return A.Size() == B.Size() && !std::memcmp(A.ToPtr(), B.ToPtr(), A.Size() * sizeof(uint32_t));
+}
+
+} // namespace
+
 void FrameGraph::Build()
 {
     HK_ASSERT(CapturedResources.IsEmpty());
 
+    int64_t startTime = Platform::SysMicroseconds();
+
     //pFramebufferCache->CleanupOutdatedFramebuffers();
 
     RegisterResources();
 
+    for (FGResourceProxyBase* resource : Resources)
+    {
+        if (resource->IsCaptured())
+        {
+            CapturedResources.Add(resource);
+        }
+    }
+
+    if (bCacheEnabled)
+    {
+        MakeCacheKey(CacheKey);
+
+        uint32_t hash = HashKey(CacheKey);
+
+        auto it = CompiledGraphs.Find(hash);
+        if (it != CompiledGraphs.End() && CompareKeys(it->second.Key, CacheKey))
+        {
+            ApplyCompiledGraph(it->second);
+
+            Stat.NumCacheHits++;
+        }
+        else
+        {
+            Compile();
+
+            if (it == CompiledGraphs.End() && CompiledGraphs.Size() >= MAX_COMPILED_GRAPHS)
+            {
+                CompiledGraphs.Clear();
+            }
+
+            CompiledGraph& compiled = CompiledGraphs[hash];
+            compiled.Key = CacheKey;
+            StoreCompiledGraph(compiled);
+        }
+    }
+    else
+    {
+        Compile();
+    }
+
+    SlotTextures.Clear();
+    SlotTextures.Resize(Slots.Size(), nullptr);
+
+    Stat.AliasedTextureMemory   = Math::Max(Stat.AliasedTextureMemory, AliasedTextureMemory);
+    Stat.ExactDescTextureMemory = Math::Max(Stat.ExactDescTextureMemory, ExactDescTextureMemory);
+
+    Stat.NumBuilds++;
+    Stat.BuildTimeMicroseconds += Platform::SysMicroseconds() - startTime;
+}
+
+void FrameGraph::MakeCacheKey(TVector<uint32_t>& Key) const
+{
+    Key.Clear();
+    Key.Add(RenderTasks.Size());
+    Key.Add(ExternalResources.Size());
+
+    for (std::unique_ptr<FGRenderTaskBase> const& task : RenderTasks)
+    {
+        Key.Add(task->ProxyType | (task->bCulled << 8));
+        Key.Add(task->ProducedResources.Size());
+        Key.Add(task->ReadResources.Size());
+        Key.Add(task->WriteResources.Size());
+        Key.Add(task->ReadWriteResources.Size());
+
+        for (auto& resource : task->ProducedResources)
+        {
+            Key.Add(resource->GetId());
+            Key.Add(resource->GetProxyType() | (resource->IsCaptured() << 8));
+
+            switch (resource->GetProxyType())
+            {
+                case DEVICE_OBJECT_TYPE_TEXTURE: {
+                    TextureDesc const& desc = static_cast<FGTextureProxy const*>(resource.get())->GetResourceDesc();
+                    Key.Add(desc.Type | (desc.Format << 8) | (uint32_t(desc.BindFlags) << 16));
+                    Key.Add(desc.Resolution.Width);
+                    Key.Add(desc.Resolution.Height);
+                    Key.Add(desc.Resolution.SliceCount);
+                    Key.Add(desc.Multisample.NumSamples | (desc.Multisample.bFixedSampleLocations << 8) | (uint32_t(desc.NumMipLevels) << 16));
+                    Key.Add(desc.Swizzle.R | (desc.Swizzle.G << 8) | (desc.Swizzle.B << 16) | (uint32_t(desc.Swizzle.A) << 24));
+                    break;
+                }
+                case DEVICE_OBJECT_TYPE_BUFFER_VIEW: {
+                    BufferViewDesc const& desc = static_cast<FGBufferViewProxy const*>(resource.get())->GetResourceDesc();
+                    Key.Add(desc.Format);
+                    AddKey64(Key, desc.Offset);
+                    AddKey64(Key, desc.SizeInBytes);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        for (FGResourceProxyBase* resource : task->ReadResources)
+            Key.Add(resource->GetId());
+        for (FGResourceProxyBase* resource : task->WriteResources)
+            Key.Add(resource->GetId());
+        for (FGResourceProxyBase* resource : task->ReadWriteResources)
+            Key.Add(resource->GetId());
+    }
+
+    for (auto& resource : ExternalResources)
+    {
+        Key.Add(resource->GetId());
+        Key.Add(resource->GetProxyType() | (resource->IsCaptured() << 8));
+    }
+}
+
+void FrameGraph::StoreCompiledGraph(CompiledGraph& Compiled) const
+{
+    Compiled.Timeline = Timeline;
+
+    Compiled.TaskIndices.Clear();
+    Compiled.TaskIndices.Reserve(Timeline.Size());
+
+    int taskIndex = 0;
+    for (TimelineStep const& step : Timeline)
+    {
+        while (RenderTasks[taskIndex].get() != step.RenderTask)
+            taskIndex++;
+        Compiled.TaskIndices.Add(taskIndex);
+    }
+
+    Compiled.AcquiredResources.Clear();
+    Compiled.AcquiredResources.Reserve(AcquiredResources.Size());
+    for (FGResourceProxyBase* resource : AcquiredResources)
+        Compiled.AcquiredResources.Add(resource->GetId());
+
+    Compiled.ReleasedResources.Clear();
+    Compiled.ReleasedResources.Reserve(ReleasedResources.Size());
+    for (FGResourceProxyBase* resource : ReleasedResources)
+        Compiled.ReleasedResources.Add(resource->GetId());
+
+    Compiled.AcquiredSlots          = AcquiredSlots;
+    Compiled.ReleasedSlots          = ReleasedSlots;
+    Compiled.Slots                  = Slots;
+    Compiled.AliasedTextureMemory   = AliasedTextureMemory;
+    Compiled.ExactDescTextureMemory = ExactDescTextureMemory;
+}
+
+void FrameGraph::ApplyCompiledGraph(CompiledGraph const& Compiled)
+{
+    Timeline = Compiled.Timeline;
+    for (int i = 0; i < Timeline.Size(); i++)
+    {
+        Timeline[i].RenderTask = RenderTasks[Compiled.TaskIndices[i]].get();
+    }
+
+    AcquiredResources.Clear();
+    AcquiredResources.Reserve(Compiled.AcquiredResources.Size());
+    for (uint32_t id : Compiled.AcquiredResources)
+        AcquiredResources.Add(ResourceById[id]);
+
+    ReleasedResources.Clear();
+    ReleasedResources.Reserve(Compiled.ReleasedResources.Size());
+    for (uint32_t id : Compiled.ReleasedResources)
+        ReleasedResources.Add(ResourceById[id]);
+
+    AcquiredSlots          = Compiled.AcquiredSlots;
+    ReleasedSlots          = Compiled.ReleasedSlots;
+    Slots                  = Compiled.Slots;
+    AliasedTextureMemory   = Compiled.AliasedTextureMemory;
+    ExactDescTextureMemory = Compiled.ExactDescTextureMemory;
+}
+
+void FrameGraph::Compile()
+{
     for (std::unique_ptr<FGRenderTaskBase>& task : RenderTasks)
     {
         task->ResourceRefs = task->ProducedResources.Size() + task->WriteResources.Size() + task->ReadWriteResources.Size();
@@ -52,11 +269,6 @@ void FrameGraph::Build()
     for (FGResourceProxyBase* resource : Resources)
     {
         resource->ResourceRefs = resource->Readers.Size();
-
-        if (resource->IsCaptured())
-        {
-            CapturedResources.Add(resource);
-        }
     }
 
     UnreferencedResources.Clear();
@@ -184,7 +396,12 @@ void FrameGraph::Build()
 
             if (bValid && RenderTasks[lastIndex] == task)
             {
-                ReleasedResources.Add(const_cast<FGResourceProxyBase*>(resource));
+                // The task may access the same resource several times, release it once
+                auto first = ReleasedResources.Begin() + firstReleasedResource;
+                if (std::find(first, ReleasedResources.End(), resource) == ReleasedResources.End())
+                {
+                    ReleasedResources.Add(const_cast<FGResourceProxyBase*>(resource));
+                }
             }
         }
 
@@ -199,6 +416,212 @@ void FrameGraph::Build()
         step.FirstReleasedResource = firstReleasedResource;
         step.NumReleasedResources  = numReleasedResources;
     }
+
+    PlanAliasing();
+}
+
+void FrameGraph::PlanAliasing()
+{
+    AcquiredSlots.Clear();
+    AcquiredSlots.Resize(AcquiredResources.Size(), -1);
+
+    Slots.Clear();
+    SlotFreeStep.Clear();
+    SlotLastRelease.Clear();
+
+    ResourceSlots.Clear();
+    ResourceSlots.Resize(IdGenerator, -1);
+
+    ExactDescSlots.Clear();
+    ExactDescSlotFreeStep.Clear();
+
+    ResourceExactDescSlots.Clear();
+    ResourceExactDescSlots.Resize(IdGenerator, -1);
+
+    AliasedTextureMemory   = 0;
+    ExactDescTextureMemory = 0;
+
+    for (int stepIndex = 0; stepIndex < Timeline.Size(); stepIndex++)
+    {
+        TimelineStep const& step = Timeline[stepIndex];
+
+        for (int i = step.FirstAcquiredResource; i < step.FirstAcquiredResource + step.NumAcquiredResources; i++)
+        {
+            FGResourceProxyBase* resource = AcquiredResources[i];
+            if (!resource->IsTransient() || resource->GetProxyType() != DEVICE_OBJECT_TYPE_TEXTURE)
+            {
+                continue;
+            }
+
+            TextureDesc const& desc = static_cast<FGTextureProxy*>(resource)->GetResourceDesc();
+
+            // Take a slot that was released by one of the previous steps. A slot with the same descriptor is preferred,
+            // otherwise the resource gets a texture view of the slot texture.
+            int slot = -1;
+            for (int n = 0; n < Slots.Size(); n++)
+            {
+                if (SlotFreeStep[n] < stepIndex && Slots[n].IsStorageCompatible(desc))
+                {
+                    slot = n;
+                    if (Slots[n] == desc)
+                        break;
+                }
+            }
+
+            if (slot == -1)
+            {
+                slot = Slots.Size();
+                Slots.Add(desc);
+                SlotFreeStep.Add(0);
+                SlotLastRelease.Add(-1);
+
+                AliasedTextureMemory += FGRenderTargetCache::CalcTextureMemory(desc);
+            }
+
+            SlotFreeStep[slot]    = std::numeric_limits<int>::max();
+            SlotLastRelease[slot] = -1;
+
+            AcquiredSlots[i] = slot;
+            ResourceSlots[resource->GetId()] = slot;
+
+            // Same plan without texture views, for statistics
+            int exactDescSlot = -1;
+            for (int n = 0; n < ExactDescSlots.Size(); n++)
+            {
+                if (ExactDescSlotFreeStep[n] < stepIndex && ExactDescSlots[n] == desc)
+                {
+                    exactDescSlot = n;
+                    break;
+                }
+            }
+
+            if (exactDescSlot == -1)
+            {
+                exactDescSlot = ExactDescSlots.Size();
+                ExactDescSlots.Add(desc);
+                ExactDescSlotFreeStep.Add(0);
+
+                ExactDescTextureMemory += FGRenderTargetCache::CalcTextureMemory(desc);
+            }
+
+            ExactDescSlotFreeStep[exactDescSlot] = std::numeric_limits<int>::max();
+            ResourceExactDescSlots[resource->GetId()] = exactDescSlot;
+        }
+
+        for (int i = step.FirstReleasedResource; i < step.FirstReleasedResource + step.NumReleasedResources; i++)
+        {
+            int slot = ResourceSlots[ReleasedResources[i]->GetId()];
+            if (slot != -1)
+            {
+                SlotFreeStep[slot]    = stepIndex;
+                SlotLastRelease[slot] = i;
+
+                ExactDescSlotFreeStep[ResourceExactDescSlots[ReleasedResources[i]->GetId()]] = stepIndex;
+            }
+        }
+    }
+
+    // Slots whose last owner is neither released nor captured go back to the cache after the last step
+    if (!Timeline.IsEmpty())
+    {
+        for (int i = 0; i < AcquiredResources.Size(); i++)
+        {
+            int slot = AcquiredSlots[i];
+            if (slot != -1 && SlotFreeStep[slot] == std::numeric_limits<int>::max() && !AcquiredResources[i]->IsCaptured())
+            {
+                bool bLastOwner = true;
+                for (int n = i + 1; n < AcquiredResources.Size() && bLastOwner; n++)
+                    bLastOwner = AcquiredSlots[n] != slot;
+                if (bLastOwner)
+                {
+                    SlotFreeStep[slot]    = Timeline.Size() - 1;
+                    SlotLastRelease[slot] = ReleasedResources.Size();
+                    ReleasedResources.Add(AcquiredResources[i]);
+                    Timeline.Last().NumReleasedResources++;
+                }
+            }
+        }
+    }
+
+    // Only the last release of the slot returns the texture to the cache
+    ReleasedSlots.Clear();
+    ReleasedSlots.Resize(ReleasedResources.Size(), -1);
+    for (int slot = 0; slot < Slots.Size(); slot++)
+    {
+        if (SlotLastRelease[slot] != -1)
+        {
+            ReleasedSlots[SlotLastRelease[slot]] = slot;
+        }
+    }
+}
+
+void FrameGraph::AcquireResources(TimelineStep const& Step)
+{
+    for (int i = Step.FirstAcquiredResource; i < Step.FirstAcquiredResource + Step.NumAcquiredResources; i++)
+    {
+        FGResourceProxyBase* resourceProxy = AcquiredResources[i];
+        if (resourceProxy->IsTransient())
+        {
+            switch (resourceProxy->GetProxyType())
+            {
+                case DEVICE_OBJECT_TYPE_TEXTURE: {
+                    int slot = AcquiredSlots[i];
+                    if (!SlotTextures[slot])
+                    {
+                        SlotTextures[slot] = pRenderTargetCache->AcquireStorage(Slots[slot]);
+                    }
+
+                    ITexture*          texture = SlotTextures[slot];
+                    TextureDesc const& desc    = static_cast<FGTextureProxy*>(resourceProxy)->GetResourceDesc();
+                    if (texture->GetDesc() != desc)
+                    {
+                        // View of the slot texture in the format of the resource
+                        texture = pRenderTargetCache->GetAlias(texture, desc);
+                    }
+                    resourceProxy->SetDeviceObject(texture);
+
+                    Stat.RenderTargetCacheMemory = Math::Max(Stat.RenderTargetCacheMemory, pRenderTargetCache->GetTextureMemory());
+                    break;
+                }
+                default:
+                    HK_ASSERT(0);
+            }
+        }
+    }
+}
+
+void FrameGraph::ReleaseResources(TimelineStep const& Step)
+{
+    for (int i = Step.FirstReleasedResource; i < Step.FirstReleasedResource + Step.NumReleasedResources; i++)
+    {
+        FGResourceProxyBase* resourceProxy = ReleasedResources[i];
+        if (resourceProxy->IsTransient() && resourceProxy->GetDeviceObject())
+        {
+            switch (resourceProxy->GetProxyType())
+            {
+                case DEVICE_OBJECT_TYPE_TEXTURE: {
+                    int slot = ReleasedSlots[i];
+                    if (slot != -1)
+                    {
+                        pRenderTargetCache->Release(SlotTextures[slot]);
+                        SlotTextures[slot] = nullptr;
+                    }
+                    else
+                    {
+                        // The texture is passed to the next resource of the slot, its contents are not needed anymore
+                        ITexture* texture = static_cast<ITexture*>(resourceProxy->GetDeviceObject());
+                        for (uint16_t mipLevel = 0; mipLevel < texture->GetDesc().NumMipLevels; mipLevel++)
+                        {
+                            texture->Invalidate(mipLevel);
+                        }
+                    }
+                    break;
+                }
+                default:
+                    HK_ASSERT(0);
+            }
+        }
+    }
 }
 
 void FrameGraph::Debug()
@@ -225,6 +648,8 @@ void FrameGraph::Debug()
 
 void FrameGraph::ExportGraphviz(StringView FileName)
 {
+    // NOTE: Reference counters are only updated when the timeline is compiled, not when it is taken from the cache
+
     File f = File::OpenWrite(FileName);
     if (!f)
     {
@@ -36,18 +36,43 @@ SOFTWARE.
 
 #include <Engine/Core/String.h>
 #include <Engine/Core/Containers/Stack.h>
+#include <Engine/Core/Containers/Hash.h>
 
 #include <Engine/RenderCore/Device.h>
 
 // TODO:
 // 1. Optimize. Very slow framegraph rebuilding in debug mode.
-// 2. Destroy unused framebuffers and textures (after some time?)
+// 2. Destroy unused framebuffers (after some time?)
 
 HK_NAMESPACE_BEGIN
 
 namespace RenderCore
 {
 
+/** Frame graph build statistics */
+struct FrameGraphStat
+{
+    /** Number of Build() calls */
+    uint32_t NumBuilds{};
+
+    /** Number of builds that reused a compiled timeline */
+    uint32_t NumCacheHits{};
+
+    /** Total time spent in Build() */
+    int64_t BuildTimeMicroseconds{};
+
+    /** Peak memory of the textures planned to back transient resources. Resources with non-overlapping lifetimes
+    share a texture if they have the same size and view compatible formats (see TextureDesc::IsStorageCompatible). */
+    size_t AliasedTextureMemory{};
+
+    /** Peak memory of the plan that shares textures only between equal descriptors. This is what the render target
+    cache holds without texture views, the difference with AliasedTextureMemory is the saving of view aliasing. */
+    size_t ExactDescTextureMemory{};
+
+    /** Peak memory of all textures owned by the render target cache, including free ones */
+    size_t RenderTargetCacheMemory{};
+};
+
 class FrameGraph : public RefCounted
 {
 public:
@@ -72,6 +97,7 @@ public:
             resource->pDeviceObject->RemoveRef();
         ExternalResources.Clear();
         Resources.Clear();
+        ResourceById.Clear();
         RenderTasks.Clear();
         IdGenerator = 0;
     }
@@ -91,10 +117,23 @@ public:
         return static_cast<T*>(ExternalResources.Last().get());
     }
 
+    /** Build the timeline. If the declared tasks and resources match a previous build, its compiled timeline is reused. */
     void Build();
 
     void Debug();
 
+    /** Enable or disable reuse of compiled timelines across builds */
+    void SetCacheEnabled(bool bEnabled)
+    {
+        bCacheEnabled = bEnabled;
+        if (!bEnabled)
+            CompiledGraphs.Clear();
+    }
+
+    FrameGraphStat const& GetStat() const { return Stat; }
+
+    void ResetStat() { Stat = {}; }
+
     void ExportGraphviz(StringView FileName);
 
     std::size_t GenerateResourceId() const
@@ -131,10 +170,33 @@ public:
         return ReleasedResources;
     }
 
+    /** Acquire device objects for transient resources of the step. Backends call it before executing the step task. */
+    void AcquireResources(TimelineStep const& Step);
+
+    /** Release transient resources that are not needed after the step */
+    void ReleaseResources(TimelineStep const& Step);
+
 private:
+    /** Compiled timeline with tasks referenced by index and resources by id, so it can be applied to a new graph with the same topology */
+    struct CompiledGraph
+    {
+        TVector<uint32_t>     Key;
+        TVector<TimelineStep> Timeline;
+        TVector<int>          TaskIndices;
+        TVector<uint32_t>     AcquiredResources;
+        TVector<uint32_t>     ReleasedResources;
+        TVector<int>          AcquiredSlots;
+        TVector<int>          ReleasedSlots;
+        TVector<TextureDesc>  Slots;
+        size_t                AliasedTextureMemory;
+        size_t                ExactDescTextureMemory;
+    };
+
     void RegisterResources()
     {
         Resources.Clear();
+        ResourceById.Clear();
+        ResourceById.Resize(IdGenerator);
 
         for (std::unique_ptr<FGRenderTaskBase>& task : RenderTasks)
         {
@@ -148,8 +210,23 @@ private:
         {
             Resources.Add(resourcePtr.get());
         }
+
+        for (FGResourceProxyBase* resource : Resources)
+        {
+            ResourceById[resource->GetId()] = resource;
+        }
     }
 
+    void MakeCacheKey(TVector<uint32_t>& Key) const;
+
+    void Compile();
+
+    void PlanAliasing();
+
+    void StoreCompiledGraph(CompiledGraph& Compiled) const;
+
+    void ApplyCompiledGraph(CompiledGraph const& Compiled);
+
     void ReleaseCapturedResources();
 
     TRef<IDevice>             pDevice;
@@ -159,13 +236,36 @@ private:
     TVector<std::unique_ptr<FGResourceProxyBase>> ExternalResources;
     TVector<FGResourceProxyBase*>              Resources; // all resources
     TVector<FGResourceProxyBase*>              CapturedResources;
+    TVector<FGResourceProxyBase*>              ResourceById;
 
     TVector<TimelineStep>        Timeline;
     TVector<FGResourceProxyBase*> AcquiredResources, ReleasedResources;
 
+    // Aliasing plan. Transient textures with compatible storage and non-overlapping lifetimes share a slot,
+    // each slot is backed by one texture from the render target cache. Resources with a descriptor different from
+    // the slot use a texture view of the slot texture.
+    TVector<int>         AcquiredSlots; // Slot for each acquired resource or -1
+    TVector<int>         ReleasedSlots; // Slot that is returned to the cache by the release or -1 if the slot is reused later
+    TVector<TextureDesc> Slots;
+    TVector<ITexture*>   SlotTextures;
+    size_t               AliasedTextureMemory{};
+    size_t               ExactDescTextureMemory{};
+
     // Temporary data. Used for building
     TStack<FGResourceProxyBase*>  UnreferencedResources;
     TVector<FGResourceProxyBase*> ResourcesRW;
+    TVector<uint32_t>             CacheKey;
+    TVector<int>                  SlotFreeStep;
+    TVector<int>                  SlotLastRelease;
+    TVector<int>                  ResourceSlots;
+    TVector<TextureDesc>          ExactDescSlots;
+    TVector<int>                  ExactDescSlotFreeStep;
+    TVector<int>                  ResourceExactDescSlots;
+
+    THashMap<uint32_t, CompiledGraph> CompiledGraphs;
+    bool                              bCacheEnabled = true;
+
+    FrameGraphStat Stat;
 
     mutable std::size_t IdGenerator = 0;
 };
@@ -29,3 +29,196 @@ SOFTWARE.
 */
 
 #include "ImmediateContext.h"
+#include "CommandList.h"
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+static constexpr uint32_t UNKNOWN_UID = ~0u;
+
+void IImmediateContext::SetStateFilterEnabled(bool bEnabled)
+{
+    if (bStateFilterEnabled != bEnabled)
+    {
+        bStateFilterEnabled = bEnabled;
+        InvalidateStateFilter();
+    }
+}
+
+void IImmediateContext::InvalidateStateFilter()
+{
+    State.PipelineUID = UNKNOWN_UID;
+    for (int i = 0; i < MAX_VERTEX_BUFFER_SLOTS; i++)
+    {
+        State.VertexBufferUIDs[i]    = UNKNOWN_UID;
+        State.VertexBufferOffsets[i] = 0;
+    }
+    State.IndexBufferUID    = UNKNOWN_UID;
+    State.IndexBufferOffset = 0;
+    State.IndexType         = INDEX_TYPE_UINT16;
+    State.ResourceTableUID  = UNKNOWN_UID;
+}
+
+bool IImmediateContext::FilterPipeline(IPipeline* pPipeline)
+{
+    uint32_t uid = pPipeline ? pPipeline->GetUID() : 0;
+
+    if (bStateFilterEnabled && State.PipelineUID == uid)
+    {
+        Stat.RedundantPipelineChanges++;
+        return false;
+    }
+
+    State.PipelineUID = uid;
+    Stat.PipelineChanges++;
+    return true;
+}
+
+bool IImmediateContext::FilterVertexBuffer(unsigned int InputSlot, IBuffer const* pVertexBuffer, unsigned int Offset)
+{
+    HK_ASSERT(InputSlot < MAX_VERTEX_BUFFER_SLOTS);
+
+    uint32_t uid = pVertexBuffer ? pVertexBuffer->GetUID() : 0;
+
+    if (bStateFilterEnabled && State.VertexBufferUIDs[InputSlot] == uid && State.VertexBufferOffsets[InputSlot] == Offset)
+    {
+        Stat.RedundantVertexBufferChanges++;
+        return false;
+    }
+
+    State.VertexBufferUIDs[InputSlot]    = uid;
+    State.VertexBufferOffsets[InputSlot] = Offset;
+    Stat.VertexBufferChanges++;
+    return true;
+}
+
+bool IImmediateContext::FilterIndexBuffer(IBuffer const* pIndexBuffer, INDEX_TYPE Type, unsigned int Offset)
+{
+    uint32_t uid = pIndexBuffer ? pIndexBuffer->GetUID() : 0;
+
+    if (bStateFilterEnabled && State.IndexBufferUID == uid && State.IndexType == Type && State.IndexBufferOffset == Offset)
+    {
+        Stat.RedundantIndexBufferChanges++;
+        return false;
+    }
+
+    State.IndexBufferUID    = uid;
+    State.IndexType         = Type;
+    State.IndexBufferOffset = Offset;
+    Stat.IndexBufferChanges++;
+    return true;
+}
+
+bool IImmediateContext::FilterResourceTable(IResourceTable* pResourceTable)
+{
+    if (!pResourceTable)
+    {
+        pResourceTable = GetRootResourceTable();
+    }
+
+    uint32_t uid = pResourceTable->GetUID();
+
+    if (bStateFilterEnabled && State.ResourceTableUID == uid)
+    {
+        Stat.RedundantResourceTableChanges++;
+        return false;
+    }
+
+    State.ResourceTableUID = uid;
+    Stat.ResourceTableChanges++;
+    return true;
+}
+
+void IImmediateContext::ExecuteCommandList(CommandList const& CmdList)
+{
+    IResourceTable* resourceTable = GetRootResourceTable();
+
+    uint8_t const* data = CmdList.GetData();
+    uint8_t const* end  = data + CmdList.GetSizeInBytes();
+
+    while (data < end)
+    {
+        switch (reinterpret_cast<CommandPacket const*>(data)->Type)
+        {
+            case COMMAND_PACKET_BIND_PIPELINE:
+            {
+                auto packet = reinterpret_cast<CommandPacket_BindPipeline const*>(data);
+                BindPipeline(packet->pPipeline);
+                data += CommandList::GetPacketSize<CommandPacket_BindPipeline>();
+                break;
+            }
+            case COMMAND_PACKET_BIND_VERTEX_BUFFER:
+            {
+                auto packet = reinterpret_cast<CommandPacket_BindVertexBuffer const*>(data);
+                BindVertexBuffer(packet->InputSlot, packet->pBuffer, packet->Offset);
+                data += CommandList::GetPacketSize<CommandPacket_BindVertexBuffer>();
+                break;
+            }
+            case COMMAND_PACKET_BIND_INDEX_BUFFER:
+            {
+                auto packet = reinterpret_cast<CommandPacket_BindIndexBuffer const*>(data);
+                BindIndexBuffer(packet->pBuffer, packet->IndexType, packet->Offset);
+                data += CommandList::GetPacketSize<CommandPacket_BindIndexBuffer>();
+                break;
+            }
+            case COMMAND_PACKET_BIND_TEXTURE:
+            {
+                auto packet = reinterpret_cast<CommandPacket_BindTexture const*>(data);
+                resourceTable->BindTexture(packet->Slot, packet->pView);
+                data += CommandList::GetPacketSize<CommandPacket_BindTexture>();
+                break;
+            }
+            case COMMAND_PACKET_BIND_BUFFER:
+            {
+                auto packet = reinterpret_cast<CommandPacket_BindBuffer const*>(data);
+                resourceTable->BindBuffer(packet->Slot, packet->pBuffer, packet->Offset, packet->Size);
+                data += CommandList::GetPacketSize<CommandPacket_BindBuffer>();
+                break;
+            }
+            case COMMAND_PACKET_SET_VIEWPORT:
+            {
+                auto packet = reinterpret_cast<CommandPacket_SetViewport const*>(data);
+                SetViewport(packet->Rect);
+                data += CommandList::GetPacketSize<CommandPacket_SetViewport>();
+                break;
+            }
+            case COMMAND_PACKET_SET_SCISSOR:
+            {
+                auto packet = reinterpret_cast<CommandPacket_SetScissor const*>(data);
+                SetScissor(packet->Scissor);
+                data += CommandList::GetPacketSize<CommandPacket_SetScissor>();
+                break;
+            }
+            case COMMAND_PACKET_STENCIL_REF:
+            {
+                auto packet = reinterpret_cast<CommandPacket_StencilRef const*>(data);
+                DynamicState_StencilRef(packet->StencilRef);
+                data += CommandList::GetPacketSize<CommandPacket_StencilRef>();
+                break;
+            }
+            case COMMAND_PACKET_DRAW:
+            {
+                auto packet = reinterpret_cast<CommandPacket_Draw const*>(data);
+                Draw(&packet->Cmd);
+                data += CommandList::GetPacketSize<CommandPacket_Draw>();
+                break;
+            }
+            case COMMAND_PACKET_DRAW_INDEXED:
+            {
+                auto packet = reinterpret_cast<CommandPacket_DrawIndexed const*>(data);
+                Draw(&packet->Cmd);
+                data += CommandList::GetPacketSize<CommandPacket_DrawIndexed>();
+                break;
+            }
+            default:
+                HK_ASSERT(0);
+                return;
+        }
+    }
+}
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
@@ -409,6 +409,43 @@ public:
     virtual void BindBuffer(int Slot, IBuffer const* pBuffer, size_t Offset = 0, size_t Size = 0) = 0;
 };
 
+/** Command statistics collected by the context. Backends fill in what they can track. */
+struct ImmediateContextStat
+{
+    uint32_t DrawCalls{};
+    uint32_t DispatchCalls{};
+    uint32_t RenderPasses{};
+
+    uint32_t PipelineChanges{};
+    uint32_t VertexBufferChanges{};
+    uint32_t IndexBufferChanges{};
+    uint32_t ResourceTableChanges{};
+    uint32_t ResourceBindings{};
+    uint32_t ViewportChanges{};
+    uint32_t ScissorChanges{};
+    uint32_t DynamicStateChanges{};
+
+    uint32_t BufferUploads{};
+    size_t   BufferUploadBytes{};
+    uint32_t BufferMaps{};
+    uint32_t TextureUploads{};
+    size_t   TextureUploadBytes{};
+    uint32_t Copies{};
+    uint32_t Clears{};
+
+    // Binds removed by the redundant state filter
+    uint32_t RedundantPipelineChanges{};
+    uint32_t RedundantVertexBufferChanges{};
+    uint32_t RedundantIndexBufferChanges{};
+    uint32_t RedundantResourceTableChanges{};
+    uint32_t RedundantResourceBindings{};
+
+    uint32_t GetRedundantChanges() const
+    {
+        return RedundantPipelineChanges + RedundantVertexBufferChanges + RedundantIndexBufferChanges + RedundantResourceTableChanges + RedundantResourceBindings;
+    }
+};
+
 class IImmediateContext : public IDeviceObject
 {
 public:
@@ -416,10 +453,24 @@ public:
 
     IImmediateContext(IDevice* pDevice) :
         IDeviceObject(pDevice, PROXY_TYPE, true)
-    {}
+    {
+        InvalidateStateFilter();
+    }
+
+    ImmediateContextStat const& GetStat() const { return Stat; }
+
+    void ResetStat() { Stat = {}; }
+
+    /** Enable or disable filtering of redundant pipeline, vertex/index buffer and resource table binds */
+    void SetStateFilterEnabled(bool bEnabled);
+
+    bool IsStateFilterEnabled() const { return bStateFilterEnabled; }
 
     virtual void ExecuteFrameGraph(class FrameGraph* pFrameGraph) = 0;
 
+    /** Replay commands recorded to the deferred command list */
+    void ExecuteCommandList(class CommandList const& CmdList);
+
     //
     // Pipeline
     //
@@ -885,6 +936,34 @@ public:
                                                        size_t              SizeInBytes,
                                                        unsigned int        Alignment,
                                                        void*               pSysMem) = 0;
+
+protected:
+    /** Redundant state filter shared by the backends. The functions return false if the state is already set.
+    Issued and removed changes are counted in Stat. */
+    bool FilterPipeline(IPipeline* pPipeline);
+    bool FilterVertexBuffer(unsigned int InputSlot, IBuffer const* pVertexBuffer, unsigned int Offset);
+    bool FilterIndexBuffer(IBuffer const* pIndexBuffer, INDEX_TYPE Type, unsigned int Offset);
+    bool FilterResourceTable(IResourceTable* pResourceTable);
+
+    /** Forget the filtered state. Call it when the backend resets its own bindings. */
+    void InvalidateStateFilter();
+
+    ImmediateContextStat Stat;
+
+private:
+    struct FilteredState
+    {
+        uint32_t   PipelineUID;
+        uint32_t   VertexBufferUIDs[MAX_VERTEX_BUFFER_SLOTS];
+        uint32_t   VertexBufferOffsets[MAX_VERTEX_BUFFER_SLOTS];
+        uint32_t   IndexBufferUID;
+        uint32_t   IndexBufferOffset;
+        INDEX_TYPE IndexType;
+        uint32_t   ResourceTableUID;
+    };
+
+    FilteredState State;
+    bool          bStateFilterEnabled{true};
 };
 
 } // namespace RenderCore
@@ -0,0 +1,185 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "BufferNullImpl.h"
+#include "DeviceNullImpl.h"
+#include "ImmediateContextNullImpl.h"
+
+#include <Engine/Core/Platform/Logger.h>
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+BufferNullImpl::BufferNullImpl(DeviceNullImpl* pDevice, BufferDesc const& Desc, const void* SysMem) :
+    IBuffer(pDevice, Desc)
+{
+    // Keep the contents in system memory, so mapping and readback work as usual
+    pStorage = (uint8_t*)pDevice->GetAllocator().Allocate(Math::Max<size_t>(Desc.SizeInBytes, 1));
+    if (!pStorage)
+    {
+        LOG("BufferNullImpl::ctor: couldn't allocate buffer size {} bytes\n", Desc.SizeInBytes);
+        return;
+    }
+
+    if (SysMem)
+    {
+        Platform::Memcpy(pStorage, SysMem, Desc.SizeInBytes);
+    }
+    else
+    {
+        Platform::ZeroMem(pStorage, Desc.SizeInBytes);
+    }
+
+    SetHandle(pStorage);
+
+    pDevice->BufferMemoryAllocated += Desc.SizeInBytes;
+}
+
+BufferNullImpl::~BufferNullImpl()
+{
+    DeviceNullImpl* pDevice = static_cast<DeviceNullImpl*>(GetDevice());
+
+    if (pStorage)
+    {
+        pDevice->GetAllocator().Deallocate(pStorage);
+
+        pDevice->BufferMemoryAllocated -= GetDesc().SizeInBytes;
+    }
+}
+
+bool BufferNullImpl::CreateView(BufferViewDesc const& BufferViewDesc, TRef<IBufferView>* ppBufferView)
+{
+    *ppBufferView = MakeRef<BufferViewNullImpl>(BufferViewDesc, this);
+    return true;
+}
+
+bool BufferNullImpl::Orphan()
+{
+    if (GetDesc().bImmutableStorage)
+    {
+        LOG("Buffer::Orphan: expected mutable buffer\n");
+        return false;
+    }
+    return true;
+}
+
+void BufferNullImpl::Invalidate()
+{
+}
+
+void BufferNullImpl::InvalidateRange(size_t _RangeOffset, size_t _RangeSize)
+{
+}
+
+void BufferNullImpl::FlushMappedRange(size_t _RangeOffset, size_t _RangeSize)
+{
+}
+
+void BufferNullImpl::Read(void* _SysMem)
+{
+    ReadRange(0, GetDesc().SizeInBytes, _SysMem);
+}
+
+void BufferNullImpl::ReadRange(size_t _ByteOffset, size_t _SizeInBytes, void* _SysMem)
+{
+    static_cast<DeviceNullImpl*>(GetDevice())->GetImmediateContextNull()->ReadBufferRange(this, _ByteOffset, _SizeInBytes, _SysMem);
+}
+
+void BufferNullImpl::Write(const void* _SysMem)
+{
+    WriteRange(0, GetDesc().SizeInBytes, _SysMem);
+}
+
+void BufferNullImpl::WriteRange(size_t _ByteOffset, size_t _SizeInBytes, const void* _SysMem)
+{
+    static_cast<DeviceNullImpl*>(GetDevice())->GetImmediateContextNull()->WriteBufferRange(this, _ByteOffset, _SizeInBytes, _SysMem);
+}
+
+BufferViewNullImpl::BufferViewNullImpl(BufferViewDesc const& Desc, BufferNullImpl* pBuffer) :
+    IBufferView(pBuffer->GetDevice(), Desc), pSrcBuffer(pBuffer)
+{
+    pSrcBuffer->AddRef();
+
+    if (!pSrcBuffer->IsValid())
+    {
+        LOG("BufferViewNullImpl::ctor: invalid buffer handle\n");
+        return;
+    }
+
+    SetRange(Desc.Offset, Desc.SizeInBytes);
+
+    SetHandle(this);
+}
+
+BufferViewNullImpl::~BufferViewNullImpl()
+{
+    pSrcBuffer->RemoveRef();
+}
+
+void BufferViewNullImpl::SetRange(size_t Offset, size_t SizeInBytes)
+{
+    if (!SizeInBytes)
+    {
+        Offset      = 0;
+        SizeInBytes = pSrcBuffer->GetDesc().SizeInBytes;
+    }
+
+    if (!IsAligned(Offset, GetDevice()->GetDeviceCaps(DEVICE_CAPS_BUFFER_VIEW_OFFSET_ALIGNMENT)))
+    {
+        LOG("BufferViewNullImpl::SetRange: buffer offset is not aligned\n");
+        return;
+    }
+
+    if (Offset + SizeInBytes > pSrcBuffer->GetDesc().SizeInBytes)
+    {
+        LOG("BufferViewNullImpl::SetRange: invalid buffer range\n");
+        return;
+    }
+
+    Desc.Offset      = Offset;
+    Desc.SizeInBytes = SizeInBytes;
+}
+
+size_t BufferViewNullImpl::GetBufferOffset(uint16_t MipLevel) const
+{
+    return Desc.Offset;
+}
+
+size_t BufferViewNullImpl::GetBufferSizeInBytes(uint16_t MipLevel) const
+{
+    return Desc.SizeInBytes;
+}
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
@@ -0,0 +1,257 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "DeviceNullImpl.h"
+#include "ImmediateContextNullImpl.h"
+#include "BufferNullImpl.h"
+#include "TextureNullImpl.h"
+#include "GenericWindowNullImpl.h"
+
+#include <Engine/Core/Platform/Platform.h>
+#include <Engine/Core/Platform/Logger.h>
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+static void* Allocate(size_t _BytesCount)
+{
+    return Platform::GetHeapAllocator<HEAP_RHI>().Alloc(_BytesCount);
+}
+
+static void Deallocate(void* _Bytes)
+{
+    Platform::GetHeapAllocator<HEAP_RHI>().Free(_Bytes);
+}
+
+static constexpr AllocatorCallback DefaultAllocator = {Allocate, Deallocate};
+
+DeviceNullImpl::DeviceNullImpl(AllocatorCallback const* pAllocator)
+{
+    LOG("Using null render device\n");
+
+    GraphicsVendor = VENDOR_UNKNOWN;
+
+    FeatureSupport[FEATURE_HALF_FLOAT_VERTEX]   = true;
+    FeatureSupport[FEATURE_HALF_FLOAT_PIXEL]    = true;
+    FeatureSupport[FEATURE_TEXTURE_ANISOTROPY]  = true;
+    FeatureSupport[FEATURE_SPARSE_TEXTURES]     = false;
+    FeatureSupport[FEATURE_BINDLESS_TEXTURE]    = false;
+    FeatureSupport[FEATURE_SWAP_CONTROL]        = false;
+    FeatureSupport[FEATURE_SWAP_CONTROL_TEAR]   = false;
+    FeatureSupport[FEATURE_GPU_MEMORY_INFO]     = false;
+    FeatureSupport[FEATURE_SPIR_V]              = false;
+
+    // Typical desktop limits so that the renderer takes its regular code paths
+    DeviceCaps[DEVICE_CAPS_BUFFER_VIEW_MAX_SIZE]                   = 128 << 20;
+    DeviceCaps[DEVICE_CAPS_BUFFER_VIEW_OFFSET_ALIGNMENT]           = 256;
+    DeviceCaps[DEVICE_CAPS_CONSTANT_BUFFER_OFFSET_ALIGNMENT]       = 256;
+    DeviceCaps[DEVICE_CAPS_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT] = 256;
+    DeviceCaps[DEVICE_CAPS_MAX_TEXTURE_SIZE]                       = 16384;
+    DeviceCaps[DEVICE_CAPS_MAX_TEXTURE_LAYERS]                     = 2048;
+    DeviceCaps[DEVICE_CAPS_MAX_SPARSE_TEXTURE_LAYERS]              = 0;
+    DeviceCaps[DEVICE_CAPS_MAX_TEXTURE_ANISOTROPY]                 = 16;
+    DeviceCaps[DEVICE_CAPS_MAX_PATCH_VERTICES]                     = 32;
+    DeviceCaps[DEVICE_CAPS_MAX_VERTEX_BUFFER_SLOTS]                = 16;
+    DeviceCaps[DEVICE_CAPS_MAX_VERTEX_ATTRIB_STRIDE]               = 2048;
+    DeviceCaps[DEVICE_CAPS_MAX_VERTEX_ATTRIB_RELATIVE_OFFSET]      = 2047;
+    DeviceCaps[DEVICE_CAPS_MAX_CONSTANT_BUFFER_BINDINGS]           = 84;
+    DeviceCaps[DEVICE_CAPS_MAX_SHADER_STORAGE_BUFFER_BINDINGS]     = 16;
+    DeviceCaps[DEVICE_CAPS_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS]     = 8;
+    DeviceCaps[DEVICE_CAPS_MAX_TRANSFORM_FEEDBACK_BUFFERS]         = 4;
+    DeviceCaps[DEVICE_CAPS_CONSTANT_BUFFER_MAX_BLOCK_SIZE]         = 65536;
+
+    Allocator = pAllocator ? *pAllocator : DefaultAllocator;
+
+    pImmediateContext = new ImmediateContextNullImpl(this);
+}
+
+DeviceNullImpl::~DeviceNullImpl()
+{
+    pImmediateContext->RemoveRef();
+}
+
+IImmediateContext* DeviceNullImpl::GetImmediateContext()
+{
+    return pImmediateContext;
+}
+
+void DeviceNullImpl::GetOrCreateMainWindow(DisplayVideoMode const& VideoMode, TRef<IGenericWindow>* ppWindow)
+{
+    if (pMainWindow.IsExpired())
+    {
+        *ppWindow = MakeRef<GenericWindowNullImpl>(this, VideoMode);
+        pMainWindow = *ppWindow;
+    }
+    else
+    {
+        *ppWindow = pMainWindow;
+    }
+}
+
+void DeviceNullImpl::CreateGenericWindow(DisplayVideoMode const& VideoMode, TRef<IGenericWindow>* ppWindow)
+{
+    *ppWindow = MakeRef<GenericWindowNullImpl>(this, VideoMode);
+}
+
+void DeviceNullImpl::CreateSwapChain(IGenericWindow* pWindow, TRef<ISwapChain>* ppSwapChain)
+{
+    *ppSwapChain = MakeRef<SwapChainNullImpl>(this, static_cast<GenericWindowNullImpl*>(pWindow));
+}
+
+void DeviceNullImpl::CreatePipeline(PipelineDesc const& Desc, TRef<IPipeline>* ppPipeline)
+{
+    *ppPipeline = MakeRef<PipelineNullImpl>(this, Desc);
+}
+
+void DeviceNullImpl::CreateShaderFromBinary(ShaderBinaryData const* _BinaryData, TRef<IShaderModule>* ppShaderModule)
+{
+    *ppShaderModule = MakeRef<ShaderModuleNullImpl>(this, _BinaryData->ShaderType);
+}
+
+void DeviceNullImpl::CreateShaderFromCode(SHADER_TYPE _ShaderType, unsigned int _NumSources, const char* const* _Sources, TRef<IShaderModule>* ppShaderModule)
+{
+    *ppShaderModule = MakeRef<ShaderModuleNullImpl>(this, _ShaderType);
+}
+
+void DeviceNullImpl::CreateBuffer(BufferDesc const& Desc, const void* _SysMem, TRef<IBuffer>* ppBuffer)
+{
+    *ppBuffer = MakeRef<BufferNullImpl>(this, Desc, _SysMem);
+}
+
+void DeviceNullImpl::CreateTexture(TextureDesc const& Desc, TRef<ITexture>* ppTexture)
+{
+    *ppTexture = MakeRef<TextureNullImpl>(this, Desc);
+}
+
+void DeviceNullImpl::CreateTextureAlias(TextureDesc const& Desc, ITexture* pStorage, TRef<ITexture>* ppTexture)
+{
+    HK_ASSERT(pStorage->GetDesc().IsStorageCompatible(Desc));
+
+    *ppTexture = MakeRef<TextureNullImpl>(this, Desc);
+}
+
+void DeviceNullImpl::CreateSparseTexture(SparseTextureDesc const& Desc, TRef<ISparseTexture>* ppTexture)
+{
+    *ppTexture = MakeRef<SparseTextureNullImpl>(this, Desc);
+}
+
+void DeviceNullImpl::CreateTransformFeedback(TransformFeedbackDesc const& Desc, TRef<ITransformFeedback>* ppTransformFeedback)
+{
+    *ppTransformFeedback = MakeRef<TransformFeedbackNullImpl>(this, Desc);
+}
+
+void DeviceNullImpl::CreateQueryPool(QueryPoolDesc const& Desc, TRef<IQueryPool>* ppQueryPool)
+{
+    *ppQueryPool = MakeRef<QueryPoolNullImpl>(this, Desc);
+}
+
+void DeviceNullImpl::CreateResourceTable(TRef<IResourceTable>* ppResourceTable)
+{
+    *ppResourceTable = MakeRef<ResourceTableNullImpl>(this);
+}
+
+bool DeviceNullImpl::CreateShaderBinaryData(SHADER_TYPE        _ShaderType,
+                                            unsigned int       _NumSources,
+                                            const char* const* _Sources,
+                                            ShaderBinaryData*  _BinaryData)
+{
+    // There is no shader compiler
+    Platform::ZeroMem(_BinaryData, sizeof(*_BinaryData));
+    _BinaryData->ShaderType = _ShaderType;
+    return false;
+}
+
+void DeviceNullImpl::DestroyShaderBinaryData(ShaderBinaryData* _BinaryData)
+{
+}
+
+AllocatorCallback const& DeviceNullImpl::GetAllocator() const
+{
+    return Allocator;
+}
+
+int32_t DeviceNullImpl::GetGPUMemoryTotalAvailable()
+{
+    return 0;
+}
+
+int32_t DeviceNullImpl::GetGPUMemoryCurrentAvailable()
+{
+    return 0;
+}
+
+bool DeviceNullImpl::EnumerateSparseTexturePageSize(SPARSE_TEXTURE_TYPE Type, TEXTURE_FORMAT Format, int* NumPageSizes, int* PageSizesX, int* PageSizesY, int* PageSizesZ)
+{
+    *NumPageSizes = 0;
+    return false;
+}
+
+bool DeviceNullImpl::ChooseAppropriateSparseTexturePageSize(SPARSE_TEXTURE_TYPE Type, TEXTURE_FORMAT Format, int Width, int Height, int Depth, int* PageSizeIndex, int* PageSizeX, int* PageSizeY, int* PageSizeZ)
+{
+    *PageSizeIndex = -1;
+    return false;
+}
+
+PipelineNullImpl::PipelineNullImpl(DeviceNullImpl* pDevice, PipelineDesc const& Desc) :
+    IPipeline(pDevice)
+{
+    SetHandle(this);
+}
+
+ShaderModuleNullImpl::ShaderModuleNullImpl(DeviceNullImpl* pDevice, SHADER_TYPE ShaderType) :
+    IShaderModule(pDevice)
+{
+    Type = ShaderType;
+    SetHandle(this);
+}
+
+TransformFeedbackNullImpl::TransformFeedbackNullImpl(DeviceNullImpl* pDevice, TransformFeedbackDesc const& Desc) :
+    ITransformFeedback(pDevice)
+{
+    SetHandle(this);
+}
+
+QueryPoolNullImpl::QueryPoolNullImpl(DeviceNullImpl* pDevice, QueryPoolDesc const& Desc) :
+    IQueryPool(pDevice)
+{
+    HK_ASSERT(Desc.PoolSize > 0);
+
+    QueryType = Desc.QueryType;
+    PoolSize  = Desc.PoolSize;
+
+    SetHandle(this);
+}
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
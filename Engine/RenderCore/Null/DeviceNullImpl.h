@@ -0,0 +1,141 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include <Engine/RenderCore/Device.h>
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+class ImmediateContextNullImpl;
+
+/**
+
+Null device. Implements the RenderCore interfaces without touching a GPU: buffers are kept in system
+memory, textures have no storage and all commands are only counted in the immediate context statistics.
+Used for dedicated servers and for measuring CPU cost of the renderer on machines without a GPU.
+
+*/
+class DeviceNullImpl final : public IDevice
+{
+public:
+    DeviceNullImpl(AllocatorCallback const* pAllocator);
+    ~DeviceNullImpl();
+
+    IImmediateContext* GetImmediateContext() override;
+
+    void GetOrCreateMainWindow(DisplayVideoMode const& VideoMode, TRef<IGenericWindow>* ppWindow) override;
+
+    void CreateGenericWindow(DisplayVideoMode const& VideoMode, TRef<IGenericWindow>* ppWindow) override;
+
+    void CreateSwapChain(IGenericWindow* pWindow, TRef<ISwapChain>* ppSwapChain) override;
+
+    void CreatePipeline(PipelineDesc const& Desc, TRef<IPipeline>* ppPipeline) override;
+
+    void CreateShaderFromBinary(ShaderBinaryData const* _BinaryData, TRef<IShaderModule>* ppShaderModule) override;
+    void CreateShaderFromCode(SHADER_TYPE _ShaderType, unsigned int _NumSources, const char* const* _Sources, TRef<IShaderModule>* ppShaderModule) override;
+
+    void CreateBuffer(BufferDesc const& Desc, const void* _SysMem, TRef<IBuffer>* ppBuffer) override;
+
+    void CreateTexture(TextureDesc const& Desc, TRef<ITexture>* ppTexture) override;
+
+    void CreateTextureAlias(TextureDesc const& Desc, ITexture* pStorage, TRef<ITexture>* ppTexture) override;
+
+    void CreateSparseTexture(SparseTextureDesc const& Desc, TRef<ISparseTexture>* ppTexture) override;
+
+    void CreateTransformFeedback(TransformFeedbackDesc const& Desc, TRef<ITransformFeedback>* ppTransformFeedback) override;
+
+    void CreateQueryPool(QueryPoolDesc const& Desc, TRef<IQueryPool>* ppQueryPool) override;
+
+    void CreateResourceTable(TRef<IResourceTable>* ppResourceTable) override;
+
+    bool CreateShaderBinaryData(SHADER_TYPE        _ShaderType,
+                                unsigned int       _NumSources,
+                                const char* const* _Sources,
+                                ShaderBinaryData* _BinaryData) override;
+
+    void DestroyShaderBinaryData(ShaderBinaryData* _BinaryData) override;
+
+    int32_t GetGPUMemoryTotalAvailable() override;
+    int32_t GetGPUMemoryCurrentAvailable() override;
+
+    bool EnumerateSparseTexturePageSize(SPARSE_TEXTURE_TYPE Type, TEXTURE_FORMAT Format, int* NumPageSizes, int* PageSizesX, int* PageSizesY, int* PageSizesZ) override;
+
+    bool ChooseAppropriateSparseTexturePageSize(SPARSE_TEXTURE_TYPE Type, TEXTURE_FORMAT Format, int Width, int Height, int Depth, int* PageSizeIndex, int* PageSizeX = nullptr, int* PageSizeY = nullptr, int* PageSizeZ = nullptr) override;
+
+    AllocatorCallback const& GetAllocator() const override;
+
+    //
+    // Local
+    //
+
+    ImmediateContextNullImpl* GetImmediateContextNull() { return pImmediateContext; }
+
+    size_t BufferMemoryAllocated{};
+
+private:
+    AllocatorCallback Allocator;
+
+    ImmediateContextNullImpl* pImmediateContext;
+
+    TWeakRef<IGenericWindow> pMainWindow;
+};
+
+class PipelineNullImpl final : public IPipeline
+{
+public:
+    PipelineNullImpl(DeviceNullImpl* pDevice, PipelineDesc const& Desc);
+};
+
+class ShaderModuleNullImpl final : public IShaderModule
+{
+public:
+    ShaderModuleNullImpl(DeviceNullImpl* pDevice, SHADER_TYPE ShaderType);
+};
+
+class TransformFeedbackNullImpl final : public ITransformFeedback
+{
+public:
+    TransformFeedbackNullImpl(DeviceNullImpl* pDevice, TransformFeedbackDesc const& Desc);
+};
+
+class QueryPoolNullImpl final : public IQueryPool
+{
+public:
+    QueryPoolNullImpl(DeviceNullImpl* pDevice, QueryPoolDesc const& Desc);
+};
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
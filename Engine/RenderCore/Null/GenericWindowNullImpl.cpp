@@ -0,0 +1,135 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "GenericWindowNullImpl.h"
+#include "DeviceNullImpl.h"
+
+#include <Engine/Core/Platform/Platform.h>
+#include <Engine/Core/BaseMath.h>
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+GenericWindowNullImpl::GenericWindowNullImpl(DeviceNullImpl* pDevice, DisplayVideoMode const& InVideoMode) :
+    IGenericWindow(pDevice)
+{
+    SetHandle(this);
+
+    SetVideoMode(InVideoMode);
+}
+
+void GenericWindowNullImpl::SetSwapChain(ISwapChain* InSwapChain)
+{
+    SwapChain = InSwapChain;
+}
+
+void GenericWindowNullImpl::SetVideoMode(DisplayVideoMode const& DesiredMode)
+{
+    Platform::Memcpy(&VideoMode, &DesiredMode, sizeof(VideoMode));
+
+    VideoMode.Width  = Math::Max(VideoMode.Width, 1);
+    VideoMode.Height = Math::Max(VideoMode.Height, 1);
+
+    VideoMode.FramebufferWidth  = VideoMode.Width;
+    VideoMode.FramebufferHeight = VideoMode.Height;
+    VideoMode.AspectScale       = 1;
+    VideoMode.Opacity           = Math::Clamp(VideoMode.Opacity, 0.0f, 1.0f);
+    VideoMode.DisplayId         = 0;
+    VideoMode.RefreshRate       = 60;
+    VideoMode.DPI_X             = 96;
+    VideoMode.DPI_Y             = 96;
+
+    if (SwapChain)
+    {
+        SwapChain->Resize(VideoMode.FramebufferWidth, VideoMode.FramebufferHeight);
+    }
+}
+
+SwapChainNullImpl::SwapChainNullImpl(DeviceNullImpl* pDevice, GenericWindowNullImpl* pWindow) :
+    ISwapChain(pDevice)
+{
+    Width  = pWindow->GetVideoMode().FramebufferWidth;
+    Height = pWindow->GetVideoMode().FramebufferHeight;
+
+    CreateBuffers();
+
+    SetHandle(this);
+
+    pWindow->SetSwapChain(this);
+}
+
+void SwapChainNullImpl::CreateBuffers()
+{
+    TextureDesc textureDesc;
+    textureDesc.SetResolution(TextureResolution2D(Width, Height));
+    textureDesc.SetFormat(TEXTURE_FORMAT_RGBA8_UNORM);
+    textureDesc.SetBindFlags(BIND_RENDER_TARGET);
+
+    GetDevice()->CreateTexture(textureDesc, &BackBuffer);
+
+    textureDesc.SetFormat(TEXTURE_FORMAT_D32);
+    textureDesc.SetBindFlags(BIND_DEPTH_STENCIL);
+
+    GetDevice()->CreateTexture(textureDesc, &DepthBuffer);
+}
+
+void SwapChainNullImpl::Present(int SwapInterval)
+{
+}
+
+void SwapChainNullImpl::Resize(int InWidth, int InHeight)
+{
+    if (Width == InWidth && Height == InHeight)
+    {
+        return;
+    }
+
+    Width  = InWidth;
+    Height = InHeight;
+
+    CreateBuffers();
+}
+
+ITexture* SwapChainNullImpl::GetBackBuffer()
+{
+    return BackBuffer;
+}
+
+ITexture* SwapChainNullImpl::GetDepthBuffer()
+{
+    return DepthBuffer;
+}
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
@@ -0,0 +1,779 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "ImmediateContextNullImpl.h"
+#include "DeviceNullImpl.h"
+#include "BufferNullImpl.h"
+#include "../FrameGraph.h"
+
+#include <Engine/Core/Platform/Platform.h>
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+ResourceTableNullImpl::ResourceTableNullImpl(DeviceNullImpl* pDevice, bool bIsRoot) :
+    IResourceTable(pDevice, bIsRoot)
+{
+    SetHandle(this);
+}
+
+ImmediateContextNullImpl* ResourceTableNullImpl::GetContext()
+{
+    return static_cast<DeviceNullImpl*>(GetDevice())->GetImmediateContextNull();
+}
+
+bool ResourceTableNullImpl::UpdateSlot(uint32_t* pSlotUID, uint32_t UID)
+{
+    bool bRedundant = *pSlotUID == UID && GetContext()->IsStateFilterEnabled();
+    *pSlotUID       = UID;
+    return bRedundant;
+}
+
+void ResourceTableNullImpl::BindTexture(unsigned int Slot, ITextureView* pShaderResourceView)
+{
+    HK_ASSERT(Slot < MAX_SAMPLER_SLOTS);
+
+    GetContext()->AddResourceBinding(UpdateSlot(&TextureUIDs[Slot], pShaderResourceView ? pShaderResourceView->GetUID() : 0));
+}
+
+void ResourceTableNullImpl::BindTexture(unsigned int Slot, IBufferView* pShaderResourceView)
+{
+    HK_ASSERT(Slot < MAX_SAMPLER_SLOTS);
+
+    GetContext()->AddResourceBinding(UpdateSlot(&TextureUIDs[Slot], pShaderResourceView ? pShaderResourceView->GetUID() : 0));
+}
+
+void ResourceTableNullImpl::BindImage(unsigned int Slot, ITextureView* pUnorderedAccessView)
+{
+    HK_ASSERT(Slot < MAX_IMAGE_SLOTS);
+
+    GetContext()->AddResourceBinding(UpdateSlot(&ImageUIDs[Slot], pUnorderedAccessView ? pUnorderedAccessView->GetUID() : 0));
+}
+
+void ResourceTableNullImpl::BindBuffer(int Slot, IBuffer const* pBuffer, size_t Offset, size_t Size)
+{
+    HK_ASSERT(Slot < MAX_BUFFER_SLOTS);
+
+    bool bSameRange = BufferOffsets[Slot] == Offset && BufferSizes[Slot] == Size;
+
+    BufferOffsets[Slot] = Offset;
+    BufferSizes[Slot]   = Size;
+
+    GetContext()->AddResourceBinding(UpdateSlot(&BufferUIDs[Slot], pBuffer ? pBuffer->GetUID() : 0) && bSameRange);
+}
+
+ImmediateContextNullImpl::ImmediateContextNullImpl(DeviceNullImpl* pDevice) :
+    IImmediateContext(pDevice)
+{
+    SetHandle(this);
+}
+
+ImmediateContextNullImpl::~ImmediateContextNullImpl()
+{
+}
+
+void ImmediateContextNullImpl::ExecuteFrameGraph(FrameGraph* pFrameGraph)
+{
+    for (FrameGraph::TimelineStep const& step : pFrameGraph->GetTimeline())
+    {
+        pFrameGraph->AcquireResources(step);
+
+        switch (step.RenderTask->GetProxyType())
+        {
+            case FG_RENDER_TASK_PROXY_TYPE_RENDER_PASS:
+                ExecuteRenderPass(static_cast<RenderPass*>(step.RenderTask));
+                break;
+            case FG_RENDER_TASK_PROXY_TYPE_CUSTOM:
+                ExecuteCustomTask(static_cast<FGCustomTask*>(step.RenderTask));
+                break;
+            default:
+                HK_ASSERT(0);
+                break;
+        }
+
+        pFrameGraph->ReleaseResources(step);
+    }
+
+    BindResourceTable(nullptr);
+}
+
+void ImmediateContextNullImpl::ExecuteRenderPass(RenderPass* pRenderPass)
+{
+    Rect2D renderArea;
+
+    if (pRenderPass->IsRenderAreaSpecified())
+    {
+        renderArea = pRenderPass->GetRenderArea();
+    }
+    else
+    {
+        // Take the render area from the first attachment
+        TextureAttachment* attachment = nullptr;
+        if (!pRenderPass->GetColorAttachments().IsEmpty())
+            attachment = const_cast<TextureAttachment*>(&pRenderPass->GetColorAttachments()[0]);
+        else if (pRenderPass->HasDepthStencilAttachment())
+            attachment = const_cast<TextureAttachment*>(&pRenderPass->GetDepthStencilAttachment());
+
+        if (attachment)
+        {
+            ITexture* texture = attachment->GetTexture();
+
+            renderArea.Width  = Math::Max(1u, texture->GetWidth() >> attachment->MipLevel);
+            renderArea.Height = Math::Max(1u, texture->GetHeight() >> attachment->MipLevel);
+        }
+    }
+
+    Stat.RenderPasses++;
+
+    // Match the OpenGL backend which reapplies pipeline state in a new render pass
+    InvalidateStateFilter();
+
+    Viewport vp;
+    vp.X        = renderArea.X;
+    vp.Y        = renderArea.Y;
+    vp.Width    = renderArea.Width;
+    vp.Height   = renderArea.Height;
+    vp.MinDepth = 0;
+    vp.MaxDepth = 1;
+    SetViewport(vp);
+
+    FGCommandBuffer     commandBuffer;
+    FGRenderPassContext renderPassContext;
+
+    renderPassContext.pRenderPass       = pRenderPass;
+    renderPassContext.SubpassIndex      = 0;
+    renderPassContext.RenderArea        = renderArea;
+    renderPassContext.pImmediateContext = this;
+    for (FGSubpassInfo const& Subpass : pRenderPass->GetSubpasses())
+    {
+        Subpass.Function(renderPassContext, commandBuffer);
+        renderPassContext.SubpassIndex++;
+    }
+}
+
+void ImmediateContextNullImpl::ExecuteCustomTask(FGCustomTask* pCustomTask)
+{
+    FGCustomTaskContext taskContext;
+    taskContext.pImmediateContext = this;
+    pCustomTask->Function(taskContext);
+}
+
+void ImmediateContextNullImpl::BindPipeline(IPipeline* pPipeline)
+{
+    FilterPipeline(pPipeline);
+}
+
+void ImmediateContextNullImpl::BindVertexBuffer(unsigned int InputSlot, IBuffer const* pVertexBuffer, unsigned int Offset)
+{
+    FilterVertexBuffer(InputSlot, pVertexBuffer, Offset);
+}
+
+void ImmediateContextNullImpl::BindVertexBuffers(unsigned int StartSlot, unsigned int NumBuffers, IBuffer* const* ppVertexBuffers, uint32_t const* pOffsets)
+{
+    for (unsigned int i = 0; i < NumBuffers; i++)
+    {
+        FilterVertexBuffer(StartSlot + i, ppVertexBuffers ? ppVertexBuffers[i] : nullptr, pOffsets ? pOffsets[i] : 0);
+    }
+}
+
+void ImmediateContextNullImpl::BindIndexBuffer(IBuffer const* pIndexBuffer, INDEX_TYPE Type, unsigned int Offset)
+{
+    FilterIndexBuffer(pIndexBuffer, Type, Offset);
+}
+
+IResourceTable* ImmediateContextNullImpl::GetRootResourceTable()
+{
+    if (!RootResourceTable)
+    {
+        RootResourceTable = MakeRef<ResourceTableNullImpl>(static_cast<DeviceNullImpl*>(GetDevice()), true);
+    }
+    return RootResourceTable;
+}
+
+void ImmediateContextNullImpl::BindResourceTable(IResourceTable* pResourceTable)
+{
+    FilterResourceTable(pResourceTable);
+}
+
+void ImmediateContextNullImpl::SetViewport(Viewport const& Viewport)
+{
+    Stat.ViewportChanges++;
+}
+
+void ImmediateContextNullImpl::SetViewportArray(uint32_t NumViewports, Viewport const* pViewports)
+{
+    Stat.ViewportChanges++;
+}
+
+void ImmediateContextNullImpl::SetViewportArray(uint32_t FirstIndex, uint32_t NumViewports, Viewport const* pViewports)
+{
+    Stat.ViewportChanges++;
+}
+
+void ImmediateContextNullImpl::SetViewportIndexed(uint32_t Index, Viewport const& Viewport)
+{
+    Stat.ViewportChanges++;
+}
+
+void ImmediateContextNullImpl::SetScissor(Rect2D const& Scissor)
+{
+    Stat.ScissorChanges++;
+}
+
+void ImmediateContextNullImpl::SetScissorArray(uint32_t NumScissors, Rect2D const* pScissors)
+{
+    Stat.ScissorChanges++;
+}
+
+void ImmediateContextNullImpl::SetScissorArray(uint32_t FirstIndex, uint32_t NumScissors, Rect2D const* pScissors)
+{
+    Stat.ScissorChanges++;
+}
+
+void ImmediateContextNullImpl::SetScissorIndexed(uint32_t Index, Rect2D const& Scissor)
+{
+    Stat.ScissorChanges++;
+}
+
+void ImmediateContextNullImpl::BindTransformFeedback(ITransformFeedback* pTransformFeedback)
+{
+}
+
+void ImmediateContextNullImpl::BeginTransformFeedback(PRIMITIVE_TOPOLOGY OutputPrimitive)
+{
+}
+
+void ImmediateContextNullImpl::ResumeTransformFeedback()
+{
+}
+
+void ImmediateContextNullImpl::PauseTransformFeedback()
+{
+}
+
+void ImmediateContextNullImpl::EndTransformFeedback()
+{
+}
+
+void ImmediateContextNullImpl::Draw(DrawCmd const* pCmd)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::Draw(DrawIndexedCmd const* pCmd)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::Draw(ITransformFeedback* pTransformFeedback, unsigned int InstanceCount, unsigned int StreamIndex)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::DrawIndirect(IBuffer* pDrawIndirectBuffer, unsigned int AlignedByteOffset)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::DrawIndexedIndirect(IBuffer* pDrawIndirectBuffer, unsigned int AlignedByteOffset)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::MultiDraw(unsigned int DrawCount, const unsigned int* VertexCount, const unsigned int* StartVertexLocations)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::MultiDraw(unsigned int DrawCount, const unsigned int* IndexCount, const void* const* IndexByteOffsets, const int* BaseVertexLocations)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::MultiDrawIndirect(unsigned int DrawCount, IBuffer* pDrawIndirectBuffer, unsigned int AlignedByteOffset, unsigned int Stride)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::MultiDrawIndexedIndirect(unsigned int DrawCount, IBuffer* pDrawIndirectBuffer, unsigned int AlignedByteOffset, unsigned int Stride)
+{
+    Stat.DrawCalls++;
+}
+
+void ImmediateContextNullImpl::DispatchCompute(unsigned int ThreadGroupCountX, unsigned int ThreadGroupCountY, unsigned int ThreadGroupCountZ)
+{
+    Stat.DispatchCalls++;
+}
+
+void ImmediateContextNullImpl::DispatchCompute(DispatchIndirectCmd const* pCmd)
+{
+    Stat.DispatchCalls++;
+}
+
+void ImmediateContextNullImpl::DispatchComputeIndirect(IBuffer* pDispatchIndirectBuffer, unsigned int AlignedByteOffset)
+{
+    Stat.DispatchCalls++;
+}
+
+void ImmediateContextNullImpl::BeginQuery(IQueryPool* QueryPool, uint32_t QueryID, uint32_t StreamIndex)
+{
+}
+
+void ImmediateContextNullImpl::EndQuery(IQueryPool* QueryPool, uint32_t StreamIndex)
+{
+}
+
+void ImmediateContextNullImpl::RecordTimeStamp(IQueryPool* QueryPool, uint32_t QueryID)
+{
+}
+
+void ImmediateContextNullImpl::CopyQueryPoolResultsAvailable(IQueryPool* QueryPool,
+                                                             uint32_t    FirstQuery,
+                                                             uint32_t    QueryCount,
+                                                             IBuffer*    pDstBuffer,
+                                                             size_t      DstOffst,
+                                                             size_t      DstStride,
+                                                             bool        QueryResult64Bit)
+{
+}
+
+void ImmediateContextNullImpl::CopyQueryPoolResults(IQueryPool*        QueryPool,
+                                                    uint32_t           FirstQuery,
+                                                    uint32_t           QueryCount,
+                                                    IBuffer*           pDstBuffer,
+                                                    size_t             DstOffst,
+                                                    size_t             DstStride,
+                                                    QUERY_RESULT_FLAGS Flags)
+{
+}
+
+void ImmediateContextNullImpl::BeginConditionalRender(IQueryPool* QueryPool, uint32_t QueryID, CONDITIONAL_RENDER_MODE Mode)
+{
+}
+
+void ImmediateContextNullImpl::EndConditionalRender()
+{
+}
+
+SyncObject ImmediateContextNullImpl::FenceSync()
+{
+    // Any non-null value, the fence is signaled immediately
+    return reinterpret_cast<SyncObject>(++SyncCounter);
+}
+
+void ImmediateContextNullImpl::RemoveSync(SyncObject Sync)
+{
+}
+
+CLIENT_WAIT_STATUS ImmediateContextNullImpl::ClientWait(SyncObject Sync, uint64_t TimeOutNanoseconds)
+{
+    return CLIENT_WAIT_ALREADY_SIGNALED;
+}
+
+void ImmediateContextNullImpl::ServerWait(SyncObject Sync)
+{
+}
+
+bool ImmediateContextNullImpl::IsSignaled(SyncObject Sync)
+{
+    return true;
+}
+
+void ImmediateContextNullImpl::Flush()
+{
+}
+
+void ImmediateContextNullImpl::Barrier(int BarrierBits)
+{
+}
+
+void ImmediateContextNullImpl::BarrierByRegion(int BarrierBits)
+{
+}
+
+void ImmediateContextNullImpl::TextureBarrier()
+{
+}
+
+void ImmediateContextNullImpl::DynamicState_BlendingColor(const float ConstantColor[4])
+{
+    Stat.DynamicStateChanges++;
+}
+
+void ImmediateContextNullImpl::DynamicState_SampleMask(const uint32_t SampleMask[4])
+{
+    Stat.DynamicStateChanges++;
+}
+
+void ImmediateContextNullImpl::DynamicState_StencilRef(uint32_t StencilRef)
+{
+    Stat.DynamicStateChanges++;
+}
+
+void ImmediateContextNullImpl::CopyBuffer(IBuffer* pSrcBuffer, IBuffer* pDstBuffer)
+{
+    BufferCopy range;
+    range.SrcOffset   = 0;
+    range.DstOffset   = 0;
+    range.SizeInBytes = Math::Min(pSrcBuffer->GetDesc().SizeInBytes, pDstBuffer->GetDesc().SizeInBytes);
+
+    CopyBufferRange(pSrcBuffer, pDstBuffer, 1, &range);
+}
+
+void ImmediateContextNullImpl::CopyBufferRange(IBuffer* pSrcBuffer, IBuffer* pDstBuffer, uint32_t NumRanges, BufferCopy const* Ranges)
+{
+    // Buffers live in system memory, keep their contents consistent
+    uint8_t* src = static_cast<BufferNullImpl*>(pSrcBuffer)->GetStorage();
+    uint8_t* dst = static_cast<BufferNullImpl*>(pDstBuffer)->GetStorage();
+
+    if (src && dst)
+    {
+        for (uint32_t i = 0; i < NumRanges; i++)
+        {
+            HK_ASSERT(Ranges[i].SrcOffset + Ranges[i].SizeInBytes <= pSrcBuffer->GetDesc().SizeInBytes);
+            HK_ASSERT(Ranges[i].DstOffset + Ranges[i].SizeInBytes <= pDstBuffer->GetDesc().SizeInBytes);
+
+            Platform::Memmove(dst + Ranges[i].DstOffset, src + Ranges[i].SrcOffset, Ranges[i].SizeInBytes);
+        }
+    }
+
+    Stat.Copies += NumRanges;
+}
+
+bool ImmediateContextNullImpl::CopyBufferToTexture(IBuffer const*     pSrcBuffer,
+                                                   ITexture*          pDstTexture,
+                                                   TextureRect const& Rectangle,
+                                                   DATA_FORMAT        Format,
+                                                   size_t             CompressedDataSizeInBytes,
+                                                   size_t             SourceByteOffset,
+                                                   unsigned int       Alignment)
+{
+    Stat.Copies++;
+    return true;
+}
+
+void ImmediateContextNullImpl::CopyTextureToBuffer(ITexture const*    pSrcTexture,
+                                                   IBuffer*           pDstBuffer,
+                                                   TextureRect const& Rectangle,
+                                                   DATA_FORMAT        Format,
+                                                   size_t             SizeInBytes,
+                                                   size_t             DstByteOffset,
+                                                   unsigned int       Alignment)
+{
+    Stat.Copies++;
+}
+
+void ImmediateContextNullImpl::CopyTextureRect(ITexture const*    pSrcTexture,
+                                               ITexture*          pDstTexture,
+                                               uint32_t           NumCopies,
+                                               TextureCopy const* Copies)
+{
+    Stat.Copies += NumCopies;
+}
+
+void ImmediateContextNullImpl::ClearBuffer(IBuffer* pBuffer, BUFFER_VIEW_PIXEL_FORMAT InternalFormat, DATA_FORMAT Format, const ClearValue* ClearValue)
+{
+    BufferClear range;
+    range.Offset      = 0;
+    range.SizeInBytes = pBuffer->GetDesc().SizeInBytes;
+
+    ClearBufferRange(pBuffer, InternalFormat, 1, &range, Format, ClearValue);
+}
+
+void ImmediateContextNullImpl::ClearBufferRange(IBuffer* pBuffer, BUFFER_VIEW_PIXEL_FORMAT InternalFormat, uint32_t NumRanges, BufferClear const* Ranges, DATA_FORMAT Format, const ClearValue* ClearValue)
+{
+    // Only zero fill is emulated, there is no format conversion
+    uint8_t* storage = static_cast<BufferNullImpl*>(pBuffer)->GetStorage();
+
+    if (storage && !ClearValue)
+    {
+        for (uint32_t i = 0; i < NumRanges; i++)
+        {
+            HK_ASSERT(Ranges[i].Offset + Ranges[i].SizeInBytes <= pBuffer->GetDesc().SizeInBytes);
+
+            Platform::ZeroMem(storage + Ranges[i].Offset, Ranges[i].SizeInBytes);
+        }
+    }
+
+    Stat.Clears += NumRanges;
+}
+
+void ImmediateContextNullImpl::ClearTexture(ITexture* pTexture, uint16_t MipLevel, DATA_FORMAT Format, const ClearValue* ClearValue)
+{
+    Stat.Clears++;
+}
+
+void ImmediateContextNullImpl::ClearTextureRect(ITexture*          pTexture,
+                                                uint32_t           NumRectangles,
+                                                TextureRect const* Rectangles,
+                                                DATA_FORMAT        Format,
+                                                const ClearValue*  ClearValue)
+{
+    Stat.Clears += NumRectangles;
+}
+
+void ImmediateContextNullImpl::ReadTexture(ITexture*    pTexture,
+                                           uint16_t     MipLevel,
+                                           size_t       SizeInBytes,
+                                           unsigned int Alignment,
+                                           void*        pSysMem)
+{
+    // Textures have no storage
+    Platform::ZeroMem(pSysMem, SizeInBytes);
+}
+
+void ImmediateContextNullImpl::ReadTextureRect(ITexture*          pTexture,
+                                               TextureRect const& Rectangle,
+                                               size_t             SizeInBytes,
+                                               unsigned int       Alignment,
+                                               void*              pSysMem)
+{
+    Platform::ZeroMem(pSysMem, SizeInBytes);
+}
+
+bool ImmediateContextNullImpl::WriteTexture(ITexture*    pTexture,
+                                            uint16_t     MipLevel,
+                                            size_t       SizeInBytes,
+                                            unsigned int Alignment,
+                                            const void*  pSysMem)
+{
+    Stat.TextureUploads++;
+    Stat.TextureUploadBytes += SizeInBytes;
+    return true;
+}
+
+bool ImmediateContextNullImpl::WriteTextureRect(ITexture*          pTexture,
+                                                TextureRect const& Rectangle,
+                                                size_t             SizeInBytes,
+                                                unsigned int       Alignment,
+                                                const void*        pSysMem,
+                                                size_t             RowPitch,
+                                                size_t             DepthPitch)
+{
+    Stat.TextureUploads++;
+    Stat.TextureUploadBytes += SizeInBytes;
+    return true;
+}
+
+void ImmediateContextNullImpl::ReadBufferRange(IBuffer* pBuffer, size_t ByteOffset, size_t SizeInBytes, void* pSysMem)
+{
+    uint8_t* storage = static_cast<BufferNullImpl*>(pBuffer)->GetStorage();
+    if (!storage)
+    {
+        return;
+    }
+
+    HK_ASSERT(ByteOffset + SizeInBytes <= pBuffer->GetDesc().SizeInBytes);
+
+    Platform::Memcpy(pSysMem, storage + ByteOffset, SizeInBytes);
+}
+
+void ImmediateContextNullImpl::WriteBufferRange(IBuffer* pBuffer, size_t ByteOffset, size_t SizeInBytes, const void* pSysMem)
+{
+    uint8_t* storage = static_cast<BufferNullImpl*>(pBuffer)->GetStorage();
+    if (!storage)
+    {
+        return;
+    }
+
+    HK_ASSERT(ByteOffset + SizeInBytes <= pBuffer->GetDesc().SizeInBytes);
+
+    Platform::Memcpy(storage + ByteOffset, pSysMem, SizeInBytes);
+
+    Stat.BufferUploads++;
+    Stat.BufferUploadBytes += SizeInBytes;
+}
+
+void* ImmediateContextNullImpl::MapBufferRange(IBuffer*        pBuffer,
+                                               size_t          RangeOffset,
+                                               size_t          RangeSize,
+                                               MAP_TRANSFER    ClientServerTransfer,
+                                               MAP_INVALIDATE  Invalidate,
+                                               MAP_PERSISTENCE Persistence,
+                                               bool            FlushExplicit,
+                                               bool            Unsynchronized)
+{
+    uint8_t* storage = static_cast<BufferNullImpl*>(pBuffer)->GetStorage();
+    if (!storage)
+    {
+        return nullptr;
+    }
+
+    HK_ASSERT(RangeOffset + RangeSize <= pBuffer->GetDesc().SizeInBytes);
+
+    Stat.BufferMaps++;
+
+    return storage + RangeOffset;
+}
+
+void* ImmediateContextNullImpl::MapBuffer(IBuffer*        pBuffer,
+                                          MAP_TRANSFER    ClientServerTransfer,
+                                          MAP_INVALIDATE  Invalidate,
+                                          MAP_PERSISTENCE Persistence,
+                                          bool            FlushExplicit,
+                                          bool            Unsynchronized)
+{
+    return MapBufferRange(pBuffer, 0, pBuffer->GetDesc().SizeInBytes, ClientServerTransfer, Invalidate, Persistence, FlushExplicit, Unsynchronized);
+}
+
+void ImmediateContextNullImpl::UnmapBuffer(IBuffer* pBuffer)
+{
+}
+
+void ImmediateContextNullImpl::SparseTextureCommitPage(ISparseTexture* pTexture,
+                                                       int             MipLevel,
+                                                       int             PageX,
+                                                       int             PageY,
+                                                       int             PageZ,
+                                                       DATA_FORMAT     Format,
+                                                       size_t          SizeInBytes,
+                                                       unsigned int    Alignment,
+                                                       const void*     pSysMem)
+{
+}
+
+void ImmediateContextNullImpl::SparseTextureCommitRect(ISparseTexture*    pTexture,
+                                                       TextureRect const& Rectangle,
+                                                       DATA_FORMAT        Format,
+                                                       size_t             SizeInBytes,
+                                                       unsigned int       Alignment,
+                                                       const void*        pSysMem)
+{
+}
+
+void ImmediateContextNullImpl::SparseTextureUncommitPage(ISparseTexture* pTexture, int MipLevel, int PageX, int PageY, int PageZ)
+{
+}
+
+void ImmediateContextNullImpl::SparseTextureUncommitRect(ISparseTexture* pTexture, TextureRect const& Rectangle)
+{
+}
+
+void ImmediateContextNullImpl::GetQueryPoolResults(IQueryPool*        QueryPool,
+                                                   uint32_t           FirstQuery,
+                                                   uint32_t           QueryCount,
+                                                   size_t             DataSize,
+                                                   void*              pSysMem,
+                                                   size_t             DstStride,
+                                                   QUERY_RESULT_FLAGS Flags)
+{
+    Platform::ZeroMem(pSysMem, DataSize);
+}
+
+void ImmediateContextNullImpl::GenerateTextureMipLevels(ITexture* pTexture)
+{
+}
+
+bool ImmediateContextNullImpl::CopyFramebufferToTexture(FGRenderPassContext& RenderPassContext,
+                                                        ITexture*            pDstTexture,
+                                                        int                  ColorAttachment,
+                                                        TextureOffset const& Offset,
+                                                        Rect2D const&        SrcRect,
+                                                        unsigned int         Alignment)
+{
+    Stat.Copies++;
+    return true;
+}
+
+void ImmediateContextNullImpl::CopyColorAttachmentToBuffer(FGRenderPassContext& RenderPassContext,
+                                                           IBuffer*             pDstBuffer,
+                                                           int                  SubpassAttachmentRef,
+                                                           Rect2D const&        SrcRect,
+                                                           FRAMEBUFFER_CHANNEL  FramebufferChannel,
+                                                           FRAMEBUFFER_OUTPUT   FramebufferOutput,
+                                                           COLOR_CLAMP          ColorClamp,
+                                                           size_t               SizeInBytes,
+                                                           size_t               DstByteOffset,
+                                                           unsigned int         Alignment)
+{
+    Stat.Copies++;
+}
+
+void ImmediateContextNullImpl::CopyDepthAttachmentToBuffer(FGRenderPassContext& RenderPassContext,
+                                                           IBuffer*             pDstBuffer,
+                                                           Rect2D const&        SrcRect,
+                                                           size_t               SizeInBytes,
+                                                           size_t               DstByteOffset,
+                                                           unsigned int         Alignment)
+{
+    Stat.Copies++;
+}
+
+bool ImmediateContextNullImpl::BlitFramebuffer(FGRenderPassContext&  RenderPassContext,
+                                               int                   ColorAttachment,
+                                               uint32_t              NumRectangles,
+                                               BlitRectangle const*  Rectangles,
+                                               FRAMEBUFFER_BLIT_MASK Mask,
+                                               bool                  LinearFilter)
+{
+    Stat.Copies += NumRectangles;
+    return true;
+}
+
+void ImmediateContextNullImpl::ClearAttachments(FGRenderPassContext&          RenderPassContext,
+                                                unsigned int*                 ColorAttachments,
+                                                unsigned int                  NumColorAttachments,
+                                                ClearColorValue const*        ColorClearValues,
+                                                ClearDepthStencilValue const* DepthStencilClearValue,
+                                                Rect2D const*                 Rect)
+{
+    Stat.Clears++;
+}
+
+bool ImmediateContextNullImpl::ReadFramebufferAttachment(FGRenderPassContext& RenderPassContext,
+                                                         int                  ColorAttachment,
+                                                         Rect2D const&        SrcRect,
+                                                         FRAMEBUFFER_CHANNEL  FramebufferChannel,
+                                                         FRAMEBUFFER_OUTPUT   FramebufferOutput,
+                                                         COLOR_CLAMP          ColorClamp,
+                                                         size_t               SizeInBytes,
+                                                         unsigned int         Alignment,
+                                                         void*                pSysMem)
+{
+    Platform::ZeroMem(pSysMem, SizeInBytes);
+    return true;
+}
+
+bool ImmediateContextNullImpl::ReadFramebufferDepthStencilAttachment(FGRenderPassContext& RenderPassContext,
+                                                                     Rect2D const&        SrcRect,
+                                                                     size_t               SizeInBytes,
+                                                                     unsigned int         Alignment,
+                                                                     void*                pSysMem)
+{
+    Platform::ZeroMem(pSysMem, SizeInBytes);
+    return true;
+}
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
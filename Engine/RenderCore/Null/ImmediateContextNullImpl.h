@@ -0,0 +1,384 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include <Engine/RenderCore/ImmediateContext.h>
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+class DeviceNullImpl;
+class ImmediateContextNullImpl;
+
+class ResourceTableNullImpl final : public IResourceTable
+{
+public:
+    ResourceTableNullImpl(DeviceNullImpl* pDevice, bool bIsRoot = false);
+
+    void BindTexture(unsigned int Slot, ITextureView* pShaderResourceView) override;
+    void BindTexture(unsigned int Slot, IBufferView* pShaderResourceView) override;
+    void BindImage(unsigned int Slot, ITextureView* pUnorderedAccessView) override;
+    void BindBuffer(int Slot, IBuffer const* pBuffer, size_t Offset = 0, size_t Size = 0) override;
+
+private:
+    ImmediateContextNullImpl* GetContext();
+
+    /** Returns true if the slot already holds the same resource */
+    bool UpdateSlot(uint32_t* pSlotUID, uint32_t UID);
+
+    uint32_t TextureUIDs[MAX_SAMPLER_SLOTS]{};
+    uint32_t ImageUIDs[MAX_IMAGE_SLOTS]{};
+    uint32_t BufferUIDs[MAX_BUFFER_SLOTS]{};
+    size_t   BufferOffsets[MAX_BUFFER_SLOTS]{};
+    size_t   BufferSizes[MAX_BUFFER_SLOTS]{};
+};
+
+/** Immediate context that executes nothing and only gathers command statistics */
+class ImmediateContextNullImpl final : public IImmediateContext
+{
+public:
+    ImmediateContextNullImpl(DeviceNullImpl* pDevice);
+    ~ImmediateContextNullImpl();
+
+    void ExecuteFrameGraph(FrameGraph* pFrameGraph) override;
+
+    void BindPipeline(IPipeline* pPipeline) override;
+
+    void BindVertexBuffer(unsigned int InputSlot, IBuffer const* pVertexBuffer, unsigned int Offset = 0) override;
+
+    void BindVertexBuffers(unsigned int StartSlot, unsigned int NumBuffers, IBuffer* const* ppVertexBuffers, uint32_t const* pOffsets = nullptr) override;
+
+    void BindIndexBuffer(IBuffer const* pIndexBuffer, INDEX_TYPE Type, unsigned int Offset = 0) override;
+
+    IResourceTable* GetRootResourceTable() override;
+
+    void BindResourceTable(IResourceTable* pResourceTable) override;
+
+    void SetViewport(Viewport const& Viewport) override;
+
+    void SetViewportArray(uint32_t NumViewports, Viewport const* pViewports) override;
+
+    void SetViewportArray(uint32_t FirstIndex, uint32_t NumViewports, Viewport const* pViewports) override;
+
+    void SetViewportIndexed(uint32_t Index, Viewport const& Viewport) override;
+
+    void SetScissor(Rect2D const& Scissor) override;
+
+    void SetScissorArray(uint32_t NumScissors, Rect2D const* pScissors) override;
+
+    void SetScissorArray(uint32_t FirstIndex, uint32_t NumScissors, Rect2D const* pScissors) override;
+
+    void SetScissorIndexed(uint32_t Index, Rect2D const& Scissor) override;
+
+    void BindTransformFeedback(ITransformFeedback* pTransformFeedback) override;
+
+    void BeginTransformFeedback(PRIMITIVE_TOPOLOGY OutputPrimitive) override;
+
+    void ResumeTransformFeedback() override;
+
+    void PauseTransformFeedback() override;
+
+    void EndTransformFeedback() override;
+
+    void Draw(DrawCmd const* pCmd) override;
+
+    void Draw(DrawIndexedCmd const* pCmd) override;
+
+    void Draw(ITransformFeedback* pTransformFeedback, unsigned int InstanceCount = 1, unsigned int StreamIndex = 0) override;
+
+    void DrawIndirect(IBuffer* pDrawIndirectBuffer, unsigned int AlignedByteOffset) override;
+
+    void DrawIndexedIndirect(IBuffer* pDrawIndirectBuffer, unsigned int AlignedByteOffset) override;
+
+    void MultiDraw(unsigned int DrawCount, const unsigned int* VertexCount, const unsigned int* StartVertexLocations) override;
+
+    void MultiDraw(unsigned int DrawCount, const unsigned int* IndexCount, const void* const* IndexByteOffsets, const int* BaseVertexLocations = nullptr) override;
+
+    void MultiDrawIndirect(unsigned int DrawCount, IBuffer* pDrawIndirectBuffer, unsigned int AlignedByteOffset, unsigned int Stride) override;
+
+    void MultiDrawIndexedIndirect(unsigned int DrawCount, IBuffer* pDrawIndirectBuffer, unsigned int AlignedByteOffset, unsigned int Stride) override;
+
+    void DispatchCompute(unsigned int ThreadGroupCountX,
+                         unsigned int ThreadGroupCountY,
+                         unsigned int ThreadGroupCountZ) override;
+
+    void DispatchCompute(DispatchIndirectCmd const* pCmd) override;
+
+    void DispatchComputeIndirect(IBuffer* pDispatchIndirectBuffer, unsigned int AlignedByteOffset) override;
+
+    void BeginQuery(IQueryPool* QueryPool, uint32_t QueryID, uint32_t StreamIndex = 0) override;
+
+    void EndQuery(IQueryPool* QueryPool, uint32_t StreamIndex = 0) override;
+
+    void RecordTimeStamp(IQueryPool* QueryPool, uint32_t QueryID) override;
+
+    void CopyQueryPoolResultsAvailable(IQueryPool* QueryPool,
+                                       uint32_t    FirstQuery,
+                                       uint32_t    QueryCount,
+                                       IBuffer*    pDstBuffer,
+                                       size_t      DstOffst,
+                                       size_t      DstStride,
+                                       bool        QueryResult64Bit) override;
+
+    void CopyQueryPoolResults(IQueryPool*        QueryPool,
+                              uint32_t           FirstQuery,
+                              uint32_t           QueryCount,
+                              IBuffer*           pDstBuffer,
+                              size_t             DstOffst,
+                              size_t             DstStride,
+                              QUERY_RESULT_FLAGS Flags) override;
+
+    void BeginConditionalRender(IQueryPool* QueryPool, uint32_t QueryID, CONDITIONAL_RENDER_MODE Mode) override;
+
+    void EndConditionalRender() override;
+
+    SyncObject FenceSync() override;
+
+    void RemoveSync(SyncObject Sync) override;
+
+    CLIENT_WAIT_STATUS ClientWait(SyncObject Sync, uint64_t TimeOutNanoseconds = 0xFFFFFFFFFFFFFFFF) override;
+
+    void ServerWait(SyncObject Sync) override;
+
+    bool IsSignaled(SyncObject Sync) override;
+
+    void Flush() override;
+
+    void Barrier(int BarrierBits) override;
+
+    void BarrierByRegion(int BarrierBits) override;
+
+    void TextureBarrier() override;
+
+    void DynamicState_BlendingColor(const float ConstantColor[4]) override;
+
+    void DynamicState_SampleMask(const uint32_t SampleMask[4]) override;
+
+    void DynamicState_StencilRef(uint32_t StencilRef) override;
+
+    void CopyBuffer(IBuffer* pSrcBuffer, IBuffer* pDstBuffer) override;
+
+    void CopyBufferRange(IBuffer* pSrcBuffer, IBuffer* pDstBuffer, uint32_t NumRanges, BufferCopy const* Ranges) override;
+
+    bool CopyBufferToTexture(IBuffer const*     pSrcBuffer,
+                             ITexture*          pDstTexture,
+                             TextureRect const& Rectangle,
+                             DATA_FORMAT        Format,
+                             size_t             CompressedDataSizeInBytes,
+                             size_t             SourceByteOffset,
+                             unsigned int       Alignment) override;
+
+    void CopyTextureToBuffer(ITexture const*    pSrcTexture,
+                             IBuffer*           pDstBuffer,
+                             TextureRect const& Rectangle,
+                             DATA_FORMAT        Format,
+                             size_t             SizeInBytes,
+                             size_t             DstByteOffset,
+                             unsigned int       Alignment) override;
+
+    void CopyTextureRect(ITexture const*    pSrcTexture,
+                         ITexture*          pDstTexture,
+                         uint32_t           NumCopies,
+                         TextureCopy const* Copies) override;
+
+    void ClearBuffer(IBuffer* pBuffer, BUFFER_VIEW_PIXEL_FORMAT InternalFormat, DATA_FORMAT Format, const ClearValue* ClearValue) override;
+
+    void ClearBufferRange(IBuffer* pBuffer, BUFFER_VIEW_PIXEL_FORMAT InternalFormat, uint32_t NumRanges, BufferClear const* Ranges, DATA_FORMAT Format, const ClearValue* ClearValue) override;
+
+    void ClearTexture(ITexture* pTexture, uint16_t MipLevel, DATA_FORMAT Format, const ClearValue* ClearValue) override;
+
+    void ClearTextureRect(ITexture*          pTexture,
+                          uint32_t           NumRectangles,
+                          TextureRect const* Rectangles,
+                          DATA_FORMAT        Format,
+                          const ClearValue*  ClearValue) override;
+
+    void ReadTexture(ITexture*    pTexture,
+                     uint16_t     MipLevel,
+                     size_t       SizeInBytes,
+                     unsigned int Alignment,
+                     void*        pSysMem) override;
+
+    void ReadTextureRect(ITexture*          pTexture,
+                         TextureRect const& Rectangle,
+                         size_t             SizeInBytes,
+                         unsigned int       Alignment,
+                         void*              pSysMem) override;
+
+    bool WriteTexture(ITexture*    pTexture,
+                      uint16_t     MipLevel,
+                      size_t       SizeInBytes,
+                      unsigned int Alignment,
+                      const void*  pSysMem) override;
+
+    bool WriteTextureRect(ITexture*          pTexture,
+                          TextureRect const& Rectangle,
+                          size_t             SizeInBytes,
+                          unsigned int       Alignment,
+                          const void*        pSysMem,
+                          size_t             RowPitch   = 0,
+                          size_t             DepthPitch = 0) override;
+
+    void ReadBufferRange(IBuffer* pBuffer, size_t ByteOffset, size_t SizeInBytes, void* pSysMem) override;
+
+    void WriteBufferRange(IBuffer* pBuffer, size_t ByteOffset, size_t SizeInBytes, const void* pSysMem) override;
+
+    void* MapBufferRange(IBuffer*        pBuffer,
+                         size_t          RangeOffset,
+                         size_t          RangeSize,
+                         MAP_TRANSFER    ClientServerTransfer,
+                         MAP_INVALIDATE  Invalidate     = MAP_NO_INVALIDATE,
+                         MAP_PERSISTENCE Persistence    = MAP_NON_PERSISTENT,
+                         bool            FlushExplicit  = false,
+                         bool            Unsynchronized = false) override;
+
+    void* MapBuffer(IBuffer*        pBuffer,
+                    MAP_TRANSFER    ClientServerTransfer,
+                    MAP_INVALIDATE  Invalidate     = MAP_NO_INVALIDATE,
+                    MAP_PERSISTENCE Persistence    = MAP_NON_PERSISTENT,
+                    bool            FlushExplicit  = false,
+                    bool            Unsynchronized = false) override;
+
+    void UnmapBuffer(IBuffer* pBuffer) override;
+
+    void SparseTextureCommitPage(ISparseTexture* pTexture,
+                                 int             MipLevel,
+                                 int             PageX,
+                                 int             PageY,
+                                 int             PageZ,
+                                 DATA_FORMAT     Format,
+                                 size_t          SizeInBytes,
+                                 unsigned int    Alignment,
+                                 const void*     pSysMem) override;
+
+    void SparseTextureCommitRect(ISparseTexture*    pTexture,
+                                 TextureRect const& Rectangle,
+                                 DATA_FORMAT        Format,
+                                 size_t             SizeInBytes,
+                                 unsigned int       Alignment,
+                                 const void*        pSysMem) override;
+
+    void SparseTextureUncommitPage(ISparseTexture* pTexture, int MipLevel, int PageX, int PageY, int PageZ) override;
+
+    void SparseTextureUncommitRect(ISparseTexture* pTexture, TextureRect const& Rectangle) override;
+
+    void GetQueryPoolResults(IQueryPool*        QueryPool,
+                             uint32_t           FirstQuery,
+                             uint32_t           QueryCount,
+                             size_t             DataSize,
+                             void*              pSysMem,
+                             size_t             DstStride,
+                             QUERY_RESULT_FLAGS Flags) override;
+
+    void GenerateTextureMipLevels(ITexture* pTexture) override;
+
+    bool CopyFramebufferToTexture(FGRenderPassContext& RenderPassContext,
+                                  ITexture*            pDstTexture,
+                                  int                  ColorAttachment,
+                                  TextureOffset const& Offset,
+                                  Rect2D const&        SrcRect,
+                                  unsigned int         Alignment) override;
+
+    void CopyColorAttachmentToBuffer(FGRenderPassContext& RenderPassContext,
+                                     IBuffer*             pDstBuffer,
+                                     int                  SubpassAttachmentRef,
+                                     Rect2D const&        SrcRect,
+                                     FRAMEBUFFER_CHANNEL  FramebufferChannel,
+                                     FRAMEBUFFER_OUTPUT   FramebufferOutput,
+                                     COLOR_CLAMP          ColorClamp,
+                                     size_t               SizeInBytes,
+                                     size_t               DstByteOffset,
+                                     unsigned int         Alignment) override;
+
+    void CopyDepthAttachmentToBuffer(FGRenderPassContext& RenderPassContext,
+                                     IBuffer*             pDstBuffer,
+                                     Rect2D const&        SrcRect,
+                                     size_t               SizeInBytes,
+                                     size_t               DstByteOffset,
+                                     unsigned int         Alignment) override;
+
+    bool BlitFramebuffer(FGRenderPassContext&  RenderPassContext,
+                         int                   ColorAttachment,
+                         uint32_t              NumRectangles,
+                         BlitRectangle const*  Rectangles,
+                         FRAMEBUFFER_BLIT_MASK Mask,
+                         bool                  LinearFilter) override;
+
+    void ClearAttachments(FGRenderPassContext&          RenderPassContext,
+                          unsigned int*                 ColorAttachments,
+                          unsigned int                  NumColorAttachments,
+                          ClearColorValue const*        ColorClearValues,
+                          ClearDepthStencilValue const* DepthStencilClearValue,
+                          Rect2D const*                 Rect) override;
+
+    bool ReadFramebufferAttachment(FGRenderPassContext& RenderPassContext,
+                                   int                  ColorAttachment,
+                                   Rect2D const&        SrcRect,
+                                   FRAMEBUFFER_CHANNEL  FramebufferChannel,
+                                   FRAMEBUFFER_OUTPUT   FramebufferOutput,
+                                   COLOR_CLAMP          ColorClamp,
+                                   size_t               SizeInBytes,
+                                   unsigned int         Alignment,
+                                   void*                pSysMem) override;
+
+    bool ReadFramebufferDepthStencilAttachment(FGRenderPassContext& RenderPassContext,
+                                               Rect2D const&        SrcRect,
+                                               size_t               SizeInBytes,
+                                               unsigned int         Alignment,
+                                               void*                pSysMem) override;
+
+    //
+    // Local
+    //
+
+    void AddResourceBinding(bool bRedundant)
+    {
+        if (bRedundant)
+            Stat.RedundantResourceBindings++;
+        else
+            Stat.ResourceBindings++;
+    }
+
+private:
+    void ExecuteRenderPass(class RenderPass* pRenderPass);
+    void ExecuteCustomTask(class FGCustomTask* pCustomTask);
+
+    TRef<ResourceTableNullImpl> RootResourceTable;
+
+    size_t SyncCounter{};
+};
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
@@ -0,0 +1,203 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "TextureNullImpl.h"
+#include "DeviceNullImpl.h"
+#include "ImmediateContextNullImpl.h"
+
+HK_NAMESPACE_BEGIN
+
+namespace RenderCore
+{
+
+TextureViewNullImpl::TextureViewNullImpl(TextureViewDesc const& TextureViewDesc, ITexture* pTexture) :
+    ITextureView(TextureViewDesc, pTexture)
+{
+    SetHandle(this);
+}
+
+TextureNullImpl::TextureNullImpl(DeviceNullImpl* pDevice, TextureDesc const& TextureDesc) :
+    ITexture(pDevice, TextureDesc)
+{
+    bCompressed = IsCompressedFormat(TextureDesc.Format);
+
+    SetHandle(this);
+
+    CreateDefaultViews();
+}
+
+TextureNullImpl::~TextureNullImpl()
+{
+    // It is important to destroy views before a texture
+    Views.Clear();
+}
+
+void TextureNullImpl::CreateDefaultViews()
+{
+    TextureViewDesc viewDesc;
+    viewDesc.Type          = GetDesc().Type;
+    viewDesc.Format        = GetDesc().Format;
+    viewDesc.FirstMipLevel = 0;
+    viewDesc.FirstSlice    = 0;
+    viewDesc.NumSlices     = GetSliceCount();
+
+    if (IsDepthStencilFormat(GetDesc().Format))
+    {
+        if (GetDesc().BindFlags & BIND_DEPTH_STENCIL)
+        {
+            viewDesc.ViewType     = TEXTURE_VIEW_DEPTH_STENCIL;
+            viewDesc.NumMipLevels = 1;
+            pDepthStencilView     = GetTextureView(viewDesc);
+        }
+    }
+    else
+    {
+        if (GetDesc().BindFlags & BIND_RENDER_TARGET)
+        {
+            viewDesc.ViewType     = TEXTURE_VIEW_RENDER_TARGET;
+            viewDesc.NumMipLevels = 1;
+            pRenderTargetView     = GetTextureView(viewDesc);
+        }
+    }
+
+    if (GetDesc().BindFlags & BIND_SHADER_RESOURCE)
+    {
+        viewDesc.ViewType     = TEXTURE_VIEW_SHADER_RESOURCE;
+        viewDesc.NumMipLevels = Desc.NumMipLevels;
+        pShaderResourceView   = GetTextureView(viewDesc);
+    }
+
+    if (GetDesc().BindFlags & BIND_UNORDERED_ACCESS)
+    {
+        viewDesc.ViewType     = TEXTURE_VIEW_UNORDERED_ACCESS;
+        viewDesc.NumMipLevels = Desc.NumMipLevels;
+        pUnorderedAccesView   = GetTextureView(viewDesc);
+    }
+}
+
+ITextureView* TextureNullImpl::GetTextureView(TextureViewDesc const& TextureViewDesc)
+{
+    auto it = Views.Find(TextureViewDesc);
+    if (it == Views.End())
+    {
+        TRef<TextureViewNullImpl> textureView;
+
+        textureView = MakeRef<TextureViewNullImpl>(TextureViewDesc, this);
+        Views[TextureViewDesc] = textureView;
+
+        return textureView;
+    }
+
+    return it->second;
+}
+
+void TextureNullImpl::MakeBindlessSamplerResident(BindlessHandle Handle, bool bResident)
+{
+}
+
+bool TextureNullImpl::IsBindlessSamplerResident(BindlessHandle Handle)
+{
+    return false;
+}
+
+BindlessHandle TextureNullImpl::GetBindlessSampler(SamplerDesc const& SamplerDesc)
+{
+    LOG("TextureNullImpl::GetBindlessSampler: bindless textures are not supported by null device\n");
+    return 0;
+}
+
+void TextureNullImpl::GetMipLevelInfo(uint16_t MipLevel, TextureMipLevelInfo* pInfo) const
+{
+    *pInfo = TextureMipLevelInfo{};
+
+    bool b1D = Desc.Type == TEXTURE_1D || Desc.Type == TEXTURE_1D_ARRAY;
+
+    pInfo->Resoultion.Width      = Math::Max(1u, Desc.Resolution.Width >> MipLevel);
+    pInfo->Resoultion.Height     = b1D ? 1u : Math::Max(1u, Desc.Resolution.Height >> MipLevel);
+    pInfo->Resoultion.SliceCount = GetSliceCount(MipLevel);
+
+    pInfo->bCompressed = bCompressed;
+
+    if (bCompressed)
+    {
+        TextureFormatInfo const& info = GetTextureFormatInfo(Desc.Format);
+
+        size_t blocksX = (pInfo->Resoultion.Width + info.BlockSize - 1) / info.BlockSize;
+        size_t blocksY = (pInfo->Resoultion.Height + info.BlockSize - 1) / info.BlockSize;
+
+        pInfo->CompressedDataSizeInBytes = blocksX * blocksY * pInfo->Resoultion.SliceCount * info.BytesPerBlock;
+    }
+}
+
+void TextureNullImpl::Invalidate(uint16_t MipLevel)
+{
+}
+
+void TextureNullImpl::InvalidateRect(uint32_t _NumRectangles, TextureRect const* _Rectangles)
+{
+}
+
+void TextureNullImpl::Read(uint16_t MipLevel, size_t SizeInBytes, unsigned int Alignment, void* pSysMem)
+{
+    static_cast<DeviceNullImpl*>(GetDevice())->GetImmediateContextNull()->ReadTexture(this, MipLevel, SizeInBytes, Alignment, pSysMem);
+}
+
+void TextureNullImpl::ReadRect(TextureRect const& Rectangle, size_t SizeInBytes, unsigned int Alignment, void* pSysMem)
+{
+    static_cast<DeviceNullImpl*>(GetDevice())->GetImmediateContextNull()->ReadTextureRect(this, Rectangle, SizeInBytes, Alignment, pSysMem);
+}
+
+bool TextureNullImpl::Write(uint16_t MipLevel, size_t SizeInBytes, unsigned int Alignment, const void* pSysMem)
+{
+    return static_cast<DeviceNullImpl*>(GetDevice())->GetImmediateContextNull()->WriteTexture(this, MipLevel, SizeInBytes, Alignment, pSysMem);
+}
+
+bool TextureNullImpl::WriteRect(TextureRect const& Rectangle, size_t SizeInBytes, unsigned int Alignment, const void* pSysMem, size_t RowPitch, size_t DepthPitch)
+{
+    return static_cast<DeviceNullImpl*>(GetDevice())->GetImmediateContextNull()->WriteTextureRect(this, Rectangle, SizeInBytes, Alignment, pSysMem, RowPitch, DepthPitch);
+}
+
+SparseTextureNullImpl::SparseTextureNullImpl(DeviceNullImpl* pDevice, SparseTextureDesc const& Desc) :
+    ISparseTexture(pDevice, Desc)
+{
+    bCompressed = IsCompressedFormat(Desc.Format);
+
+    PageSizeX = 0;
+    PageSizeY = 0;
+    PageSizeZ = 0;
+
+    // Sparse textures are not supported (FEATURE_SPARSE_TEXTURES is off), so the texture stays invalid
+    LOG("SparseTextureNullImpl::ctor: sparse textures are not supported by null device\n");
+}
+
+} // namespace RenderCore
+
+HK_NAMESPACE_END
@@ -497,6 +497,11 @@ void DeviceGLImpl::CreateTexture(TextureDesc const& Desc, TRef<ITexture>* ppText
     *ppTexture = MakeRef<TextureGLImpl>(this, Desc);
 }
 
+void DeviceGLImpl::CreateTextureAlias(TextureDesc const& Desc, ITexture* pStorage, TRef<ITexture>* ppTexture)
+{
+    *ppTexture = MakeRef<TextureGLImpl>(this, Desc, pStorage);
+}
+
 void DeviceGLImpl::CreateSparseTexture(SparseTextureDesc const& Desc, TRef<ISparseTexture>* ppTexture)
 {
     *ppTexture = MakeRef<SparseTextureGLImpl>(this, Desc);
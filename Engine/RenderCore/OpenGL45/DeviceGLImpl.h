@@ -122,6 +122,8 @@ public:
 
     void CreateTexture(TextureDesc const& Desc, TRef<ITexture>* ppTexture) override;
 
+    void CreateTextureAlias(TextureDesc const& Desc, ITexture* pStorage, TRef<ITexture>* ppTexture) override;
+
     void CreateSparseTexture(SparseTextureDesc const& Desc, TRef<ISparseTexture>* ppTexture) override;
 
     void CreateTransformFeedback(TransformFeedbackDesc const& Desc, TRef<ITransformFeedback>* ppTransformFeedback) override;
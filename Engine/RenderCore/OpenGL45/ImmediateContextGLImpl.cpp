@@ -343,6 +343,7 @@ ImmediateContextGLImpl::ImmediateContextGLImpl(DeviceGLImpl* pDevice, WindowPool
     Platform::ZeroMem(BufferBindingUIDs, sizeof(BufferBindingUIDs));
     Platform::ZeroMem(BufferBindingOffsets, sizeof(BufferBindingOffsets));
     Platform::ZeroMem(BufferBindingSizes, sizeof(BufferBindingSizes));
+    Platform::ZeroMem(TextureBindingUIDs, sizeof(TextureBindingUIDs));
 
     CurrentPipeline       = nullptr;
     CurrentVertexLayout   = nullptr;
@@ -803,7 +804,7 @@ void ImmediateContextGLImpl::BindPipeline(IPipeline* _Pipeline)
 
     HK_ASSERT(_Pipeline != nullptr);
 
-    if (CurrentPipeline == _Pipeline)
+    if (!FilterPipeline(_Pipeline))
     {
         return;
     }
@@ -1218,6 +1219,11 @@ void ImmediateContextGLImpl::BindVertexBuffer(unsigned int   _InputSlot,
 {
     HK_ASSERT(_InputSlot < MAX_VERTEX_BUFFER_SLOTS);
 
+    if (!FilterVertexBuffer(_InputSlot, _VertexBuffer, _Offset))
+    {
+        return;
+    }
+
     VertexBufferUIDs[_InputSlot]    = _VertexBuffer ? _VertexBuffer->GetUID() : 0;
     VertexBufferHandles[_InputSlot] = _VertexBuffer ? _VertexBuffer->GetHandleNativeGL() : 0;
     VertexBufferOffsets[_InputSlot] = _Offset;
@@ -1236,6 +1242,11 @@ void ImmediateContextGLImpl::BindVertexBuffers(unsigned int    _StartSlot,
         {
             int slot = _StartSlot + i;
 
+            if (!FilterVertexBuffer(slot, _VertexBuffers[i], _Offsets ? _Offsets[i] : 0))
+            {
+                continue;
+            }
+
             VertexBufferUIDs[slot]    = _VertexBuffers[i] ? _VertexBuffers[i]->GetUID() : 0;
             VertexBufferHandles[slot] = _VertexBuffers[i] ? _VertexBuffers[i]->GetHandleNativeGL() : 0;
             VertexBufferOffsets[slot] = _Offsets ? _Offsets[i] : 0;
@@ -1247,6 +1258,11 @@ void ImmediateContextGLImpl::BindVertexBuffers(unsigned int    _StartSlot,
         {
             int slot = _StartSlot + i;
 
+            if (!FilterVertexBuffer(slot, nullptr, 0))
+            {
+                continue;
+            }
+
             VertexBufferUIDs[slot]    = 0;
             VertexBufferHandles[slot] = 0;
             VertexBufferOffsets[slot] = 0;
@@ -1342,6 +1358,11 @@ void ImmediateContextGLImpl::BindIndexBuffer(IBuffer const* _IndexBuffer,
                                               INDEX_TYPE     _Type,
                                               unsigned int   _Offset)
 {
+    if (!FilterIndexBuffer(_IndexBuffer, _Type, _Offset))
+    {
+        return;
+    }
+
     IndexBufferType       = IndexTypeLUT[_Type];
     IndexBufferOffset     = _Offset;
     IndexBufferTypeSizeOf = IndexTypeSizeOfLUT[_Type];
@@ -1356,6 +1377,11 @@ IResourceTable* ImmediateContextGLImpl::GetRootResourceTable()
 
 void ImmediateContextGLImpl::BindResourceTable(IResourceTable* _ResourceTable)
 {
+    if (!FilterResourceTable(_ResourceTable))
+    {
+        return;
+    }
+
     IResourceTable* tbl = _ResourceTable ? _ResourceTable : RootResourceTable.GetObject();
 
     CurrentResourceTable = static_cast<ResourceTableGLImpl*>(tbl);
@@ -1799,8 +1825,6 @@ void ImmediateContextGLImpl::UpdateVertexAndIndexBuffers()
 
 void ImmediateContextGLImpl::UpdateShaderBindings()
 {
-    // TODO: memcmp CurrentPipeline->TextureBindings, CurrentResourceTable->TextureBindings2
-
     //LOG("NumSamplerObjects {}\n", CurrentPipeline->NumSamplerObjects);
 
     //for (int i = 0 ; i < CurrentPipeline->NumSamplerObjects ; i++)
@@ -1811,7 +1835,25 @@ void ImmediateContextGLImpl::UpdateShaderBindings()
     //        LOG("Sampler type: null\n");
     //}
 
-    glBindTextures(0, CurrentPipeline->NumSamplerObjects, CurrentResourceTable->GetTextureBindings()); // 4.4
+    int numTextures = CurrentPipeline->NumSamplerObjects;
+    int numChanged  = 0;
+
+    for (int i = 0; i < numTextures; i++)
+    {
+        if (TextureBindingUIDs[i] != CurrentResourceTable->GetTextureBindingUIDs()[i])
+        {
+            TextureBindingUIDs[i] = CurrentResourceTable->GetTextureBindingUIDs()[i];
+            numChanged++;
+        }
+    }
+
+    if (numChanged)
+    {
+        glBindTextures(0, numTextures, CurrentResourceTable->GetTextureBindings()); // 4.4
+    }
+
+    Stat.ResourceBindings += numChanged;
+    Stat.RedundantResourceBindings += numTextures - numChanged;
 
 #if 1
     for (int i = 0; i < CurrentPipeline->NumImages; i++)
@@ -1833,6 +1875,7 @@ void ImmediateContextGLImpl::UpdateShaderBindings()
     {
         if (BufferBindingUIDs[i] != CurrentResourceTable->GetBufferBindingUIDs()[i] || BufferBindingOffsets[i] != CurrentResourceTable->GetBufferBindingOffsets()[i] || BufferBindingSizes[i] != CurrentResourceTable->GetBufferBindingSizes()[i])
         {
+            Stat.ResourceBindings++;
 
             BufferBindingUIDs[i]    = CurrentResourceTable->GetBufferBindingUIDs()[i];
             BufferBindingOffsets[i] = CurrentResourceTable->GetBufferBindingOffsets()[i];
@@ -2521,6 +2564,9 @@ void ImmediateContextGLImpl::BeginRenderPass(RenderPassBeginGL const& _RenderPas
     CurrentRenderPassRenderArea = _RenderPassBegin.RenderArea;
     CurrentPipeline             = nullptr;
 
+    // Pipeline state must be reapplied inside the new render pass
+    InvalidateStateFilter();
+
     for (int i = 0; i < CurrentRenderPass->GetColorAttachments().Size(); i++)
     {
         ColorAttachmentClearValues[i] = CurrentRenderPass->GetColorAttachments()[i].ClearValue.Color;
@@ -5381,29 +5427,9 @@ void ImmediateContextGLImpl::ExecuteFrameGraph(FrameGraph* pFrameGraph)
 {
     pFramebufferCache->CleanupOutdatedFramebuffers();
 
-    auto& acquiredResources = pFrameGraph->GetAcquiredResources();
-    auto& releasedResources = pFrameGraph->GetReleasedResources();
-
-    FGRenderTargetCache* pRenderTargetCache = pFrameGraph->GetRenderTargetCache();
-
     for (FrameGraph::TimelineStep const& step : pFrameGraph->GetTimeline())
     {
-        // Acquire resources for the render pass
-        for (int i = 0; i < step.NumAcquiredResources; i++)
-        {
-            FGResourceProxyBase* resourceProxy = acquiredResources[step.FirstAcquiredResource + i];
-            if (resourceProxy->IsTransient())
-            {
-                switch (resourceProxy->GetProxyType())
-                {
-                    case DEVICE_OBJECT_TYPE_TEXTURE:
-                        resourceProxy->SetDeviceObject(pRenderTargetCache->Acquire(static_cast<FGTextureProxy*>(resourceProxy)->GetResourceDesc()));
-                        break;
-                    default:
-                        HK_ASSERT(0);
-                }
-            }
-        }
+        pFrameGraph->AcquireResources(step);
 
         switch (step.RenderTask->GetProxyType())
         {
@@ -5418,22 +5444,7 @@ void ImmediateContextGLImpl::ExecuteFrameGraph(FrameGraph* pFrameGraph)
                 break;
         }
 
-        // Release resources that are not needed after the current render pass
-        for (int i = 0; i < step.NumReleasedResources; i++)
-        {
-            FGResourceProxyBase* resourceProxy = releasedResources[step.FirstReleasedResource + i];
-            if (resourceProxy->IsTransient() && resourceProxy->GetDeviceObject())
-            {
-                switch (resourceProxy->GetProxyType())
-                {
-                    case DEVICE_OBJECT_TYPE_TEXTURE:
-                        pRenderTargetCache->Release(static_cast<ITexture*>(resourceProxy->GetDeviceObject()));
-                        break;
-                    default:
-                        HK_ASSERT(0);
-                }
-            }
-        }
+        pFrameGraph->ReleaseResources(step);
     }
 
     // Unbind current framebuffer
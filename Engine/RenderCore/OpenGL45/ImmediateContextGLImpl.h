@@ -654,6 +654,7 @@ private:
     uint32_t  BufferBindingUIDs[MAX_BUFFER_SLOTS];
     ptrdiff_t BufferBindingOffsets[MAX_BUFFER_SLOTS];
     ptrdiff_t BufferBindingSizes[MAX_BUFFER_SLOTS];
+    uint32_t  TextureBindingUIDs[MAX_SAMPLER_SLOTS];
 
     TRef<IResourceTable>       RootResourceTable;
     TRef<ResourceTableGLImpl>  CurrentResourceTable;
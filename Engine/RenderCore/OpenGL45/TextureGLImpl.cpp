@@ -65,6 +65,25 @@ static void SetSwizzleParams(GLuint _Id, TextureSwizzle const& _Swizzle)
     }
 }
 
+static GLenum GetTextureTarget(TextureDesc const& TextureDesc)
+{
+    GLenum target = TextureTargetLUT[TextureDesc.Type].Target;
+
+    if (TextureDesc.Multisample.NumSamples > 1)
+    {
+        switch (target)
+        {
+            case GL_TEXTURE_2D:
+                target = GL_TEXTURE_2D_MULTISAMPLE;
+                break;
+            case GL_TEXTURE_2D_ARRAY:
+                target = GL_TEXTURE_2D_MULTISAMPLE_ARRAY;
+                break;
+        }
+    }
+    return target;
+}
+
 TextureGLImpl::TextureGLImpl(DeviceGLImpl* pDevice, TextureDesc const& TextureDesc, bool bDummyTexture) :
     ITexture(pDevice, TextureDesc), bDummyTexture(bDummyTexture)
 {
@@ -72,22 +91,9 @@ TextureGLImpl::TextureGLImpl(DeviceGLImpl* pDevice, TextureDesc const& TextureDe
 
     if (!bDummyTexture)
     {
-        GLenum target         = TextureTargetLUT[TextureDesc.Type].Target;
+        GLenum target         = GetTextureTarget(TextureDesc);
         GLenum internalFormat = InternalFormatLUT[TextureDesc.Format].InternalFormat;
 
-        if (TextureDesc.Multisample.NumSamples > 1)
-        {
-            switch (target)
-            {
-                case GL_TEXTURE_2D:
-                    target = GL_TEXTURE_2D_MULTISAMPLE;
-                    break;
-                case GL_TEXTURE_2D_ARRAY:
-                    target = GL_TEXTURE_2D_MULTISAMPLE_ARRAY;
-                    break;
-            }
-        }
-
         glCreateTextures(target, 1, &id);
 
         SetSwizzleParams(id, TextureDesc.Swizzle);
@@ -158,6 +164,29 @@ TextureGLImpl::TextureGLImpl(DeviceGLImpl* pDevice, TextureDesc const& TextureDe
     CreateDefaultViews();
 }
 
+TextureGLImpl::TextureGLImpl(DeviceGLImpl* pDevice, TextureDesc const& TextureDesc, ITexture* pStorage) :
+    ITexture(pDevice, TextureDesc)
+{
+    HK_ASSERT(pStorage->GetDesc().IsStorageCompatible(TextureDesc));
+
+    GLuint id;
+    glGenTextures(1, &id);
+
+    // 4.3. The view shares the storage, memory is accounted by the storage texture.
+    glTextureView(id, GetTextureTarget(TextureDesc), pStorage->GetHandleNativeGL(),
+                  InternalFormatLUT[TextureDesc.Format].InternalFormat, 0, TextureDesc.NumMipLevels, 0, pStorage->GetSliceCount());
+
+    SetSwizzleParams(id, TextureDesc.Swizzle);
+
+    pDevice->TextureMemoryAllocated += CalcTextureRequiredMemory();
+
+    bCompressed = IsCompressedFormat(TextureDesc.Format);
+
+    SetHandleNativeGL(id);
+
+    CreateDefaultViews();
+}
+
 void TextureGLImpl::CreateDefaultViews()
 {
     TextureViewDesc viewDesc;
@@ -44,6 +44,9 @@ class TextureGLImpl final : public ITexture
 {
 public:
     TextureGLImpl(DeviceGLImpl* pDevice, TextureDesc const& TextureDesc, bool bDummyTexture = false);
+
+    /** Texture view of the storage of another texture */
+    TextureGLImpl(DeviceGLImpl* pDevice, TextureDesc const& TextureDesc, ITexture* pStorage);
     ~TextureGLImpl();
 
     void MakeBindlessSamplerResident(BindlessHandle Handle, bool bResident) override;
@@ -281,6 +281,18 @@ struct TextureDesc
         return !(operator==(Rhs));
     }
 
+    /** Texture of the Rhs descriptor can be created as an alias of the storage of this one (see IDevice::CreateTextureAlias) */
+    bool IsStorageCompatible(TextureDesc const& Rhs) const
+    {
+        // clang-format off
+        return Type        == Rhs.Type &&
+               Resolution  == Rhs.Resolution &&
+               Multisample == Rhs.Multisample &&
+               NumMipLevels== Rhs.NumMipLevels &&
+               IsViewCompatibleFormat(Format, Rhs.Format);
+        // clang-format on
+    }
+
     TextureDesc& SetFormat(TEXTURE_FORMAT InFormat)
     {
         Format = InFormat;
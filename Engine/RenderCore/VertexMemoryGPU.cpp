@@ -125,6 +125,8 @@ void VertexMemoryGPU::Defragment(bool bDeallocateEmptyBlocks, bool bForceUpload)
 
     std::sort(m_Handles.Begin(), m_Handles.End(), cmp);
 
+    m_Revision++;
+
     // NOTE: We can allocate new GPU buffers for blocks and just copy buffer-to-buffer on GPU side and then deallocate old buffers.
     // It is gonna be faster than CPU->GPU transition and get rid of implicit synchroization on the driver, but takes more memory.
 
@@ -435,11 +437,23 @@ StreamedMemoryGPU::StreamedMemoryGPU(RenderCore::IDevice* pDevice) :
         CriticalError("StreamedMemoryGPU::Initialize: cannot initialize persistent mapped buffer size {}\n", bufferCI.SizeInBytes);
     }
 
-    Platform::ZeroMem(m_ChainBuffer, sizeof(m_ChainBuffer));
+    for (int i = 0; i < STREAMED_MEMORY_GPU_BUFFERS_COUNT; i++)
+    {
+        ChainBuffer* pChainBuffer = &m_ChainBuffer[i];
+
+        pChainBuffer->UsedMemory.StoreRelaxed(0);
+        pChainBuffer->HandlesCount.StoreRelaxed(0);
+        pChainBuffer->WindowsCount.StoreRelaxed(0);
+        pChainBuffer->WindowWaste.StoreRelaxed(0);
+        pChainBuffer->Sync = nullptr;
+    }
 
     m_BufferIndex = 0;
+    m_FrameIndex = 0;
     m_MaxMemoryUsage = 0;
-    m_LastAllocatedBlockSize = 0;
+    m_Stat = {};
+    m_NumStalls = 0;
+    m_StallMicroseconds = 0;
 
     m_VertexBufferAlignment = 32; // TODO: Get from driver!!!
     m_IndexBufferAlignment = 16;  // TODO: Get from driver!!!
@@ -508,10 +522,18 @@ void StreamedMemoryGPU::Wait(RenderCore::SyncObject Sync)
     const uint64_t timeOutNanoseconds = 1;
     if (Sync)
     {
-        RenderCore::CLIENT_WAIT_STATUS status;
+        RenderCore::CLIENT_WAIT_STATUS status = m_pImmediateContext->ClientWait(Sync, timeOutNanoseconds);
+        if (status == RenderCore::CLIENT_WAIT_ALREADY_SIGNALED || status == RenderCore::CLIENT_WAIT_CONDITION_SATISFIED)
+            return;
+
+        // The GPU is still reading the block
+        int64_t startTime = Platform::SysMicroseconds();
         do {
             status = m_pImmediateContext->ClientWait(Sync, timeOutNanoseconds);
         } while (status != RenderCore::CLIENT_WAIT_ALREADY_SIGNALED && status != RenderCore::CLIENT_WAIT_CONDITION_SATISFIED);
+
+        m_NumStalls++;
+        m_StallMicroseconds += Platform::SysMicroseconds() - startTime;
     }
 }
 
@@ -525,12 +547,56 @@ void StreamedMemoryGPU::Swap()
     m_pImmediateContext->RemoveSync(m_ChainBuffer[m_BufferIndex].Sync);
     m_ChainBuffer[m_BufferIndex].Sync = m_pImmediateContext->FenceSync();
 
-    m_MaxMemoryUsage = Math::Max(m_MaxMemoryUsage, m_ChainBuffer[m_BufferIndex].UsedMemory);
+    ChainBuffer* pChainBuffer = &m_ChainBuffer[m_BufferIndex];
+
+    m_Stat.UsedMemory        = pChainBuffer->UsedMemory.Load();
+    m_Stat.WindowWaste       = pChainBuffer->WindowWaste.Load();
+    m_Stat.NumAllocations    = pChainBuffer->HandlesCount.Load();
+    m_Stat.NumWindows        = pChainBuffer->WindowsCount.Load();
+    m_Stat.NumStalls         = m_NumStalls;
+    m_Stat.StallMicroseconds = m_StallMicroseconds;
+
+    m_NumStalls = 0;
+    m_StallMicroseconds = 0;
+
+    m_MaxMemoryUsage = Math::Max(m_MaxMemoryUsage, m_Stat.UsedMemory);
     m_BufferIndex = (m_BufferIndex + 1) % STREAMED_MEMORY_GPU_BUFFERS_COUNT;
-    m_ChainBuffer[m_BufferIndex].HandlesCount = 0;
-    m_ChainBuffer[m_BufferIndex].UsedMemory = 0;
+    m_FrameIndex++;
+
+    pChainBuffer = &m_ChainBuffer[m_BufferIndex];
+    pChainBuffer->HandlesCount.Store(0);
+    pChainBuffer->UsedMemory.Store(0);
+    pChainBuffer->WindowsCount.Store(0);
+    pChainBuffer->WindowWaste.Store(0);
+}
+
+size_t StreamedMemoryGPU::Reserve(size_t _SizeInBytes, int _Alignment)
+{
+    ChainBuffer* pChainBuffer = &m_ChainBuffer[m_BufferIndex];
+
+    int64_t usedMemory = pChainBuffer->UsedMemory.LoadRelaxed();
+    size_t alignedOffset;
+    do {
+        alignedOffset = Align((size_t)usedMemory, _Alignment);
+
+        if (alignedOffset + _SizeInBytes > STREAMED_MEMORY_GPU_BLOCK_SIZE)
+        {
+            CriticalError("StreamedMemoryGPU::Allocate: failed on allocation of {} bytes\nIncrease STREAMED_MEMORY_GPU_BLOCK_SIZE\n", _SizeInBytes);
+        }
+    } while (!pChainBuffer->UsedMemory.CompareExchangeWeak(usedMemory, alignedOffset + _SizeInBytes));
+
+    return alignedOffset;
+}
+
+size_t StreamedMemoryGPU::ReserveWindow(size_t _SizeInBytes, int _Alignment)
+{
+    HK_ASSERT(_SizeInBytes > 0);
+
+    size_t offset = Reserve(_SizeInBytes, _Alignment);
+
+    m_ChainBuffer[m_BufferIndex].WindowsCount.Increment();
 
-    m_LastAllocatedBlockSize = 0;
+    return offset + m_BufferIndex * STREAMED_MEMORY_GPU_BLOCK_SIZE;
 }
 
 size_t StreamedMemoryGPU::Allocate(size_t _SizeInBytes, int _Alignment, const void* _Data)
@@ -543,19 +609,9 @@ size_t StreamedMemoryGPU::Allocate(size_t _SizeInBytes, int _Alignment, const vo
         _SizeInBytes = 1;
     }
 
-    ChainBuffer* pChainBuffer = &m_ChainBuffer[m_BufferIndex];
-
-    size_t alignedOffset = Align(pChainBuffer->UsedMemory, _Alignment);
-
-    if (alignedOffset + _SizeInBytes > STREAMED_MEMORY_GPU_BLOCK_SIZE)
-    {
-        CriticalError("StreamedMemoryGPU::Allocate: failed on allocation of {} bytes\nIncrease STREAMED_MEMORY_GPU_BLOCK_SIZE\n", _SizeInBytes);
-    }
-
-    m_LastAllocatedBlockSize = _SizeInBytes;
+    size_t alignedOffset = Reserve(_SizeInBytes, _Alignment);
 
-    pChainBuffer->UsedMemory = alignedOffset + _SizeInBytes;
-    pChainBuffer->HandlesCount++;
+    m_ChainBuffer[m_BufferIndex].HandlesCount.Increment();
 
     alignedOffset += m_BufferIndex * STREAMED_MEMORY_GPU_BLOCK_SIZE;
 
@@ -567,14 +623,113 @@ size_t StreamedMemoryGPU::Allocate(size_t _SizeInBytes, int _Alignment, const vo
     return alignedOffset;
 }
 
-void StreamedMemoryGPU::ShrinkLastAllocatedMemoryBlock(size_t _SizeInBytes)
+void StreamedMemoryGPU::ShrinkLastAllocatedMemoryBlock(size_t _StreamHandle, size_t _BlockSize, size_t _NewSize)
 {
-    HK_ASSERT(_SizeInBytes <= m_LastAllocatedBlockSize);
+    HK_ASSERT(_NewSize <= _BlockSize);
 
-    ChainBuffer* pChainBuffer = &m_ChainBuffer[m_BufferIndex];
-    pChainBuffer->UsedMemory = pChainBuffer->UsedMemory - m_LastAllocatedBlockSize + _SizeInBytes;
+    size_t bufferOffset = m_BufferIndex * STREAMED_MEMORY_GPU_BLOCK_SIZE;
+
+    HK_ASSERT(_StreamHandle >= bufferOffset && _StreamHandle + _BlockSize <= bufferOffset + STREAMED_MEMORY_GPU_BLOCK_SIZE);
+
+    int64_t blockEnd    = _StreamHandle - bufferOffset + _BlockSize;
+    int64_t newBlockEnd = blockEnd - _BlockSize + _NewSize;
+
+    // Keep the block as is if something was allocated after it
+    m_ChainBuffer[m_BufferIndex].UsedMemory.CompareExchangeStrong(blockEnd, newBlockEnd);
+}
+
+StreamedMemoryWindow::StreamedMemoryWindow(StreamedMemoryGPU* pStreamedMemory, size_t WindowSize) :
+    m_pStreamedMemory(pStreamedMemory), m_WindowSize(WindowSize), m_FrameIndex(pStreamedMemory->GetFrameIndex())
+{}
+
+StreamedMemoryWindow::~StreamedMemoryWindow()
+{
+    Release();
+}
+
+size_t StreamedMemoryWindow::AllocateVertex(size_t _SizeInBytes, const void* _Data)
+{
+    return Allocate(_SizeInBytes, m_pStreamedMemory->m_VertexBufferAlignment, _Data);
+}
+
+size_t StreamedMemoryWindow::AllocateIndex(size_t _SizeInBytes, const void* _Data)
+{
+    return Allocate(_SizeInBytes, m_pStreamedMemory->m_IndexBufferAlignment, _Data);
+}
+
+size_t StreamedMemoryWindow::AllocateJoint(size_t _SizeInBytes, const void* _Data)
+{
+    return Allocate(_SizeInBytes, m_pStreamedMemory->m_ConstantBufferAlignment, _Data);
+}
+
+size_t StreamedMemoryWindow::AllocateConstant(size_t _SizeInBytes, const void* _Data)
+{
+    return Allocate(_SizeInBytes, m_pStreamedMemory->m_ConstantBufferAlignment, _Data);
+}
+
+size_t StreamedMemoryWindow::AllocateWithCustomAlignment(size_t _SizeInBytes, int _Alignment, const void* _Data)
+{
+    return Allocate(_SizeInBytes, _Alignment, _Data);
+}
+
+void StreamedMemoryWindow::Release()
+{
+    if (m_FrameIndex == m_pStreamedMemory->GetFrameIndex())
+    {
+        auto& chainBuffer = m_pStreamedMemory->m_ChainBuffer[m_pStreamedMemory->m_BufferIndex];
+
+        if (m_End > m_Cursor)
+            chainBuffer.WindowWaste.Add(m_End - m_Cursor);
+        if (m_NumAllocations)
+            chainBuffer.HandlesCount.Add(m_NumAllocations);
+    }
+    m_Cursor = m_End = 0;
+    m_NumAllocations = 0;
+}
+
+size_t StreamedMemoryWindow::Allocate(size_t _SizeInBytes, int _Alignment, const void* _Data)
+{
+    HK_ASSERT(_SizeInBytes > 0);
 
-    m_LastAllocatedBlockSize = _SizeInBytes;
+    if (_SizeInBytes == 0)
+    {
+        // Don't allow to alloc empty chunks
+        _SizeInBytes = 1;
+    }
+
+    // The window was reserved on previous frame
+    if (m_FrameIndex != m_pStreamedMemory->GetFrameIndex())
+    {
+        m_FrameIndex = m_pStreamedMemory->GetFrameIndex();
+        m_Cursor = m_End = 0;
+        m_NumAllocations = 0;
+    }
+
+    // Large blocks go directly to the ring
+    if (_SizeInBytes > m_WindowSize / 2)
+    {
+        return m_pStreamedMemory->Allocate(_SizeInBytes, _Alignment, _Data);
+    }
+
+    size_t alignedOffset = Align(m_Cursor, _Alignment);
+
+    if (alignedOffset + _SizeInBytes > m_End)
+    {
+        Release();
+
+        alignedOffset = m_pStreamedMemory->ReserveWindow(m_WindowSize, Math::Max(_Alignment, m_pStreamedMemory->m_ConstantBufferAlignment));
+        m_End = alignedOffset + m_WindowSize;
+    }
+
+    m_Cursor = alignedOffset + _SizeInBytes;
+    m_NumAllocations++;
+
+    if (_Data)
+    {
+        Platform::Memcpy((byte*)m_pStreamedMemory->m_pMappedMemory + alignedOffset, _Data, _SizeInBytes);
+    }
+
+    return alignedOffset;
 }
 
 HK_NAMESPACE_END
@@ -32,6 +32,7 @@ SOFTWARE.
 
 #include <Engine/Core/Platform/Memory/PoolAllocator.h>
 #include <Engine/Core/Containers/Vector.h>
+#include <Engine/Core/Platform/Atomic.h>
 #include <Engine/RenderCore/Device.h>
 
 HK_NAMESPACE_BEGIN
@@ -52,6 +53,12 @@ constexpr int JOINT_SIZE_ALIGN  = 16;
 
 typedef void* (*GetMemoryCallback)(void* _UserPointer);
 
+/** Size of index in bytes */
+HK_FORCEINLINE size_t GetIndexSize(RenderCore::INDEX_TYPE IndexType)
+{
+    return IndexType == RenderCore::INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
 /** VertexHandle holds internal data. Don't modify it outside of VertexMemoryGPU */
 struct VertexHandle
 {
@@ -138,6 +145,9 @@ public:
     /** Total block count */
     int GetBlocksCount() const { return m_Blocks.Size(); }
 
+    /** Incremented by defragmentation. Buffers and offsets obtained from handles are valid while the revision is the same. */
+    uint32_t GetRevision() const { return m_Revision; }
+
 private:
     /** Find a free block */
     int FindBlock(size_t _RequiredSize);
@@ -181,8 +191,42 @@ private:
 
     size_t m_UsedMemory;
     size_t m_UsedMemoryHuge;
+    uint32_t m_Revision{};
+};
+
+/** Streamed memory statistics of the last completed frame */
+struct StreamedMemoryStat
+{
+    /** Memory used by the frame, including alignment and window tails */
+    size_t UsedMemory;
+
+    /** Unused tails of allocation windows */
+    size_t WindowWaste;
+
+    /** Number of allocations */
+    int NumAllocations;
+
+    /** Number of allocation windows reserved by worker threads */
+    int NumWindows;
+
+    /** Number of waits that blocked on the GPU */
+    int NumStalls;
+
+    /** Time spent waiting for the GPU */
+    int64_t StallMicroseconds;
+
+    /** Fill level of the frame block in range [0..1] */
+    float GetFillLevel() const { return (float)UsedMemory / STREAMED_MEMORY_GPU_BLOCK_SIZE; }
 };
 
+/**
+
+StreamedMemoryGPU
+
+Ring of persistently mapped frame blocks. Allocations are lock-free and may be made from any thread
+during the frame, but not concurrently with Wait() or Swap().
+
+*/
 class StreamedMemoryGPU : public RefCounted
 {
     HK_FORBID_COPY(StreamedMemoryGPU)
@@ -207,8 +251,13 @@ public:
     /** Allocate data with custum alignment. Return stream handle. Stream handle is actual during current frame. */
     size_t AllocateWithCustomAlignment(size_t _SizeInBytes, int _Alignment, const void* _Data = nullptr);
 
-    /** Change size of last allocated memory block */
-    void ShrinkLastAllocatedMemoryBlock(size_t _SizeInBytes);
+    /** Reserve a range of the current frame block with a single atomic operation. Return stream handle.
+    Unlike Allocate*, the range is not counted as a stream handle. Used by allocation windows. */
+    size_t ReserveWindow(size_t _SizeInBytes, int _Alignment);
+
+    /** Change size of a memory block allocated on current frame. _BlockSize is the size the block was allocated with.
+    Does nothing if other allocations were made after the block. */
+    void ShrinkLastAllocatedMemoryBlock(size_t _StreamHandle, size_t _BlockSize, size_t _NewSize);
 
     /** Map data. Mapped data is actual during current frame. */
     void* Map(size_t _StreamHandle);
@@ -229,10 +278,10 @@ public:
     size_t GetAllocatedMemory() const { return STREAMED_MEMORY_GPU_BLOCK_SIZE; }
 
     /** Get total used memory */
-    size_t GetUsedMemory() const { return m_ChainBuffer[m_BufferIndex].UsedMemory; }
+    size_t GetUsedMemory() const { return m_ChainBuffer[m_BufferIndex].UsedMemory.Load(); }
 
     /** Get total used memory on previous frame */
-    size_t GetUsedMemoryPrev() const { return m_ChainBuffer[(m_BufferIndex + STREAMED_MEMORY_GPU_BUFFERS_COUNT - 1) % STREAMED_MEMORY_GPU_BUFFERS_COUNT].UsedMemory; }
+    size_t GetUsedMemoryPrev() const { return m_ChainBuffer[(m_BufferIndex + STREAMED_MEMORY_GPU_BUFFERS_COUNT - 1) % STREAMED_MEMORY_GPU_BUFFERS_COUNT].UsedMemory.Load(); }
 
     /** Get free memory */
     size_t GetUnusedMemory() const { return GetAllocatedMemory() - GetUsedMemory(); }
@@ -241,17 +290,29 @@ public:
     size_t GetMaxMemoryUsage() const { return m_MaxMemoryUsage; }
 
     /** Get stream handles count */
-    int GetHandlesCount() const { return m_ChainBuffer[m_BufferIndex].HandlesCount; }
+    int GetHandlesCount() const { return m_ChainBuffer[m_BufferIndex].HandlesCount.Load(); }
+
+    /** Get statistics of the last completed frame */
+    StreamedMemoryStat const& GetStat() const { return m_Stat; }
+
+    /** Incremented on each swap. Stream handles of previous frames are not actual. */
+    uint32_t GetFrameIndex() const { return m_FrameIndex; }
 
 private:
+    friend class StreamedMemoryWindow;
+
     size_t Allocate(size_t _SizeInBytes, int _Alignment, const void* _Data);
 
     void Wait(RenderCore::SyncObject Sync);
 
+    size_t Reserve(size_t _SizeInBytes, int _Alignment);
+
     struct ChainBuffer
     {
-        size_t                 UsedMemory;
-        int                    HandlesCount;
+        AtomicLong             UsedMemory;
+        AtomicInt              HandlesCount;
+        AtomicInt              WindowsCount;
+        AtomicLong             WindowWaste;
         RenderCore::SyncObject Sync;
     };
 
@@ -261,11 +322,66 @@ private:
     TRef<RenderCore::IBuffer> m_Buffer;
     void*                     m_pMappedMemory;
     int                       m_BufferIndex;
+    uint32_t                  m_FrameIndex;
     size_t                    m_MaxMemoryUsage;
-    size_t                    m_LastAllocatedBlockSize;
+    StreamedMemoryStat        m_Stat;
+    int                       m_NumStalls;
+    int64_t                   m_StallMicroseconds;
     int                       m_VertexBufferAlignment;
     int                       m_IndexBufferAlignment;
     int                       m_ConstantBufferAlignment;
 };
 
+/**
+
+StreamedMemoryWindow
+
+Per-thread allocator on top of StreamedMemoryGPU. Reserves windows of the current frame block with a single
+atomic operation and sub-allocates from them without synchronization. Use one window per thread and
+release it before the end of the frame.
+
+*/
+class StreamedMemoryWindow
+{
+    HK_FORBID_COPY(StreamedMemoryWindow)
+
+public:
+    static constexpr size_t DEFAULT_WINDOW_SIZE = 64 << 10; // 64 KB
+
+    StreamedMemoryWindow(StreamedMemoryGPU* pStreamedMemory, size_t WindowSize = DEFAULT_WINDOW_SIZE);
+
+    ~StreamedMemoryWindow();
+
+    /** Allocate vertex data. Return stream handle. Stream handle is actual during current frame. */
+    size_t AllocateVertex(size_t _SizeInBytes, const void* _Data = nullptr);
+
+    /** Allocate index data. Return stream handle. Stream handle is actual during current frame. */
+    size_t AllocateIndex(size_t _SizeInBytes, const void* _Data = nullptr);
+
+    /** Allocate joint data. Return stream handle. Stream handle is actual during current frame. */
+    size_t AllocateJoint(size_t _SizeInBytes, const void* _Data = nullptr);
+
+    /** Allocate constant data. Return stream handle. Stream handle is actual during current frame. */
+    size_t AllocateConstant(size_t _SizeInBytes, const void* _Data = nullptr);
+
+    /** Allocate data with custum alignment. Return stream handle. Stream handle is actual during current frame. */
+    size_t AllocateWithCustomAlignment(size_t _SizeInBytes, int _Alignment, const void* _Data = nullptr);
+
+    /** Map data. Mapped data is actual during current frame. */
+    void* Map(size_t _StreamHandle) { return m_pStreamedMemory->Map(_StreamHandle); }
+
+    /** Give up the rest of the current window. Called automatically on destruction. */
+    void Release();
+
+private:
+    size_t Allocate(size_t _SizeInBytes, int _Alignment, const void* _Data);
+
+    StreamedMemoryGPU* m_pStreamedMemory;
+    size_t             m_WindowSize;
+    size_t             m_Cursor{};
+    size_t             m_End{};
+    int                m_NumAllocations{};
+    uint32_t           m_FrameIndex{};
+};
+
 HK_NAMESPACE_END
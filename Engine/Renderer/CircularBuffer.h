@@ -46,6 +46,12 @@ public:
 
     RenderCore::IBuffer* GetBuffer() { return m_Buffer; }
 
+    /** Max size of a single allocation */
+    size_t GetBufferSize() const { return m_BufferSize; }
+
+    /** Alignment of allocation offsets */
+    size_t GetAlignment() const { return m_ConstantBufferAlignment; }
+
 private:
     struct ChainBuffer
     {
@@ -35,24 +35,28 @@ HK_NAMESPACE_BEGIN
 
 using namespace RenderCore;
 
-static bool BindMaterialDepthPass(IImmediateContext* immediateCtx, RenderInstance const* instance)
+static IPipeline* GetDepthPassPipeline(RenderInstance const* instance)
 {
     MaterialGPU* pMaterial = instance->Material;
 
     HK_ASSERT(pMaterial);
 
-    int bSkinned = instance->SkeletonSize > 0;
-
-    IPipeline* pPipeline;
-    if (GRenderView->bAllowMotionBlur && instance->GetGeometryPriority() == RENDERING_GEOMETRY_PRIORITY_DYNAMIC)
+    if (instance->InstanceCount > 1)
     {
-        pPipeline = pMaterial->DepthVelocityPass[bSkinned];
+        return pMaterial->DepthPassInstanced[instance->GetVertexFormat()];
     }
-    else
+    if (GRenderView->bAllowMotionBlur && instance->GetGeometryPriority() == RENDERING_GEOMETRY_PRIORITY_DYNAMIC)
     {
-        pPipeline = pMaterial->DepthPass[bSkinned];
+        return pMaterial->DepthVelocityPass[instance->GetVertexFormat()];
     }
+    return pMaterial->DepthPass[instance->GetVertexFormat()];
+}
+
+static bool BindMaterialDepthPass(IImmediateContext* immediateCtx, RenderInstance const* instance)
+{
+    int bSkinned = instance->SkeletonSize > 0;
 
+    IPipeline* pPipeline = GetDepthPassPipeline(instance);
     if (!pPipeline)
     {
         return false;
@@ -77,6 +81,52 @@ static bool BindMaterialDepthPass(IImmediateContext* immediateCtx, RenderInstanc
     return true;
 }
 
+static bool RecordDepthPass(CommandList& cmdList, RenderInstance const* instance)
+{
+    IPipeline* pPipeline = GetDepthPassPipeline(instance);
+    if (!pPipeline)
+    {
+        return false;
+    }
+
+    cmdList.BindPipeline(pPipeline);
+
+    if (instance->SkeletonSize > 0)
+    {
+        cmdList.BindVertexBuffer(1, instance->WeightsBuffer, instance->WeightsBufferOffset);
+    }
+    else
+    {
+        cmdList.BindVertexBuffer(1, nullptr, 0);
+    }
+
+    BindVertexAndIndexBuffers(cmdList, instance);
+
+    BindTextures(cmdList, instance->MaterialInstance, instance->Material->DepthPassTextureCount);
+    if (instance->InstanceCount > 1)
+    {
+        BindMeshInstances(cmdList, instance);
+    }
+    else
+    {
+        BindSkeleton(cmdList, instance->SkeletonOffset, instance->SkeletonSize);
+    }
+
+    return true;
+}
+
+static bool RecordDepthPassMotionBlur(CommandList& cmdList, RenderInstance const* instance)
+{
+    if (!RecordDepthPass(cmdList, instance))
+    {
+        return false;
+    }
+
+    BindSkeletonMotionBlur(cmdList, instance->Payload->SkeletonOffsetMB, instance->SkeletonSize);
+
+    return true;
+}
+
 void AddDepthPass( FrameGraph & FrameGraph, FGTextureProxy ** ppDepthTexture, FGTextureProxy ** ppVelocity )
 {
     RenderPass & depthPass = FrameGraph.AddTask< RenderPass >( "Depth Pre-Pass" );
@@ -129,6 +179,11 @@ void AddDepthPass( FrameGraph & FrameGraph, FGTextureProxy ** ppDepthTexture, FG
                                                 sizeof( DrawIndexedIndirectCmd ) );
             }
 
+            if (DrawInstancesDeferred(immediateCtx, GFrameData->Instances.ToPtr() + GRenderView->FirstInstance, GRenderView->InstanceCount, RecordDepthPassMotionBlur))
+            {
+                return;
+            }
+
             DrawIndexedCmd drawCmd;
             drawCmd.InstanceCount = 1;
             drawCmd.StartInstanceLocation = 0;
@@ -136,16 +191,30 @@ void AddDepthPass( FrameGraph & FrameGraph, FGTextureProxy ** ppDepthTexture, FG
             for ( int i = 0 ; i < GRenderView->InstanceCount ; i++ ) {
                 RenderInstance const * instance = GFrameData->Instances[GRenderView->FirstInstance + i];
 
+                // Already drawn by the preceding instanced draw call
+                if (instance->InstanceCount == 0)
+                {
+                    continue;
+                }
+
                 if (!BindMaterialDepthPass(immediateCtx, instance))
                 {
                     continue;
                 }
 
                 BindTextures( instance->MaterialInstance, instance->Material->DepthPassTextureCount );
-                BindSkeleton( instance->SkeletonOffset, instance->SkeletonSize );
-                BindSkeletonMotionBlur( instance->SkeletonOffsetMB, instance->SkeletonSize );
+                if (instance->InstanceCount > 1)
+                {
+                    BindMeshInstances( instance );
+                }
+                else
+                {
+                    BindSkeleton( instance->SkeletonOffset, instance->SkeletonSize );
+                }
+                BindSkeletonMotionBlur( instance->Payload->SkeletonOffsetMB, instance->SkeletonSize );
                 BindInstanceConstants( instance );
 
+                drawCmd.InstanceCount = instance->InstanceCount;
                 drawCmd.IndexCountPerInstance = instance->IndexCount;
                 drawCmd.StartIndexLocation = instance->StartIndexLocation;
                 drawCmd.BaseVertexLocation = instance->BaseVertexLocation;
@@ -184,6 +253,11 @@ void AddDepthPass( FrameGraph & FrameGraph, FGTextureProxy ** ppDepthTexture, FG
                                                 sizeof( DrawIndexedIndirectCmd ) );
             }
 
+            if (DrawInstancesDeferred(immediateCtx, GFrameData->Instances.ToPtr() + GRenderView->FirstInstance, GRenderView->InstanceCount, RecordDepthPass))
+            {
+                return;
+            }
+
             DrawIndexedCmd drawCmd;
             drawCmd.InstanceCount = 1;
             drawCmd.StartInstanceLocation = 0;
@@ -191,15 +265,29 @@ void AddDepthPass( FrameGraph & FrameGraph, FGTextureProxy ** ppDepthTexture, FG
             for ( int i = 0 ; i < GRenderView->InstanceCount ; i++ ) {
                 RenderInstance const * instance = GFrameData->Instances[GRenderView->FirstInstance + i];
 
+                // Already drawn by the preceding instanced draw call
+                if (instance->InstanceCount == 0)
+                {
+                    continue;
+                }
+
                 if (!BindMaterialDepthPass(immediateCtx, instance))
                 {
                     continue;
                 }
 
                 BindTextures( instance->MaterialInstance, instance->Material->DepthPassTextureCount );
-                BindSkeleton( instance->SkeletonOffset, instance->SkeletonSize );
+                if (instance->InstanceCount > 1)
+                {
+                    BindMeshInstances( instance );
+                }
+                else
+                {
+                    BindSkeleton( instance->SkeletonOffset, instance->SkeletonSize );
+                }
                 BindInstanceConstants( instance );
 
+                drawCmd.InstanceCount = instance->InstanceCount;
                 drawCmd.IndexCountPerInstance = instance->IndexCount;
                 drawCmd.StartIndexLocation = instance->StartIndexLocation;
                 drawCmd.BaseVertexLocation = instance->BaseVertexLocation;
@@ -205,7 +205,7 @@ static bool BindMaterialOutlinePass(IImmediateContext* immediateCtx, RenderInsta
 
     int bSkinned = instance->SkeletonSize > 0;
 
-    IPipeline* pPipeline = pMaterial->OutlinePass[bSkinned];
+    IPipeline* pPipeline = pMaterial->OutlinePass[instance->GetVertexFormat()];
     if (!pPipeline)
     {
         return false;
@@ -386,6 +386,89 @@ static const VertexAttribInfo VertexAttribsStaticVertexLight[] = {
      0, // InstanceDataStepRate
      HK_OFS(MeshVertexLight, VertexLight)}};
 
+static const VertexAttribInfo VertexAttribsPacked[] = {
+    {"InPackedPosition",
+     0, // location
+     0, // buffer input slot
+     VAT_USHORT4N,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, Position)},
+    {"InTexCoord",
+     1, // location
+     0, // buffer input slot
+     VAT_HALF2,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, TexCoord)},
+    {"InPackedNormalTangent",
+     2, // location
+     0, // buffer input slot
+     VAT_BYTE4N,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, Normal)}};
+
+static const VertexAttribInfo VertexAttribsPackedLightmap[] = {
+    {"InPackedPosition",
+     0, // location
+     0, // buffer input slot
+     VAT_USHORT4N,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, Position)},
+    {"InTexCoord",
+     1, // location
+     0, // buffer input slot
+     VAT_HALF2,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, TexCoord)},
+    {"InPackedNormalTangent",
+     2, // location
+     0, // buffer input slot
+     VAT_BYTE4N,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, Normal)},
+    {"InLightmapTexCoord",
+     5, // location
+     1, // buffer input slot
+     VAT_FLOAT2,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexUV, TexCoord)}};
+
+static const VertexAttribInfo VertexAttribsPackedVertexLight[] = {
+    {"InPackedPosition",
+     0, // location
+     0, // buffer input slot
+     VAT_USHORT4N,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, Position)},
+    {"InTexCoord",
+     1, // location
+     0, // buffer input slot
+     VAT_HALF2,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, TexCoord)},
+    {"InPackedNormalTangent",
+     2, // location
+     0, // buffer input slot
+     VAT_BYTE4N,
+     VAM_FLOAT,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexPacked, Normal)},
+    {"InVertexLight",
+     5,          // location
+     1,          // buffer input slot
+     VAT_UBYTE4, //VAT_UBYTE4N,
+     VAM_INTEGER,
+     0, // InstanceDataStepRate
+     HK_OFS(MeshVertexLight, VertexLight)}};
+
 static const VertexAttribInfo VertexAttribsTerrain[] = {
     {"InPosition",
      0, // location
@@ -425,7 +508,7 @@ static const VertexAttribInfo VertexAttribsTerrainInstanced[] = {
      1, // InstanceDataStepRate
      HK_OFS(TerrainPatchInstance, QuadColor)}};
 
-void CreateDepthPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, bool _AlphaMasking, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateDepthPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, bool _AlphaMasking, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Packed, bool _Instanced, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -442,7 +525,7 @@ void CreateDepthPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -459,8 +542,8 @@ void CreateDepthPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
     }
 
     String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
@@ -471,6 +554,14 @@ void CreateDepthPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char
     {
         sources.Add("#define SKINNED_MESH\n");
     }
+    if (_Instanced)
+    {
+        sources.Add("#define INSTANCED_MESH\n");
+    }
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -522,15 +613,15 @@ void CreateDepthPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char
     BufferInfo buffers[3];
     buffers[0].BufferBinding = BUFFER_BIND_CONSTANT; // view constants
     buffers[1].BufferBinding = BUFFER_BIND_CONSTANT; // drawcall constants
-    buffers[2].BufferBinding = BUFFER_BIND_CONSTANT; // skeleton
+    buffers[2].BufferBinding = BUFFER_BIND_CONSTANT; // skeleton or mesh instances
 
-    pipelineCI.ResourceLayout.NumBuffers = _Skinned ? 3 : 2;
+    pipelineCI.ResourceLayout.NumBuffers = (_Skinned || _Instanced) ? 3 : 2;
     pipelineCI.ResourceLayout.Buffers = buffers;
 
     GDevice->CreatePipeline(pipelineCI, ppPipeline);
 }
 
-void CreateDepthVelocityPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateDepthVelocityPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Packed, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -544,7 +635,7 @@ void CreateDepthVelocityPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -561,8 +652,8 @@ void CreateDepthVelocityPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
     }
 
     String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
@@ -574,6 +665,10 @@ void CreateDepthVelocityPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     {
         sources.Add("#define SKINNED_MESH\n");
     }
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -638,7 +733,7 @@ void CreateDepthVelocityPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     GDevice->CreatePipeline(pipelineCI, ppPipeline);
 }
 
-void CreateWireframePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateWireframePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Packed, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -656,7 +751,7 @@ void CreateWireframePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -673,8 +768,8 @@ void CreateWireframePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
     }
 
     String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
@@ -685,6 +780,10 @@ void CreateWireframePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const
     {
         sources.Add("#define SKINNED_MESH\n");
     }
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -749,7 +848,7 @@ void CreateWireframePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const
     GDevice->CreatePipeline(pipelineCI, ppPipeline);
 }
 
-void CreateNormalsPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, bool _Skinned, TextureSampler const* Samplers, int NumSamplers)
+void CreateNormalsPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, bool _Skinned, bool _Packed, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -764,7 +863,7 @@ void CreateNormalsPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const ch
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -781,8 +880,8 @@ void CreateNormalsPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const ch
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
     }
 
     String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
@@ -793,6 +892,10 @@ void CreateNormalsPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const ch
     {
         sources.Add("#define SKINNED_MESH\n");
     }
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -862,7 +965,7 @@ static RenderCore::BLENDING_PRESET GetBlendingPreset(BLENDING_MODE _Blending)
     return RenderCore::BLENDING_NO_BLEND;
 }
 
-void CreateLightPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _DepthTest, bool _Translucent, BLENDING_MODE _Blending, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateLightPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Packed, bool _Instanced, bool _DepthTest, bool _Translucent, BLENDING_MODE _Blending, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -896,7 +999,7 @@ void CreateLightPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -927,13 +1030,21 @@ void CreateLightPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
 
         String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
 
         sources.Clear();
         sources.Add("#define MATERIAL_PASS_COLOR\n");
+        if (_Instanced)
+        {
+            sources.Add("#define INSTANCED_MESH\n");
+        }
+        if (_Packed)
+        {
+            sources.Add("#define PACKED_VERTEX\n");
+        }
         sources.Add(vertexAttribsShaderString.CStr());
         sources.Add(_SourceCode);
         ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -1014,7 +1125,7 @@ void CreateLightPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char
     GDevice->CreatePipeline(pipelineCI, ppPipeline);
 }
 
-void CreateLightPassLightmapPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _DepthTest, bool _Translucent, BLENDING_MODE _Blending, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateLightPassLightmapPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Packed, bool _DepthTest, bool _Translucent, BLENDING_MODE _Blending, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -1043,14 +1154,18 @@ void CreateLightPassLightmapPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
 
     dssd.bDepthEnable = _DepthTest;
 
-    pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStaticLightmap);
-    pipelineCI.pVertexAttribs = VertexAttribsStaticLightmap;
+    pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPackedLightmap) : HK_ARRAY_SIZE(VertexAttribsStaticLightmap);
+    pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPackedLightmap : VertexAttribsStaticLightmap;
 
     String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
 
     sources.Clear();
     sources.Add("#define MATERIAL_PASS_COLOR\n");
     sources.Add("#define USE_LIGHTMAP\n");
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -1082,7 +1197,7 @@ void CreateLightPassLightmapPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -1137,7 +1252,7 @@ void CreateLightPassLightmapPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     GDevice->CreatePipeline(pipelineCI, ppPipeline);
 }
 
-void CreateLightPassVertexLightPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _DepthTest, bool _Translucent, BLENDING_MODE _Blending, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateLightPassVertexLightPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Packed, bool _DepthTest, bool _Translucent, BLENDING_MODE _Blending, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -1166,14 +1281,18 @@ void CreateLightPassVertexLightPipeline(TRef<RenderCore::IPipeline>* ppPipeline,
 
     dssd.bDepthEnable = _DepthTest;
 
-    pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStaticVertexLight);
-    pipelineCI.pVertexAttribs = VertexAttribsStaticVertexLight;
+    pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPackedVertexLight) : HK_ARRAY_SIZE(VertexAttribsStaticVertexLight);
+    pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPackedVertexLight : VertexAttribsStaticVertexLight;
 
     String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
 
     sources.Clear();
     sources.Add("#define MATERIAL_PASS_COLOR\n");
     sources.Add("#define USE_VERTEX_LIGHT\n");
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -1205,7 +1324,7 @@ void CreateLightPassVertexLightPipeline(TRef<RenderCore::IPipeline>* ppPipeline,
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -1260,7 +1379,7 @@ void CreateLightPassVertexLightPipeline(TRef<RenderCore::IPipeline>* ppPipeline,
     GDevice->CreatePipeline(pipelineCI, ppPipeline);
 }
 
-void CreateShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, bool _ShadowMasking, bool _TwoSided, bool _Skinned, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, bool _ShadowMasking, bool _TwoSided, bool _Skinned, bool _Packed, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -1288,7 +1407,7 @@ void CreateShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -1305,8 +1424,8 @@ void CreateShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
     }
 
     PipelineInputAssemblyInfo& inputAssembly = pipelineCI.IA;
@@ -1320,6 +1439,10 @@ void CreateShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const
     {
         sources.Add("#define SKINNED_MESH\n");
     }
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -1392,7 +1515,7 @@ void CreateShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const
     GDevice->CreatePipeline(pipelineCI, ppPipeline);
 }
 
-void CreateOmniShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, bool _ShadowMasking, bool _TwoSided, bool _Skinned, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateOmniShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, bool _ShadowMasking, bool _TwoSided, bool _Skinned, bool _Packed, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -1410,7 +1533,7 @@ void CreateOmniShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -1427,8 +1550,8 @@ void CreateOmniShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
     }
 
     PipelineInputAssemblyInfo& inputAssembly = pipelineCI.IA;
@@ -1442,6 +1565,10 @@ void CreateOmniShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
     {
         sources.Add("#define SKINNED_MESH\n");
     }
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -1506,7 +1633,7 @@ void CreateOmniShadowMapPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, co
 }
 
 
-void CreateFeedbackPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, TextureSampler const* Samplers, int NumSamplers)
+void CreateFeedbackPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Packed, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -1525,7 +1652,7 @@ void CreateFeedbackPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const c
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -1556,13 +1683,17 @@ void CreateFeedbackPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const c
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
 
         String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
 
         sources.Clear();
         sources.Add("#define MATERIAL_PASS_FEEDBACK\n");
+        if (_Packed)
+        {
+            sources.Add("#define PACKED_VERTEX\n");
+        }
         sources.Add(vertexAttribsShaderString.CStr());
         sources.Add(_SourceCode);
         ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -1600,7 +1731,7 @@ void CreateFeedbackPassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const c
     GDevice->CreatePipeline(pipelineCI, ppPipeline);
 }
 
-void CreateOutlinePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
+void CreateOutlinePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const char* _SourceCode, RenderCore::POLYGON_CULL _CullMode, bool _Skinned, bool _Packed, bool _Tessellation, TextureSampler const* Samplers, int NumSamplers)
 {
     PipelineDesc pipelineCI;
     ShaderFactory::SourceList sources;
@@ -1622,7 +1753,7 @@ void CreateOutlinePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const ch
     VertexBindingInfo vertexBinding[2] = {};
 
     vertexBinding[0].InputSlot = 0;
-    vertexBinding[0].Stride = sizeof(MeshVertex);
+    vertexBinding[0].Stride = _Packed ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
     vertexBinding[0].InputRate = INPUT_RATE_PER_VERTEX;
 
     vertexBinding[1].InputSlot = 1;
@@ -1639,8 +1770,8 @@ void CreateOutlinePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const ch
     }
     else
     {
-        pipelineCI.NumVertexAttribs = HK_ARRAY_SIZE(VertexAttribsStatic);
-        pipelineCI.pVertexAttribs = VertexAttribsStatic;
+        pipelineCI.NumVertexAttribs = _Packed ? HK_ARRAY_SIZE(VertexAttribsPacked) : HK_ARRAY_SIZE(VertexAttribsStatic);
+        pipelineCI.pVertexAttribs = _Packed ? VertexAttribsPacked : VertexAttribsStatic;
     }
 
     String vertexAttribsShaderString = ShaderStringForVertexAttribs<String>(pipelineCI.pVertexAttribs, pipelineCI.NumVertexAttribs);
@@ -1651,6 +1782,10 @@ void CreateOutlinePassPipeline(TRef<RenderCore::IPipeline>* ppPipeline, const ch
     {
         sources.Add("#define SKINNED_MESH\n");
     }
+    if (_Packed)
+    {
+        sources.Add("#define PACKED_VERTEX\n");
+    }
     sources.Add(vertexAttribsShaderString.CStr());
     sources.Add(_SourceCode);
     ShaderFactory::CreateShader(VERTEX_SHADER, sources, pipelineCI.pVS);
@@ -1932,25 +2067,38 @@ MaterialGPU::MaterialGPU(CompiledMaterial const* pCompiledMaterial)
         case MATERIAL_TYPE_PBR:
         case MATERIAL_TYPE_BASELIGHT:
         case MATERIAL_TYPE_UNLIT: {
-            for (int i = 0; i < 2; i++)
-            {
-                bool bSkinned = !!i;
-
-                CreateDepthPassPipeline(&DepthPass[i], code.CStr(), pCompiledMaterial->bAlphaMasking, cullMode, bSkinned, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->DepthPassTextureCount);
-                CreateDepthVelocityPassPipeline(&DepthVelocityPass[i], code.CStr(), cullMode, bSkinned, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->DepthPassTextureCount);
-                CreateLightPassPipeline(&LightPass[i], code.CStr(), cullMode, bSkinned, pCompiledMaterial->bDepthTest_EXPERIMENTAL, pCompiledMaterial->bTranslucent, pCompiledMaterial->Blending, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount);
-                CreateWireframePassPipeline(&WireframePass[i], code.CStr(), cullMode, bSkinned, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->WireframePassTextureCount);
-                CreateNormalsPassPipeline(&NormalsPass[i], code.CStr(), bSkinned, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->NormalsPassTextureCount);
-                CreateShadowMapPassPipeline(&ShadowPass[i], code.CStr(), pCompiledMaterial->bShadowMapMasking, pCompiledMaterial->bTwoSided, bSkinned, bTessellationShadowMap, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->ShadowMapPassTextureCount);
-                CreateOmniShadowMapPassPipeline(&OmniShadowPass[i], code.CStr(), pCompiledMaterial->bShadowMapMasking, pCompiledMaterial->bTwoSided, bSkinned, bTessellationShadowMap, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->ShadowMapPassTextureCount);
-                CreateFeedbackPassPipeline(&FeedbackPass[i], code.CStr(), cullMode, bSkinned, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount); // FIXME: Add FeedbackPassTextureCount
-                CreateOutlinePassPipeline(&OutlinePass[i], code.CStr(), cullMode, bSkinned, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->DepthPassTextureCount);
-            }
-
-            if (MaterialType != MATERIAL_TYPE_UNLIT)
+            for (int i = 0; i < MESH_VERTEX_FORMAT_COUNT; i++)
             {
-                CreateLightPassLightmapPipeline(&LightPassLightmap, code.CStr(), cullMode, pCompiledMaterial->bDepthTest_EXPERIMENTAL, pCompiledMaterial->bTranslucent, pCompiledMaterial->Blending, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount);
-                CreateLightPassVertexLightPipeline(&LightPassVertexLight, code.CStr(), cullMode, pCompiledMaterial->bDepthTest_EXPERIMENTAL, pCompiledMaterial->bTranslucent, pCompiledMaterial->Blending, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount);
+                bool bSkinned = i == MESH_VERTEX_FORMAT_SKINNED;
+                bool bPacked = i == MESH_VERTEX_FORMAT_PACKED;
+
+                CreateDepthPassPipeline(&DepthPass[i], code.CStr(), pCompiledMaterial->bAlphaMasking, cullMode, bSkinned, bPacked, false, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->DepthPassTextureCount);
+                CreateDepthVelocityPassPipeline(&DepthVelocityPass[i], code.CStr(), cullMode, bSkinned, bPacked, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->DepthPassTextureCount);
+                CreateLightPassPipeline(&LightPass[i], code.CStr(), cullMode, bSkinned, bPacked, false, pCompiledMaterial->bDepthTest_EXPERIMENTAL, pCompiledMaterial->bTranslucent, pCompiledMaterial->Blending, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount);
+                CreateWireframePassPipeline(&WireframePass[i], code.CStr(), cullMode, bSkinned, bPacked, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->WireframePassTextureCount);
+                CreateNormalsPassPipeline(&NormalsPass[i], code.CStr(), bSkinned, bPacked, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->NormalsPassTextureCount);
+                CreateShadowMapPassPipeline(&ShadowPass[i], code.CStr(), pCompiledMaterial->bShadowMapMasking, pCompiledMaterial->bTwoSided, bSkinned, bPacked, bTessellationShadowMap, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->ShadowMapPassTextureCount);
+                CreateOmniShadowMapPassPipeline(&OmniShadowPass[i], code.CStr(), pCompiledMaterial->bShadowMapMasking, pCompiledMaterial->bTwoSided, bSkinned, bPacked, bTessellationShadowMap, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->ShadowMapPassTextureCount);
+                CreateFeedbackPassPipeline(&FeedbackPass[i], code.CStr(), cullMode, bSkinned, bPacked, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount); // FIXME: Add FeedbackPassTextureCount
+                CreateOutlinePassPipeline(&OutlinePass[i], code.CStr(), cullMode, bSkinned, bPacked, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->DepthPassTextureCount);
+
+                if (bSkinned)
+                {
+                    continue;
+                }
+
+                // Automatic instancing is used only for opaque static geometry without tessellation
+                if (!pCompiledMaterial->bTranslucent && !bTessellation)
+                {
+                    CreateDepthPassPipeline(&DepthPassInstanced[i], code.CStr(), pCompiledMaterial->bAlphaMasking, cullMode, false, bPacked, true, false, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->DepthPassTextureCount);
+                    CreateLightPassPipeline(&LightPassInstanced[i], code.CStr(), cullMode, false, bPacked, true, pCompiledMaterial->bDepthTest_EXPERIMENTAL, false, pCompiledMaterial->Blending, false, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount);
+                }
+
+                if (MaterialType != MATERIAL_TYPE_UNLIT)
+                {
+                    CreateLightPassLightmapPipeline(&LightPassLightmap[i], code.CStr(), cullMode, bPacked, pCompiledMaterial->bDepthTest_EXPERIMENTAL, pCompiledMaterial->bTranslucent, pCompiledMaterial->Blending, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount);
+                    CreateLightPassVertexLightPipeline(&LightPassVertexLight[i], code.CStr(), cullMode, bPacked, pCompiledMaterial->bDepthTest_EXPERIMENTAL, pCompiledMaterial->bTranslucent, pCompiledMaterial->Blending, bTessellation, pCompiledMaterial->Samplers.ToPtr(), pCompiledMaterial->LightPassTextureCount);
+                }
             }
             break;
         }
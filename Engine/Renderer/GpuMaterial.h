@@ -56,19 +56,21 @@ public:
 
     using PipelineRef = TRef<RenderCore::IPipeline>;
 
-    // NOTE: 0 - Static geometry, 1 - Skinned geometry
-
-    PipelineRef DepthPass[2];
-    PipelineRef DepthVelocityPass[2];
-    PipelineRef WireframePass[2];
-    PipelineRef NormalsPass[2];
-    PipelineRef LightPass[2];
-    PipelineRef LightPassLightmap;
-    PipelineRef LightPassVertexLight;
-    PipelineRef ShadowPass[2];
-    PipelineRef OmniShadowPass[2];
-    PipelineRef FeedbackPass[2];
-    PipelineRef OutlinePass[2];
+    // NOTE: Pipelines are indexed by MESH_VERTEX_FORMAT. Lightmap, vertex light and instanced passes have no skinned variant.
+
+    PipelineRef DepthPass[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef DepthVelocityPass[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef WireframePass[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef NormalsPass[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef LightPass[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef LightPassLightmap[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef LightPassVertexLight[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef DepthPassInstanced[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef LightPassInstanced[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef ShadowPass[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef OmniShadowPass[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef FeedbackPass[MESH_VERTEX_FORMAT_COUNT];
+    PipelineRef OutlinePass[MESH_VERTEX_FORMAT_COUNT];
     #if 0
     PipelineRef HUDPipeline;
     #endif
@@ -190,27 +190,32 @@ void LightRenderer::CreateLookupBRDF()
     GHunkMemory.ClearLastHunk();
 }
 #endif
-bool LightRenderer::BindMaterialLightPass(IImmediateContext* immediateCtx, RenderInstance const* Instance)
+
+/** Selects the light pass pipeline, the second vertex stream and the lightmap of the instance. Returns false if the material type has no light pass. */
+static bool SelectLightPassPipeline(RenderInstance const* Instance, IPipeline** ppPipeline, IBuffer** ppSecondVertexBuffer, size_t* pSecondBufferOffset, ITexture** ppLightmap)
 {
     MaterialGPU* pMaterial = Instance->Material;
-    IPipeline*    pPipeline;
-    IBuffer*      pSecondVertexBuffer = nullptr;
-    size_t        secondBufferOffset  = 0;
 
     HK_ASSERT(pMaterial);
 
+    MESH_VERTEX_FORMAT vertexFormat = Instance->GetVertexFormat();
+
     bool bSkinned     = Instance->SkeletonSize > 0;
     bool bLightmap    = Instance->LightmapUVChannel != nullptr && Instance->Lightmap;
     bool bVertexLight = Instance->VertexLightChannel != nullptr;
 
+    *ppSecondVertexBuffer = nullptr;
+    *pSecondBufferOffset  = 0;
+    *ppLightmap           = nullptr;
+
     switch (pMaterial->MaterialType)
     {
         case MATERIAL_TYPE_UNLIT:
-            pPipeline = pMaterial->LightPass[bSkinned];
+            *ppPipeline = Instance->InstanceCount > 1 ? pMaterial->LightPassInstanced[vertexFormat] : pMaterial->LightPass[vertexFormat];
             if (bSkinned)
             {
-                pSecondVertexBuffer = Instance->WeightsBuffer;
-                secondBufferOffset  = Instance->WeightsBufferOffset;
+                *ppSecondVertexBuffer = Instance->WeightsBuffer;
+                *pSecondBufferOffset  = Instance->WeightsBufferOffset;
             }
             break;
 
@@ -218,33 +223,30 @@ bool LightRenderer::BindMaterialLightPass(IImmediateContext* immediateCtx, Rende
         case MATERIAL_TYPE_BASELIGHT:
             if (bSkinned)
             {
-                pPipeline = pMaterial->LightPass[1];
+                *ppPipeline = pMaterial->LightPass[MESH_VERTEX_FORMAT_SKINNED];
 
-                pSecondVertexBuffer = Instance->WeightsBuffer;
-                secondBufferOffset  = Instance->WeightsBufferOffset;
+                *ppSecondVertexBuffer = Instance->WeightsBuffer;
+                *pSecondBufferOffset  = Instance->WeightsBufferOffset;
             }
             else if (bLightmap)
             {
-                pPipeline = pMaterial->LightPassLightmap;
+                *ppPipeline = pMaterial->LightPassLightmap[vertexFormat];
 
-                pSecondVertexBuffer = Instance->LightmapUVChannel;
-                secondBufferOffset  = Instance->LightmapUVOffset;
+                *ppSecondVertexBuffer = Instance->LightmapUVChannel;
+                *pSecondBufferOffset  = Instance->LightmapUVOffset;
 
-                // lightmap is in last sample
-                rtbl->BindTexture(pMaterial->LightmapSlot, Instance->Lightmap);
+                *ppLightmap = Instance->Lightmap;
             }
             else if (bVertexLight)
             {
-                pPipeline = pMaterial->LightPassVertexLight;
+                *ppPipeline = pMaterial->LightPassVertexLight[vertexFormat];
 
-                pSecondVertexBuffer = Instance->VertexLightChannel;
-                secondBufferOffset  = Instance->VertexLightOffset;
+                *ppSecondVertexBuffer = Instance->VertexLightChannel;
+                *pSecondBufferOffset  = Instance->VertexLightOffset;
             }
             else
             {
-                pPipeline = pMaterial->LightPass[0];
-
-                pSecondVertexBuffer = nullptr;
+                *ppPipeline = Instance->InstanceCount > 1 ? pMaterial->LightPassInstanced[vertexFormat] : pMaterial->LightPass[vertexFormat];
             }
             break;
 
@@ -252,6 +254,27 @@ bool LightRenderer::BindMaterialLightPass(IImmediateContext* immediateCtx, Rende
             return false;
     }
 
+    return true;
+}
+
+bool LightRenderer::BindMaterialLightPass(IImmediateContext* immediateCtx, RenderInstance const* Instance)
+{
+    IPipeline* pPipeline;
+    IBuffer*   pSecondVertexBuffer;
+    size_t     secondBufferOffset;
+    ITexture*  pLightmap;
+
+    if (!SelectLightPassPipeline(Instance, &pPipeline, &pSecondVertexBuffer, &secondBufferOffset, &pLightmap))
+    {
+        return false;
+    }
+
+    if (pLightmap)
+    {
+        // lightmap is in last sample
+        rtbl->BindTexture(Instance->Material->LightmapSlot, pLightmap);
+    }
+
     immediateCtx->BindPipeline(pPipeline);
     immediateCtx->BindVertexBuffer(1, pSecondVertexBuffer, secondBufferOffset);
 
@@ -275,6 +298,53 @@ bool LightRenderer::BindMaterialLightPass(IImmediateContext* immediateCtx, Rende
     return true;
 }
 
+static bool RecordLightPass(CommandList& cmdList, RenderInstance const* Instance)
+{
+    IPipeline* pPipeline;
+    IBuffer*   pSecondVertexBuffer;
+    size_t     secondBufferOffset;
+    ITexture*  pLightmap;
+
+    if (!SelectLightPassPipeline(Instance, &pPipeline, &pSecondVertexBuffer, &secondBufferOffset, &pLightmap))
+    {
+        return false;
+    }
+
+    if (pLightmap)
+    {
+        cmdList.BindTexture(Instance->Material->LightmapSlot, pLightmap);
+    }
+
+    cmdList.BindPipeline(pPipeline);
+    cmdList.BindVertexBuffer(1, pSecondVertexBuffer, secondBufferOffset);
+
+    BindVertexAndIndexBuffers(cmdList, Instance);
+
+    {
+        VirtualTexture* pVirtualTex = GFeedbackAnalyzerVT->GetTexture(0);
+
+        if (GPhysCacheVT)
+            cmdList.BindTexture(6, GPhysCacheVT->GetLayers()[0]);
+
+        if (pVirtualTex)
+        {
+            cmdList.BindTexture(7, pVirtualTex->GetIndirectionTexture());
+        }
+    }
+
+    BindTextures(cmdList, Instance->MaterialInstance, Instance->Material->LightPassTextureCount);
+    if (Instance->InstanceCount > 1)
+    {
+        BindMeshInstances(cmdList, Instance);
+    }
+    else
+    {
+        BindSkeleton(cmdList, Instance->SkeletonOffset, Instance->SkeletonSize);
+    }
+
+    return true;
+}
+
 void LightRenderer::AddPass(FrameGraph&     FrameGraph,
                              FGTextureProxy*  DepthTarget,
                              FGTextureProxy*  SSAOTexture,
@@ -408,6 +478,11 @@ void LightRenderer::AddPass(FrameGraph&     FrameGraph,
                                                                          sizeof(DrawIndexedIndirectCmd));
                               }
 
+                              if (DrawInstancesDeferred(immediateCtx, GFrameData->Instances.ToPtr() + GRenderView->FirstInstance, GRenderView->InstanceCount, RecordLightPass))
+                              {
+                                  return;
+                              }
+
                               DrawIndexedCmd drawCmd;
                               drawCmd.InstanceCount         = 1;
                               drawCmd.StartInstanceLocation = 0;
@@ -416,15 +491,29 @@ void LightRenderer::AddPass(FrameGraph&     FrameGraph,
                               {
                                   RenderInstance const* instance = GFrameData->Instances[GRenderView->FirstInstance + i];
 
+                                  // Already drawn by the preceding instanced draw call
+                                  if (instance->InstanceCount == 0)
+                                  {
+                                      continue;
+                                  }
+
                                   if (!BindMaterialLightPass(immediateCtx, instance))
                                   {
                                       continue;
                                   }
 
                                   BindTextures(instance->MaterialInstance, instance->Material->LightPassTextureCount);
-                                  BindSkeleton(instance->SkeletonOffset, instance->SkeletonSize);
+                                  if (instance->InstanceCount > 1)
+                                  {
+                                      BindMeshInstances(instance);
+                                  }
+                                  else
+                                  {
+                                      BindSkeleton(instance->SkeletonOffset, instance->SkeletonSize);
+                                  }
                                   BindInstanceConstants(instance);
 
+                                  drawCmd.InstanceCount         = instance->InstanceCount;
                                   drawCmd.IndexCountPerInstance = instance->IndexCount;
                                   drawCmd.StartIndexLocation    = instance->StartIndexLocation;
                                   drawCmd.BaseVertexLocation    = instance->BaseVertexLocation;
@@ -506,6 +595,11 @@ void LightRenderer::AddPass(FrameGraph&     FrameGraph,
                                        rtbl->BindTexture(18, ShadowMapDepth3->Actual());
                                        rtbl->BindTexture(19, OmnidirectionalShadowMapArray->Actual());
 
+                                       if (DrawInstancesDeferred(immediateCtx, GFrameData->TranslucentInstances.ToPtr() + GRenderView->FirstTranslucentInstance, GRenderView->TranslucentInstanceCount, RecordLightPass))
+                                       {
+                                           return;
+                                       }
+
                                        for (int i = 0; i < GRenderView->TranslucentInstanceCount; i++)
                                        {
                                            RenderInstance const* instance = GFrameData->TranslucentInstances[GRenderView->FirstTranslucentInstance + i];
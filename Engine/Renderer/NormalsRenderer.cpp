@@ -43,7 +43,7 @@ static bool BindMaterialNormalPass(IImmediateContext* immediateCtx, RenderInstan
 
     int bSkinned = instance->SkeletonSize > 0;
 
-    IPipeline* pPipeline = pMaterial->NormalsPass[bSkinned];
+    IPipeline* pPipeline = pMaterial->NormalsPass[instance->GetVertexFormat()];
     if (!pPipeline)
     {
         return false;
@@ -53,6 +53,8 @@ HK_NAMESPACE_BEGIN
 using namespace RenderCore;
 
 ConsoleVar r_FrameGraphDebug("r_FrameGraphDebug"s, "0"s);
+ConsoleVar r_RenderTargetLifetime("r_RenderTargetLifetime"s, "120"s, 0, "Number of frames an unused render target is kept in the cache"s);
+ConsoleVar r_FrameGraphCache("r_FrameGraphCache"s, "1"s, 0, "Reuse compiled frame graph timelines when topology does not change"s);
 ConsoleVar r_RenderSnapshot("r_RenderSnapshot"s, "0"s, CVAR_CHEAT);
 ConsoleVar r_DebugRenderMode("r_DebugRenderMode"s, "0"s, CVAR_CHEAT);
 ConsoleVar r_BloomScale("r_BloomScale"s, "1"s);
@@ -84,13 +86,14 @@ TRef<RenderCore::IPipeline> CreateTerrainMaterialDepth();
 TRef<RenderCore::IPipeline> CreateTerrainMaterialLight();
 TRef<RenderCore::IPipeline> CreateTerrainMaterialWireframe();
 
-RenderBackend::RenderBackend(RenderCore::IDevice* pDevice)
+RenderBackend::RenderBackend(RenderCore::IDevice* pDevice, AsyncJobList* pJobList)
 {
     LOG("Initializing render backend...\n");
 
     GDevice = pDevice;
     rcmd = GDevice->GetImmediateContext();
     rtbl = rcmd->GetRootResourceTable();
+    GRenderJobList = pJobList;
 
     m_FrameGraph = MakeRef<FrameGraph>(GDevice);
 
@@ -311,6 +314,7 @@ RenderBackend::~RenderBackend()
     //LOG( "VT ref count {}\n", vt->GetRefCount() );
 
     GCircularBuffer.Reset();
+    GRenderJobList = nullptr;
     GWhiteTexture.Reset();
     GLookupBRDF.Reset();
     GSphereMesh.Reset();
@@ -433,6 +437,8 @@ void RenderBackend::RenderFrame(StreamedMemoryGPU* StreamedMemory, ITexture* pBa
 
     GFrameData = pFrameData;
 
+    m_FrameGraph->SetCacheEnabled(r_FrameGraphCache);
+
     //FrameGraph->Clear();
 
     //rcmd->SetSwapChainResolution( GFrameData->CanvasWidth, GFrameData->CanvasHeight );
@@ -473,6 +479,8 @@ void RenderBackend::RenderFrame(StreamedMemoryGPU* StreamedMemory, ITexture* pBa
 
     m_FrameGraph->Clear();
 
+    m_FrameGraph->GetRenderTargetCache()->CleanupUnusedTextures(Math::Max(0, r_RenderTargetLifetime.GetInteger()));
+
     m_FeedbackAnalyzerVT->End();
 
     if (r_ShowGPUTime)
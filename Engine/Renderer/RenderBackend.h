@@ -46,7 +46,7 @@ HK_NAMESPACE_BEGIN
 class RenderBackend : public RefCounted
 {
 public:
-    RenderBackend(RenderCore::IDevice* pDevice);
+    RenderBackend(RenderCore::IDevice* pDevice, class AsyncJobList* pJobList = nullptr);
     ~RenderBackend();
 
     void GenerateIrradianceMap(RenderCore::ITexture* pCubemap, TRef<RenderCore::ITexture>* ppTexture);
@@ -63,6 +63,8 @@ public:
 
     int MaxOmnidirectionalShadowMapsPerView() const;
 
+    RenderCore::FrameGraph* GetFrameGraph() { return m_FrameGraph; }
+
 private:
     void RenderView(int ViewportIndex, RenderViewData* pRenderView);
     void SetViewConstants(int ViewportIndex);
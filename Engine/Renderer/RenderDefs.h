@@ -48,6 +48,9 @@ HK_NAMESPACE_BEGIN
 /** Max skeleton joints */
 constexpr int MAX_SKINNED_MESH_JOINTS = 256;
 
+/** Max instances per automatically instanced draw call. Must match MAX_MESH_INSTANCES in instance_uniforms.glsl */
+constexpr int MAX_MESH_INSTANCES = 64;
+
 /** Max textures per material */
 constexpr int MAX_MATERIAL_TEXTURES = 11; // Reserved texture slots for AOLookup, ClusterItemTBO, ClusterLookup, ShadowMapShadow, Lightmap
 
@@ -247,6 +250,21 @@ enum RENDERING_PRIORITY : uint8_t
     RENDERING_PRIORITY_SKYBOX = 15 << 4,
 };
 
+/** Vertex format of mesh geometry. Selects the pipeline variant of a material. */
+enum MESH_VERTEX_FORMAT : uint8_t
+{
+    /** MeshVertex */
+    MESH_VERTEX_FORMAT_STATIC,
+
+    /** MeshVertex + MeshVertexSkin */
+    MESH_VERTEX_FORMAT_SKINNED,
+
+    /** MeshVertexPacked */
+    MESH_VERTEX_FORMAT_PACKED,
+
+    MESH_VERTEX_FORMAT_COUNT
+};
+
 /** Rendering priorities for geometry. RENDERING_PRIORITY is mixed with RENDERING_GEOMETRY_PRIORITY. */
 enum RENDERING_GEOMETRY_PRIORITY : uint8_t
 {
@@ -472,6 +490,7 @@ class MaterialGPU;
 struct MaterialFrameData
 {
     MaterialGPU*                   Material;
+    uint64_t                       MaterialInstanceId; // Stable id of the material instance, used for draw call ordering
     RenderCore::ITexture*          Textures[MAX_MATERIAL_TEXTURES];
     int                            NumTextures;
     Float4                         UniformVectors[4];
@@ -710,6 +729,24 @@ struct DirectionalLightInstance
 };
 
 
+/**
+
+Render instance payload. Per-draw data that is only read when the draw call constants are written.
+Kept apart from RenderInstance so that sorting and batching touch fewer cache lines.
+
+*/
+struct RenderInstancePayload
+{
+    Float4x4 Matrix;
+    Float4x4 MatrixP;
+
+    Float3x3 ModelNormalToViewSpace;
+
+    Float4 LightmapOffset;
+
+    size_t SkeletonOffsetMB;
+};
+
 /**
 
 Render instance (opaque & translucent meshes)
@@ -717,6 +754,8 @@ Render instance (opaque & translucent meshes)
 */
 struct RenderInstance
 {
+    uint64_t SortKey;
+
     MaterialGPU*       Material;
     MaterialFrameData* MaterialInstance;
 
@@ -726,6 +765,18 @@ struct RenderInstance
     RenderCore::IBuffer* IndexBuffer;
     size_t               IndexBufferOffset;
 
+    unsigned int IndexCount;
+    unsigned int StartIndexLocation;
+    int          BaseVertexLocation;
+
+    RenderCore::INDEX_TYPE IndexType;
+
+    /** Automatic instancing: 0 - drawn by a preceding instance, 1 - regular draw, >1 - instanced draw */
+    unsigned int InstanceCount;
+
+    /** Per-instance transforms (MeshInstanceData) for instanced draw */
+    size_t InstanceDataStreamHandle;
+
     RenderCore::IBuffer* WeightsBuffer;
     size_t               WeightsBufferOffset;
 
@@ -736,22 +787,19 @@ struct RenderInstance
     size_t               LightmapUVOffset;
 
     RenderCore::ITexture* Lightmap;
-    Float4                LightmapOffset;
-
-    Float4x4 Matrix;
-    Float4x4 MatrixP;
-
-    Float3x3 ModelNormalToViewSpace;
 
     size_t SkeletonOffset;
-    size_t SkeletonOffsetMB;
     size_t SkeletonSize;
 
-    unsigned int IndexCount;
-    unsigned int StartIndexLocation;
-    int          BaseVertexLocation;
+    /** Dequantization of packed vertex positions. Null for regular vertices. */
+    VertexQuantization const* PackedVertices;
 
-    uint64_t SortKey;
+    RenderInstancePayload* Payload;
+
+    MESH_VERTEX_FORMAT GetVertexFormat() const
+    {
+        return SkeletonSize > 0 ? MESH_VERTEX_FORMAT_SKINNED : (PackedVertices ? MESH_VERTEX_FORMAT_PACKED : MESH_VERTEX_FORMAT_STATIC);
+    }
 
     uint8_t GetRenderingPriority() const
     {
@@ -764,12 +812,25 @@ struct RenderInstance
     }
 
     void GenerateSortKey(uint8_t Priority, uint64_t Mesh)
+    {
+        GenerateSortKey(Priority, (uint64_t)MaterialInstance, Mesh);
+    }
+
+    void GenerateSortKey(uint8_t Priority, uint64_t MaterialInstanceId, uint64_t Mesh)
     {
         // NOTE: 8 bits are still unused. We can use it in future.
-        SortKey = ((uint64_t)(Priority) << 56u) | ((uint64_t)(HashTraits::Murmur3Hash64((uint64_t)Material) & 0xffffu) << 40u) | ((uint64_t)(HashTraits::Murmur3Hash64((uint64_t)MaterialInstance) & 0xffffu) << 24u) | ((uint64_t)(HashTraits::Murmur3Hash64(Mesh) & 0xffffu) << 8u);
+        SortKey = ((uint64_t)(Priority) << 56u) | ((uint64_t)(HashTraits::Murmur3Hash64((uint64_t)Material) & 0xffffu) << 40u) | ((uint64_t)(HashTraits::Murmur3Hash64(MaterialInstanceId) & 0xffffu) << 24u) | ((uint64_t)(HashTraits::Murmur3Hash64(Mesh) & 0xffffu) << 8u);
     }
 };
 
+/** Per-instance data of automatically instanced draw call. Matches MeshInstance in instance_uniforms.glsl */
+struct MeshInstanceData
+{
+    Float4x4 TransformMatrix;
+    Float4x4 TransformMatrixP;
+    Float3x4 ModelNormalToViewSpace;
+};
+
 
 /**
 
@@ -789,12 +850,19 @@ struct ShadowRenderInstance
     Float3x4             WorldTransformMatrix;
     size_t               SkeletonOffset;
     size_t               SkeletonSize;
+    VertexQuantization const* PackedVertices; // Dequantization of packed vertex positions. Null for regular vertices.
     unsigned int         IndexCount;
     unsigned int         StartIndexLocation;
     int                  BaseVertexLocation;
+    RenderCore::INDEX_TYPE IndexType;
     uint16_t             CascadeMask; // Cascade mask for directional lights or face index for point/spot lights
     uint64_t             SortKey;
 
+    MESH_VERTEX_FORMAT GetVertexFormat() const
+    {
+        return SkeletonSize > 0 ? MESH_VERTEX_FORMAT_SKINNED : (PackedVertices ? MESH_VERTEX_FORMAT_PACKED : MESH_VERTEX_FORMAT_STATIC);
+    }
+
     void GenerateSortKey(uint8_t Priority, uint64_t Mesh)
     {
         // NOTE: 8 bits are still unused. We can use it in future.
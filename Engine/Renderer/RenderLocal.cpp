@@ -32,6 +32,7 @@ SOFTWARE.
 
 #include <Engine/Core/Platform/Platform.h>
 #include <Engine/Runtime/EmbeddedResources.h>
+#include <Engine/Runtime/AsyncJobManager.h>
 
 HK_NAMESPACE_BEGIN
 
@@ -63,6 +64,9 @@ StreamedMemoryGPU* GStreamedMemory;
 Don't use to store long-live data. */
 TRef<CircularBuffer> GCircularBuffer;
 
+/** Job list to record deferred command lists on worker threads. Can be null. */
+AsyncJobList* GRenderJobList;
+
 /** Sphere mesh */
 TRef<SphereMesh> GSphereMesh;
 
@@ -93,6 +97,24 @@ IPipeline* GTerrainDepthPipeline;
 IPipeline* GTerrainLightPipeline;
 IPipeline* GTerrainWireframePipeline;
 
+ConsoleVar r_DeferredInstanceCommands("r_DeferredInstanceCommands"s, "1"s, 0, "Record depth and light pass commands on worker threads"s);
+
+static constexpr int MIN_INSTANCES_PER_JOB = 64;
+static constexpr int MAX_INSTANCE_JOBS     = 8;
+
+struct InstanceDrawJob
+{
+    CommandList*                   pCommandList;
+    RenderInstance const* const*   Instances;
+    int                            InstanceCount;
+    size_t                         ConstantBufferOffset;
+    size_t                         ConstantBufferStride;
+    RecordInstanceBindingsCallback RecordBindings;
+};
+
+static TVector<CommandList>     InstanceCommandLists;
+static TVector<InstanceDrawJob> InstanceDrawJobs;
+
 TextureResolution2D GetFrameResoultion()
 {
     return TextureResolution2D(GRenderView->Width, GRenderView->Height);
@@ -144,16 +166,28 @@ void BindTextures(MaterialFrameData* Instance, int MaxTextures)
     }
 }
 
+void BindTextures(CommandList& CmdList, MaterialFrameData* Instance, int MaxTextures)
+{
+    HK_ASSERT(Instance);
+
+    int n = Math::Min(Instance->NumTextures, MaxTextures);
+
+    for (int t = 0; t < n; t++)
+    {
+        CmdList.BindTexture(t, Instance->Textures[t]);
+    }
+}
+
 void BindVertexAndIndexBuffers(IImmediateContext* immediateCtx, RenderInstance const* Instance)
 {
     immediateCtx->BindVertexBuffer(0, Instance->VertexBuffer, Instance->VertexBufferOffset);
-    immediateCtx->BindIndexBuffer(Instance->IndexBuffer, INDEX_TYPE_UINT32, Instance->IndexBufferOffset);
+    immediateCtx->BindIndexBuffer(Instance->IndexBuffer, Instance->IndexType, Instance->IndexBufferOffset);
 }
 
 void BindVertexAndIndexBuffers(IImmediateContext* immediateCtx, ShadowRenderInstance const* Instance)
 {
     immediateCtx->BindVertexBuffer(0, Instance->VertexBuffer, Instance->VertexBufferOffset);
-    immediateCtx->BindIndexBuffer(Instance->IndexBuffer, INDEX_TYPE_UINT32, Instance->IndexBufferOffset);
+    immediateCtx->BindIndexBuffer(Instance->IndexBuffer, Instance->IndexType, Instance->IndexBufferOffset);
 }
 
 void BindVertexAndIndexBuffers(IImmediateContext* immediateCtx, LightPortalRenderInstance const* Instance)
@@ -162,26 +196,70 @@ void BindVertexAndIndexBuffers(IImmediateContext* immediateCtx, LightPortalRende
     immediateCtx->BindIndexBuffer(Instance->IndexBuffer, INDEX_TYPE_UINT32, Instance->IndexBufferOffset);
 }
 
+void BindVertexAndIndexBuffers(CommandList& CmdList, RenderInstance const* Instance)
+{
+    CmdList.BindVertexBuffer(0, Instance->VertexBuffer, Instance->VertexBufferOffset);
+    CmdList.BindIndexBuffer(Instance->IndexBuffer, Instance->IndexType, Instance->IndexBufferOffset);
+}
+
+void BindVertexAndIndexBuffers(CommandList& CmdList, ShadowRenderInstance const* Instance)
+{
+    CmdList.BindVertexBuffer(0, Instance->VertexBuffer, Instance->VertexBufferOffset);
+    CmdList.BindIndexBuffer(Instance->IndexBuffer, Instance->IndexType, Instance->IndexBufferOffset);
+}
+
 void BindSkeleton(size_t _Offset, size_t _Size)
 {
     rtbl->BindBuffer(2, GStreamBuffer, _Offset, _Size);
 }
 
+void BindSkeleton(CommandList& CmdList, size_t _Offset, size_t _Size)
+{
+    CmdList.BindBuffer(2, GStreamBuffer, _Offset, _Size);
+}
+
 void BindSkeletonMotionBlur(size_t _Offset, size_t _Size)
 {
     rtbl->BindBuffer(7, GStreamBuffer, _Offset, _Size);
 }
 
-void BindInstanceConstants(RenderInstance const* Instance)
+void BindSkeletonMotionBlur(CommandList& CmdList, size_t _Offset, size_t _Size)
 {
-    size_t offset = GCircularBuffer->Allocate(sizeof(InstanceConstantBuffer));
+    CmdList.BindBuffer(7, GStreamBuffer, _Offset, _Size);
+}
 
-    InstanceConstantBuffer* pConstantBuf = reinterpret_cast<InstanceConstantBuffer*>(GCircularBuffer->GetMappedMemory() + offset);
+void BindMeshInstances(RenderInstance const* Instance)
+{
+    rtbl->BindBuffer(2, GStreamBuffer, Instance->InstanceDataStreamHandle, sizeof(MeshInstanceData) * Instance->InstanceCount);
+}
 
-    Platform::Memcpy(&pConstantBuf->TransformMatrix, &Instance->Matrix, sizeof(pConstantBuf->TransformMatrix));
-    Platform::Memcpy(&pConstantBuf->TransformMatrixP, &Instance->MatrixP, sizeof(pConstantBuf->TransformMatrixP));
-    StoreFloat3x3AsFloat3x4Transposed(Instance->ModelNormalToViewSpace, pConstantBuf->ModelNormalToViewSpace);
-    Platform::Memcpy(&pConstantBuf->LightmapOffset, &Instance->LightmapOffset, sizeof(pConstantBuf->LightmapOffset));
+void BindMeshInstances(CommandList& CmdList, RenderInstance const* Instance)
+{
+    CmdList.BindBuffer(2, GStreamBuffer, Instance->InstanceDataStreamHandle, sizeof(MeshInstanceData) * Instance->InstanceCount);
+}
+
+static void StorePackedPositionConstants(VertexQuantization const* Quantization, Float4& Scale, Float4& Bias)
+{
+    if (Quantization)
+    {
+        Scale = Float4(Quantization->Scale, 0.0f);
+        Bias  = Float4(Quantization->Bias, 0.0f);
+    }
+    else
+    {
+        Scale = Float4(1.0f);
+        Bias  = Float4(0.0f);
+    }
+}
+
+void StoreInstanceConstants(RenderInstance const* Instance, InstanceConstantBuffer* pConstantBuf)
+{
+    RenderInstancePayload const* payload = Instance->Payload;
+
+    Platform::Memcpy(&pConstantBuf->TransformMatrix, &payload->Matrix, sizeof(pConstantBuf->TransformMatrix));
+    Platform::Memcpy(&pConstantBuf->TransformMatrixP, &payload->MatrixP, sizeof(pConstantBuf->TransformMatrixP));
+    StoreFloat3x3AsFloat3x4Transposed(payload->ModelNormalToViewSpace, pConstantBuf->ModelNormalToViewSpace);
+    Platform::Memcpy(&pConstantBuf->LightmapOffset, &payload->LightmapOffset, sizeof(pConstantBuf->LightmapOffset));
     Platform::Memcpy(&pConstantBuf->uaddr_0, Instance->MaterialInstance->UniformVectors, sizeof(Float4) * Instance->MaterialInstance->NumUniformVectors);
 
     // TODO:
@@ -189,6 +267,15 @@ void BindInstanceConstants(RenderInstance const* Instance)
     pConstantBuf->VTScale  = Float2(1.0f); //Instance->VTScale;
     pConstantBuf->VTUnit   = 0;            //Instance->VTUnit;
 
+    StorePackedPositionConstants(Instance->PackedVertices, pConstantBuf->PackedPositionScale, pConstantBuf->PackedPositionBias);
+}
+
+void BindInstanceConstants(RenderInstance const* Instance)
+{
+    size_t offset = GCircularBuffer->Allocate(sizeof(InstanceConstantBuffer));
+
+    StoreInstanceConstants(Instance, reinterpret_cast<InstanceConstantBuffer*>(GCircularBuffer->GetMappedMemory() + offset));
+
     rtbl->BindBuffer(1, GCircularBuffer->GetBuffer(), offset, sizeof(InstanceConstantBuffer));
 }
 
@@ -198,22 +285,115 @@ void BindInstanceConstantsFB(RenderInstance const* Instance)
 
     FeedbackConstantBuffer* pConstantBuf = reinterpret_cast<FeedbackConstantBuffer*>(GCircularBuffer->GetMappedMemory() + offset);
 
-    Platform::Memcpy(&pConstantBuf->TransformMatrix, &Instance->Matrix, sizeof(pConstantBuf->TransformMatrix));
+    Platform::Memcpy(&pConstantBuf->TransformMatrix, &Instance->Payload->Matrix, sizeof(pConstantBuf->TransformMatrix));
 
     // TODO:
     pConstantBuf->VTOffset = Float2(0.0f); //Instance->VTOffset;
     pConstantBuf->VTScale  = Float2(1.0f); //Instance->VTScale;
     pConstantBuf->VTUnit   = 0;            //Instance->VTUnit;
 
+    StorePackedPositionConstants(Instance->PackedVertices, pConstantBuf->PackedPositionScale, pConstantBuf->PackedPositionBias);
+
     rtbl->BindBuffer(1, GCircularBuffer->GetBuffer(), offset, sizeof(FeedbackConstantBuffer));
 }
 
-void BindShadowInstanceConstants(ShadowRenderInstance const* Instance)
+static void RecordInstancesJob(void* pData)
 {
-    size_t offset = GCircularBuffer->Allocate(sizeof(ShadowInstanceConstantBuffer));
+    InstanceDrawJob* job = static_cast<InstanceDrawJob*>(pData);
 
-    ShadowInstanceConstantBuffer* pConstantBuf = reinterpret_cast<ShadowInstanceConstantBuffer*>(GCircularBuffer->GetMappedMemory() + offset);
+    CommandList& cmdList = *job->pCommandList;
+    cmdList.Reset();
+
+    byte*    pMappedMemory   = GCircularBuffer->GetMappedMemory();
+    IBuffer* pConstantBuffer = GCircularBuffer->GetBuffer();
+
+    DrawIndexedCmd drawCmd;
+    drawCmd.StartInstanceLocation = 0;
+
+    for (int i = 0; i < job->InstanceCount; i++)
+    {
+        RenderInstance const* instance = job->Instances[i];
+
+        // Already drawn by the preceding instanced draw call
+        if (instance->InstanceCount == 0)
+        {
+            continue;
+        }
+
+        if (!job->RecordBindings(cmdList, instance))
+        {
+            continue;
+        }
+
+        size_t offset = job->ConstantBufferOffset + i * job->ConstantBufferStride;
+        StoreInstanceConstants(instance, reinterpret_cast<InstanceConstantBuffer*>(pMappedMemory + offset));
+        cmdList.BindBuffer(1, pConstantBuffer, offset, sizeof(InstanceConstantBuffer));
+
+        drawCmd.InstanceCount         = instance->InstanceCount;
+        drawCmd.IndexCountPerInstance = instance->IndexCount;
+        drawCmd.StartIndexLocation    = instance->StartIndexLocation;
+        drawCmd.BaseVertexLocation    = instance->BaseVertexLocation;
+
+        cmdList.Draw(&drawCmd);
+    }
+}
+
+bool DrawInstancesDeferred(IImmediateContext* immediateCtx, RenderInstance const* const* Instances, int InstanceCount, RecordInstanceBindingsCallback RecordBindings)
+{
+    if (!r_DeferredInstanceCommands || !GRenderJobList || InstanceCount < MIN_INSTANCES_PER_JOB * 2)
+    {
+        return false;
+    }
+
+    // Same constraints as for shadow casters: the circular buffer is not thread safe, and the block
+    // must not be split by a buffer swap before the commands are replayed.
+    size_t constantBufferStride = Align(sizeof(InstanceConstantBuffer), GCircularBuffer->GetAlignment());
+    size_t constantBufferSize   = constantBufferStride * InstanceCount;
+    if (constantBufferSize > GCircularBuffer->GetBufferSize())
+    {
+        return false;
+    }
+
+    size_t constantBufferOffset = GCircularBuffer->Allocate(constantBufferSize);
+
+    int numJobs         = Math::Min(InstanceCount / MIN_INSTANCES_PER_JOB, MAX_INSTANCE_JOBS);
+    int instancesPerJob = (InstanceCount + numJobs - 1) / numJobs;
 
+    numJobs = (InstanceCount + instancesPerJob - 1) / instancesPerJob;
+
+    if (InstanceCommandLists.Size() < numJobs)
+    {
+        InstanceCommandLists.Resize(numJobs);
+    }
+    InstanceDrawJobs.Resize(numJobs);
+
+    for (int i = 0; i < numJobs; i++)
+    {
+        int firstInstance = i * instancesPerJob;
+
+        InstanceDrawJob& job     = InstanceDrawJobs[i];
+        job.pCommandList         = &InstanceCommandLists[i];
+        job.Instances            = Instances + firstInstance;
+        job.InstanceCount        = Math::Min(instancesPerJob, InstanceCount - firstInstance);
+        job.ConstantBufferOffset = constantBufferOffset + firstInstance * constantBufferStride;
+        job.ConstantBufferStride = constantBufferStride;
+        job.RecordBindings       = RecordBindings;
+
+        GRenderJobList->AddJob(RecordInstancesJob, &job);
+    }
+
+    GRenderJobList->SubmitAndWait();
+
+    for (int i = 0; i < numJobs; i++)
+    {
+        immediateCtx->ExecuteCommandList(InstanceCommandLists[i]);
+    }
+
+    return true;
+}
+
+void StoreShadowInstanceConstants(ShadowRenderInstance const* Instance, ShadowInstanceConstantBuffer* pConstantBuf)
+{
     StoreFloat3x4AsFloat4x4Transposed(Instance->WorldTransformMatrix, pConstantBuf->TransformMatrix);
 
     if (Instance->MaterialInstance)
@@ -223,6 +403,15 @@ void BindShadowInstanceConstants(ShadowRenderInstance const* Instance)
 
     pConstantBuf->CascadeMask = Instance->CascadeMask;
 
+    StorePackedPositionConstants(Instance->PackedVertices, pConstantBuf->PackedPositionScale, pConstantBuf->PackedPositionBias);
+}
+
+void BindShadowInstanceConstants(ShadowRenderInstance const* Instance)
+{
+    size_t offset = GCircularBuffer->Allocate(sizeof(ShadowInstanceConstantBuffer));
+
+    StoreShadowInstanceConstants(Instance, reinterpret_cast<ShadowInstanceConstantBuffer*>(GCircularBuffer->GetMappedMemory() + offset));
+
     rtbl->BindBuffer(1, GCircularBuffer->GetBuffer(), offset, sizeof(ShadowInstanceConstantBuffer));
 }
 
@@ -247,6 +436,8 @@ void BindShadowInstanceConstants(ShadowRenderInstance const* Instance, int FaceI
 
     pConstantBuf->CascadeMask = Instance->CascadeMask;
 
+    StorePackedPositionConstants(Instance->PackedVertices, pConstantBuf->PackedPositionScale, pConstantBuf->PackedPositionBias);
+
     rtbl->BindBuffer(1, GCircularBuffer->GetBuffer(), offset, sizeof(ShadowInstanceConstantBuffer));
 }
 
@@ -32,6 +32,8 @@ SOFTWARE.
 
 #include <Engine/Core/ConsoleVar.h>
 
+#include <Engine/RenderCore/CommandList.h>
+
 #include "GpuMaterial.h"
 #include "RenderBackend.h"
 #include "CircularBuffer.h"
@@ -137,6 +139,8 @@ struct InstanceConstantBuffer
     uint32_t Pad0;
     uint32_t Pad1;
     uint32_t Pad2;
+    Float4   PackedPositionScale; // Dequantization of packed vertex positions
+    Float4   PackedPositionBias;
 };
 
 struct FeedbackConstantBuffer
@@ -146,6 +150,8 @@ struct FeedbackConstantBuffer
     Float2   VTScale;
     uint32_t VTUnit;
     uint32_t Pad[3];
+    Float4   PackedPositionScale;
+    Float4   PackedPositionBias;
 };
 
 struct ShadowInstanceConstantBuffer
@@ -160,6 +166,8 @@ struct ShadowInstanceConstantBuffer
     Float4   uaddr_3;
     uint32_t CascadeMask;
     uint32_t Pad[3];
+    Float4   PackedPositionScale;
+    Float4   PackedPositionBias;
 };
 
 struct TerrainInstanceConstantBuffer
@@ -211,6 +219,9 @@ extern StreamedMemoryGPU*  GStreamedMemory;
 Don't use to store long-live data. */
 extern TRef<CircularBuffer> GCircularBuffer;
 
+/** Job list to record deferred command lists on worker threads. Can be null. */
+extern class AsyncJobList* GRenderJobList;
+
 /** Sphere mesh */
 extern TRef<SphereMesh> GSphereMesh;
 
@@ -264,16 +275,38 @@ void BindVertexAndIndexBuffers(RenderCore::IImmediateContext* immediateCtx, Shad
 
 void BindVertexAndIndexBuffers(RenderCore::IImmediateContext* immediateCtx, LightPortalRenderInstance const* Instance);
 
+void BindVertexAndIndexBuffers(RenderCore::CommandList& CmdList, RenderInstance const* Instance);
+
+void BindVertexAndIndexBuffers(RenderCore::CommandList& CmdList, ShadowRenderInstance const* Instance);
+
 void BindSkeleton(size_t _Offset, size_t _Size);
+void BindSkeleton(RenderCore::CommandList& CmdList, size_t _Offset, size_t _Size);
 void BindSkeletonMotionBlur(size_t _Offset, size_t _Size);
+void BindSkeletonMotionBlur(RenderCore::CommandList& CmdList, size_t _Offset, size_t _Size);
+void BindMeshInstances(RenderInstance const* Instance);
+void BindMeshInstances(RenderCore::CommandList& CmdList, RenderInstance const* Instance);
 
 void BindTextures(RenderCore::IResourceTable* Rtbl, MaterialFrameData* Instance, int MaxTextures);
 void BindTextures(MaterialFrameData* Instance, int MaxTextures);
+void BindTextures(RenderCore::CommandList& CmdList, MaterialFrameData* Instance, int MaxTextures);
+
+void StoreInstanceConstants(RenderInstance const* Instance, InstanceConstantBuffer* pConstantBuf);
 
 void BindInstanceConstants(RenderInstance const* Instance);
 
 void BindInstanceConstantsFB(RenderInstance const* Instance);
 
+/** Records the pipeline, buffer and texture bindings of an instance. Called on worker threads.
+Returns false if the instance must be skipped. */
+using RecordInstanceBindingsCallback = bool (*)(RenderCore::CommandList& CmdList, RenderInstance const* Instance);
+
+/** Record draw calls for the instances into command lists on worker threads and replay them on the immediate context.
+Per-instance constants are stored by the recording jobs. Returns false if deferred recording is not used;
+the caller must draw the instances itself. */
+bool DrawInstancesDeferred(RenderCore::IImmediateContext* immediateCtx, RenderInstance const* const* Instances, int InstanceCount, RecordInstanceBindingsCallback RecordBindings);
+
+void StoreShadowInstanceConstants(ShadowRenderInstance const* Instance, ShadowInstanceConstantBuffer* pConstantBuf);
+
 void BindShadowInstanceConstants(ShadowRenderInstance const* Instance);
 void BindShadowInstanceConstants(ShadowRenderInstance const* Instance, int FaceIndex, Float3 const& LightPosition);
 
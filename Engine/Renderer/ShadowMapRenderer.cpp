@@ -1,11 +1,17 @@
 #include "ShadowMapRenderer.h"
 #include "RenderLocal.h"
 
+#include <Engine/Runtime/AsyncJobManager.h>
+
 HK_NAMESPACE_BEGIN
 
 using namespace RenderCore;
 
 ConsoleVar r_ShadowCascadeBits("r_ShadowCascadeBits"s, "32"s); // Allowed 16, 32 bits
+ConsoleVar r_DeferredShadowCommands("r_DeferredShadowCommands"s, "1"s, 0, "Record shadow caster commands on worker threads"s);
+
+static constexpr int MIN_SHADOW_CASTERS_PER_JOB = 64;
+static constexpr int MAX_SHADOW_CASTER_JOBS     = 8;
 
 static const float  EVSM_positiveExponent = 40.0;
 static const float  EVSM_negativeExponent = 5.0;
@@ -167,7 +173,7 @@ bool ShadowMapRenderer::BindMaterialShadowMap(IImmediateContext* immediateCtx, S
     {
         int bSkinned = instance->SkeletonSize > 0;
 
-        IPipeline* pPipeline = pMaterial->ShadowPass[bSkinned];
+        IPipeline* pPipeline = pMaterial->ShadowPass[instance->GetVertexFormat()];
         if (!pPipeline)
         {
             return false;
@@ -197,6 +203,126 @@ bool ShadowMapRenderer::BindMaterialShadowMap(IImmediateContext* immediateCtx, S
     return true;
 }
 
+bool ShadowMapRenderer::DrawShadowCastersDeferred(IImmediateContext* immediateCtx, ShadowRenderInstance const* const* Instances, int InstanceCount)
+{
+    if (!r_DeferredShadowCommands || !GRenderJobList || InstanceCount < MIN_SHADOW_CASTERS_PER_JOB * 2)
+    {
+        return false;
+    }
+
+    // Constants for all casters are allocated as a single block before recording: the circular buffer is not
+    // thread safe, and the block must not be split by a buffer swap before the commands are replayed.
+    size_t constantBufferStride = Align(sizeof(ShadowInstanceConstantBuffer), GCircularBuffer->GetAlignment());
+    size_t constantBufferSize   = constantBufferStride * InstanceCount;
+    if (constantBufferSize > GCircularBuffer->GetBufferSize())
+    {
+        return false;
+    }
+
+    size_t constantBufferOffset = GCircularBuffer->Allocate(constantBufferSize);
+
+    int numJobs         = Math::Min(InstanceCount / MIN_SHADOW_CASTERS_PER_JOB, MAX_SHADOW_CASTER_JOBS);
+    int instancesPerJob = (InstanceCount + numJobs - 1) / numJobs;
+
+    numJobs = (InstanceCount + instancesPerJob - 1) / instancesPerJob;
+
+    if (CommandLists.Size() < numJobs)
+    {
+        CommandLists.Resize(numJobs);
+    }
+    ShadowCasterJobs.Resize(numJobs);
+
+    for (int i = 0; i < numJobs; i++)
+    {
+        int firstInstance = i * instancesPerJob;
+
+        ShadowCasterJob& job            = ShadowCasterJobs[i];
+        job.pCommandList                = &CommandLists[i];
+        job.Instances                   = Instances + firstInstance;
+        job.InstanceCount               = Math::Min(instancesPerJob, InstanceCount - firstInstance);
+        job.ConstantBufferOffset        = constantBufferOffset + firstInstance * constantBufferStride;
+        job.ConstantBufferStride        = constantBufferStride;
+        job.pStaticShadowCasterPipeline = StaticShadowCasterPipeline;
+
+        GRenderJobList->AddJob(RecordShadowCastersJob, &job);
+    }
+
+    GRenderJobList->SubmitAndWait();
+
+    for (int i = 0; i < numJobs; i++)
+    {
+        immediateCtx->ExecuteCommandList(CommandLists[i]);
+    }
+
+    return true;
+}
+
+void ShadowMapRenderer::RecordShadowCastersJob(void* pData)
+{
+    ShadowCasterJob* job = static_cast<ShadowCasterJob*>(pData);
+
+    CommandList& cmdList = *job->pCommandList;
+    cmdList.Reset();
+
+    byte*    pMappedMemory   = GCircularBuffer->GetMappedMemory();
+    IBuffer* pConstantBuffer = GCircularBuffer->GetBuffer();
+
+    DrawIndexedCmd drawCmd;
+    drawCmd.InstanceCount         = 1;
+    drawCmd.StartInstanceLocation = 0;
+
+    for (int i = 0; i < job->InstanceCount; i++)
+    {
+        ShadowRenderInstance const* instance = job->Instances[i];
+
+        MaterialGPU* pMaterial = instance->Material;
+
+        if (pMaterial)
+        {
+            int bSkinned = instance->SkeletonSize > 0;
+
+            IPipeline* pPipeline = pMaterial->ShadowPass[instance->GetVertexFormat()];
+            if (!pPipeline)
+            {
+                continue;
+            }
+
+            cmdList.BindPipeline(pPipeline);
+
+            if (bSkinned)
+            {
+                cmdList.BindVertexBuffer(1, instance->WeightsBuffer, instance->WeightsBufferOffset);
+            }
+            else
+            {
+                cmdList.BindVertexBuffer(1, nullptr, 0);
+            }
+
+            BindTextures(cmdList, instance->MaterialInstance, pMaterial->ShadowMapPassTextureCount);
+        }
+        else
+        {
+            cmdList.BindPipeline(job->pStaticShadowCasterPipeline);
+            cmdList.BindVertexBuffer(1, nullptr, 0);
+        }
+
+        BindVertexAndIndexBuffers(cmdList, instance);
+
+        BindSkeleton(cmdList, instance->SkeletonOffset, instance->SkeletonSize);
+
+        // Draw call constants
+        size_t offset = job->ConstantBufferOffset + i * job->ConstantBufferStride;
+        StoreShadowInstanceConstants(instance, reinterpret_cast<ShadowInstanceConstantBuffer*>(pMappedMemory + offset));
+        cmdList.BindBuffer(1, pConstantBuffer, offset, sizeof(ShadowInstanceConstantBuffer));
+
+        drawCmd.IndexCountPerInstance = instance->IndexCount;
+        drawCmd.StartIndexLocation    = instance->StartIndexLocation;
+        drawCmd.BaseVertexLocation    = instance->BaseVertexLocation;
+
+        cmdList.Draw(&drawCmd);
+    }
+}
+
 bool ShadowMapRenderer::BindMaterialOmniShadowMap(IImmediateContext* immediateCtx, ShadowRenderInstance const* instance)
 {
     MaterialGPU* pMaterial = instance->Material;
@@ -205,7 +331,7 @@ bool ShadowMapRenderer::BindMaterialOmniShadowMap(IImmediateContext* immediateCt
     {
         int bSkinned = instance->SkeletonSize > 0;
 
-        IPipeline* pPipeline = pMaterial->OmniShadowPass[bSkinned];
+        IPipeline* pPipeline = pMaterial->OmniShadowPass[instance->GetVertexFormat()];
         if (!pPipeline)
         {
             return false;
@@ -383,6 +509,11 @@ void ShadowMapRenderer::AddPass(FrameGraph& FrameGraph, DirectionalLightInstance
                             immediateCtx->Draw(&drawCmd);
                         }
 
+                        if (DrawShadowCastersDeferred(immediateCtx, GFrameData->ShadowInstances.ToPtr() + shadowMap->FirstShadowInstance, shadowMap->ShadowInstanceCount))
+                        {
+                            return;
+                        }
+
                         drawCmd.InstanceCount = 1;
 
                         for (int i = 0; i < shadowMap->ShadowInstanceCount; i++)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Engine/RenderCore/FrameGraph.h>
+#include <Engine/RenderCore/CommandList.h>
 #include <Engine/Geometry/VectorMath.h>
 #include "RenderDefs.h"
 #include "OmnidirectionalShadowMapPool.h"
@@ -27,9 +28,27 @@ private:
     bool BindMaterialShadowMap(RenderCore::IImmediateContext* immediateCtx, ShadowRenderInstance const* instance);
     bool BindMaterialOmniShadowMap(RenderCore::IImmediateContext* immediateCtx, ShadowRenderInstance const* instance);
 
+    /** Record shadow casters to command lists on worker threads and replay them. Returns false if deferred recording is not used. */
+    bool DrawShadowCastersDeferred(RenderCore::IImmediateContext* immediateCtx, ShadowRenderInstance const* const* Instances, int InstanceCount);
+
+    struct ShadowCasterJob
+    {
+        RenderCore::CommandList*          pCommandList;
+        ShadowRenderInstance const* const* Instances;
+        int                               InstanceCount;
+        size_t                            ConstantBufferOffset;
+        size_t                            ConstantBufferStride;
+        RenderCore::IPipeline*            pStaticShadowCasterPipeline;
+    };
+
+    static void RecordShadowCastersJob(void* pData);
+
     TRef<RenderCore::IPipeline> StaticShadowCasterPipeline;
     TRef<RenderCore::IPipeline> LightPortalPipeline;
     TRef<RenderCore::ITexture>  DummyShadowMap;
+
+    TVector<RenderCore::CommandList> CommandLists;
+    TVector<ShadowCasterJob>         ShadowCasterJobs;
 };
 
 extern const Float4 EVSM_ClearValue;
@@ -182,7 +182,7 @@ static bool BindMaterialFeedbackPass(IImmediateContext* immediateCtx, RenderInst
 
     int bSkinned = Instance->SkeletonSize > 0;
 
-    IPipeline* pPipeline = pMaterial->FeedbackPass[bSkinned];
+    IPipeline* pPipeline = pMaterial->FeedbackPass[Instance->GetVertexFormat()];
     if (!pPipeline)
     {
         return false;
@@ -33,10 +33,13 @@ SOFTWARE.
 #include "IndexedMesh.h"
 
 #include <Engine/Assets/Asset.h>
+#include <Engine/Core/ConsoleVar.h>
 #include <Engine/Core/Platform/Logger.h>
 
 HK_NAMESPACE_BEGIN
 
+ConsoleVar com_CompressAnimations("com_CompressAnimations"s, "0"s, 0, "Compress skeletal animations on load"s);
+
 HK_CLASS_META(SkeletalAnimation)
 
 SkeletalAnimation::SkeletalAnimation()
@@ -55,6 +58,14 @@ void SkeletalAnimation::Purge()
     m_MinNodeIndex = 0;
     m_MaxNodeIndex = 0;
     m_ChannelsMap.Clear();
+    m_CompressedChannels.Clear();
+    m_PositionFrames.Clear();
+    m_PositionKeys.Clear();
+    m_RotationFrames.Clear();
+    m_RotationKeys.Clear();
+    m_ScaleFrames.Clear();
+    m_ScaleKeys.Clear();
+    m_bCompressed = false;
     m_FrameCount = 0;
     m_FrameDelta = 0;
     m_FrameRate = 0;
@@ -75,6 +86,15 @@ void SkeletalAnimation::Initialize(int frameCount, float frameDelta, Transform c
     m_Bounds.ResizeInvalidate(frameCount);
     Platform::Memcpy(m_Bounds.ToPtr(), bounds, sizeof(m_Bounds[0]) * frameCount);
 
+    m_CompressedChannels.Clear();
+    m_PositionFrames.Clear();
+    m_PositionKeys.Clear();
+    m_RotationFrames.Clear();
+    m_RotationKeys.Clear();
+    m_ScaleFrames.Clear();
+    m_ScaleKeys.Clear();
+    m_bCompressed = false;
+
     if (!m_Channels.IsEmpty())
     {
         m_MinNodeIndex = Math::MaxValue<int32_t>();
@@ -156,7 +176,423 @@ bool SkeletalAnimation::LoadResource(IBinaryStreamReadInterface& stream)
                transforms.ToPtr(), transforms.Size(),
                channels.ToPtr(), channels.Size(), bounds.ToPtr());
 
+    if (com_CompressAnimations.GetBool() && IsValid())
+    {
+        AnimationCompressionReport report;
+        if (Compress(AnimationCompressionSettings(), &report))
+        {
+            LOG("Animation {} compressed: {} -> {} bytes, keys {} -> {}, static tracks {}, constant tracks {}, max error: position {}, rotation {}, scale {}\n",
+                guid,
+                report.RawSizeInBytes, report.CompressedSizeInBytes,
+                report.NumRawKeys, report.NumKeys,
+                report.NumStaticTracks, report.NumConstantTracks,
+                report.MaxPositionError, report.MaxRotationError, report.MaxScaleError);
+        }
+    }
+
+    return true;
+}
+
+namespace
+{
+
+constexpr float QUAT_COMPONENT_RANGE = 0.70710678f; // 1 / sqrt(2)
+constexpr float QUAT_COMPONENT_SCALE = 32767.0f;
+
+/** Max distance between two kept keys, in frames */
+constexpr int MAX_KEY_GAP = 1024;
+
+/** Rotation angle between unit quaternions. Chord length based, acos is too imprecise for small angles. */
+HK_FORCEINLINE float QuatAngle(Quat const& a, Quat const& b)
+{
+    float d = a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W;
+    Quat  diff = d < 0.0f ? a + b : a - b;
+    float chord = std::sqrt(diff.X * diff.X + diff.Y * diff.Y + diff.Z * diff.Z + diff.W * diff.W);
+    return 4.0f * std::asin(Math::Min(chord * 0.5f, 1.0f));
+}
+
+HK_FORCEINLINE Quat Nlerp(Quat const& a, Quat const& b, float t)
+{
+    float d = a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W;
+    Quat  q = d < 0.0f ? a * (1.0f - t) - b * t : a * (1.0f - t) + b * t;
+    return q.Normalized();
+}
+
+template <typename QuantizedQuat>
+QuantizedQuat QuantizeQuat(Quat const& q)
+{
+    float c[4] = {q.X, q.Y, q.Z, q.W};
+
+    int largest = 0;
+    for (int i = 1; i < 4; i++)
+    {
+        if (Math::Abs(c[i]) > Math::Abs(c[largest]))
+            largest = i;
+    }
+
+    // q and -q are the same rotation, so keep the dropped component positive
+    const float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+    uint64_t bits  = largest;
+    int      shift = 2;
+    for (int i = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+
+        float    v  = Math::Clamp(c[i] * sign / QUAT_COMPONENT_RANGE, -1.0f, 1.0f);
+        uint64_t qv = (uint64_t)(int)std::floor((v * 0.5f + 0.5f) * QUAT_COMPONENT_SCALE + 0.5f);
+
+        bits |= qv << shift;
+        shift += 15;
+    }
+
+    QuantizedQuat result;
+    result.Data[0] = bits & 0xffff;
+    result.Data[1] = (bits >> 16) & 0xffff;
+    result.Data[2] = (bits >> 32) & 0xffff;
+    return result;
+}
+
+template <typename QuantizedQuat>
+Quat DequantizeQuat(QuantizedQuat const& q)
+{
+    uint64_t bits = uint64_t(q.Data[0]) | (uint64_t(q.Data[1]) << 16) | (uint64_t(q.Data[2]) << 32);
+
+    int   largest = bits & 3;
+    int   shift   = 2;
+    float c[4];
+    float sumSq = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+
+        c[i] = ((float)((bits >> shift) & 0x7fff) / QUAT_COMPONENT_SCALE * 2.0f - 1.0f) * QUAT_COMPONENT_RANGE;
+        sumSq += c[i] * c[i];
+        shift += 15;
+    }
+    c[largest] = std::sqrt(Math::Max(0.0f, 1.0f - sumSq));
+
+    return Quat(c[3], c[0], c[1], c[2]);
+}
+
+/** Find the last key at or before the frame */
+HK_FORCEINLINE int FindKey(uint16_t const* frames, int numKeys, int frame)
+{
+    return (int)(std::upper_bound(frames, frames + numKeys, (uint16_t)frame) - frames) - 1;
+}
+
+/**
+Greedy key reduction. Each segment ends at a key for which linear interpolation from the segment start reproduces
+all the frames in between within the tolerance, and the next frame would not. The end is found with galloping and
+binary search, so a segment of length N costs O(N log N) error evaluations rather than rescanning it for every
+candidate. Keys are the source values, dequantized if they are stored quantized.
+*/
+template <typename T, typename LerpFn, typename ErrorFn>
+void ReduceKeys(T const* values, T const* keys, int frameCount, float tolerance, LerpFn lerp, ErrorFn error, TVector<int>& keptFrames)
+{
+    auto isValidSegment = [&](int start, int end)
+    {
+        for (int f = start + 1; f < end; f++)
+        {
+            float t = float(f - start) / float(end - start);
+            if (error(lerp(keys[start], keys[end], t), values[f]) > tolerance)
+                return false;
+        }
+        return true;
+    };
+
+    keptFrames.Clear();
+    keptFrames.Add(0);
+
+    int start = 0;
+    while (start < frameCount - 1)
+    {
+        const int maxEnd = Math::Min(frameCount - 1, start + MAX_KEY_GAP);
+
+        // Adjacent keys are always valid
+        int validEnd   = start + 1;
+        int invalidEnd = maxEnd + 1;
+
+        for (int gap = 2; validEnd < maxEnd; gap *= 2)
+        {
+            int candidate = Math::Min(start + gap, maxEnd);
+            if (!isValidSegment(start, candidate))
+            {
+                invalidEnd = candidate;
+                break;
+            }
+            validEnd = candidate;
+        }
+
+        while (invalidEnd - validEnd > 1)
+        {
+            int candidate = (validEnd + invalidEnd) / 2;
+            if (isValidSegment(start, candidate))
+                validEnd = candidate;
+            else
+                invalidEnd = candidate;
+        }
+
+        keptFrames.Add(validEnd);
+        start = validEnd;
+    }
+}
+
+} // namespace
+
+bool SkeletalAnimation::Compress(AnimationCompressionSettings const& settings, AnimationCompressionReport* pReport)
+{
+    if (m_bCompressed || !m_bIsAnimationValid)
+        return false;
+
+    if (m_FrameCount > 0xffff)
+    {
+        LOG("SkeletalAnimation::Compress: too many frames\n");
+        return false;
+    }
+
+    AnimationCompressionReport report;
+
+    report.RawSizeInBytes = m_Transforms.Size() * sizeof(m_Transforms[0]);
+    report.NumTracks      = m_Channels.Size() * 3;
+    report.NumRawKeys     = m_Transforms.Size() * 3;
+
+    m_CompressedChannels.ResizeInvalidate(m_Channels.Size());
+
+    TVector<Float3> values(m_FrameCount);
+    TVector<Quat>   rotations(m_FrameCount);
+    TVector<Quat>   dequantized(m_FrameCount);
+    TVector<int>    keptFrames;
+
+    auto lerpVec   = [](Float3 const& a, Float3 const& b, float t) { return Math::Lerp(a, b, t); };
+    auto errorVec  = [](Float3 const& a, Float3 const& b) { return a.Dist(b); };
+    auto errorMax  = [](Float3 const& a, Float3 const& b) { return Math::Max(Math::Max(Math::Abs(a.X - b.X), Math::Abs(a.Y - b.Y)), Math::Abs(a.Z - b.Z)); };
+    auto errorQuat = [](Quat const& a, Quat const& b) { return QuatAngle(a, b); };
+
+    auto compressVecTrack = [&](Track& track, TVector<uint16_t>& frames, TVector<Float3>& keys, Float3 const& defaultValue, float tolerance, bool bScale)
+    {
+        auto error = [&](Float3 const& a, Float3 const& b) { return bScale ? errorMax(a, b) : errorVec(a, b); };
+
+        track.FirstKey = keys.Size();
+
+        bool bConstant = true;
+        for (int f = 1; f < m_FrameCount && bConstant; f++)
+            bConstant = error(values[f], values[0]) <= tolerance;
+
+        if (bConstant)
+        {
+            if (error(values[0], defaultValue) <= tolerance)
+            {
+                track.NumKeys = 0;
+                report.NumStaticTracks++;
+                return;
+            }
+            frames.Add(0);
+            keys.Add(values[0]);
+            track.NumKeys = 1;
+            report.NumConstantTracks++;
+            return;
+        }
+
+        ReduceKeys(values.ToPtr(), values.ToPtr(), m_FrameCount, tolerance, lerpVec, error, keptFrames);
+
+        for (int frame : keptFrames)
+        {
+            frames.Add(frame);
+            keys.Add(values[frame]);
+        }
+        track.NumKeys = keptFrames.Size();
+    };
+
+    for (int channelIndex = 0; channelIndex < m_Channels.Size(); channelIndex++)
+    {
+        AnimationChannel const& channel    = m_Channels[channelIndex];
+        CompressedChannel&      compressed = m_CompressedChannels[channelIndex];
+        Transform const*        transforms = m_Transforms.ToPtr() + channel.TransformOffset;
+
+        for (int f = 0; f < m_FrameCount; f++)
+            values[f] = transforms[f].Position;
+        compressVecTrack(compressed.Position, m_PositionFrames, m_PositionKeys, Float3(0.0f), settings.PositionTolerance, false);
+
+        for (int f = 0; f < m_FrameCount; f++)
+            values[f] = transforms[f].Scale;
+        compressVecTrack(compressed.Scale, m_ScaleFrames, m_ScaleKeys, Float3(1.0f), settings.ScaleTolerance, true);
+
+        Track& track = compressed.Rotation;
+        track.FirstKey = m_RotationKeys.Size();
+
+        for (int f = 0; f < m_FrameCount; f++)
+        {
+            rotations[f]   = transforms[f].Rotation.Normalized();
+            dequantized[f] = DequantizeQuat(QuantizeQuat<QuantizedQuat>(rotations[f]));
+        }
+
+        bool bConstant = true;
+        for (int f = 1; f < m_FrameCount && bConstant; f++)
+            bConstant = QuatAngle(rotations[f], dequantized[0]) <= settings.RotationTolerance;
+
+        if (bConstant)
+        {
+            if (QuatAngle(rotations[0], Quat::Identity()) <= settings.RotationTolerance)
+            {
+                track.NumKeys = 0;
+                report.NumStaticTracks++;
+            }
+            else
+            {
+                m_RotationFrames.Add(0);
+                m_RotationKeys.Add(QuantizeQuat<QuantizedQuat>(rotations[0]));
+                track.NumKeys = 1;
+                report.NumConstantTracks++;
+            }
+        }
+        else
+        {
+            ReduceKeys(rotations.ToPtr(), dequantized.ToPtr(), m_FrameCount, settings.RotationTolerance, Nlerp, errorQuat, keptFrames);
+
+            for (int frame : keptFrames)
+            {
+                m_RotationFrames.Add(frame);
+                m_RotationKeys.Add(QuantizeQuat<QuantizedQuat>(rotations[frame]));
+            }
+            track.NumKeys = keptFrames.Size();
+        }
+    }
+
+    m_bCompressed = true;
+
+    // Measure real error of the compressed data
+    double sumPositionError = 0, sumRotationError = 0, sumScaleError = 0;
+    for (int channelIndex = 0; channelIndex < m_Channels.Size(); channelIndex++)
+    {
+        Transform const* transforms = m_Transforms.ToPtr() + m_Channels[channelIndex].TransformOffset;
+
+        for (int f = 0; f < m_FrameCount; f++)
+        {
+            Transform sampled;
+            SampleCompressed(m_CompressedChannels[channelIndex], f, sampled);
+
+            float positionError = sampled.Position.Dist(transforms[f].Position);
+            float rotationError = QuatAngle(sampled.Rotation, transforms[f].Rotation.Normalized());
+            float scaleError    = errorMax(sampled.Scale, transforms[f].Scale);
+
+            report.MaxPositionError = Math::Max(report.MaxPositionError, positionError);
+            report.MaxRotationError = Math::Max(report.MaxRotationError, rotationError);
+            report.MaxScaleError    = Math::Max(report.MaxScaleError, scaleError);
+
+            sumPositionError += positionError;
+            sumRotationError += rotationError;
+            sumScaleError += scaleError;
+        }
+    }
+
+    const double numSamples = Math::Max(1.0, (double)m_Transforms.Size());
+    report.AvgPositionError = sumPositionError / numSamples;
+    report.AvgRotationError = sumRotationError / numSamples;
+    report.AvgScaleError    = sumScaleError / numSamples;
+
+    report.NumKeys = m_PositionKeys.Size() + m_RotationKeys.Size() + m_ScaleKeys.Size();
+    report.CompressedSizeInBytes = m_CompressedChannels.Size() * sizeof(m_CompressedChannels[0]) +
+        m_PositionKeys.Size() * (sizeof(m_PositionKeys[0]) + sizeof(m_PositionFrames[0])) +
+        m_RotationKeys.Size() * (sizeof(m_RotationKeys[0]) + sizeof(m_RotationFrames[0])) +
+        m_ScaleKeys.Size() * (sizeof(m_ScaleKeys[0]) + sizeof(m_ScaleFrames[0]));
+
+    m_Transforms.Free();
+
+    m_PositionFrames.ShrinkToFit();
+    m_PositionKeys.ShrinkToFit();
+    m_RotationFrames.ShrinkToFit();
+    m_RotationKeys.ShrinkToFit();
+    m_ScaleFrames.ShrinkToFit();
+    m_ScaleKeys.ShrinkToFit();
+
+    if (pReport)
+        *pReport = report;
+
     return true;
 }
 
+void SkeletalAnimation::SampleCompressed(CompressedChannel const& channel, int frame, Transform& result) const
+{
+    auto sampleVec = [frame](Track const& track, uint16_t const* frames, Float3 const* keys, Float3 const& defaultValue) -> Float3
+    {
+        if (track.NumKeys == 0)
+            return defaultValue;
+
+        frames += track.FirstKey;
+        keys += track.FirstKey;
+
+        int k = FindKey(frames, track.NumKeys, frame);
+        if (k + 1 >= (int)track.NumKeys)
+            return keys[track.NumKeys - 1];
+        if (frames[k] == frame)
+            return keys[k];
+
+        return Math::Lerp(keys[k], keys[k + 1], float(frame - frames[k]) / float(frames[k + 1] - frames[k]));
+    };
+
+    result.Position = sampleVec(channel.Position, m_PositionFrames.ToPtr(), m_PositionKeys.ToPtr(), Float3(0.0f));
+    result.Scale    = sampleVec(channel.Scale, m_ScaleFrames.ToPtr(), m_ScaleKeys.ToPtr(), Float3(1.0f));
+
+    Track const& track = channel.Rotation;
+    if (track.NumKeys == 0)
+    {
+        result.Rotation = Quat::Identity();
+        return;
+    }
+
+    uint16_t const*      frames = m_RotationFrames.ToPtr() + track.FirstKey;
+    QuantizedQuat const* keys   = m_RotationKeys.ToPtr() + track.FirstKey;
+
+    int k = FindKey(frames, track.NumKeys, frame);
+    if (k + 1 >= (int)track.NumKeys)
+        result.Rotation = DequantizeQuat(keys[track.NumKeys - 1]);
+    else if (frames[k] == frame)
+        result.Rotation = DequantizeQuat(keys[k]);
+    else
+        result.Rotation = Nlerp(DequantizeQuat(keys[k]), DequantizeQuat(keys[k + 1]), float(frame - frames[k]) / float(frames[k + 1] - frames[k]));
+}
+
+void SkeletalAnimation::SampleChannel(int channelIndex, int frame, int nextFrame, float blend, Transform& result) const
+{
+    if (!m_bCompressed)
+    {
+        int transformOffset = m_Channels[channelIndex].TransformOffset;
+
+        if (frame == nextFrame || blend < 0.0001f)
+        {
+            result = m_Transforms[transformOffset + frame];
+        }
+        else
+        {
+            Transform const& frame1 = m_Transforms[transformOffset + frame];
+            Transform const& frame2 = m_Transforms[transformOffset + nextFrame];
+
+            result.Position = Math::Lerp(frame1.Position, frame2.Position, blend);
+            result.Rotation = Math::Slerp(frame1.Rotation, frame2.Rotation, blend);
+            result.Scale    = Math::Lerp(frame1.Scale, frame2.Scale, blend);
+        }
+        return;
+    }
+
+    CompressedChannel const& channel = m_CompressedChannels[channelIndex];
+
+    if (frame == nextFrame || blend < 0.0001f)
+    {
+        SampleCompressed(channel, frame, result);
+    }
+    else
+    {
+        Transform frame1, frame2;
+        SampleCompressed(channel, frame, frame1);
+        SampleCompressed(channel, nextFrame, frame2);
+
+        result.Position = Math::Lerp(frame1.Position, frame2.Position, blend);
+        result.Rotation = Math::Slerp(frame1.Rotation, frame2.Rotation, blend);
+        result.Scale    = Math::Lerp(frame1.Scale, frame2.Scale, blend);
+    }
+}
+
 HK_NAMESPACE_END
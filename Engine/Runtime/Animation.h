@@ -37,6 +37,42 @@ SOFTWARE.
 
 HK_NAMESPACE_BEGIN
 
+struct AnimationCompressionSettings
+{
+    /** Max position error in joint space */
+    float PositionTolerance = 0.0001f;
+
+    /** Max rotation error in radians */
+    float RotationTolerance = 0.001f;
+
+    /** Max scale error */
+    float ScaleTolerance = 0.0001f;
+};
+
+struct AnimationCompressionReport
+{
+    size_t RawSizeInBytes{};
+    size_t CompressedSizeInBytes{};
+
+    /** Three tracks (position, rotation, scale) per channel */
+    int NumTracks{};
+    /** Tracks that are equal to the default value and have no keys */
+    int NumStaticTracks{};
+    /** Tracks with a single key */
+    int NumConstantTracks{};
+
+    int NumRawKeys{};
+    int NumKeys{};
+
+    /** Errors measured in joint space over all frames */
+    float MaxPositionError{};
+    float MaxRotationError{};
+    float MaxScaleError{};
+    float AvgPositionError{};
+    float AvgRotationError{};
+    float AvgScaleError{};
+};
+
 /**
 
 SkeletalAnimation
@@ -62,8 +98,19 @@ public:
     void Purge();
 
     TVector<AnimationChannel> const& GetChannels() const { return m_Channels; }
+
+    /** Raw frames. Empty for compressed animation, use SampleChannel instead. */
     TVector<Transform> const& GetTransforms() const { return m_Transforms; }
 
+    /** Replace raw frames with compressed tracks: key reduction within the error bounds, constant and static track
+    elimination and quantized rotations. */
+    bool Compress(AnimationCompressionSettings const& settings, AnimationCompressionReport* pReport = nullptr);
+
+    bool IsCompressed() const { return m_bCompressed; }
+
+    /** Sample joint transform of the channel between two frames */
+    void SampleChannel(int channelIndex, int frame, int nextFrame, float blend, Transform& result) const;
+
     unsigned short GetChannelIndex(int jointIndex) const;
 
     int GetFrameCount() const { return m_FrameCount; }
@@ -86,8 +133,36 @@ protected:
     const char* GetDefaultResourcePath() const override { return "/Default/Animation/Default"; }
 
 private:
+    struct Track
+    {
+        uint32_t FirstKey;
+        uint32_t NumKeys; // 0 - default value, 1 - constant
+    };
+
+    struct CompressedChannel
+    {
+        Track Position;
+        Track Rotation;
+        Track Scale;
+    };
+
+    /** Smallest three: 2 bits for the index of dropped component, 15 bits for each of the others */
+    struct QuantizedQuat
+    {
+        uint16_t Data[3];
+    };
+
+    void SampleCompressed(CompressedChannel const& channel, int frame, Transform& result) const;
+
     TVector<AnimationChannel> m_Channels;
     TVector<Transform> m_Transforms;
+    TVector<CompressedChannel> m_CompressedChannels;
+    TVector<uint16_t> m_PositionFrames;
+    TVector<Float3> m_PositionKeys;
+    TVector<uint16_t> m_RotationFrames;
+    TVector<QuantizedQuat> m_RotationKeys;
+    TVector<uint16_t> m_ScaleFrames;
+    TVector<Float3> m_ScaleKeys;
     TVector<unsigned short> m_ChannelsMap;
     TVector<BvAxisAlignedBox> m_Bounds;
     int m_MinNodeIndex = 0;
@@ -98,6 +173,7 @@ private:
     float m_DurationInSeconds = 0;                        // animation duration is FrameDelta * ( FrameCount - 1 )
     float m_DurationNormalizer = 1;                       // to normalize track timeline (DurationNormalizer = 1.0 / DurationInSeconds)
     bool m_bIsAnimationValid = false;
+    bool m_bCompressed = false;
 };
 
 HK_FORCEINLINE unsigned short SkeletalAnimation::GetChannelIndex(int jointIndex) const
@@ -32,6 +32,7 @@ SOFTWARE.
 
 #include <Engine/Core/Containers/Vector.h>
 #include <Engine/Core/Ref.h>
+#include <Engine/Geometry/JobDispatcher.h>
 
 HK_NAMESPACE_BEGIN
 
@@ -102,6 +103,24 @@ HK_FORCEINLINE int AsyncJobList::GetMaxParallelJobs() const
     return JobPool.Capacity();
 }
 
+/** Geometry job dispatch over the job list */
+class AsyncJobDispatcher final : public Geometry::IJobDispatcher
+{
+public:
+    explicit AsyncJobDispatcher(AsyncJobList* JobList) :
+        m_JobList(JobList)
+    {}
+
+    int GetMaxParallelJobs() const override { return m_JobList->GetMaxParallelJobs(); }
+
+    void AddJob(void (*Callback)(void*), void* pData) override { m_JobList->AddJob(Callback, pData); }
+
+    void SubmitAndWait() override { m_JobList->SubmitAndWait(); }
+
+private:
+    AsyncJobList* m_JobList;
+};
+
 /** Job manager */
 class AsyncJobManager final : public RefCounted
 {
@@ -30,8 +30,11 @@ SOFTWARE.
 
 #include "CollisionModel.h"
 #include "IndexedMesh.h"
+#include "ConvexDecompositionCache.h"
 
 #include <Engine/Core/Platform/Logger.h>
+#include <Engine/Core/HashFunc.h>
+#include <Engine/Core/IO.h>
 #include <Engine/Geometry/ConvexHull.h>
 #include <Engine/Geometry/ConvexDecomposition.h>
 
@@ -900,6 +903,8 @@ struct CollisionConvexHull : CollisionBody
 
 
 // CollisionTriangleSoupBVH can be used only for static or kinematic objects
+static constexpr uint32_t COOKED_BVH_VERSION = 1;
+
 struct CollisionTriangleSoupBVH : CollisionBody
 {
     TVector<Float3>                Vertices;
@@ -908,6 +913,15 @@ struct CollisionTriangleSoupBVH : CollisionBody
     BvAxisAlignedBox                      BoundingBox;
     TUniqueRef<StridingMeshInterface>    pInterface;
 
+    ~CollisionTriangleSoupBVH()
+    {
+        // The shape doesn't own the cooked BVH, so destroy the shape first
+        Data.Reset();
+
+        if (CookedBVH)
+            btAlignedFree(CookedBVH);
+    }
+
     btCollisionShape* Create(Float3 const& Scale) override
     {
         return new btScaledBvhTriangleMeshShape(Data.GetObject(), btVectorToFloat3(Scale));
@@ -993,6 +1007,131 @@ struct CollisionTriangleSoupBVH : CollisionBody
         return bUsedQuantizedAabbCompression;
     }
 
+    uint64_t CalcGeometryHash() const
+    {
+        uint32_t h0 = HashTraits::Murmur3Hash((const char*)Vertices.ToPtr(), Vertices.Size() * sizeof(Vertices[0]));
+        uint32_t h1 = HashTraits::Murmur3Hash((const char*)Indices.ToPtr(), Indices.Size() * sizeof(Indices[0]));
+        h1          = HashTraits::Murmur3Hash((const char*)Subparts.ToPtr(), Subparts.Size() * sizeof(Subparts[0]), h1);
+        return (uint64_t(h0) << 32) | h1;
+    }
+
+    /** Write the built BVH and the internal edge info in the cooked format */
+    void WriteCooked(IBinaryStreamWriteInterface& Stream) const
+    {
+        btOptimizedBvh const* bvh = Data->getOptimizedBvh();
+
+        uint32_t bvhSize = bvh->calculateSerializeBufferSize();
+
+        void* bvhData = btAlignedAlloc(bvhSize, 16);
+        bvh->serialize(bvhData, bvhSize, false);
+
+        Stream.WriteUInt32(COOKED_BVH_VERSION);
+#ifdef HK_LITTLE_ENDIAN
+        Stream.WriteBool(false);
+#else
+        Stream.WriteBool(true);
+#endif
+        Stream.WriteUInt64(CalcGeometryHash());
+        Stream.WriteBool(bUsedQuantizedAabbCompression);
+        Stream.WriteUInt32(bvhSize);
+        Stream.Write(bvhData, bvhSize);
+
+        btAlignedFree(bvhData);
+
+        int numTriangleInfos = TriangleInfoMap->size();
+        Stream.WriteUInt32(numTriangleInfos);
+        for (int i = 0; i < numTriangleInfos; i++)
+        {
+            btTriangleInfo const* info = TriangleInfoMap->getAtIndex(i);
+
+            Stream.WriteInt32(TriangleInfoMap->getKeyAtIndex(i).getUid1());
+            Stream.WriteInt32(info->m_flags);
+            Stream.WriteFloat(info->m_edgeV0V1Angle);
+            Stream.WriteFloat(info->m_edgeV1V2Angle);
+            Stream.WriteFloat(info->m_edgeV2V0Angle);
+        }
+    }
+
+    /** Validate the cooked data against the geometry and adopt it instead of building the BVH */
+    bool ReadCooked(void const* pCookedData, size_t CookedDataSize)
+    {
+        HK_ASSERT(!Data);
+
+        File f = File::OpenRead("CookedBVH", pCookedData, CookedDataSize);
+        if (!f)
+            return false;
+
+#ifdef HK_LITTLE_ENDIAN
+        const bool bBigEndian = false;
+#else
+        const bool bBigEndian = true;
+#endif
+        if (f.ReadUInt32() != COOKED_BVH_VERSION || f.ReadBool() != bBigEndian)
+            return false;
+
+        if (f.ReadUInt64() != CalcGeometryHash())
+            return false;
+
+        bool     bQuantized = f.ReadBool();
+        uint32_t bvhSize    = f.ReadUInt32();
+
+        if (f.GetOffset() + bvhSize > CookedDataSize)
+            return false;
+
+        // The BVH is deserialized in place, so it needs its own aligned copy of the data
+        void* bvhData = btAlignedAlloc(bvhSize, 16);
+        f.Read(bvhData, bvhSize);
+
+        btOptimizedBvh* bvh = (btOptimizedBvh*)btOptimizedBvh::deSerializeInPlace(bvhData, bvhSize, false);
+        if (!bvh || bvh->isQuantized() != bQuantized)
+        {
+            btAlignedFree(bvhData);
+            return false;
+        }
+
+        TUniqueRef<btTriangleInfoMap> triangleInfoMap = MakeUnique<btTriangleInfoMap>();
+
+        // key, flags and three angles
+        constexpr size_t TriangleInfoSize = sizeof(int32_t) * 2 + sizeof(float) * 3;
+
+        uint32_t numTriangleInfos = f.ReadUInt32();
+        if (f.GetOffset() + numTriangleInfos * TriangleInfoSize > CookedDataSize)
+        {
+            btAlignedFree(bvhData);
+            return false;
+        }
+
+        for (uint32_t i = 0; i < numTriangleInfos; i++)
+        {
+            int            key = f.ReadInt32();
+            btTriangleInfo info;
+            info.m_flags         = f.ReadInt32();
+            info.m_edgeV0V1Angle = f.ReadFloat();
+            info.m_edgeV1V2Angle = f.ReadFloat();
+            info.m_edgeV2V0Angle = f.ReadFloat();
+            triangleInfoMap->insert(key, info);
+        }
+
+        pInterface->Vertices     = Vertices.ToPtr();
+        pInterface->Indices      = Indices.ToPtr();
+        pInterface->Subparts     = Subparts.ToPtr();
+        pInterface->SubpartCount = Subparts.Size();
+
+        bUsedQuantizedAabbCompression = bQuantized;
+
+        Data = MakeUnique<btBvhTriangleMeshShape>(pInterface.GetObject(),
+                                                  bUsedQuantizedAabbCompression,
+                                                  btVectorToFloat3(BoundingBox.Mins),
+                                                  btVectorToFloat3(BoundingBox.Maxs),
+                                                  false);
+        Data->setOptimizedBvh(bvh);
+        Data->setTriangleInfoMap(triangleInfoMap.GetObject());
+
+        TriangleInfoMap = std::move(triangleInfoMap);
+        CookedBVH       = bvhData;
+        return true;
+    }
+
 #ifdef BULLET_WORLD_IMPORTER
     void Read(IBinaryStreamReadInterface& _Stream)
     {
@@ -1032,6 +1171,7 @@ struct CollisionTriangleSoupBVH : CollisionBody
 private:
     TUniqueRef<btBvhTriangleMeshShape> Data; // TODO: Try btMultimaterialTriangleMeshShape
     TUniqueRef<btTriangleInfoMap>      TriangleInfoMap;
+    void*                              CookedBVH{};
 
     bool bUsedQuantizedAabbCompression = false;
 };
@@ -1429,12 +1569,12 @@ void CollisionModel::AddConvexHull(CollisionConvexHullDef const* pShape, int& Nu
     }
 }
 
-void CollisionModel::AddTriangleSoupBVH(CollisionTriangleSoupBVHDef const* pShape, int& NumShapes)
+static TUniqueRef<CollisionTriangleSoupBVH> CreateTriangleSoupBVH(CollisionTriangleSoupBVHDef const* pShape)
 {
     if (pShape->VertexStride <= 0)
     {
         LOG("CollisionModel::AddTriangleSoupBVH: invalid VertexStride\n");
-        return;
+        return {};
     }
 
     auto body = MakeUnique<CollisionTriangleSoupBVH>();
@@ -1529,7 +1669,25 @@ void CollisionModel::AddTriangleSoupBVH(CollisionTriangleSoupBVHDef const* pShap
         }
     }
 
-    body->BuildBVH(pShape->bForceQuantizedAabbCompression);
+    return body;
+}
+
+void CollisionModel::AddTriangleSoupBVH(CollisionTriangleSoupBVHDef const* pShape, int& NumShapes)
+{
+    auto body = CreateTriangleSoupBVH(pShape);
+    if (!body)
+        return;
+
+    bool bCooked = false;
+    if (pShape->pCookedBVH)
+    {
+        bCooked = body->ReadCooked(pShape->pCookedBVH, pShape->CookedBVHSize);
+        if (!bCooked)
+            LOG("CollisionModel::AddTriangleSoupBVH: cooked BVH doesn't match the geometry, rebuilding\n");
+    }
+
+    if (!bCooked)
+        body->BuildBVH(pShape->bForceQuantizedAabbCompression);
 
     m_CenterOfMass += body->Position;
     NumShapes++;
@@ -1537,6 +1695,17 @@ void CollisionModel::AddTriangleSoupBVH(CollisionTriangleSoupBVHDef const* pShap
     m_CollisionBodies.Add(std::move(body));
 }
 
+bool CollisionModel::CookTriangleSoupBVH(CollisionTriangleSoupBVHDef const* pShape, IBinaryStreamWriteInterface& Stream)
+{
+    auto body = CreateTriangleSoupBVH(pShape);
+    if (!body)
+        return false;
+
+    body->BuildBVH(pShape->bForceQuantizedAabbCompression);
+    body->WriteCooked(Stream);
+    return true;
+}
+
 void CollisionModel::AddTriangleSoupGimpact(CollisionTriangleSoupGimpactDef const* pShape, int& NumShapes)
 {
     if (pShape->VertexStride <= 0)
@@ -1643,33 +1812,45 @@ void CollisionModel::AddTriangleSoupGimpact(CollisionTriangleSoupGimpactDef cons
     m_CollisionBodies.Add(std::move(body));
 }
 
-void CollisionModel::AddConvexDecomposition(CollisionConvexDecompositionDef const* pShape, int& NumShapes)
+static bool PerformConvexDecomposition(CONVEX_DECOMPOSITION_METHOD Method, Float3 const* pVertices, int VertexCount, int VertexStride, unsigned int const* pIndices, int IndexCount, ConvexDecompositionTask* pTask, ConvexDecompositionResult& Result)
 {
-    TVector<Float3>         hullVertices;
-    TVector<unsigned int>   hullIndices;
-    TVector<ConvexHullDesc> hulls;
+    if (pTask)
+    {
+        if (pTask->GetMethod() != Method)
+        {
+            LOG("PerformConvexDecomposition: task method mismatch\n");
+            return false;
+        }
 
-    if (pShape->VertexStride <= 0)
+        pTask->Wait();
+
+        Result = pTask->GetResult();
+        return !Result.Hulls.IsEmpty();
+    }
+
+    if (VertexStride <= 0)
     {
-        LOG("CollisionModel::AddConvexDecomposition: invalid VertexStride\n");
-        return;
+        LOG("PerformConvexDecomposition: invalid VertexStride\n");
+        return false;
     }
 
-    Geometry::PerformConvexDecomposition(pShape->pVertices,
-                                         pShape->VertexCount,
-                                         pShape->VertexStride,
-                                         pShape->pIndices,
-                                         pShape->IndexCount,
-                                         hullVertices,
-                                         hullIndices,
-                                         hulls);
+    return PerformConvexDecompositionCached(Method, pVertices, VertexCount, VertexStride, pIndices, IndexCount, Result);
+}
+
+void CollisionModel::AddConvexDecomposition(CollisionConvexDecompositionDef const* pShape, int& NumShapes)
+{
+    ConvexDecompositionResult decomposition;
 
-    if (hulls.IsEmpty())
+    if (!PerformConvexDecomposition(CONVEX_DECOMPOSITION_HACD, pShape->pVertices, pShape->VertexCount, pShape->VertexStride, pShape->pIndices, pShape->IndexCount, pShape->pTask, decomposition))
     {
         LOG("CollisionModel::AddConvexDecomposition: failed on convex decomposition\n");
         return;
     }
 
+    TVector<Float3> const&         hullVertices = decomposition.Vertices;
+    TVector<unsigned int> const&   hullIndices  = decomposition.Indices;
+    TVector<ConvexHullDesc> const& hulls        = decomposition.Hulls;
+
     Float3 saveCenterOfMass = m_CenterOfMass;
 
     m_CenterOfMass.Clear();
@@ -1696,31 +1877,17 @@ void CollisionModel::AddConvexDecomposition(CollisionConvexDecompositionDef cons
 
 void CollisionModel::AddConvexDecompositionVHACD(CollisionConvexDecompositionVHACDDef const* pShape, int& NumShapes)
 {
-    TVector<Float3>         hullVertices;
-    TVector<unsigned int>   hullIndices;
-    TVector<ConvexHullDesc> hulls;
-    Float3                  decompositionCenterOfMass;
+    ConvexDecompositionResult decomposition;
 
-    if (pShape->VertexStride <= 0)
+    if (!PerformConvexDecomposition(CONVEX_DECOMPOSITION_VHACD, pShape->pVertices, pShape->VertexCount, pShape->VertexStride, pShape->pIndices, pShape->IndexCount, pShape->pTask, decomposition))
     {
-        LOG("CollisionModel::AddConvexDecompositionVHACD: invalid VertexStride\n");
         return;
     }
 
-    Geometry::PerformConvexDecompositionVHACD(pShape->pVertices,
-                                              pShape->VertexCount,
-                                              pShape->VertexStride,
-                                              pShape->pIndices,
-                                              pShape->IndexCount,
-                                              hullVertices,
-                                              hullIndices,
-                                              hulls,
-                                              decompositionCenterOfMass);
-
-    if (hulls.IsEmpty())
-    {
-        return;
-    }
+    TVector<Float3> const&         hullVertices              = decomposition.Vertices;
+    TVector<unsigned int> const&   hullIndices               = decomposition.Indices;
+    TVector<ConvexHullDesc> const& hulls                     = decomposition.Hulls;
+    Float3 const&                  decompositionCenterOfMass = decomposition.CenterOfMass;
 
     m_CenterOfMass += decompositionCenterOfMass;
     NumShapes++;
@@ -40,6 +40,7 @@ class btCompoundShape;
 HK_NAMESPACE_BEGIN
 
 class IndexedMeshSubpart;
+class ConvexDecompositionTask;
 
 enum COLLISION_MASK : uint32_t
 {
@@ -224,6 +225,9 @@ struct CollisionTriangleSoupBVHDef
     IndexedMeshSubpart* const*  pIndexedMeshSubparts{};
     int                         SubpartCount{};
     bool                        bForceQuantizedAabbCompression{false};
+    /** Optional data written by CollisionModel::CookTriangleSoupBVH. If it matches the geometry, BVH construction is skipped. */
+    void const*                 pCookedBVH{};
+    size_t                      CookedBVHSize{};
 };
 
 struct CollisionTriangleSoupGimpactDef
@@ -245,24 +249,28 @@ struct CollisionTriangleSoupGimpactDef
 
 struct CollisionConvexDecompositionDef
 {
-    COLLISION_SHAPE     Type{COLLISION_SHAPE_CONVEX_DECOMPOSITION};
-    void*               pNext{};
-    Float3 const*       pVertices{};
-    int                 VertexCount{};
-    int                 VertexStride{};
-    unsigned int const* pIndices{};
-    int                 IndexCount{};
+    COLLISION_SHAPE          Type{COLLISION_SHAPE_CONVEX_DECOMPOSITION};
+    void*                    pNext{};
+    Float3 const*            pVertices{};
+    int                      VertexCount{};
+    int                      VertexStride{};
+    unsigned int const*      pIndices{};
+    int                      IndexCount{};
+    /** Optional background task started for the same geometry. If set, its result is used instead. */
+    ConvexDecompositionTask* pTask{};
 };
 
 struct CollisionConvexDecompositionVHACDDef
 {
-    COLLISION_SHAPE     Type{COLLISION_SHAPE_CONVEX_DECOMPOSITION_VHACD};
-    void*               pNext{};
-    Float3 const*       pVertices{};
-    int                 VertexCount{};
-    int                 VertexStride{};
-    unsigned int const* pIndices{};
-    int                 IndexCount{};
+    COLLISION_SHAPE          Type{COLLISION_SHAPE_CONVEX_DECOMPOSITION_VHACD};
+    void*                    pNext{};
+    Float3 const*            pVertices{};
+    int                      VertexCount{};
+    int                      VertexStride{};
+    unsigned int const*      pIndices{};
+    int                      IndexCount{};
+    /** Optional background task started for the same geometry. If set, its result is used instead. */
+    ConvexDecompositionTask* pTask{};
 };
 
 struct CollisionBody
@@ -318,6 +326,9 @@ public:
     /** Create a scaled instance of the collision model. */
     TRef<CollisionInstance> Instantiate(Float3 const& Scale);
 
+    /** Build the triangle soup BVH offline and write it to the stream. Store the result with the asset and pass it to CollisionTriangleSoupBVHDef::pCookedBVH. */
+    static bool CookTriangleSoupBVH(CollisionTriangleSoupBVHDef const* pShape, IBinaryStreamWriteInterface& Stream);
+
 protected:
     /** Load resource from file */
     bool LoadResource(IBinaryStreamReadInterface& Stream) override;
@@ -0,0 +1,232 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "ConvexDecompositionCache.h"
+
+#include <Engine/Core/IO.h>
+#include <Engine/Core/HashFunc.h>
+#include <Engine/Core/ConsoleVar.h>
+#include <Engine/Core/Platform/Logger.h>
+
+HK_NAMESPACE_BEGIN
+
+ConsoleVar com_ConvexDecompositionCache("com_ConvexDecompositionCache"s, "1"s, 0, "Cache convex decomposition results on disk"s);
+ConsoleVar com_ConvexDecompositionCachePath("com_ConvexDecompositionCachePath"s, "cache/convex_decomposition/"s);
+
+static constexpr uint32_t CONVEX_DECOMPOSITION_CACHE_VERSION = 1;
+
+namespace ConvexDecompositionCache
+{
+
+static String GetFileName(uint64_t Key)
+{
+    return HK_FORMAT("{}{:016x}.bin", com_ConvexDecompositionCachePath.GetValue(), Key);
+}
+
+uint64_t CalcKey(CONVEX_DECOMPOSITION_METHOD Method, Float3 const* pVertices, int VertexCount, int VertexStride, unsigned int const* pIndices, int IndexCount)
+{
+    // Two independent 32-bit hashes to reduce the chance of collision
+    uint32_t h0 = HashTraits::Murmur3Hash32(Method, CONVEX_DECOMPOSITION_CACHE_VERSION);
+    uint32_t h1 = HashTraits::Murmur3Hash32(Method, ~CONVEX_DECOMPOSITION_CACHE_VERSION);
+
+    byte const* srcVertices = (byte const*)pVertices;
+    for (int i = 0; i < VertexCount; i++)
+    {
+        h0 = HashTraits::Murmur3Hash((const char*)srcVertices, sizeof(Float3), h0);
+        h1 = HashTraits::SDBMHash((const char*)srcVertices, sizeof(Float3), h1);
+        srcVertices += VertexStride;
+    }
+
+    h0 = HashTraits::Murmur3Hash((const char*)pIndices, IndexCount * sizeof(unsigned int), h0);
+    h1 = HashTraits::SDBMHash((const char*)pIndices, IndexCount * sizeof(unsigned int), h1);
+
+    return (uint64_t(h0) << 32) | h1;
+}
+
+bool Load(uint64_t Key, ConvexDecompositionResult& Result)
+{
+    String fileName = GetFileName(Key);
+
+    if (!Core::IsFileExists(fileName))
+        return false;
+
+    File f = File::OpenRead(fileName);
+    if (!f)
+        return false;
+
+    if (f.ReadUInt32() != CONVEX_DECOMPOSITION_CACHE_VERSION || f.ReadUInt64() != Key)
+    {
+        LOG("ConvexDecompositionCache::Load: invalid cache file {}\n", fileName);
+        return false;
+    }
+
+    f.ReadArray(Result.Vertices);
+    f.ReadArray(Result.Indices);
+    f.ReadArray(Result.Hulls);
+    f.ReadObject(Result.CenterOfMass);
+
+    // Validate ranges to not crash on corrupted files
+    for (ConvexHullDesc const& hull : Result.Hulls)
+    {
+        if (hull.FirstVertex < 0 || hull.VertexCount < 0 || hull.FirstVertex + hull.VertexCount > (int)Result.Vertices.Size() ||
+            hull.FirstIndex < 0 || hull.IndexCount < 0 || hull.FirstIndex + hull.IndexCount > (int)Result.Indices.Size())
+        {
+            LOG("ConvexDecompositionCache::Load: corrupted cache file {}\n", fileName);
+            Result.Clear();
+            return false;
+        }
+    }
+
+    return !Result.Hulls.IsEmpty();
+}
+
+void Save(uint64_t Key, ConvexDecompositionResult const& Result)
+{
+    String fileName = GetFileName(Key);
+
+    File f = File::OpenWrite(fileName);
+    if (!f)
+    {
+        LOG("ConvexDecompositionCache::Save: failed to write {}\n", fileName);
+        return;
+    }
+
+    f.WriteUInt32(CONVEX_DECOMPOSITION_CACHE_VERSION);
+    f.WriteUInt64(Key);
+    f.WriteArray(Result.Vertices);
+    f.WriteArray(Result.Indices);
+    f.WriteArray(Result.Hulls);
+    f.WriteObject(Result.CenterOfMass);
+}
+
+} // namespace ConvexDecompositionCache
+
+bool PerformConvexDecompositionCached(CONVEX_DECOMPOSITION_METHOD  Method,
+                                      Float3 const*                pVertices,
+                                      int                          VertexCount,
+                                      int                          VertexStride,
+                                      unsigned int const*          pIndices,
+                                      int                          IndexCount,
+                                      ConvexDecompositionResult&   Result,
+                                      ConvexDecompositionProgress* pProgress)
+{
+    Result.Clear();
+
+    const bool bUseCache = com_ConvexDecompositionCache.GetBool();
+
+    uint64_t key = 0;
+    if (bUseCache)
+    {
+        key = ConvexDecompositionCache::CalcKey(Method, pVertices, VertexCount, VertexStride, pIndices, IndexCount);
+
+        if (ConvexDecompositionCache::Load(key, Result))
+        {
+            if (pProgress)
+                pProgress->Percent.Store(100);
+            return true;
+        }
+    }
+
+    bool bResult;
+    switch (Method)
+    {
+        case CONVEX_DECOMPOSITION_HACD:
+            bResult = Geometry::PerformConvexDecomposition(pVertices, VertexCount, VertexStride, pIndices, IndexCount, Result.Vertices, Result.Indices, Result.Hulls, pProgress);
+            break;
+        case CONVEX_DECOMPOSITION_VHACD:
+            bResult = Geometry::PerformConvexDecompositionVHACD(pVertices, VertexCount, VertexStride, pIndices, IndexCount, Result.Vertices, Result.Indices, Result.Hulls, Result.CenterOfMass, pProgress);
+            break;
+        default:
+            HK_ASSERT(0);
+            bResult = false;
+            break;
+    }
+
+    if (!bResult)
+    {
+        Result.Clear();
+        return false;
+    }
+
+    if (bUseCache)
+        ConvexDecompositionCache::Save(key, Result);
+
+    if (pProgress)
+        pProgress->Percent.Store(100);
+    return true;
+}
+
+ConvexDecompositionTask::ConvexDecompositionTask(CONVEX_DECOMPOSITION_METHOD Method, Float3 const* pVertices, int VertexCount, int VertexStride, unsigned int const* pIndices, int IndexCount) :
+    m_Method(Method)
+{
+    m_SourceVertices.ResizeInvalidate(VertexCount);
+
+    byte const* srcVertices = (byte const*)pVertices;
+    for (int i = 0; i < VertexCount; i++)
+    {
+        m_SourceVertices[i] = *(Float3 const*)srcVertices;
+        srcVertices += VertexStride;
+    }
+
+    m_SourceIndices.ResizeInvalidate(IndexCount);
+    Platform::Memcpy(m_SourceIndices.ToPtr(), pIndices, IndexCount * sizeof(unsigned int));
+
+    m_Thread = Thread(
+        [this]()
+        {
+            PerformConvexDecompositionCached(m_Method,
+                                             m_SourceVertices.ToPtr(),
+                                             m_SourceVertices.Size(),
+                                             sizeof(Float3),
+                                             m_SourceIndices.ToPtr(),
+                                             m_SourceIndices.Size(),
+                                             m_Result,
+                                             &m_Progress);
+
+            // Source geometry is not needed anymore
+            m_SourceVertices.Free();
+            m_SourceIndices.Free();
+
+            m_bFinished.Store(true);
+        });
+}
+
+ConvexDecompositionTask::~ConvexDecompositionTask()
+{
+    Cancel();
+    m_Thread.Join();
+}
+
+void ConvexDecompositionTask::Wait()
+{
+    m_Thread.Join();
+}
+
+HK_NAMESPACE_END
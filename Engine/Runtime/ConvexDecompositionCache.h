@@ -0,0 +1,126 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <Engine/Core/Ref.h>
+#include <Engine/Core/Platform/Thread.h>
+#include <Engine/Geometry/ConvexDecomposition.h>
+
+HK_NAMESPACE_BEGIN
+
+enum CONVEX_DECOMPOSITION_METHOD
+{
+    CONVEX_DECOMPOSITION_HACD,
+    CONVEX_DECOMPOSITION_VHACD
+};
+
+struct ConvexDecompositionResult
+{
+    TVector<Float3>         Vertices;
+    TVector<unsigned int>   Indices;
+    TVector<ConvexHullDesc> Hulls;
+    /** Computed by VHACD only */
+    Float3                  CenterOfMass;
+
+    void Clear()
+    {
+        Vertices.Clear();
+        Indices.Clear();
+        Hulls.Clear();
+        CenterOfMass.Clear();
+    }
+};
+
+/** On-disk cache of convex decomposition results keyed by the content hash of the source geometry */
+namespace ConvexDecompositionCache
+{
+
+uint64_t CalcKey(CONVEX_DECOMPOSITION_METHOD Method, Float3 const* pVertices, int VertexCount, int VertexStride, unsigned int const* pIndices, int IndexCount);
+
+bool Load(uint64_t Key, ConvexDecompositionResult& Result);
+
+void Save(uint64_t Key, ConvexDecompositionResult const& Result);
+
+} // namespace ConvexDecompositionCache
+
+/** Perform convex decomposition. Identical geometry is decomposed only once, next time the result is taken from the cache. */
+bool PerformConvexDecompositionCached(CONVEX_DECOMPOSITION_METHOD  Method,
+                                      Float3 const*                pVertices,
+                                      int                          VertexCount,
+                                      int                          VertexStride,
+                                      unsigned int const*          pIndices,
+                                      int                          IndexCount,
+                                      ConvexDecompositionResult&   Result,
+                                      ConvexDecompositionProgress* pProgress = nullptr);
+
+/**
+Background convex decomposition with progress and cancellation.
+Source geometry is copied, so it can be freed right after the task is created.
+*/
+class ConvexDecompositionTask : public RefCounted
+{
+public:
+    ConvexDecompositionTask(CONVEX_DECOMPOSITION_METHOD Method, Float3 const* pVertices, int VertexCount, int VertexStride, unsigned int const* pIndices, int IndexCount);
+    ~ConvexDecompositionTask();
+
+    CONVEX_DECOMPOSITION_METHOD GetMethod() const { return m_Method; }
+
+    /** Progress in percent */
+    int GetProgress() const { return m_Progress.Percent.Load(); }
+
+    /** Request to abort the decomposition. The task finishes with an empty result. */
+    void Cancel() { m_Progress.bCancel.Store(true); }
+
+    bool IsCanceled() const { return m_Progress.bCancel.Load(); }
+
+    bool IsFinished() const { return m_bFinished.Load(); }
+
+    /** Block current thread until the task is finished */
+    void Wait();
+
+    /** Result is valid when the task is finished */
+    ConvexDecompositionResult const& GetResult() const
+    {
+        HK_ASSERT(IsFinished());
+        return m_Result;
+    }
+
+private:
+    CONVEX_DECOMPOSITION_METHOD m_Method;
+    TVector<Float3>             m_SourceVertices;
+    TVector<unsigned int>       m_SourceIndices;
+    ConvexDecompositionResult   m_Result;
+    ConvexDecompositionProgress m_Progress;
+    AtomicBool                  m_bFinished{false};
+    Thread                      m_Thread;
+};
+
+HK_NAMESPACE_END
@@ -72,6 +72,8 @@ ConsoleVar rt_VidFullscreen("rt_VidFullscreen"s, "1"s);
 #endif
 
 ConsoleVar rt_SwapInterval("rt_SwapInterval"s, "0"s, 0, "1 - enable vsync, 0 - disable vsync, -1 - tearing"s);
+ConsoleVar rt_FilterRedundantState("rt_FilterRedundantState"s, "1"s, 0, "Skip pipeline, vertex/index buffer and resource table binds that don't change the state"s);
+ConsoleVar rt_RenderBackend("rt_RenderBackend"s, "OpenGL 4.5"s, 0, "Render backend: \"OpenGL 4.5\" or \"Null\" (no GPU, for servers and CPU profiling)"s);
 
 static int TotalAllocatedRenderCore = 0;
 
@@ -227,6 +229,7 @@ void Engine::Run(EntryDecl const& entryDecl)
 
     pRenderFrontendJobList = pAsyncJobManager->GetAsyncJobList(RENDER_FRONTEND_JOB_LIST);
     pRenderBackendJobList  = pAsyncJobManager->GetAsyncJobList(RENDER_BACKEND_JOB_LIST);
+    pAssetImporterJobList  = pAsyncJobManager->GetAsyncJobList(ASSET_IMPORTER_JOB_LIST);
 
     LoadConfigFile();
 
@@ -246,7 +249,13 @@ void Engine::Run(EntryDecl const& entryDecl)
         Platform::GetHeapAllocator<HEAP_RHI>().Free(_Bytes);
     };
 
-    CreateLogicalDevice("OpenGL 4.5", &allocator, &m_RenderDevice);
+    CreateLogicalDevice(rt_RenderBackend.GetValue().CStr(), &allocator, &m_RenderDevice);
+    if (!m_RenderDevice)
+    {
+        LOG("Unknown render backend \"{}\", using OpenGL 4.5\n", rt_RenderBackend.GetValue());
+        rt_RenderBackend.ForceString("OpenGL 4.5");
+        CreateLogicalDevice("OpenGL 4.5", &allocator, &m_RenderDevice);
+    }
 
     if (rt_VidWidth.GetInteger() <= 0 || rt_VidHeight.GetInteger() <= 0)
     {
@@ -274,7 +283,7 @@ void Engine::Run(EntryDecl const& entryDecl)
     desiredMode.Opacity     = 1;
     desiredMode.bFullscreen = rt_VidFullscreen;
     desiredMode.bCentrized  = true;
-    Platform::Strcpy(desiredMode.Backend, sizeof(desiredMode.Backend), "OpenGL 4.5");
+    Platform::Strcpy(desiredMode.Backend, sizeof(desiredMode.Backend), rt_RenderBackend.GetValue().CStr());
     Platform::Strcpy(desiredMode.Title, sizeof(desiredMode.Title), entryDecl.GameTitle);
 
     m_RenderDevice->GetOrCreateMainWindow(desiredMode, &m_Window);
@@ -301,7 +310,7 @@ void Engine::Run(EntryDecl const& entryDecl)
 
     m_Renderer = MakeRef<RenderFrontend>();
 
-    m_RenderBackend = MakeRef<RenderBackend>(m_RenderDevice);
+    m_RenderBackend = MakeRef<RenderBackend>(m_RenderDevice, pRenderBackendJobList);
 
     m_FrameLoop = MakeRef<FrameLoop>(m_RenderDevice);
 
@@ -372,8 +381,16 @@ void Engine::Run(EntryDecl const& entryDecl)
         m_Renderer->Render(m_FrameLoop, m_Canvas.GetObject());
 
         // Generate GPU commands
+        m_RenderDevice->GetImmediateContext()->SetStateFilterEnabled(rt_FilterRedundantState);
         m_RenderBackend->RenderFrame(m_FrameLoop->GetStreamedMemoryGPU(), m_pSwapChain->GetBackBuffer(), m_Renderer->GetFrameData());
 
+        RenderCore::IImmediateContext* immediateCtx = m_RenderDevice->GetImmediateContext();
+        m_RenderCommandStat = immediateCtx->GetStat();
+        immediateCtx->ResetStat();
+
+        m_FrameGraphStat = m_RenderBackend->GetFrameGraph()->GetStat();
+        m_RenderBackend->GetFrameGraph()->ResetStat();
+
         SaveMemoryStats();
 
     } while (!IsPendingTerminate());
@@ -496,7 +513,7 @@ void Engine::ShowStats()
         StreamedMemoryGPU* streamedMemory = m_FrameLoop->GetStreamedMemoryGPU();
 
         const float y_step = 40;
-        const int   numLines = 13;
+        const int   numLines = 20;
 
         Float2 pos(8, 8);
 
@@ -528,6 +545,9 @@ void Engine::ShowStats()
         pos.Y += y_step;
         m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Frame memory usage (GPU): {} KB / {} MB (Peak {} KB)", streamedMemory->GetUsedMemoryPrev() / 1024.0f, streamedMemory->GetAllocatedMemory() >> 20, streamedMemory->GetMaxMemoryUsage() / 1024.0f), true);
         pos.Y += y_step;
+        StreamedMemoryStat const& streamedStat = streamedMemory->GetStat();
+        m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Frame memory fill: {}% allocs {} windows {} (waste {} KB) stalls {} ({} us)", streamedStat.GetFillLevel() * 100.0f, streamedStat.NumAllocations, streamedStat.NumWindows, streamedStat.WindowWaste / 1024.0f, streamedStat.NumStalls, streamedStat.StallMicroseconds), true);
+        pos.Y += y_step;
         m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Vertex cache memory usage (GPU): {} KB / {} MB", m_VertexMemoryGPU->GetUsedMemory() / 1024.0f, m_VertexMemoryGPU->GetAllocatedMemory() >> 20), true);
         pos.Y += y_step;
         m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Visible instances: {}", frameData->Instances.Size() + frameData->TranslucentInstances.Size()), true);
@@ -542,6 +562,23 @@ void Engine::ShowStats()
         pos.Y += y_step;
         m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Frontend time: {} msec", stat.FrontendTime), true);
         pos.Y += y_step;
+        m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Occluders: {} Occlusion culled: {}", stat.OccluderCount, stat.OcclusionCulledCount), true);
+        pos.Y += y_step;
+        m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Instanced draws: {} Merged draws: {}", stat.InstancedDrawCount, stat.MergedDrawCount), true);
+        pos.Y += y_step;
+        m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Draw calls: {} Dispatches: {} Pipeline changes: {} Buffer uploads: {} ({} KB)", m_RenderCommandStat.DrawCalls, m_RenderCommandStat.DispatchCalls, m_RenderCommandStat.PipelineChanges, m_RenderCommandStat.BufferUploads, m_RenderCommandStat.BufferUploadBytes / 1024.0f), true);
+        pos.Y += y_step;
+        m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Binds: pipelines {} (skipped {}) vertex buffers {} (skipped {}) index buffers {} (skipped {}) resources {} (skipped {})",
+                                                                m_RenderCommandStat.PipelineChanges, m_RenderCommandStat.RedundantPipelineChanges,
+                                                                m_RenderCommandStat.VertexBufferChanges, m_RenderCommandStat.RedundantVertexBufferChanges,
+                                                                m_RenderCommandStat.IndexBufferChanges, m_RenderCommandStat.RedundantIndexBufferChanges,
+                                                                m_RenderCommandStat.ResourceBindings, m_RenderCommandStat.RedundantResourceBindings), true);
+        pos.Y += y_step;
+        m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Frame graph builds: {} Cache hits: {} Build time: {} msec", m_FrameGraphStat.NumBuilds, m_FrameGraphStat.NumCacheHits, m_FrameGraphStat.BuildTimeMicroseconds / 1000.0), true);
+        pos.Y += y_step;
+        size_t savedTextureMemory = m_FrameGraphStat.ExactDescTextureMemory > m_FrameGraphStat.AliasedTextureMemory ? m_FrameGraphStat.ExactDescTextureMemory - m_FrameGraphStat.AliasedTextureMemory : 0;
+        m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Render targets: cache {} MB, planned {} MB, saved by texture views {} MB", m_FrameGraphStat.RenderTargetCacheMemory >> 20, m_FrameGraphStat.AliasedTextureMemory >> 20, savedTextureMemory >> 20), true);
+        pos.Y += y_step;
         m_Canvas->DrawText(fontStyle, pos, Color4::White(), fmt("Audio channels: {} active, {} virtual", m_AudioSystem.GetMixer()->GetNumActiveChannels(), m_AudioSystem.GetMixer()->GetNumVirtualChannels()), true);
     }
 
@@ -48,6 +48,7 @@ enum
 {
     RENDER_FRONTEND_JOB_LIST,
     RENDER_BACKEND_JOB_LIST,
+    ASSET_IMPORTER_JOB_LIST,
     MAX_RUNTIME_JOB_LISTS
 };
 
@@ -67,6 +68,8 @@ public:
     TRef<AsyncJobManager> pAsyncJobManager;
     AsyncJobList*         pRenderFrontendJobList;
     AsyncJobList*         pRenderBackendJobList;
+    /** Default job list of the asset importer. Imports using it must not run concurrently. */
+    AsyncJobList*         pAssetImporterJobList = nullptr;
 
     Engine();
 
@@ -220,6 +223,12 @@ private:
     TRef<RenderCore::ISwapChain>     m_pSwapChain;
     TRef<VertexMemoryGPU>           m_VertexMemoryGPU;
 
+    /** Render commands of the last frame */
+    RenderCore::ImmediateContextStat m_RenderCommandStat;
+
+    /** Frame graph builds of the last frame */
+    RenderCore::FrameGraphStat m_FrameGraphStat;
+
     AudioSystem m_AudioSystem;
 
     DisplayVideoMode m_DesiredMode;
@@ -46,10 +46,42 @@ HK_NAMESPACE_BEGIN
 HK_CLASS_META(IndexedMesh)
 HK_CLASS_META(ProceduralMesh)
 
+static uint32_t RevisionGen = 0;
+
+/** Use 16-bit indices if all vertices are addressable. 0xffff is reserved for primitive restart. */
+static RenderCore::INDEX_TYPE SelectIndexType(int VertexCount)
+{
+    return VertexCount < 0xffff ? RenderCore::INDEX_TYPE_UINT16 : RenderCore::INDEX_TYPE_UINT32;
+}
+
+static void PackVertices(MeshVertexPacked* pDest, MeshVertex const* pSource, int VertexCount, VertexQuantization const& Quantization)
+{
+    for (int i = 0; i < VertexCount; i++)
+    {
+        pDest[i].Pack(pSource[i], Quantization);
+    }
+}
+
+/** Temporary packed vertices for GetVertexMemory. VertexMemoryGPU writes the returned memory to the GPU before it requests the next handle. */
+static thread_local TVertexBufferCPU<MeshVertexPacked> PackedVerticesScratch;
+
+/** Temporary 16-bit indices for GetIndexMemory. VertexMemoryGPU writes the returned memory to the GPU before it requests the next handle. */
+static thread_local TIndexBufferCPU<uint16_t> Indices16Scratch;
+
+static void CopyIndices16(uint16_t* pDest, unsigned int const* pSource, int IndexCount)
+{
+    for (int i = 0; i < IndexCount; i++)
+    {
+        pDest[i] = pSource[i];
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
 IndexedMesh::IndexedMesh()
 {
+    m_Revision = ++RevisionGen;
+
     static TStaticResourceFinder<Skeleton> SkeletonResource("/Default/Skeleton/Default"s);
     m_Skeleton = SkeletonResource.GetObject();
 
@@ -81,10 +113,12 @@ void IndexedMesh::Initialize(int NumVertices, int NumIndices, int NumSubparts, b
     m_Vertices.ResizeInvalidate(NumVertices);
     m_Indices.ResizeInvalidate(NumIndices);
 
+    m_IndexType = SelectIndexType(NumVertices);
+
     VertexMemoryGPU* vertexMemory = GEngine->GetVertexMemoryGPU();
 
-    m_VertexHandle = vertexMemory->AllocateVertex(m_Vertices.Size() * sizeof(MeshVertex), nullptr, GetVertexMemory, this);
-    m_IndexHandle  = vertexMemory->AllocateIndex(m_Indices.Size() * sizeof(unsigned int), nullptr, GetIndexMemory, this);
+    m_VertexHandle = vertexMemory->AllocateVertex(m_Vertices.Size() * GetVertexSizeGPU(), nullptr, GetVertexMemory, this);
+    m_IndexHandle  = vertexMemory->AllocateIndex(m_Indices.Size() * GetIndexSize(m_IndexType), nullptr, GetIndexMemory, this);
 
     if (m_bSkinnedMesh)
     {
@@ -123,6 +157,8 @@ void IndexedMesh::AddLightmapUVs()
 
     m_LightmapUVsGPU = vertexMemory->AllocateVertex(m_Vertices.Size() * sizeof(MeshVertexUV), nullptr, GetLightmapUVMemory, this);
     m_LightmapUVs.Resize(m_Vertices.Size());
+
+    m_Revision = ++RevisionGen;
 }
 
 void IndexedMesh::Purge()
@@ -165,6 +201,9 @@ void IndexedMesh::Purge()
 
     vertexMemory->Deallocate(m_LightmapUVsGPU);
     m_LightmapUVsGPU = nullptr;
+
+    // Mark GPU buffers were changed
+    m_Revision = ++RevisionGen;
 }
 
 bool IndexedMesh::LoadResource(IBinaryStreamReadInterface& Stream)
@@ -309,10 +348,14 @@ bool IndexedMesh::LoadResource(IBinaryStreamReadInterface& Stream)
     member = doc.FindMember("Skeleton");
     SetSkeleton(GetOrCreateResource<Skeleton>(member ? member->GetStringView() : "/Default/Skeleton/Default"));
 
+    m_bPackedVertices = doc.GetBool("bPackedVertices");
+
+    m_IndexType = SelectIndexType(m_Vertices.Size());
+
     VertexMemoryGPU* vertexMemory = GEngine->GetVertexMemoryGPU();
 
-    m_VertexHandle = vertexMemory->AllocateVertex(m_Vertices.Size() * sizeof(MeshVertex), nullptr, GetVertexMemory, this);
-    m_IndexHandle  = vertexMemory->AllocateIndex(m_Indices.Size() * sizeof(unsigned int), nullptr, GetIndexMemory, this);
+    m_VertexHandle = vertexMemory->AllocateVertex(m_Vertices.Size() * GetVertexSizeGPU(), nullptr, GetVertexMemory, this);
+    m_IndexHandle  = vertexMemory->AllocateIndex(m_Indices.Size() * GetIndexSize(m_IndexType), nullptr, GetIndexMemory, this);
 
     if (m_bSkinnedMesh)
     {
@@ -342,12 +385,31 @@ bool IndexedMesh::LoadResource(IBinaryStreamReadInterface& Stream)
 
 void* IndexedMesh::GetVertexMemory(void* _This)
 {
-    return static_cast<IndexedMesh*>(_This)->GetVertices();
+    IndexedMesh* mesh = static_cast<IndexedMesh*>(_This);
+
+    if (mesh->HasPackedVertices())
+    {
+        PackedVerticesScratch.ResizeInvalidate(mesh->m_Vertices.Size());
+        PackVertices(PackedVerticesScratch.ToPtr(), mesh->m_Vertices.ToPtr(), mesh->m_Vertices.Size(), mesh->m_VertexQuantization);
+        return PackedVerticesScratch.ToPtr();
+    }
+
+    return mesh->GetVertices();
 }
 
 void* IndexedMesh::GetIndexMemory(void* _This)
 {
-    return static_cast<IndexedMesh*>(_This)->GetIndices();
+    IndexedMesh* mesh = static_cast<IndexedMesh*>(_This);
+
+    if (mesh->m_IndexType == RenderCore::INDEX_TYPE_UINT16)
+    {
+        // Indices are converted on request (upload and defragmentation), the mesh does not keep a 16-bit copy
+        Indices16Scratch.ResizeInvalidate(mesh->m_Indices.Size());
+        CopyIndices16(Indices16Scratch.ToPtr(), mesh->m_Indices.ToPtr(), mesh->m_Indices.Size());
+        return Indices16Scratch.ToPtr();
+    }
+
+    return mesh->GetIndices();
 }
 
 void* IndexedMesh::GetWeightMemory(void* _This)
@@ -472,6 +534,27 @@ void IndexedMesh::SetCollisionModel(CollisionModel* pCollisionModel)
     // TODO: Notify users that the collision model has been changed?
 }
 
+void IndexedMesh::SetOccluder(Float3 const* pVertices, int VertexCount, unsigned int const* pIndices, int IndexCount)
+{
+    m_OccluderVertices.Clear();
+    m_OccluderIndices.Clear();
+
+    for (int i = 0; i < IndexCount; i++)
+    {
+        if (pIndices[i] >= (unsigned int)VertexCount)
+        {
+            LOG("IndexedMesh::SetOccluder: invalid index\n");
+            return;
+        }
+    }
+
+    m_OccluderVertices.Resize(VertexCount);
+    Platform::Memcpy(m_OccluderVertices.ToPtr(), pVertices, VertexCount * sizeof(Float3));
+
+    m_OccluderIndices.Resize(IndexCount - IndexCount % 3);
+    Platform::Memcpy(m_OccluderIndices.ToPtr(), pIndices, m_OccluderIndices.Size() * sizeof(unsigned int));
+}
+
 void IndexedMesh::SetMaterialInstance(int SubpartIndex, MaterialInstance* pMaterialInstance)
 {
     if (SubpartIndex < 0 || SubpartIndex >= m_Subparts.Size())
@@ -518,11 +601,100 @@ bool IndexedMesh::SendVertexDataToGPU(int VerticesCount, int StartVertexLocation
 
     VertexMemoryGPU* vertexMemory = GEngine->GetVertexMemoryGPU();
 
+    if (HasPackedVertices())
+    {
+        if (UpdateVertexQuantization(VerticesCount, StartVertexLocation))
+        {
+            // Positions of all vertices are quantized relative to the mesh bounds
+            VerticesCount       = m_Vertices.Size();
+            StartVertexLocation = 0;
+        }
+
+        TVertexBufferCPU<MeshVertexPacked> packedVertices;
+
+        packedVertices.ResizeInvalidate(VerticesCount);
+        PackVertices(packedVertices.ToPtr(), m_Vertices.ToPtr() + StartVertexLocation, VerticesCount, m_VertexQuantization);
+
+        vertexMemory->Update(m_VertexHandle, StartVertexLocation * sizeof(MeshVertexPacked), VerticesCount * sizeof(MeshVertexPacked), packedVertices.ToPtr());
+        return true;
+    }
+
     vertexMemory->Update(m_VertexHandle, StartVertexLocation * sizeof(MeshVertex), VerticesCount * sizeof(MeshVertex), m_Vertices.ToPtr() + StartVertexLocation);
 
     return true;
 }
 
+size_t IndexedMesh::GetVertexSizeGPU() const
+{
+    return HasPackedVertices() ? sizeof(MeshVertexPacked) : sizeof(MeshVertex);
+}
+
+bool IndexedMesh::UpdateVertexQuantization(int VerticesCount, int StartVertexLocation)
+{
+    MeshVertex const* pVertices = m_Vertices.ToPtr();
+
+    if (VerticesCount < m_Vertices.Size())
+    {
+        // Keep current quantization while the written vertices fit into it
+        Float3 const& mins = m_VertexQuantization.Bias;
+        Float3        maxs = m_VertexQuantization.Bias + m_VertexQuantization.Scale;
+
+        bool bInside = true;
+        for (int i = StartVertexLocation; i < StartVertexLocation + VerticesCount && bInside; i++)
+        {
+            Float3 const& p = pVertices[i].Position;
+
+            bInside = p.X >= mins.X && p.Y >= mins.Y && p.Z >= mins.Z && p.X <= maxs.X && p.Y <= maxs.Y && p.Z <= maxs.Z;
+        }
+        if (bInside)
+        {
+            return false;
+        }
+    }
+
+    BvAxisAlignedBox bounds;
+    bounds.Clear();
+    for (int i = 0; i < m_Vertices.Size(); i++)
+    {
+        bounds.AddPoint(pVertices[i].Position);
+    }
+
+    VertexQuantization quantization = VertexQuantization::FromBounds(bounds.Mins, bounds.Maxs);
+    if (quantization == m_VertexQuantization)
+    {
+        return false;
+    }
+
+    m_VertexQuantization = quantization;
+    return true;
+}
+
+void IndexedMesh::SetPackedVertices(bool bPackedVertices)
+{
+    if (m_bPackedVertices == bPackedVertices)
+    {
+        return;
+    }
+
+    m_bPackedVertices = bPackedVertices;
+
+    if (m_bSkinnedMesh || !m_VertexHandle)
+    {
+        return;
+    }
+
+    // Reallocate GPU vertices in the new format
+    VertexMemoryGPU* vertexMemory = GEngine->GetVertexMemoryGPU();
+
+    vertexMemory->Deallocate(m_VertexHandle);
+
+    m_VertexHandle = vertexMemory->AllocateVertex(m_Vertices.Size() * GetVertexSizeGPU(), nullptr, GetVertexMemory, this);
+
+    SendVertexDataToGPU(m_Vertices.Size(), 0);
+
+    m_Revision = ++RevisionGen;
+}
+
 bool IndexedMesh::WriteVertexData(MeshVertex const* Vertices, int VerticesCount, int StartVertexLocation)
 {
     if (!VerticesCount)
@@ -653,6 +825,17 @@ bool IndexedMesh::SendIndexDataToGPU(int _IndexCount, int _StartIndexLocation)
 
     VertexMemoryGPU* vertexMemory = GEngine->GetVertexMemoryGPU();
 
+    if (m_IndexType == RenderCore::INDEX_TYPE_UINT16)
+    {
+        TIndexBufferCPU<uint16_t> indices16;
+
+        indices16.ResizeInvalidate(_IndexCount);
+        CopyIndices16(indices16.ToPtr(), m_Indices.ToPtr() + _StartIndexLocation, _IndexCount);
+
+        vertexMemory->Update(m_IndexHandle, _StartIndexLocation * sizeof(uint16_t), _IndexCount * sizeof(uint16_t), indices16.ToPtr());
+        return true;
+    }
+
     vertexMemory->Update(m_IndexHandle, _StartIndexLocation * sizeof(unsigned int), _IndexCount * sizeof(unsigned int), m_Indices.ToPtr() + _StartIndexLocation);
 
     return true;
@@ -1166,12 +1349,18 @@ void IndexedMeshSubpart::SetBaseVertex(int BaseVertex)
 {
     m_BaseVertex     = BaseVertex;
     m_bAABBTreeDirty = true;
+
+    if (m_OwnerMesh)
+        m_OwnerMesh->m_Revision = ++RevisionGen;
 }
 
 void IndexedMeshSubpart::SetFirstIndex(int FirstIndex)
 {
     m_FirstIndex     = FirstIndex;
     m_bAABBTreeDirty = true;
+
+    if (m_OwnerMesh)
+        m_OwnerMesh->m_Revision = ++RevisionGen;
 }
 
 void IndexedMeshSubpart::SetVertexCount(int VertexCount)
@@ -1183,6 +1372,9 @@ void IndexedMeshSubpart::SetIndexCount(int IndexCount)
 {
     m_IndexCount     = IndexCount;
     m_bAABBTreeDirty = true;
+
+    if (m_OwnerMesh)
+        m_OwnerMesh->m_Revision = ++RevisionGen;
 }
 
 void IndexedMeshSubpart::SetMaterialInstance(MaterialInstance* pMaterialInstance)
@@ -1585,7 +1777,17 @@ void ProceduralMesh::PreRenderUpdate(RenderFrontendDef const* pDef)
         StreamedMemoryGPU* streamedMemory = pDef->StreamedMemory;
 
         m_VertexStream = streamedMemory->AllocateVertex(sizeof(MeshVertex) * VertexCache.Size(), VertexCache.ToPtr());
-        m_IndexSteam   = streamedMemory->AllocateIndex(sizeof(unsigned int) * IndexCache.Size(), IndexCache.ToPtr());
+
+        m_IndexType = SelectIndexType(VertexCache.Size());
+        if (m_IndexType == RenderCore::INDEX_TYPE_UINT16)
+        {
+            m_IndexSteam = streamedMemory->AllocateIndex(sizeof(uint16_t) * IndexCache.Size());
+            CopyIndices16((uint16_t*)streamedMemory->Map(m_IndexSteam), IndexCache.ToPtr(), IndexCache.Size());
+        }
+        else
+        {
+            m_IndexSteam = streamedMemory->AllocateIndex(sizeof(unsigned int) * IndexCache.Size(), IndexCache.ToPtr());
+        }
     }
 }
 
@@ -1845,7 +2047,7 @@ void CreateBoxMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<unsig
     pVerts[6 + 8 * 2].SetNormal(zero, pos, zero);
     pVerts[6 + 8 * 2].SetTexCoord(Float2(0, 0) * TexCoordScale);
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 }
 
 void CreateSphereMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<unsigned int>& Indices, BvAxisAlignedBox& Bounds, float Radius, float TexCoordScale, int NumVerticalSubdivs, int NumHorizontalSubdivs)
@@ -1911,7 +2113,7 @@ void CreateSphereMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<un
         }
     }
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 }
 
 void CreatePlaneMeshXZ(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<unsigned int>& Indices, BvAxisAlignedBox& Bounds, float Width, float Height, Float2 const& TexCoordScale)
@@ -1933,7 +2135,7 @@ void CreatePlaneMeshXZ(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<u
     constexpr unsigned int indices[6] = {0, 1, 2, 2, 3, 0};
     Platform::Memcpy(Indices.ToPtr(), &indices, sizeof(indices));
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 
     Bounds.Mins.X  = -halfWidth;
     Bounds.Mins.Y  = -0.001f;
@@ -1962,7 +2164,7 @@ void CreatePlaneMeshXY(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<u
     constexpr unsigned int indices[6] = {0, 1, 2, 2, 3, 0};
     Platform::Memcpy(Indices.ToPtr(), &indices, sizeof(indices));
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 
     Bounds.Mins.X  = -halfWidth;
     Bounds.Mins.Y  = -halfHeight;
@@ -2096,7 +2298,7 @@ void CreatePatchMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<uns
         }
     }
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 
     Bounds.Clear();
     Bounds.AddPoint(Corner00);
@@ -2220,7 +2422,7 @@ void CreateCylinderMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<
         firstVertex += (NumSubdivs + 1) * 2;
     }
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 }
 
 void CreateConeMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<unsigned int>& Indices, BvAxisAlignedBox& Bounds, float Radius, float Height, float TexCoordScale, int NumSubdivs)
@@ -2330,7 +2532,7 @@ void CreateConeMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<unsi
 
     HK_ASSERT(pIndices == Indices.ToPtr() + Indices.Size());
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 }
 
 void CreateCapsuleMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<unsigned int>& Indices, BvAxisAlignedBox& Bounds, float Radius, float Height, float TexCoordScale, int NumVerticalSubdivs, int NumHorizontalSubdivs)
@@ -2430,7 +2632,7 @@ void CreateCapsuleMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<u
         }
     }
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 }
 
 void CreateSkyboxMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<unsigned int>& Indices, BvAxisAlignedBox& Bounds, Float3 const& Extents, float TexCoordScale)
@@ -2571,7 +2773,7 @@ void CreateSkyboxMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<un
     pVerts[6 + 8 * 2].SetNormal(zero, neg, zero);
     pVerts[6 + 8 * 2].SetTexCoord(Float2(0, 0) * TexCoordScale);
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 }
 
 void CreateSkydomeMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<unsigned int>& Indices, BvAxisAlignedBox& Bounds, float Radius, float TexCoordScale, int NumVerticalSubdivs, int NumHorizontalSubdivs, bool bHemisphere)
@@ -2638,7 +2840,7 @@ void CreateSkydomeMesh(TVertexBufferCPU<MeshVertex>& Vertices, TIndexBufferCPU<u
         }
     }
 
-    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size());
+    Geometry::CalcTangentSpace(Vertices.ToPtr(), Vertices.Size(), Indices.ToPtr(), Indices.Size(), Geometry::TANGENT_SPACE_FAST);
 }
 
 MeshRenderView* IndexedMesh::GetDefaultRenderView() const
@@ -299,6 +299,15 @@ public:
     /** Skinned mesh have 4 weights for each vertex */
     bool IsSkinned() const { return m_bSkinnedMesh; }
 
+    /** Store vertices on the GPU in the compact MeshVertexPacked format. Ignored for skinned meshes. */
+    void SetPackedVertices(bool bPackedVertices);
+
+    /** Vertices are stored on the GPU in the compact MeshVertexPacked format */
+    bool HasPackedVertices() const { return m_bPackedVertices && !m_bSkinnedMesh; }
+
+    /** Dequantization of packed vertex positions. Null if the mesh has no packed vertices. */
+    VertexQuantization const* GetVertexQuantization() const { return HasPackedVertices() ? &m_VertexQuantization : nullptr; }
+
     /** Get mesh part */
     IndexedMeshSubpart* GetSubpart(int SubpartIndex);
 
@@ -330,6 +339,16 @@ public:
     /** Collision model for the mesh. */
     CollisionModel* GetCollisionModel() const { return m_CollisionModel; }
 
+    /** Low-poly occluder for software occlusion culling. Occluder must be inside the mesh volume. */
+    void SetOccluder(Float3 const* pVertices, int VertexCount, unsigned int const* pIndices, int IndexCount);
+
+    /** Has occluder for software occlusion culling */
+    bool HasOccluder() const { return !m_OccluderIndices.IsEmpty(); }
+
+    TVector<Float3> const& GetOccluderVertices() const { return m_OccluderVertices; }
+
+    TVector<unsigned int> const& GetOccluderIndices() const { return m_OccluderIndices; }
+
     MeshRenderView* GetDefaultRenderView() const;
 
     /** Soft body collision model */
@@ -370,6 +389,9 @@ public:
     /** Get total index count */
     int GetIndexCount() const { return m_Indices.Size(); }
 
+    /** Index type of the GPU index buffer. 16-bit indices are used automatically for meshes with less than 65535 vertices. */
+    RenderCore::INDEX_TYPE GetIndexType() const { return m_IndexType; }
+
     /** Get all mesh subparts */
     IndexedMeshSubpartArray const& GetSubparts() const { return m_Subparts; }
 
@@ -431,6 +453,9 @@ public:
 
     bool HasLightmapUVs() const { return m_LightmapUVsGPU != nullptr; }
 
+    /** Internal. Changes when GPU buffers are reallocated or subpart ranges are modified. Used to validate cached render data. */
+    uint32_t GetRevision() const { return m_Revision; }
+
 protected:
     void Initialize(int NumVertices, int NumIndices, int NumSubparts, bool bSkinnedMesh = false);
 
@@ -450,6 +475,10 @@ private:
 
     void AddLightmapUVs();
 
+    size_t GetVertexSizeGPU() const;
+
+    bool UpdateVertexQuantization(int VerticesCount, int StartVertexLocation);
+
     VertexHandle*            m_VertexHandle  = nullptr;
     VertexHandle*            m_IndexHandle   = nullptr;
     VertexHandle*            m_WeightsHandle = nullptr;
@@ -462,16 +491,22 @@ private:
     TVertexBufferCPU<MeshVertex>     m_Vertices;
     TVertexBufferCPU<MeshVertexSkin> m_Weights;
     TIndexBufferCPU<unsigned int>    m_Indices;
+    RenderCore::INDEX_TYPE           m_IndexType = RenderCore::INDEX_TYPE_UINT32;
 
     TVector<SocketDef*>      m_Sockets;
     TRef<Skeleton>           m_Skeleton;
     TRef<CollisionModel>     m_CollisionModel;
+    TVector<Float3>          m_OccluderVertices;
+    TVector<unsigned int>    m_OccluderIndices;
     TVector<SoftbodyLink>    m_SoftbodyLinks;
     TVector<SoftbodyFace>    m_SoftbodyFaces;
     MeshSkin                 m_Skin;
     BvAxisAlignedBox         m_BoundingBox;
     uint16_t                 m_RaycastPrimitivesPerLeaf = 16;
     bool                     m_bSkinnedMesh             = false;
+    bool                     m_bPackedVertices          = false;
+    VertexQuantization       m_VertexQuantization;
+    uint32_t                 m_Revision;
     mutable bool             m_bBoundingBoxDirty        = false;
 };
 
@@ -505,6 +540,9 @@ public:
     /** Get mesh GPU buffers */
     void GetIndexBufferGPU(StreamedMemoryGPU* StreamedMemory, RenderCore::IBuffer** ppBuffer, size_t* pOffset);
 
+    /** Index type of the streamed index buffer. Actual during current frame. */
+    RenderCore::INDEX_TYPE GetIndexType() const { return m_IndexType; }
+
     /** Check ray intersection. Result is unordered by distance to save performance */
     bool Raycast(Float3 const& RayStart, Float3 const& RayDir, float Distance, bool bCullBackFace, TVector<TriangleHitResult>& HitResult) const;
 
@@ -523,6 +561,8 @@ private:
     size_t m_VertexStream = 0;
     size_t m_IndexSteam   = 0;
 
+    RenderCore::INDEX_TYPE m_IndexType = RenderCore::INDEX_TYPE_UINT32;
+
     int m_VisFrame = -1;
 };
 
@@ -406,7 +406,8 @@ void LightVoxelizer::Voxelize(StreamedMemoryGPU* StreamedMemory, RenderViewData*
     // NOTE: we add MAX_CLUSTER_ITEMS*3 to resolve array overflow
     int maxItems                         = MAX_TOTAL_CLUSTER_ITEMS + MAX_CLUSTER_ITEMS * 3;
     int alignment                        = GEngine->GetRenderBackend()->ClusterPackedIndicesAlignment();
-    RV->ClusterPackedIndicesStreamHandle = StreamedMemory->AllocateWithCustomAlignment(maxItems * sizeof(ClusterPackedIndex),
+    size_t blockSize                     = maxItems * sizeof(ClusterPackedIndex);
+    RV->ClusterPackedIndicesStreamHandle = StreamedMemory->AllocateWithCustomAlignment(blockSize,
                                                                                        alignment,
                                                                                        nullptr);
     RV->ClusterPackedIndices             = (ClusterPackedIndex*)StreamedMemory->Map(RV->ClusterPackedIndicesStreamHandle);
@@ -449,7 +450,7 @@ void LightVoxelizer::Voxelize(StreamedMemoryGPU* StreamedMemory, RenderViewData*
     }
 
     // Shrink ClusterItems
-    StreamedMemory->ShrinkLastAllocatedMemoryBlock(RV->ClusterPackedIndexCount * sizeof(ClusterPackedIndex));
+    StreamedMemory->ShrinkLastAllocatedMemoryBlock(RV->ClusterPackedIndicesStreamHandle, blockSize, RV->ClusterPackedIndexCount * sizeof(ClusterPackedIndex));
 }
 
 void LightVoxelizer::VoxelizeWork(void* _Data)
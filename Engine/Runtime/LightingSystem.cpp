@@ -0,0 +1,97 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "LightingSystem.h"
+#include "World/Drawable.h"
+
+HK_NAMESPACE_BEGIN
+
+void LightingSystem::AddShadowCaster(Drawable* Caster)
+{
+    if (Caster->ShadowCasterIndex != -1)
+    {
+        // Already added
+        return;
+    }
+
+    Caster->ShadowCasterIndex = m_ShadowCasters.Size();
+
+    m_ShadowCasters.Add(Caster);
+    m_ShadowCasterMoveStamps.Add(++m_ShadowCastersMoveStamp);
+    m_ShadowCasterBounds.Resize(Align(m_ShadowCasters.Size(), 4));
+    m_ShadowCasterBounds[Caster->ShadowCasterIndex] = Caster->GetWorldBounds();
+
+    m_ShadowCastersRevision++;
+}
+
+void LightingSystem::RemoveShadowCaster(Drawable* Caster)
+{
+    int index = Caster->ShadowCasterIndex;
+    if (index == -1)
+    {
+        // Not added
+        return;
+    }
+
+    HK_ASSERT(m_ShadowCasters[index] == Caster);
+
+    // Move the last caster to the free place
+    int last = m_ShadowCasters.Size() - 1;
+    if (index != last)
+    {
+        m_ShadowCasters[index] = m_ShadowCasters[last];
+        m_ShadowCasters[index]->ShadowCasterIndex = index;
+        m_ShadowCasterBounds[index] = m_ShadowCasterBounds[last];
+        m_ShadowCasterMoveStamps[index] = m_ShadowCasterMoveStamps[last];
+    }
+
+    m_ShadowCasters.RemoveLast();
+    m_ShadowCasterMoveStamps.RemoveLast();
+    m_ShadowCasterBounds.Resize(Align(m_ShadowCasters.Size(), 4));
+
+    Caster->ShadowCasterIndex = -1;
+
+    m_ShadowCastersRevision++;
+}
+
+void LightingSystem::UpdateShadowCaster(Drawable* Caster)
+{
+    int index = Caster->ShadowCasterIndex;
+    if (index == -1)
+    {
+        return;
+    }
+
+    m_ShadowCasterBounds[index] = Caster->GetWorldBounds();
+    m_ShadowCasterMoveStamps[index] = ++m_ShadowCastersMoveStamp;
+}
+
+HK_NAMESPACE_END
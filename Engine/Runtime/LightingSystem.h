@@ -32,15 +32,63 @@ SOFTWARE.
 
 #include <Engine/Core/Platform/BaseTypes.h>
 #include <Engine/Core/IntrusiveLinkedListMacro.h>
+#include <Engine/Renderer/RenderDefs.h>
 #include "World/DirectionalLightComponent.h"
 
 HK_NAMESPACE_BEGIN
 
+class Drawable;
+
+/** Cascade culling result of the directional light from the previous frame */
+struct ShadowCascadeCache
+{
+    Float4x4 ViewProjection[MAX_SHADOW_CASCADES];
+    int NumCascades = 0;
+
+    /** Shadow casters revision the masks were calculated for */
+    uint32_t Revision = ~0u;
+
+    /** Shadow casters movement stamp the masks were calculated for */
+    uint32_t MoveStamp = 0;
+
+    /** Cascade mask for each shadow caster */
+    TVector<uint32_t> CascadeMasks;
+};
+
 class LightingSystem
 {
-public:    
-    TList<Drawable>                  ShadowCasters;
+public:
     TList<DirectionalLightComponent> DirectionalLights;
+
+    /** Cascade culling results per directional light. Updated by render frontend. */
+    TVector<ShadowCascadeCache> ShadowCascadeCaches;
+
+    void AddShadowCaster(Drawable* Caster);
+    void RemoveShadowCaster(Drawable* Caster);
+
+    /** Update shadow caster bounds after movement */
+    void UpdateShadowCaster(Drawable* Caster);
+
+    TVector<Drawable*> const& GetShadowCasters() const { return m_ShadowCasters; }
+
+    /** Shadow caster world bounds. Padded to a multiple of 4 for SSE culling. */
+    TVector<BvAxisAlignedBoxSSE> const& GetShadowCasterBounds() const { return m_ShadowCasterBounds; }
+
+    /** Movement stamp for each shadow caster */
+    TVector<uint32_t> const& GetShadowCasterMoveStamps() const { return m_ShadowCasterMoveStamps; }
+
+    /** Changes when shadow casters are added or removed */
+    uint32_t GetShadowCastersRevision() const { return m_ShadowCastersRevision; }
+
+    /** Changes when any shadow caster moves */
+    uint32_t GetShadowCastersMoveStamp() const { return m_ShadowCastersMoveStamp; }
+
+private:
+    TVector<Drawable*>           m_ShadowCasters;
+    TVector<BvAxisAlignedBoxSSE> m_ShadowCasterBounds;
+    TVector<uint32_t>            m_ShadowCasterMoveStamps;
+    uint32_t                     m_ShadowCastersRevision{};
+    uint32_t                     m_ShadowCastersMoveStamp{};
 };
 
 HK_NAMESPACE_END
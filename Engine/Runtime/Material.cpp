@@ -1096,6 +1096,7 @@ MaterialFrameData* MaterialInstance::PreRenderUpdate(FrameLoop* FrameLoop, int _
     m_FrameData = (MaterialFrameData*)FrameLoop->AllocFrameMem(sizeof(MaterialFrameData));
 
     m_FrameData->Material = m_pMaterial->GetGPUResource();
+    m_FrameData->MaterialInstanceId = Id;
 
     RenderCore::ITexture** textures = m_FrameData->Textures;
     m_FrameData->NumTextures        = NumTextureSlots();
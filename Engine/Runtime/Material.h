@@ -192,6 +192,9 @@ public:
     /** Internal. Used by render frontend */
     MaterialFrameData* PreRenderUpdate(class FrameLoop* FrameLoop, int FrameNumber);
 
+    /** Internal. Frame data prepared by PreRenderUpdate for the frame. Safe to call from worker threads. */
+    MaterialFrameData* GetFrameData(int FrameNumber) const { return m_VisFrame == FrameNumber ? m_FrameData : nullptr; }
+
 protected:
     /** Load resource from file */
     bool LoadResource(IBinaryStreamReadInterface& Stream) override;
@@ -0,0 +1,416 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "OcclusionCuller.h"
+#include "Engine.h"
+
+#include <Engine/Core/ConsoleVar.h>
+#include <Engine/Core/Platform/Profiler.h>
+
+HK_NAMESPACE_BEGIN
+
+ConsoleVar com_DrawOcclusionCulling("com_DrawOcclusionCulling"s, "0"s, CVAR_CHEAT, "Draw occluders and occluded bounds"s);
+
+void OcclusionCuller::Clear()
+{
+    m_Triangles.Clear();
+    m_Occluders.Clear();
+    m_CulledBounds.Clear();
+    m_CulledCount = 0;
+}
+
+void OcclusionCuller::Begin(RenderViewData const* View, int Width)
+{
+    constexpr int alignX = TILE_SIZE * BINS_X;
+    constexpr int alignY = TILE_SIZE * BINS_Y;
+
+    float aspect = View->Width > 0 ? (float)View->Height / View->Width : 1.0f;
+
+    m_Width = Math::Max(alignX, Width / alignX * alignX);
+    m_Height = Math::Max(alignY, (int)(m_Width * aspect) / alignY * alignY);
+    m_TilesX = m_Width / TILE_SIZE;
+    m_TilesY = m_Height / TILE_SIZE;
+
+    m_ViewProjection = View->ViewProjection;
+
+    m_Depth.ResizeInvalidate(m_Width * m_Height);
+    m_TileDepth.ResizeInvalidate(m_TilesX * m_TilesY);
+
+    Clear();
+}
+
+void OcclusionCuller::AddOccluder(Float3x4 const& TransformMatrix, Float3 const* Vertices, unsigned int const* Indices, int IndexCount)
+{
+    Float4x4 transform = m_ViewProjection * TransformMatrix;
+
+    for (int i = 0; i + 2 < IndexCount; i += 3)
+    {
+        Float4 clipVertices[3] =
+            {
+                transform * Vertices[Indices[i]],
+                transform * Vertices[Indices[i + 1]],
+                transform * Vertices[Indices[i + 2]]};
+
+        AddClippedTriangle(clipVertices);
+    }
+
+    OccluderRef& occluder = m_Occluders.Add();
+    occluder.TransformMatrix = TransformMatrix;
+    occluder.Vertices = Vertices;
+    occluder.Indices = Indices;
+    occluder.IndexCount = IndexCount;
+}
+
+void OcclusionCuller::AddClippedTriangle(Float4 const* ClipVertices)
+{
+    // Distance to the near plane. With reversed-Z the near plane is z = w.
+    float dist[3];
+    int numInside = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        dist[i] = ClipVertices[i].W - ClipVertices[i].Z;
+        if (dist[i] >= 0.0f)
+            numInside++;
+    }
+
+    if (numInside == 0)
+        return;
+
+    if (numInside == 3)
+    {
+        AddScreenTriangle(ClipVertices[0], ClipVertices[1], ClipVertices[2]);
+        return;
+    }
+
+    // Clip the triangle by the near plane. Result is a triangle or a quad.
+    Float4 poly[4];
+    int numPoints = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        int next = i == 2 ? 0 : i + 1;
+
+        if (dist[i] >= 0.0f)
+            poly[numPoints++] = ClipVertices[i];
+
+        if ((dist[i] >= 0.0f) != (dist[next] >= 0.0f))
+        {
+            float t = dist[i] / (dist[i] - dist[next]);
+            poly[numPoints++] = ClipVertices[i] + (ClipVertices[next] - ClipVertices[i]) * t;
+        }
+    }
+
+    for (int i = 2; i < numPoints; i++)
+        AddScreenTriangle(poly[0], poly[i - 1], poly[i]);
+}
+
+void OcclusionCuller::AddScreenTriangle(Float4 const& V0, Float4 const& V1, Float4 const& V2)
+{
+    Float4 const* v[3] = {&V0, &V1, &V2};
+
+    ScreenTriangle triangle;
+
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = -std::numeric_limits<float>::max();
+    float maxY = -std::numeric_limits<float>::max();
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (v[i]->W <= 0.0f)
+            return;
+
+        float invW = 1.0f / v[i]->W;
+
+        triangle.X[i] = (v[i]->X * invW * 0.5f + 0.5f) * m_Width;
+        triangle.Y[i] = (0.5f - v[i]->Y * invW * 0.5f) * m_Height;
+        triangle.Z[i] = v[i]->Z * invW;
+
+        minX = Math::Min(minX, triangle.X[i]);
+        minY = Math::Min(minY, triangle.Y[i]);
+        maxX = Math::Max(maxX, triangle.X[i]);
+        maxY = Math::Max(maxY, triangle.Y[i]);
+    }
+
+    // Pixels are sampled at centers
+    minX = Math::Clamp(minX - 0.5f, 0.0f, (float)m_Width);
+    minY = Math::Clamp(minY - 0.5f, 0.0f, (float)m_Height);
+    maxX = Math::Clamp(maxX - 0.5f, -1.0f, (float)(m_Width - 1));
+    maxY = Math::Clamp(maxY - 0.5f, -1.0f, (float)(m_Height - 1));
+
+    triangle.MinX = (int)Math::Ceil(minX);
+    triangle.MinY = (int)Math::Ceil(minY);
+    triangle.MaxX = (int)Math::Floor(maxX);
+    triangle.MaxY = (int)Math::Floor(maxY);
+
+    if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+        return;
+
+    // Make counter-clockwise in screen space
+    float area = (triangle.X[1] - triangle.X[0]) * (triangle.Y[2] - triangle.Y[0]) - (triangle.X[2] - triangle.X[0]) * (triangle.Y[1] - triangle.Y[0]);
+    if (Math::Abs(area) < 1e-6f)
+        return;
+    if (area < 0.0f)
+    {
+        std::swap(triangle.X[1], triangle.X[2]);
+        std::swap(triangle.Y[1], triangle.Y[2]);
+        std::swap(triangle.Z[1], triangle.Z[2]);
+    }
+
+    m_Triangles.Add(triangle);
+}
+
+struct OcclusionBinWork
+{
+    int BinIndex;
+    OcclusionCuller* Self;
+};
+
+void OcclusionCuller::Rasterize()
+{
+    HK_PROFILER_EVENT("Rasterize Occluders");
+
+    OcclusionBinWork works[BINS_X * BINS_Y];
+
+    for (int i = 0; i < BINS_X * BINS_Y; i++)
+    {
+        works[i].BinIndex = i;
+        works[i].Self = this;
+        GEngine->pRenderFrontendJobList->AddJob(RasterizeBinJob, &works[i]);
+    }
+
+    GEngine->pRenderFrontendJobList->SubmitAndWait();
+}
+
+void OcclusionCuller::RasterizeBinJob(void* _Data)
+{
+    OcclusionBinWork* work = static_cast<OcclusionBinWork*>(_Data);
+
+    work->Self->RasterizeBin(work->BinIndex);
+}
+
+void OcclusionCuller::RasterizeBin(int BinIndex)
+{
+    const int binWidth = m_Width / BINS_X;
+    const int binHeight = m_Height / BINS_Y;
+    const int binMinX = (BinIndex % BINS_X) * binWidth;
+    const int binMinY = (BinIndex / BINS_X) * binHeight;
+    const int binMaxX = binMinX + binWidth - 1;
+    const int binMaxY = binMinY + binHeight - 1;
+
+    for (int y = binMinY; y <= binMaxY; y++)
+        Platform::ZeroMem(&m_Depth[y * m_Width + binMinX], binWidth * sizeof(float));
+
+    const __m128 pixelOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+    for (ScreenTriangle const& tri : m_Triangles)
+    {
+        if (tri.MaxX < binMinX || tri.MinX > binMaxX || tri.MaxY < binMinY || tri.MinY > binMaxY)
+            continue;
+
+        // Bins are aligned to 4 pixels, so the SIMD loop never crosses the bin bounds
+        const int minX = Math::Max(tri.MinX, binMinX) & ~3;
+        const int maxX = Math::Min(tri.MaxX, binMaxX);
+        const int minY = Math::Max(tri.MinY, binMinY);
+        const int maxY = Math::Min(tri.MaxY, binMaxY);
+
+        const float x0 = tri.X[0], y0 = tri.Y[0], z0 = tri.Z[0];
+        const float x1 = tri.X[1], y1 = tri.Y[1], z1 = tri.Z[1];
+        const float x2 = tri.X[2], y2 = tri.Y[2], z2 = tri.Z[2];
+
+        // Edge functions E(x, y) = A * x + B * y + C, positive inside
+        const float a0 = y0 - y1, b0 = x1 - x0, c0 = (y1 - y0) * x0 - (x1 - x0) * y0;
+        const float a1 = y1 - y2, b1 = x2 - x1, c1 = (y2 - y1) * x1 - (x2 - x1) * y1;
+        const float a2 = y2 - y0, b2 = x0 - x2, c2 = (y0 - y2) * x2 - (x0 - x2) * y2;
+
+        // Depth plane
+        const float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+        const float dzdx = ((z1 - z0) * (y2 - y0) - (z2 - z0) * (y1 - y0)) / area;
+        const float dzdy = ((z2 - z0) * (x1 - x0) - (z1 - z0) * (x2 - x0)) / area;
+        const float zc = z0 - dzdx * x0 - dzdy * y0;
+
+        // Interpolated depth never exceeds the closest vertex
+        const __m128 zMax = _mm_set1_ps(Math::Max(z0, Math::Max(z1, z2)));
+        const __m128 zero = _mm_setzero_ps();
+
+        for (int y = minY; y <= maxY; y++)
+        {
+            const float py = y + 0.5f;
+
+            const __m128 e0Row = _mm_set1_ps(b0 * py + c0);
+            const __m128 e1Row = _mm_set1_ps(b1 * py + c1);
+            const __m128 e2Row = _mm_set1_ps(b2 * py + c2);
+            const __m128 zRow = _mm_set1_ps(dzdy * py + zc);
+
+            float* depth = &m_Depth[y * m_Width];
+
+            for (int x = minX; x <= maxX; x += 4)
+            {
+                const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), pixelOffset);
+
+                __m128 mask = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), px), e0Row), zero);
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), px), e1Row), zero));
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), px), e2Row), zero));
+
+                if (_mm_movemask_ps(mask) == 0)
+                    continue;
+
+                __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), px), zRow), zMax);
+
+                __m128 d = _mm_loadu_ps(depth + x);
+                _mm_storeu_ps(depth + x, _mm_max_ps(d, _mm_and_ps(mask, z)));
+            }
+        }
+    }
+
+    // Update tile depth
+    for (int ty = binMinY / TILE_SIZE; ty <= binMaxY / TILE_SIZE; ty++)
+    {
+        for (int tx = binMinX / TILE_SIZE; tx <= binMaxX / TILE_SIZE; tx++)
+        {
+            __m128 minDepth = _mm_set1_ps(1.0f);
+
+            for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; y++)
+            {
+                float const* depth = &m_Depth[y * m_Width + tx * TILE_SIZE];
+                for (int x = 0; x < TILE_SIZE; x += 4)
+                    minDepth = _mm_min_ps(minDepth, _mm_loadu_ps(depth + x));
+            }
+
+            minDepth = _mm_min_ps(minDepth, _mm_shuffle_ps(minDepth, minDepth, _MM_SHUFFLE(1, 0, 3, 2)));
+            minDepth = _mm_min_ps(minDepth, _mm_shuffle_ps(minDepth, minDepth, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            m_TileDepth[ty * m_TilesX + tx] = _mm_cvtss_f32(minDepth);
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(BvAxisAlignedBox const& Bounds)
+{
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = -std::numeric_limits<float>::max();
+    float maxY = -std::numeric_limits<float>::max();
+    float maxZ = -std::numeric_limits<float>::max();
+
+    for (int i = 0; i < 8; i++)
+    {
+        Float3 corner((i & 1) ? Bounds.Maxs.X : Bounds.Mins.X,
+                      (i & 2) ? Bounds.Maxs.Y : Bounds.Mins.Y,
+                      (i & 4) ? Bounds.Maxs.Z : Bounds.Mins.Z);
+
+        Float4 clip = m_ViewProjection * corner;
+
+        // Box intersects the near plane
+        if (clip.W <= 0.0f || clip.Z > clip.W)
+            return true;
+
+        float invW = 1.0f / clip.W;
+
+        float x = (clip.X * invW * 0.5f + 0.5f) * m_Width;
+        float y = (0.5f - clip.Y * invW * 0.5f) * m_Height;
+
+        minX = Math::Min(minX, x);
+        minY = Math::Min(minY, y);
+        maxX = Math::Max(maxX, x);
+        maxY = Math::Max(maxY, y);
+        maxZ = Math::Max(maxZ, clip.Z * invW);
+    }
+
+    // Conservatively cover all pixels touched by the screen rect
+    int x0 = (int)Math::Floor(Math::Clamp(minX, 0.0f, (float)(m_Width - 1)));
+    int y0 = (int)Math::Floor(Math::Clamp(minY, 0.0f, (float)(m_Height - 1)));
+    int x1 = (int)Math::Floor(Math::Clamp(maxX, 0.0f, (float)(m_Width - 1)));
+    int y1 = (int)Math::Floor(Math::Clamp(maxY, 0.0f, (float)(m_Height - 1)));
+
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++)
+    {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++)
+        {
+            // Whole tile is covered by closer occluders
+            if (m_TileDepth[ty * m_TilesX + tx] > maxZ)
+                continue;
+
+            int px0 = Math::Max(x0, tx * TILE_SIZE);
+            int py0 = Math::Max(y0, ty * TILE_SIZE);
+            int px1 = Math::Min(x1, tx * TILE_SIZE + TILE_SIZE - 1);
+            int py1 = Math::Min(y1, ty * TILE_SIZE + TILE_SIZE - 1);
+
+            for (int y = py0; y <= py1; y++)
+            {
+                float const* depth = &m_Depth[y * m_Width];
+                for (int x = px0; x <= px1; x++)
+                {
+                    if (depth[x] <= maxZ)
+                        return true;
+                }
+            }
+        }
+    }
+
+    m_CulledCount++;
+
+    if (com_DrawOcclusionCulling)
+        m_CulledBounds.Add(Bounds);
+
+    return false;
+}
+
+void OcclusionCuller::DrawDebug(DebugRenderer* InRenderer)
+{
+    if (!com_DrawOcclusionCulling)
+        return;
+
+    InRenderer->SetDepthTest(true);
+
+    TVector<Float3> vertices;
+
+    InRenderer->SetColor(Color4(0, 1, 0, 1));
+    for (OccluderRef const& occluder : m_Occluders)
+    {
+        vertices.Clear();
+        for (int i = 0; i < occluder.IndexCount; i++)
+        {
+            unsigned int index = occluder.Indices[i];
+            if (index >= vertices.Size())
+                vertices.Resize(index + 1);
+            vertices[index] = occluder.TransformMatrix * occluder.Vertices[index];
+        }
+        InRenderer->DrawTriangleSoupWireframe(vertices.ToPtr(), sizeof(Float3), occluder.Indices, occluder.IndexCount);
+    }
+
+    InRenderer->SetColor(Color4(1, 0, 0, 1));
+    for (BvAxisAlignedBox const& bounds : m_CulledBounds)
+    {
+        InRenderer->DrawAABB(bounds);
+    }
+}
+
+HK_NAMESPACE_END
@@ -0,0 +1,125 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include "DebugRenderer.h"
+
+HK_NAMESPACE_BEGIN
+
+/**
+
+OcclusionCuller
+
+Software occlusion culling. Low-poly occluders are rasterized on the CPU into a small
+depth buffer with a tile-level (hierarchical) min depth, then bounding boxes are tested against it.
+Depth is stored in reversed-Z NDC: greater value is closer to the viewer, cleared to zero.
+
+*/
+class OcclusionCuller
+{
+public:
+    /** Hierarchical depth tile size in pixels */
+    static constexpr int TILE_SIZE = 8;
+
+    /** Screen is split into BINS_X * BINS_Y bins, each bin is rasterized by a separate job */
+    static constexpr int BINS_X = 4;
+    static constexpr int BINS_Y = 4;
+
+    /** Clear occluders */
+    void Clear();
+
+    /** Start new frame. Width is the depth buffer width, height is chosen from the view aspect ratio. */
+    void Begin(RenderViewData const* View, int Width);
+
+    /** Add occluder triangles. Occluder must be inside the visible geometry. */
+    void AddOccluder(Float3x4 const& TransformMatrix, Float3 const* Vertices, unsigned int const* Indices, int IndexCount);
+
+    /** Rasterize occluders in parallel by screen bins */
+    void Rasterize();
+
+    /** Return false if the box is completely hidden by occluders */
+    bool IsVisible(BvAxisAlignedBox const& Bounds);
+
+    void DrawDebug(DebugRenderer* InRenderer);
+
+    int GetOccluderCount() const { return m_Occluders.Size(); }
+
+    int GetTriangleCount() const { return m_Triangles.Size(); }
+
+    int GetCulledCount() const { return m_CulledCount; }
+
+private:
+    struct ScreenTriangle
+    {
+        float X[3];
+        float Y[3];
+        float Z[3];
+        int MinX;
+        int MinY;
+        int MaxX;
+        int MaxY;
+    };
+
+    struct OccluderRef
+    {
+        Float3x4 TransformMatrix;
+        Float3 const* Vertices;
+        unsigned int const* Indices;
+        int IndexCount;
+    };
+
+    void AddClippedTriangle(Float4 const* ClipVertices);
+    void AddScreenTriangle(Float4 const& V0, Float4 const& V1, Float4 const& V2);
+
+    static void RasterizeBinJob(void* _Data);
+
+    void RasterizeBin(int BinIndex);
+
+    Float4x4 m_ViewProjection;
+    int m_Width{};
+    int m_Height{};
+    int m_TilesX{};
+    int m_TilesY{};
+    int m_CulledCount{};
+
+    /** Per-pixel depth */
+    TVector<float> m_Depth;
+
+    /** Per-tile min depth: farthest occluder depth in the tile */
+    TVector<float> m_TileDepth;
+
+    TVector<ScreenTriangle> m_Triangles;
+    TVector<OccluderRef> m_Occluders;
+    TVector<BvAxisAlignedBox> m_CulledBounds;
+};
+
+HK_NAMESPACE_END
@@ -0,0 +1,235 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "RadixSort.h"
+#include "AsyncJobManager.h"
+
+#include <Engine/Core/BaseMath.h>
+#include <Engine/Core/Platform/Profiler.h>
+
+HK_NAMESPACE_BEGIN
+
+RadixSortItem const* RadixSort::Sort(RadixSortItem* Items, size_t Count, AsyncJobList* JobList)
+{
+    HK_ASSERT(Count <= 0xffffffff);
+
+    if (Count < MIN_ITEMS)
+    {
+        std::sort(Items, Items + Count, [](RadixSortItem const& a, RadixSortItem const& b)
+                  {
+                      return a.Key < b.Key || (a.Key == b.Key && a.Index < b.Index);
+                  });
+        return Items;
+    }
+
+    m_Temp.ResizeInvalidate(Count);
+
+    if (JobList && Count >= MIN_PARALLEL_ITEMS)
+        return SortParallel(Items, Count, JobList);
+
+    return SortSerial(Items, Count);
+}
+
+void RadixSort::ComputeHistograms(RadixSortItem const* Items, size_t Count, uint32_t (*Histograms)[RADIX_SIZE])
+{
+    Platform::ZeroMem(Histograms, sizeof(uint32_t) * NUM_DIGITS * RADIX_SIZE);
+
+    for (size_t i = 0; i < Count; i++)
+    {
+        uint64_t key = Items[i].Key;
+        for (int digit = 0; digit < NUM_DIGITS; digit++)
+        {
+            Histograms[digit][key & (RADIX_SIZE - 1)]++;
+            key >>= RADIX_BITS;
+        }
+    }
+}
+
+RadixSortItem const* RadixSort::SortSerial(RadixSortItem* Items, size_t Count)
+{
+    uint32_t histograms[NUM_DIGITS][RADIX_SIZE];
+
+    ComputeHistograms(Items, Count, histograms);
+
+    RadixSortItem* src = Items;
+    RadixSortItem* dst = m_Temp.ToPtr();
+
+    for (int digit = 0; digit < NUM_DIGITS; digit++)
+    {
+        const int shift = digit * RADIX_BITS;
+        uint32_t* offsets = histograms[digit];
+
+        // All keys have the same digit
+        if (offsets[(src[0].Key >> shift) & (RADIX_SIZE - 1)] == Count)
+            continue;
+
+        uint32_t sum = 0;
+        for (int i = 0; i < RADIX_SIZE; i++)
+        {
+            uint32_t n = offsets[i];
+            offsets[i] = sum;
+            sum += n;
+        }
+
+        for (size_t i = 0; i < Count; i++)
+            dst[offsets[(src[i].Key >> shift) & (RADIX_SIZE - 1)]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    return src;
+}
+
+void RadixSort::HistogramsJob(void* Data)
+{
+    Job* job = (Job*)Data;
+
+    ComputeHistograms(job->Src + job->First, job->Count, job->Histograms);
+}
+
+void RadixSort::DigitHistogramJob(void* Data)
+{
+    Job* job = (Job*)Data;
+
+    uint32_t* histogram = job->Histograms[0];
+    Platform::ZeroMem(histogram, sizeof(uint32_t) * RADIX_SIZE);
+
+    RadixSortItem const* src = job->Src + job->First;
+    for (size_t i = 0; i < job->Count; i++)
+        histogram[(src[i].Key >> job->Shift) & (RADIX_SIZE - 1)]++;
+}
+
+void RadixSort::ScatterJob(void* Data)
+{
+    Job* job = (Job*)Data;
+
+    uint32_t* offsets = job->Histograms[0];
+
+    RadixSortItem const* src = job->Src + job->First;
+    RadixSortItem* dst = job->Dst;
+    for (size_t i = 0; i < job->Count; i++)
+        dst[offsets[(src[i].Key >> job->Shift) & (RADIX_SIZE - 1)]++] = src[i];
+}
+
+RadixSortItem const* RadixSort::SortParallel(RadixSortItem* Items, size_t Count, AsyncJobList* JobList)
+{
+    HK_PROFILER_EVENT("Radix sort");
+
+    const int numJobs = Math::Min<int>(MAX_JOBS, JobList->GetMaxParallelJobs());
+    const size_t chunkSize = (Count + numJobs - 1) / numJobs;
+
+    m_Jobs.ResizeInvalidate(numJobs);
+
+    for (int i = 0; i < numJobs; i++)
+    {
+        Job& job = m_Jobs[i];
+        job.Src = Items;
+        job.First = i * chunkSize;
+        job.Count = Math::Min(chunkSize, Count - job.First);
+        JobList->AddJob(HistogramsJob, &job);
+    }
+    JobList->SubmitAndWait();
+
+    // Digit histograms of the whole array do not depend on the order of items
+    bool bSkipDigit[NUM_DIGITS];
+    for (int digit = 0; digit < NUM_DIGITS; digit++)
+    {
+        const int key = (Items[0].Key >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1);
+
+        uint32_t total = 0;
+        for (int i = 0; i < numJobs; i++)
+            total += m_Jobs[i].Histograms[digit][key];
+
+        // All keys have the same digit
+        bSkipDigit[digit] = total == Count;
+    }
+
+    // Per-chunk histograms of the source array are valid for the first executed pass only
+    bool bFirstPass = true;
+
+    RadixSortItem* src = Items;
+    RadixSortItem* dst = m_Temp.ToPtr();
+
+    for (int digit = 0; digit < NUM_DIGITS; digit++)
+    {
+        if (bSkipDigit[digit])
+            continue;
+
+        const int shift = digit * RADIX_BITS;
+
+        if (bFirstPass)
+        {
+            if (digit != 0)
+            {
+                for (int i = 0; i < numJobs; i++)
+                    Platform::Memcpy(m_Jobs[i].Histograms[0], m_Jobs[i].Histograms[digit], sizeof(uint32_t) * RADIX_SIZE);
+            }
+            bFirstPass = false;
+        }
+        else
+        {
+            for (int i = 0; i < numJobs; i++)
+            {
+                m_Jobs[i].Src = src;
+                m_Jobs[i].Shift = shift;
+                JobList->AddJob(DigitHistogramJob, &m_Jobs[i]);
+            }
+            JobList->SubmitAndWait();
+        }
+
+        // Items of each digit are placed chunk by chunk to keep the sort stable
+        uint32_t sum = 0;
+        for (int n = 0; n < RADIX_SIZE; n++)
+        {
+            for (int i = 0; i < numJobs; i++)
+            {
+                uint32_t count = m_Jobs[i].Histograms[0][n];
+                m_Jobs[i].Histograms[0][n] = sum;
+                sum += count;
+            }
+        }
+
+        for (int i = 0; i < numJobs; i++)
+        {
+            m_Jobs[i].Src = src;
+            m_Jobs[i].Dst = dst;
+            m_Jobs[i].Shift = shift;
+            JobList->AddJob(ScatterJob, &m_Jobs[i]);
+        }
+        JobList->SubmitAndWait();
+
+        std::swap(src, dst);
+    }
+
+    return src;
+}
+
+HK_NAMESPACE_END
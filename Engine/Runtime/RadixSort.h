@@ -0,0 +1,126 @@
+/*
+
+Hork Engine Source Code
+
+MIT License
+
+Copyright (C) 2017-2023 Alexander Samusev.
+
+This file is part of the Hork Engine Source Code.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include <Engine/Core/Containers/Vector.h>
+
+HK_NAMESPACE_BEGIN
+
+class AsyncJobList;
+
+/** Key-index pair sorted by RadixSort */
+struct RadixSortItem
+{
+    uint64_t Key;
+    uint32_t Index;
+};
+
+/**
+
+RadixSort
+
+LSD radix sort of key-index pairs by 8-bit digits. The sort is stable. Digits that are equal
+for all keys are skipped, so narrow keys (e.g. 32-bit) cost only as many passes as they need.
+Large inputs can be sorted on the job system: each job histograms and scatters its own chunk.
+
+*/
+class RadixSort
+{
+public:
+    /** Items below this count are sorted by std::sort */
+    static constexpr size_t MIN_ITEMS = 64;
+
+    /** Items below this count are sorted on the current thread */
+    static constexpr size_t MIN_PARALLEL_ITEMS = 16384;
+
+    /** Max jobs for parallel sort */
+    static constexpr int MAX_JOBS = 8;
+
+    /** Sort items by key. Returns sorted items: either Items or internal scratch memory.
+    If JobList is not null, large inputs are sorted in parallel. */
+    RadixSortItem const* Sort(RadixSortItem* Items, size_t Count, AsyncJobList* JobList = nullptr);
+
+    /** Sort an array of pointers to objects with SortKey member */
+    template <typename T>
+    void SortByKey(T** Objects, size_t Count, AsyncJobList* JobList = nullptr);
+
+private:
+    static constexpr int RADIX_BITS = 8;
+    static constexpr int RADIX_SIZE = 1 << RADIX_BITS;
+    static constexpr int NUM_DIGITS = 64 / RADIX_BITS;
+
+    struct Job
+    {
+        RadixSortItem const* Src;
+        RadixSortItem*       Dst;
+        size_t               First;
+        size_t               Count;
+        int                  Shift;
+        uint32_t             Histograms[NUM_DIGITS][RADIX_SIZE];
+    };
+
+    RadixSortItem const* SortSerial(RadixSortItem* Items, size_t Count);
+    RadixSortItem const* SortParallel(RadixSortItem* Items, size_t Count, AsyncJobList* JobList);
+
+    static void ComputeHistograms(RadixSortItem const* Items, size_t Count, uint32_t (*Histograms)[RADIX_SIZE]);
+    static void HistogramsJob(void* Data);
+    static void DigitHistogramJob(void* Data);
+    static void ScatterJob(void* Data);
+
+    TVector<RadixSortItem> m_Items;
+    TVector<RadixSortItem> m_Temp;
+    TVector<void*>         m_Objects;
+    TVector<Job>           m_Jobs;
+};
+
+template <typename T>
+void RadixSort::SortByKey(T** Objects, size_t Count, AsyncJobList* JobList)
+{
+    if (Count < 2)
+        return;
+
+    m_Items.ResizeInvalidate(Count);
+    m_Objects.ResizeInvalidate(Count);
+    for (size_t i = 0; i < Count; i++)
+    {
+        m_Items[i].Key   = Objects[i]->SortKey;
+        m_Items[i].Index = i;
+        m_Objects[i]     = Objects[i];
+    }
+
+    RadixSortItem const* sorted = Sort(m_Items.ToPtr(), Count, JobList);
+
+    for (size_t i = 0; i < Count; i++)
+        Objects[i] = static_cast<T*>(m_Objects[sorted[i].Index]);
+}
+
+HK_NAMESPACE_END
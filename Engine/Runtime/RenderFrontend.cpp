@@ -61,9 +61,18 @@ extern ConsoleVar r_HBAO;
 extern ConsoleVar r_HBAODeinterleaved;
 
 ConsoleVar com_DrawFrustumClusters("com_DrawFrustumClusters"s, "0"s, CVAR_CHEAT);
+ConsoleVar com_OcclusionCulling("com_OcclusionCulling"s, "1"s, 0, "Software occlusion culling by mesh occluders"s);
+ConsoleVar com_OcclusionBufferWidth("com_OcclusionBufferWidth"s, "256"s);
+ConsoleVar com_MaxOccluders("com_MaxOccluders"s, "64"s);
+ConsoleVar r_AutoInstancing("r_AutoInstancing"s, "1"s, 0, "Merge identical static mesh render instances into instanced draw calls"s);
+ConsoleVar r_ParallelRenderInstances("r_ParallelRenderInstances"s, "1"s, 0, "Generate render instances on the job system"s);
+ConsoleVar r_ParallelSort("r_ParallelSort"s, "1"s, 0, "Sort large render instance lists on the job system"s);
 
 static constexpr int TerrainTileSize = 256; //32;//256;
 
+/** Minimal count of drawables processed by one render instance job */
+static constexpr int RenderInstanceBatchSize = 256;
+
 RenderFrontend::RenderFrontend()
 {
     m_TerrainMesh = MakeRef<TerrainMesh>(TerrainTileSize);
@@ -81,21 +90,63 @@ RenderFrontend::~RenderFrontend()
 {
 }
 
-struct InstanceSortFunction
+template <typename T>
+void RenderFrontend::SortByKey(T** Objects, int Count)
 {
-    bool operator()(RenderInstance const* _A, RenderInstance* _B)
-    {
-        return _A->SortKey < _B->SortKey;
-    }
-} InstanceSortFunction;
+    m_RadixSort.SortByKey(Objects, Count, r_ParallelSort ? GEngine->pRenderFrontendJobList : nullptr);
+}
 
-struct ShadowInstanceSortFunction
+/** Orders instances by stable ids rather than addresses, so the order does not change from run to run.
+Equal instances keep generation order (used with stable sort). */
+struct DrawCallSortFunction
 {
-    bool operator()(ShadowRenderInstance const* _A, ShadowRenderInstance* _B)
-    {
-        return _A->SortKey < _B->SortKey;
-    }
-} ShadowInstanceSortFunction;
+    bool operator()(RenderInstance const* _A, RenderInstance const* _B) const
+    {
+        if (_A->MaterialInstance->MaterialInstanceId != _B->MaterialInstance->MaterialInstanceId)
+            return _A->MaterialInstance->MaterialInstanceId < _B->MaterialInstance->MaterialInstanceId;
+        if (_A->VertexBuffer->GetUID() != _B->VertexBuffer->GetUID())
+            return _A->VertexBuffer->GetUID() < _B->VertexBuffer->GetUID();
+        if (_A->VertexBufferOffset != _B->VertexBufferOffset)
+            return _A->VertexBufferOffset < _B->VertexBufferOffset;
+        if (_A->IndexBuffer->GetUID() != _B->IndexBuffer->GetUID())
+            return _A->IndexBuffer->GetUID() < _B->IndexBuffer->GetUID();
+        if (_A->IndexBufferOffset != _B->IndexBufferOffset)
+            return _A->IndexBufferOffset < _B->IndexBufferOffset;
+        if (_A->IndexType != _B->IndexType)
+            return _A->IndexType < _B->IndexType;
+        if (_A->IndexCount != _B->IndexCount)
+            return _A->IndexCount < _B->IndexCount;
+        if (_A->StartIndexLocation != _B->StartIndexLocation)
+            return _A->StartIndexLocation < _B->StartIndexLocation;
+        return _A->BaseVertexLocation < _B->BaseVertexLocation;
+    }
+} DrawCallSortFunction;
+
+static bool CanInstanceRenderInstance(RenderInstance const* Instance)
+{
+    // Skinned, lightmapped, vertex lit and dynamic geometry have per-instance resources or velocity output
+    return Instance->SkeletonSize == 0 &&
+        Instance->VertexLightChannel == nullptr &&
+        !(Instance->LightmapUVChannel && Instance->Lightmap) &&
+        Instance->GetGeometryPriority() == RENDERING_GEOMETRY_PRIORITY_STATIC &&
+        Instance->Material->DepthPassInstanced[Instance->GetVertexFormat()] &&
+        Instance->Material->LightPassInstanced[Instance->GetVertexFormat()];
+}
+
+static bool IsSameDrawCall(RenderInstance const* A, RenderInstance const* B)
+{
+    return A->SortKey == B->SortKey &&
+        A->Material == B->Material &&
+        A->MaterialInstance == B->MaterialInstance &&
+        A->VertexBuffer == B->VertexBuffer &&
+        A->VertexBufferOffset == B->VertexBufferOffset &&
+        A->IndexBuffer == B->IndexBuffer &&
+        A->IndexBufferOffset == B->IndexBufferOffset &&
+        A->IndexType == B->IndexType &&
+        A->IndexCount == B->IndexCount &&
+        A->StartIndexLocation == B->StartIndexLocation &&
+        A->BaseVertexLocation == B->BaseVertexLocation;
+}
 
 void RenderFrontend::Render(FrameLoop* InFrameLoop, Canvas* InCanvas)
 {
@@ -108,6 +159,10 @@ void RenderFrontend::Render(FrameLoop* InFrameLoop, Canvas* InCanvas)
     m_Stat.FrontendTime = Platform::SysMilliseconds();
     m_Stat.PolyCount = 0;
     m_Stat.ShadowMapPolyCount = 0;
+    m_Stat.OccluderCount = 0;
+    m_Stat.OcclusionCulledCount = 0;
+    m_Stat.InstancedDrawCount = 0;
+    m_Stat.MergedDrawCount = 0;
 
     TVector<WorldRenderView*> const& renderViews = InFrameLoop->GetRenderViews();
 
@@ -150,15 +205,19 @@ void RenderFrontend::Render(FrameLoop* InFrameLoop, Canvas* InCanvas)
 
     //int64_t t = m_FrameLoop->SysMilliseconds();
 
-    for (RenderViewData* view = m_FrameData.RenderViews; view < &m_FrameData.RenderViews[m_FrameData.NumViews]; view++)
     {
-        std::sort(m_FrameData.Instances.Begin() + view->FirstInstance,
-                  m_FrameData.Instances.Begin() + (view->FirstInstance + view->InstanceCount),
-                  InstanceSortFunction);
+        HK_PROFILER_EVENT("Sort Render Instances");
 
-        std::sort(m_FrameData.TranslucentInstances.Begin() + view->FirstTranslucentInstance,
-                  m_FrameData.TranslucentInstances.Begin() + (view->FirstTranslucentInstance + view->TranslucentInstanceCount),
-                  InstanceSortFunction);
+        for (RenderViewData* view = m_FrameData.RenderViews; view < &m_FrameData.RenderViews[m_FrameData.NumViews]; view++)
+        {
+            SortByKey(m_FrameData.Instances.ToPtr() + view->FirstInstance, view->InstanceCount);
+            SortByKey(m_FrameData.TranslucentInstances.ToPtr() + view->FirstTranslucentInstance, view->TranslucentInstanceCount);
+
+            if (r_AutoInstancing)
+            {
+                MergeRenderInstances(view);
+            }
+        }
     }
     //LOG( "Sort instances time {} instances count {}\n", m_FrameLoop->SysMilliseconds() - t, m_FrameData.Instances.Size() + m_FrameData.ShadowInstances.Size() );
 
@@ -172,6 +231,68 @@ void RenderFrontend::Render(FrameLoop* InFrameLoop, Canvas* InCanvas)
     m_Stat.FrontendTime = Platform::SysMilliseconds() - m_Stat.FrontendTime;
 }
 
+void RenderFrontend::MergeRenderInstances(RenderViewData* View)
+{
+    // Instance data is small and allocated per group, so sub-allocate it from a window instead of hitting the shared ring each time
+    StreamedMemoryWindow instanceDataWindow(m_FrameLoop->GetStreamedMemoryGPU());
+
+    RenderInstance** instances = m_FrameData.Instances.ToPtr() + View->FirstInstance;
+    RenderInstance** end = instances + View->InstanceCount;
+
+    while (instances < end)
+    {
+        // Instances with equal sort keys stay in generation order, so group identical draw calls together
+        RenderInstance** spanEnd = instances + 1;
+        while (spanEnd < end && (*spanEnd)->SortKey == (*instances)->SortKey)
+            spanEnd++;
+
+        if (spanEnd - instances > 1)
+        {
+            std::stable_sort(instances, spanEnd, DrawCallSortFunction);
+
+            for (RenderInstance** first = instances; first < spanEnd;)
+            {
+                RenderInstance* leader = *first;
+
+                if (!CanInstanceRenderInstance(leader))
+                {
+                    first++;
+                    continue;
+                }
+
+                RenderInstance** last = first + 1;
+                while (last < spanEnd && last - first < MAX_MESH_INSTANCES && IsSameDrawCall(leader, *last))
+                    last++;
+
+                int count = last - first;
+                if (count > 1)
+                {
+                    leader->InstanceCount = count;
+                    leader->InstanceDataStreamHandle = instanceDataWindow.AllocateConstant(sizeof(MeshInstanceData) * count);
+
+                    MeshInstanceData* data = (MeshInstanceData*)instanceDataWindow.Map(leader->InstanceDataStreamHandle);
+                    for (RenderInstance** it = first; it < last; it++, data++)
+                    {
+                        RenderInstance* instance = *it;
+
+                        data->TransformMatrix = instance->Payload->Matrix;
+                        data->TransformMatrixP = instance->Payload->MatrixP;
+                        data->ModelNormalToViewSpace = Float3x4(instance->Payload->ModelNormalToViewSpace.Transposed());
+
+                        if (instance != leader)
+                            instance->InstanceCount = 0;
+                    }
+
+                    m_Stat.InstancedDrawCount++;
+                    m_Stat.MergedDrawCount += count - 1;
+                }
+                first = last;
+            }
+        }
+        instances = spanEnd;
+    }
+}
+
 void RenderFrontend::RenderView(int _Index)
 {
     WorldRenderView* worldRenderView = m_FrameLoop->GetRenderViews()[_Index];
@@ -352,6 +473,8 @@ void RenderFrontend::RenderView(int _Index)
 
     QueryVisiblePrimitives(world);
 
+    CullOccludedPrimitives();
+
     EnvironmentMap* pEnvironmentMap = world->GetGlobalEnvironmentMap();
 
     if (pEnvironmentMap)
@@ -379,6 +502,8 @@ void RenderFrontend::RenderView(int _Index)
         {
             m_LightVoxelizer.DrawVoxels(&m_DebugDraw);
         }
+
+        m_OcclusionCuller.DrawDebug(&m_DebugDraw);
     }
 
     AddRenderInstances(world);
@@ -416,7 +541,118 @@ void RenderFrontend::QueryVisiblePrimitives(World* InWorld)
     InWorld->QueryVisiblePrimitives(m_VisPrimitives, m_VisSurfaces, &m_VisPass, query);
 }
 
-void RenderFrontend::QueryShadowCasters(World* InWorld, Float4x4 const& LightViewProjection, Float3 const& LightPosition, Float3x3 const& LightBasis, TVector<PrimitiveDef*>& Primitives, TVector<SurfaceDef*>& Surfaces)
+void RenderFrontend::CullOccludedPrimitives()
+{
+    m_OcclusionCuller.Clear();
+
+    if (!com_OcclusionCulling)
+    {
+        return;
+    }
+
+    HK_PROFILER_EVENT("Occlusion Culling");
+
+    Float3 const& viewPosition = m_RenderDef.View->ViewPosition;
+
+    // Select occluders. Closest and largest occluders go first.
+    m_Occluders.Clear();
+    for (PrimitiveDef* primitive : m_VisPrimitives[VSD_PRIMITIVE_KIND_DRAWABLE])
+    {
+        Drawable* drawable = static_cast<Drawable*>(primitive->Owner);
+        if (drawable->GetDrawableType() != DRAWABLE_STATIC_MESH)
+        {
+            continue;
+        }
+
+        MeshComponent* mesh = static_cast<MeshComponent*>(drawable);
+        if (mesh->bOccluder && mesh->GetMesh()->HasOccluder())
+        {
+            m_Occluders.Add(primitive);
+        }
+    }
+
+    if (m_Occluders.IsEmpty())
+    {
+        return;
+    }
+
+    auto occluderScore = [&viewPosition](PrimitiveDef const* primitive)
+    {
+        BvAxisAlignedBox const& bounds = primitive->Box;
+        return bounds.Size().LengthSqr() / Math::Max(viewPosition.DistSqr(bounds.Center()), 1.0f);
+    };
+
+    int maxOccluders = Math::Max(com_MaxOccluders.GetInteger(), 1);
+    if (m_Occluders.Size() > maxOccluders)
+    {
+        std::partial_sort(m_Occluders.Begin(), m_Occluders.Begin() + maxOccluders, m_Occluders.End(),
+                          [&occluderScore](PrimitiveDef const* a, PrimitiveDef const* b)
+                          {
+                              return occluderScore(a) > occluderScore(b);
+                          });
+        m_Occluders.Resize(maxOccluders);
+    }
+
+    m_OcclusionCuller.Begin(m_RenderDef.View, com_OcclusionBufferWidth.GetInteger());
+
+    for (PrimitiveDef* primitive : m_Occluders)
+    {
+        MeshComponent* mesh = static_cast<MeshComponent*>(primitive->Owner);
+        IndexedMesh* resource = mesh->GetMesh();
+
+        m_OcclusionCuller.AddOccluder(mesh->GetWorldTransformMatrix(), resource->GetOccluderVertices().ToPtr(), resource->GetOccluderIndices().ToPtr(), resource->GetOccluderIndices().Size());
+    }
+
+    if (m_OcclusionCuller.GetTriangleCount() == 0)
+    {
+        return;
+    }
+
+    m_OcclusionCuller.Rasterize();
+
+    std::sort(m_Occluders.Begin(), m_Occluders.End());
+
+    const int visSlot = VSD_QuerySlot(m_VisPass);
+
+    int count;
+    for (TVector<PrimitiveDef*>& primitives : m_VisPrimitives.Buckets)
+    {
+        count = 0;
+        for (PrimitiveDef* primitive : primitives)
+        {
+            if (!std::binary_search(m_Occluders.Begin(), m_Occluders.End(), primitive))
+            {
+                BvAxisAlignedBox bounds = primitive->Type == VSD_PRIMITIVE_SPHERE ? BvAxisAlignedBox(primitive->Sphere.Center - primitive->Sphere.Radius, primitive->Sphere.Center + primitive->Sphere.Radius) : primitive->Box;
+
+                if (!m_OcclusionCuller.IsVisible(bounds))
+                {
+                    // Occluded primitives are not visible in this pass
+                    primitive->VisPass[visSlot] = 0;
+                    continue;
+                }
+            }
+            primitives[count++] = primitive;
+        }
+        primitives.Resize(count);
+    }
+
+    count = 0;
+    for (SurfaceDef* surface : m_VisSurfaces)
+    {
+        if (!m_OcclusionCuller.IsVisible(surface->Bounds))
+        {
+            surface->VisPass[visSlot] = 0;
+            continue;
+        }
+        m_VisSurfaces[count++] = surface;
+    }
+    m_VisSurfaces.Resize(count);
+
+    m_Stat.OccluderCount += m_OcclusionCuller.GetOccluderCount();
+    m_Stat.OcclusionCulledCount += m_OcclusionCuller.GetCulledCount();
+}
+
+void RenderFrontend::QueryShadowCasters(World* InWorld, Float4x4 const& LightViewProjection, Float3 const& LightPosition, Float3x3 const& LightBasis, VisPrimitiveBuckets& Primitives, TVector<SurfaceDef*>& Surfaces)
 {
     VisibilityQuery query;
     BvFrustum frustum;
@@ -517,8 +753,6 @@ void RenderFrontend::AddRenderInstances(World* InWorld)
     HK_PROFILER_EVENT("Add Render Instances");
 
     RenderViewData* view = m_RenderDef.View;
-    Drawable* drawable;
-    TerrainComponent* terrain;
     PunctualLightComponent* light;
     EnvironmentProbe* envProbe;
     StreamedMemoryGPU* streamedMemory = m_FrameLoop->GetStreamedMemoryGPU();
@@ -526,73 +760,67 @@ void RenderFrontend::AddRenderInstances(World* InWorld)
 
     m_VisLights.Clear();
     m_VisEnvProbes.Clear();
+    m_VisDrawables.Clear();
+    m_NumReservedInstances = 0;
 
-    for (PrimitiveDef* primitive : m_VisPrimitives)
+    for (PrimitiveDef* primitive : m_VisPrimitives[VSD_PRIMITIVE_KIND_DRAWABLE])
     {
-        // TODO: Replace upcasting by something better (virtual function?)
+        AddDrawable(static_cast<Drawable*>(primitive->Owner));
+    }
 
-        if (nullptr != (drawable = Upcast<Drawable>(primitive->Owner)))
+    for (PrimitiveDef* primitive : m_VisPrimitives[VSD_PRIMITIVE_KIND_TERRAIN])
+    {
+        AddTerrain(static_cast<TerrainComponent*>(primitive->Owner));
+    }
+
+    for (PrimitiveDef* primitive : m_VisPrimitives[VSD_PRIMITIVE_KIND_PUNCTUAL_LIGHT])
+    {
+        light = static_cast<PunctualLightComponent*>(primitive->Owner);
+        if (!light->IsEnabled())
         {
-            AddDrawable(drawable);
             continue;
         }
 
-        if (nullptr != (terrain = Upcast<TerrainComponent>(primitive->Owner)))
+        if (m_VisLights.Size() < MAX_LIGHTS)
         {
-            AddTerrain(terrain);
-            continue;
+            m_VisLights.Add(light);
         }
-
-        if (nullptr != (light = Upcast<PunctualLightComponent>(primitive->Owner)))
+        else
         {
-            if (!light->IsEnabled())
-            {
-                continue;
-            }
+            LOG("MAX_LIGHTS hit\n");
+            break;
+        }
+    }
 
-            if (m_VisLights.Size() < MAX_LIGHTS)
-            {
-                m_VisLights.Add(light);
-            }
-            else
-            {
-                LOG("MAX_LIGHTS hit\n");
-            }
+    for (PrimitiveDef* primitive : m_VisPrimitives[VSD_PRIMITIVE_KIND_ENVIRONMENT_PROBE])
+    {
+        envProbe = static_cast<EnvironmentProbe*>(primitive->Owner);
+        if (!envProbe->IsEnabled())
+        {
             continue;
         }
 
-        if (nullptr != (envProbe = Upcast<EnvironmentProbe>(primitive->Owner)))
+        if (m_VisEnvProbes.Size() < MAX_PROBES)
         {
-            if (!envProbe->IsEnabled())
-            {
-                continue;
-            }
-
-            if (m_VisEnvProbes.Size() < MAX_PROBES)
-            {
-                m_VisEnvProbes.Add(envProbe);
-            }
-            else
-            {
-                LOG("MAX_PROBES hit\n");
-            }
-            continue;
+            m_VisEnvProbes.Add(envProbe);
         }
+        else
+        {
+            LOG("MAX_PROBES hit\n");
+            break;
+        }
+    }
 
+    if (!m_VisPrimitives[VSD_PRIMITIVE_KIND_UNKNOWN].IsEmpty())
+    {
         LOG("Unhandled primitive\n");
     }
 
+    GenerateRenderInstances();
+
     if (r_RenderSurfaces && !m_VisSurfaces.IsEmpty())
     {
-        struct SortFunction
-        {
-            bool operator()(SurfaceDef const* _A, SurfaceDef const* _B)
-            {
-                return (_A->SortKey < _B->SortKey);
-            }
-        } SortFunction;
-
-        std::sort(m_VisSurfaces.ToPtr(), m_VisSurfaces.ToPtr() + m_VisSurfaces.Size(), SortFunction);
+        SortByKey(m_VisSurfaces.ToPtr(), m_VisSurfaces.Size());
 
         AddSurfaces(m_VisSurfaces.ToPtr(), m_VisSurfaces.Size());
     }
@@ -728,20 +956,241 @@ void RenderFrontend::AddRenderInstances(World* InWorld)
 
 void RenderFrontend::AddDrawable(Drawable* InComponent)
 {
+    if (!r_RenderMeshes)
+    {
+        return;
+    }
+
+    int numInstances;
+
     switch (InComponent->GetDrawableType())
     {
         case DRAWABLE_STATIC_MESH:
-            AddStaticMesh(static_cast<MeshComponent*>(InComponent));
-            break;
         case DRAWABLE_SKINNED_MESH:
-            AddSkinnedMesh(static_cast<SkinnedComponent*>(InComponent));
+            numInstances = PrepareMesh(static_cast<MeshComponent*>(InComponent));
             break;
         case DRAWABLE_PROCEDURAL_MESH:
-            AddProceduralMesh(static_cast<ProceduralMeshComponent*>(InComponent));
+            numInstances = PrepareProceduralMesh(static_cast<ProceduralMeshComponent*>(InComponent));
             break;
         default:
+            numInstances = 0;
             break;
     }
+
+    if (numInstances > 0)
+    {
+        VisDrawable& visDrawable = m_VisDrawables.Add();
+        visDrawable.Component = InComponent;
+        visDrawable.FirstInstance = m_NumReservedInstances;
+
+        m_NumReservedInstances += numInstances;
+    }
+}
+
+int RenderFrontend::PrepareMesh(MeshComponent* InComponent)
+{
+    // Component and material updates are not thread-safe, so they are done here before the instances are generated in parallel.
+    InComponent->PreRenderUpdate(&m_RenderDef);
+
+    int numInstances = 0;
+
+    if (InComponent->GetDrawableType() == DRAWABLE_STATIC_MESH)
+    {
+        if (!IsMeshRenderProxyValid(InComponent))
+        {
+            UpdateMeshRenderProxy(InComponent);
+        }
+
+        for (MeshRenderProxy::Subpart const& proxySubpart : InComponent->GetRenderProxy().Subparts)
+        {
+            if (proxySubpart.View->IsEnabled() && proxySubpart.pMaterialInstance->PreRenderUpdate(m_FrameLoop, m_FrameNumber))
+                numInstances++;
+        }
+
+        return numInstances;
+    }
+
+    const int numSubparts = InComponent->GetMesh()->GetSubparts().Size();
+
+    for (auto& meshRender : InComponent->GetRenderViews())
+    {
+        if (!meshRender->IsEnabled())
+            continue;
+
+        for (int subpartIndex = 0; subpartIndex < numSubparts; subpartIndex++)
+        {
+            MaterialInstance* materialInstance = meshRender->GetMaterial(subpartIndex);
+            HK_ASSERT(materialInstance);
+
+            if (materialInstance->PreRenderUpdate(m_FrameLoop, m_FrameNumber))
+                numInstances++;
+        }
+    }
+
+    return numInstances;
+}
+
+int RenderFrontend::PrepareProceduralMesh(ProceduralMeshComponent* InComponent)
+{
+    InComponent->PreRenderUpdate(&m_RenderDef);
+
+    ProceduralMesh* mesh = InComponent->GetMesh();
+    if (!mesh)
+    {
+        return 0;
+    }
+
+    mesh->PreRenderUpdate(&m_RenderDef);
+
+    if (mesh->IndexCache.IsEmpty())
+    {
+        return 0;
+    }
+
+    int numInstances = 0;
+
+    for (auto& meshRender : InComponent->GetRenderViews())
+    {
+        if (!meshRender->IsEnabled())
+            continue;
+
+        MaterialInstance* materialInstance = meshRender->GetMaterial();
+        HK_ASSERT(materialInstance);
+
+        if (!materialInstance->PreRenderUpdate(m_FrameLoop, m_FrameNumber))
+            break;
+
+        numInstances++;
+    }
+
+    return numInstances;
+}
+
+void RenderFrontend::GenerateRenderInstances()
+{
+    HK_PROFILER_EVENT("Generate Render Instances");
+
+    const int numDrawables = m_VisDrawables.Size();
+    if (!numDrawables)
+    {
+        return;
+    }
+
+    RenderInstance* instances = (RenderInstance*)m_FrameLoop->AllocFrameMem(sizeof(RenderInstance) * m_NumReservedInstances);
+    RenderInstancePayload* payloads = (RenderInstancePayload*)m_FrameLoop->AllocFrameMem(sizeof(RenderInstancePayload) * m_NumReservedInstances);
+
+    AsyncJobList* jobList = GEngine->pRenderFrontendJobList;
+
+    int numBatches = 1;
+    if (r_ParallelRenderInstances)
+    {
+        numBatches = Math::Clamp((numDrawables + RenderInstanceBatchSize - 1) / RenderInstanceBatchSize, 1, jobList->GetMaxParallelJobs());
+    }
+
+    const int batchSize = (numDrawables + numBatches - 1) / numBatches;
+    numBatches = (numDrawables + batchSize - 1) / batchSize;
+
+    if (m_RenderInstanceBatches.Size() < numBatches)
+    {
+        m_RenderInstanceBatches.Resize(numBatches);
+    }
+
+    for (int i = 0; i < numBatches; i++)
+    {
+        RenderInstanceBatch& batch = m_RenderInstanceBatches[i];
+
+        const int firstDrawable = i * batchSize;
+
+        batch.RenderDef = &m_RenderDef;
+        batch.Drawables = &m_VisDrawables[firstDrawable];
+        batch.DrawableCount = Math::Min(batchSize, numDrawables - firstDrawable);
+        batch.FreeInstance = instances + batch.Drawables[0].FirstInstance;
+        batch.FreePayload = payloads + batch.Drawables[0].FirstInstance;
+        batch.Instances.Clear();
+        batch.TranslucentInstances.Clear();
+        batch.OutlineInstances.Clear();
+        batch.PolyCount = 0;
+    }
+
+    if (numBatches > 1)
+    {
+        for (int i = 0; i < numBatches; i++)
+        {
+            jobList->AddJob(GenerateRenderInstancesJob, &m_RenderInstanceBatches[i]);
+        }
+
+        jobList->SubmitAndWait();
+    }
+    else
+    {
+        GenerateRenderInstancesJob(&m_RenderInstanceBatches[0]);
+    }
+
+    // Batches cover contiguous ranges of drawables, so merging them in order gives the same result as serial generation
+    RenderViewData* view = m_RenderDef.View;
+    for (int i = 0; i < numBatches; i++)
+    {
+        RenderInstanceBatch const& batch = m_RenderInstanceBatches[i];
+
+        m_FrameData.Instances.Add(batch.Instances);
+        m_FrameData.TranslucentInstances.Add(batch.TranslucentInstances);
+        m_FrameData.OutlineInstances.Add(batch.OutlineInstances);
+
+        view->InstanceCount += batch.Instances.Size();
+        view->TranslucentInstanceCount += batch.TranslucentInstances.Size();
+        view->OutlineInstanceCount += batch.OutlineInstances.Size();
+
+        m_RenderDef.PolyCount += batch.PolyCount;
+    }
+}
+
+void RenderFrontend::GenerateRenderInstancesJob(void* Data)
+{
+    RenderInstanceBatch& batch = *static_cast<RenderInstanceBatch*>(Data);
+
+    for (int i = 0; i < batch.DrawableCount; i++)
+    {
+        Drawable* drawable = batch.Drawables[i].Component;
+
+        switch (drawable->GetDrawableType())
+        {
+            case DRAWABLE_STATIC_MESH:
+                AddStaticMesh(batch, static_cast<MeshComponent*>(drawable));
+                break;
+            case DRAWABLE_SKINNED_MESH:
+                AddSkinnedMesh(batch, static_cast<SkinnedComponent*>(drawable));
+                break;
+            case DRAWABLE_PROCEDURAL_MESH:
+                AddProceduralMesh(batch, static_cast<ProceduralMeshComponent*>(drawable));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+RenderInstance* RenderFrontend::AddRenderInstance(RenderInstanceBatch& Batch, Material* InMaterial, bool bOutline)
+{
+    RenderInstance* instance = Batch.FreeInstance++;
+
+    instance->Payload = Batch.FreePayload++;
+    instance->InstanceCount = 1;
+
+    if (InMaterial->IsTranslucent())
+    {
+        Batch.TranslucentInstances.Add(instance);
+    }
+    else
+    {
+        Batch.Instances.Add(instance);
+    }
+
+    if (bOutline)
+    {
+        Batch.OutlineInstances.Add(instance);
+    }
+
+    return instance;
 }
 
 void RenderFrontend::AddTerrain(TerrainComponent* InComponent)
@@ -833,23 +1282,52 @@ void RenderFrontend::AddTerrain(TerrainComponent* InComponent)
     view->TerrainInstanceCount++;
 }
 
-void RenderFrontend::AddStaticMesh(MeshComponent* InComponent)
+bool RenderFrontend::IsMeshRenderProxyValid(MeshComponent* InComponent)
 {
-    if (!r_RenderMeshes)
+    MeshRenderProxy const& proxy = InComponent->GetRenderProxy();
+
+    if (!proxy.bValid)
     {
-        return;
+        return false;
     }
 
-    InComponent->PreRenderUpdate(&m_RenderDef);
+    LevelLighting* lighting = InComponent->GetLevel()->Lighting;
 
-    Float3x4 const& componentWorldTransform = InComponent->GetRenderTransformMatrix(m_RenderDef.FrameNumber);
-    Float3x4 const& componentWorldTransformP = InComponent->GetRenderTransformMatrix(m_RenderDef.FrameNumber + 1);
+    // Lighting attributes are public and can be changed without notifying the component
+    if (proxy.Mesh != InComponent->GetMesh() ||
+        proxy.Lighting != lighting ||
+        proxy.LightmapBlock != InComponent->LightmapBlock ||
+        proxy.VertexLightChannel != InComponent->VertexLightChannel ||
+        proxy.SubpartBaseVertexOffset != InComponent->SubpartBaseVertexOffset ||
+        proxy.MeshRevision != proxy.Mesh->GetRevision() ||
+        proxy.VertexMemoryRevision != GEngine->GetVertexMemoryGPU()->GetRevision() ||
+        proxy.MotionBehavior != InComponent->GetMotionBehavior() ||
+        proxy.bHasLightmap != InComponent->bHasLightmap ||
+        proxy.bHasVertexLight != InComponent->bHasVertexLight ||
+        proxy.bVertexLight != r_VertexLight.GetBool())
+    {
+        return false;
+    }
 
-    // TODO: optimize: parallel, sse, check if transformable
-    Float4x4 instanceMatrix = m_RenderDef.View->ViewProjection * componentWorldTransform;
-    Float4x4 instanceMatrixP = m_RenderDef.View->ViewProjectionP * componentWorldTransformP;
+    // Materials of render views can be changed without notifying the component
+    for (MeshRenderProxy::Subpart const& proxySubpart : proxy.Subparts)
+    {
+        MaterialInstance* materialInstance = proxySubpart.View->GetMaterial(proxySubpart.SubpartIndex);
 
-    Float3x3 worldRotation = InComponent->GetWorldRotation().ToMatrix3x3();
+        if (materialInstance != proxySubpart.pMaterialInstance ||
+            materialInstance->GetMaterial() != proxySubpart.pMaterial ||
+            proxySubpart.pMaterial->GetGPUResource() != proxySubpart.Instance.Material)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void RenderFrontend::UpdateMeshRenderProxy(MeshComponent* InComponent)
+{
+    MeshRenderProxy& proxy = InComponent->GetRenderProxy();
 
     Level* level = InComponent->GetLevel();
     LevelLighting* lighting = level->Lighting;
@@ -857,19 +1335,43 @@ void RenderFrontend::AddStaticMesh(MeshComponent* InComponent)
     IndexedMesh* mesh = InComponent->GetMesh();
     IndexedMeshSubpartArray const& subparts = mesh->GetSubparts();
 
+    proxy.Mesh = mesh;
+    proxy.Lighting = lighting;
+    proxy.LightmapBlock = InComponent->LightmapBlock;
+    proxy.VertexLightChannel = InComponent->VertexLightChannel;
+    proxy.SubpartBaseVertexOffset = InComponent->SubpartBaseVertexOffset;
+    proxy.MeshRevision = mesh->GetRevision();
+    proxy.VertexMemoryRevision = GEngine->GetVertexMemoryGPU()->GetRevision();
+    proxy.MotionBehavior = InComponent->GetMotionBehavior();
+    proxy.bHasLightmap = InComponent->bHasLightmap;
+    proxy.bHasVertexLight = InComponent->bHasVertexLight;
+    proxy.bVertexLight = r_VertexLight.GetBool();
+    proxy.bValid = true;
+
     bool bHasLightmap = (lighting &&
                          InComponent->bHasLightmap &&
                          InComponent->LightmapBlock < lighting->Lightmaps.Size() &&
                          !r_VertexLight &&
                          mesh->HasLightmapUVs());
 
-    auto& meshRenderViews = InComponent->GetRenderViews();
+    RenderCore::IBuffer* vertexLightChannel = nullptr;
+    size_t vertexLightOffset = 0;
 
-    for (auto& meshRender : meshRenderViews)
+    if (InComponent->bHasVertexLight)
     {
-        if (!meshRender->IsEnabled())
-            continue;
+        VertexLight* vertexLight = level->GetVertexLight(InComponent->VertexLightChannel);
+        if (vertexLight && vertexLight->GetVertexCount() == mesh->GetVertexCount())
+        {
+            vertexLight->GetVertexBufferGPU(&vertexLightChannel, &vertexLightOffset);
+        }
+    }
+
+    uint8_t geometryPriority = InComponent->GetMotionBehavior() != MB_STATIC ? RENDERING_GEOMETRY_PRIORITY_DYNAMIC : RENDERING_GEOMETRY_PRIORITY_STATIC;
+
+    proxy.Subparts.Clear();
 
+    for (auto& meshRender : InComponent->GetRenderViews())
+    {
         for (int subpartIndex = 0, count = subparts.Size(); subpartIndex < count; subpartIndex++)
         {
             IndexedMeshSubpart* subpart = subparts[subpartIndex];
@@ -877,97 +1379,100 @@ void RenderFrontend::AddStaticMesh(MeshComponent* InComponent)
             MaterialInstance* materialInstance = meshRender->GetMaterial(subpartIndex);
             HK_ASSERT(materialInstance);
 
-            MaterialFrameData* materialInstanceFrameData = materialInstance->PreRenderUpdate(m_FrameLoop, m_FrameNumber);
-            if (!materialInstanceFrameData)
-                continue;
-
             Material* material = materialInstance->GetMaterial();
 
-            // Add render instance
-            RenderInstance* instance = (RenderInstance*)m_FrameLoop->AllocFrameMem(sizeof(RenderInstance));
-
-            if (material->IsTranslucent())
-            {
-                m_FrameData.TranslucentInstances.Add(instance);
-                m_RenderDef.View->TranslucentInstanceCount++;
-            }
-            else
-            {
-                m_FrameData.Instances.Add(instance);
-                m_RenderDef.View->InstanceCount++;
-            }
+            MeshRenderProxy::Subpart& proxySubpart = proxy.Subparts.Add();
+            proxySubpart.View = meshRender;
+            proxySubpart.SubpartIndex = subpartIndex;
+            proxySubpart.pMaterialInstance = materialInstance;
+            proxySubpart.pMaterial = material;
 
-            if (InComponent->bOutline)
-            {
-                m_FrameData.OutlineInstances.Add(instance);
-                m_RenderDef.View->OutlineInstanceCount++;
-            }
+            RenderInstance& instance = proxySubpart.Instance;
 
-            instance->Material = material->GetGPUResource();
-            instance->MaterialInstance = materialInstanceFrameData;
+            instance.Material = material->GetGPUResource();
+            instance.MaterialInstance = nullptr;
 
-            mesh->GetVertexBufferGPU(&instance->VertexBuffer, &instance->VertexBufferOffset);
-            mesh->GetIndexBufferGPU(&instance->IndexBuffer, &instance->IndexBufferOffset);
-            mesh->GetWeightsBufferGPU(&instance->WeightsBuffer, &instance->WeightsBufferOffset);
+            mesh->GetVertexBufferGPU(&instance.VertexBuffer, &instance.VertexBufferOffset);
+            mesh->GetIndexBufferGPU(&instance.IndexBuffer, &instance.IndexBufferOffset);
+            instance.IndexType = mesh->GetIndexType();
+            mesh->GetWeightsBufferGPU(&instance.WeightsBuffer, &instance.WeightsBufferOffset);
 
             if (bHasLightmap)
             {
-                mesh->GetLightmapUVsGPU(&instance->LightmapUVChannel, &instance->LightmapUVOffset);
-                instance->LightmapOffset = InComponent->LightmapOffset;
-                instance->Lightmap = lighting->Lightmaps[InComponent->LightmapBlock];
+                mesh->GetLightmapUVsGPU(&instance.LightmapUVChannel, &instance.LightmapUVOffset);
+                instance.Lightmap = lighting->Lightmaps[InComponent->LightmapBlock];
             }
             else
             {
-                instance->LightmapUVChannel = nullptr;
-                instance->Lightmap = nullptr;
+                instance.LightmapUVChannel = nullptr;
+                instance.Lightmap = nullptr;
             }
 
-            if (InComponent->bHasVertexLight)
-            {
-                VertexLight* vertexLight = level->GetVertexLight(InComponent->VertexLightChannel);
-                if (vertexLight && vertexLight->GetVertexCount() == mesh->GetVertexCount())
-                {
-                    vertexLight->GetVertexBufferGPU(&instance->VertexLightChannel, &instance->VertexLightOffset);
-                }
-            }
-            else
-            {
-                instance->VertexLightChannel = nullptr;
-            }
+            instance.VertexLightChannel = vertexLightChannel;
+            instance.VertexLightOffset = vertexLightOffset;
 
-            instance->IndexCount = subpart->GetIndexCount();
-            instance->StartIndexLocation = subpart->GetFirstIndex();
-            instance->BaseVertexLocation = subpart->GetBaseVertex() + InComponent->SubpartBaseVertexOffset;
-            instance->SkeletonOffset = 0;
-            instance->SkeletonOffsetMB = 0;
-            instance->SkeletonSize = 0;
-            instance->Matrix = instanceMatrix;
-            instance->MatrixP = instanceMatrixP;
-            instance->ModelNormalToViewSpace = m_RenderDef.View->NormalToViewMatrix * worldRotation;
+            instance.IndexCount = subpart->GetIndexCount();
+            instance.StartIndexLocation = subpart->GetFirstIndex();
+            instance.BaseVertexLocation = subpart->GetBaseVertex() + InComponent->SubpartBaseVertexOffset;
+            instance.SkeletonOffset = 0;
+            instance.SkeletonSize = 0;
+            instance.PackedVertices = mesh->GetVertexQuantization();
+            instance.InstanceCount = 1;
 
-            uint8_t priority = material->GetRenderingPriority();
-            if (InComponent->GetMotionBehavior() != MB_STATIC)
-            {
-                priority |= RENDERING_GEOMETRY_PRIORITY_DYNAMIC;
-            }
-
-            instance->GenerateSortKey(priority, (uint64_t)mesh);
-
-            m_RenderDef.PolyCount += instance->IndexCount / 3;
+            // Material frame data changes every frame, so the material instance is used for the key
+            instance.GenerateSortKey(material->GetRenderingPriority() | geometryPriority, (uint64_t)materialInstance, (uint64_t)mesh);
         }
     }
 }
 
-void RenderFrontend::AddSkinnedMesh(SkinnedComponent* InComponent)
+void RenderFrontend::AddStaticMesh(RenderInstanceBatch& Batch, MeshComponent* InComponent)
 {
-    IndexedMesh* mesh = InComponent->GetMesh();
+    RenderFrontendDef const* renderDef = Batch.RenderDef;
 
-    if (!r_RenderMeshes)
+    Float3x4 const& componentWorldTransform = InComponent->GetRenderTransformMatrix(renderDef->FrameNumber);
+    Float3x4 const& componentWorldTransformP = InComponent->GetRenderTransformMatrix(renderDef->FrameNumber + 1);
+
+    // TODO: optimize: sse, check if transformable
+    Float4x4 instanceMatrix = renderDef->View->ViewProjection * componentWorldTransform;
+    Float4x4 instanceMatrixP = renderDef->View->ViewProjectionP * componentWorldTransformP;
+
+    Float3x3 modelNormalToViewSpace = renderDef->View->NormalToViewMatrix * InComponent->GetWorldRotation().ToMatrix3x3();
+
+    // The proxy is validated in PrepareMesh
+    for (MeshRenderProxy::Subpart const& proxySubpart : InComponent->GetRenderProxy().Subparts)
     {
-        return;
+        if (!proxySubpart.View->IsEnabled())
+            continue;
+
+        MaterialFrameData* materialInstanceFrameData = proxySubpart.pMaterialInstance->GetFrameData(renderDef->FrameNumber);
+        if (!materialInstanceFrameData)
+            continue;
+
+        // Add render instance
+        RenderInstance* instance = AddRenderInstance(Batch, proxySubpart.pMaterial, InComponent->bOutline);
+
+        RenderInstancePayload* payload = instance->Payload;
+
+        *instance = proxySubpart.Instance;
+
+        instance->MaterialInstance = materialInstanceFrameData;
+        instance->Payload = payload;
+
+        payload->Matrix = instanceMatrix;
+        payload->MatrixP = instanceMatrixP;
+        payload->ModelNormalToViewSpace = modelNormalToViewSpace;
+        payload->LightmapOffset = InComponent->LightmapOffset;
+        payload->SkeletonOffsetMB = 0;
+
+        Batch.PolyCount += instance->IndexCount / 3;
     }
+}
 
-    InComponent->PreRenderUpdate(&m_RenderDef);
+void RenderFrontend::AddSkinnedMesh(RenderInstanceBatch& Batch, SkinnedComponent* InComponent)
+{
+    RenderFrontendDef const* renderDef = Batch.RenderDef;
+
+    IndexedMesh* mesh = InComponent->GetMesh();
 
     size_t skeletonOffset = 0;
     size_t skeletonOffsetMB = 0;
@@ -975,12 +1480,12 @@ void RenderFrontend::AddSkinnedMesh(SkinnedComponent* InComponent)
 
     InComponent->GetSkeletonHandle(skeletonOffset, skeletonOffsetMB, skeletonSize);
 
-    Float3x4 const& componentWorldTransform = InComponent->GetRenderTransformMatrix(m_RenderDef.FrameNumber);
-    Float3x4 const& componentWorldTransformP = InComponent->GetRenderTransformMatrix(m_RenderDef.FrameNumber + 1);
+    Float3x4 const& componentWorldTransform = InComponent->GetRenderTransformMatrix(renderDef->FrameNumber);
+    Float3x4 const& componentWorldTransformP = InComponent->GetRenderTransformMatrix(renderDef->FrameNumber + 1);
 
-    // TODO: optimize: parallel, sse, check if transformable
-    Float4x4 instanceMatrix = m_RenderDef.View->ViewProjection * componentWorldTransform;
-    Float4x4 instanceMatrixP = m_RenderDef.View->ViewProjectionP * componentWorldTransformP;
+    // TODO: optimize: sse, check if transformable
+    Float4x4 instanceMatrix = renderDef->View->ViewProjection * componentWorldTransform;
+    Float4x4 instanceMatrixP = renderDef->View->ViewProjectionP * componentWorldTransformP;
 
     Float3x3 worldRotation = InComponent->GetWorldRotation().ToMatrix3x3();
 
@@ -1000,31 +1505,14 @@ void RenderFrontend::AddSkinnedMesh(SkinnedComponent* InComponent)
             MaterialInstance* materialInstance = meshRender->GetMaterial(subpartIndex);
             HK_ASSERT(materialInstance);
 
-            MaterialFrameData* materialInstanceFrameData = materialInstance->PreRenderUpdate(m_FrameLoop, m_FrameNumber);
+            MaterialFrameData* materialInstanceFrameData = materialInstance->GetFrameData(renderDef->FrameNumber);
             if (!materialInstanceFrameData)
                 continue;
 
             Material* material = materialInstance->GetMaterial();
 
             // Add render instance
-            RenderInstance* instance = (RenderInstance*)m_FrameLoop->AllocFrameMem(sizeof(RenderInstance));
-
-            if (material->IsTranslucent())
-            {
-                m_FrameData.TranslucentInstances.Add(instance);
-                m_RenderDef.View->TranslucentInstanceCount++;
-            }
-            else
-            {
-                m_FrameData.Instances.Add(instance);
-                m_RenderDef.View->InstanceCount++;
-            }
-
-            if (InComponent->bOutline)
-            {
-                m_FrameData.OutlineInstances.Add(instance);
-                m_RenderDef.View->OutlineInstanceCount++;
-            }
+            RenderInstance* instance = AddRenderInstance(Batch, material, InComponent->bOutline);
 
             instance->Material = material->GetGPUResource();
             instance->MaterialInstance = materialInstanceFrameData;
@@ -1034,6 +1522,7 @@ void RenderFrontend::AddSkinnedMesh(SkinnedComponent* InComponent)
 
             mesh->GetVertexBufferGPU(&instance->VertexBuffer, &instance->VertexBufferOffset);
             mesh->GetIndexBufferGPU(&instance->IndexBuffer, &instance->IndexBufferOffset);
+            instance->IndexType = mesh->GetIndexType();
             mesh->GetWeightsBufferGPU(&instance->WeightsBuffer, &instance->WeightsBufferOffset);
 
             instance->LightmapUVChannel = nullptr;
@@ -1043,11 +1532,12 @@ void RenderFrontend::AddSkinnedMesh(SkinnedComponent* InComponent)
             instance->StartIndexLocation = subpart->GetFirstIndex();
             instance->BaseVertexLocation = subpart->GetBaseVertex();
             instance->SkeletonOffset = skeletonOffset;
-            instance->SkeletonOffsetMB = skeletonOffsetMB;
+            instance->Payload->SkeletonOffsetMB = skeletonOffsetMB;
             instance->SkeletonSize = skeletonSize;
-            instance->Matrix = instanceMatrix;
-            instance->MatrixP = instanceMatrixP;
-            instance->ModelNormalToViewSpace = m_RenderDef.View->NormalToViewMatrix * worldRotation;
+            instance->PackedVertices = mesh->GetVertexQuantization();
+            instance->Payload->Matrix = instanceMatrix;
+            instance->Payload->MatrixP = instanceMatrixP;
+            instance->Payload->ModelNormalToViewSpace = renderDef->View->NormalToViewMatrix * worldRotation;
 
             uint8_t priority = material->GetRenderingPriority();
 
@@ -1056,39 +1546,24 @@ void RenderFrontend::AddSkinnedMesh(SkinnedComponent* InComponent)
 
             instance->GenerateSortKey(priority, (uint64_t)mesh);
 
-            m_RenderDef.PolyCount += instance->IndexCount / 3;
+            Batch.PolyCount += instance->IndexCount / 3;
         }
     }
 }
 
-void RenderFrontend::AddProceduralMesh(ProceduralMeshComponent* InComponent)
+void RenderFrontend::AddProceduralMesh(RenderInstanceBatch& Batch, ProceduralMeshComponent* InComponent)
 {
-    if (!r_RenderMeshes)
-    {
-        return;
-    }
-
-    InComponent->PreRenderUpdate(&m_RenderDef);
+    RenderFrontendDef const* renderDef = Batch.RenderDef;
 
+    // The mesh was updated by PrepareProceduralMesh
     ProceduralMesh* mesh = InComponent->GetMesh();
-    if (!mesh)
-    {
-        return;
-    }
 
-    mesh->PreRenderUpdate(&m_RenderDef);
+    Float3x4 const& componentWorldTransform = InComponent->GetRenderTransformMatrix(renderDef->FrameNumber);
+    Float3x4 const& componentWorldTransformP = InComponent->GetRenderTransformMatrix(renderDef->FrameNumber + 1);
 
-    if (mesh->IndexCache.IsEmpty())
-    {
-        return;
-    }
-
-    Float3x4 const& componentWorldTransform = InComponent->GetRenderTransformMatrix(m_RenderDef.FrameNumber);
-    Float3x4 const& componentWorldTransformP = InComponent->GetRenderTransformMatrix(m_RenderDef.FrameNumber + 1);
-
-    // TODO: optimize: parallel, sse, check if transformable
-    Float4x4 instanceMatrix = m_RenderDef.View->ViewProjection * componentWorldTransform;
-    Float4x4 instanceMatrixP = m_RenderDef.View->ViewProjectionP * componentWorldTransformP;
+    // TODO: optimize: sse, check if transformable
+    Float4x4 instanceMatrix = renderDef->View->ViewProjection * componentWorldTransform;
+    Float4x4 instanceMatrixP = renderDef->View->ViewProjectionP * componentWorldTransformP;
 
     auto& meshRenderViews = InComponent->GetRenderViews();
 
@@ -1100,37 +1575,21 @@ void RenderFrontend::AddProceduralMesh(ProceduralMeshComponent* InComponent)
         MaterialInstance* materialInstance = meshRender->GetMaterial();
         HK_ASSERT(materialInstance);
 
-        MaterialFrameData* materialInstanceFrameData = materialInstance->PreRenderUpdate(m_FrameLoop, m_FrameNumber);
+        MaterialFrameData* materialInstanceFrameData = materialInstance->GetFrameData(renderDef->FrameNumber);
         if (!materialInstanceFrameData)
             return;
 
         Material* material = materialInstance->GetMaterial();
 
         // Add render instance
-        RenderInstance* instance = (RenderInstance*)m_FrameLoop->AllocFrameMem(sizeof(RenderInstance));
-
-        if (material->IsTranslucent())
-        {
-            m_FrameData.TranslucentInstances.Add(instance);
-            m_RenderDef.View->TranslucentInstanceCount++;
-        }
-        else
-        {
-            m_FrameData.Instances.Add(instance);
-            m_RenderDef.View->InstanceCount++;
-        }
-
-        if (InComponent->bOutline)
-        {
-            m_FrameData.OutlineInstances.Add(instance);
-            m_RenderDef.View->OutlineInstanceCount++;
-        }
+        RenderInstance* instance = AddRenderInstance(Batch, material, InComponent->bOutline);
 
         instance->Material = material->GetGPUResource();
         instance->MaterialInstance = materialInstanceFrameData;
 
-        mesh->GetVertexBufferGPU(m_RenderDef.StreamedMemory, &instance->VertexBuffer, &instance->VertexBufferOffset);
-        mesh->GetIndexBufferGPU(m_RenderDef.StreamedMemory, &instance->IndexBuffer, &instance->IndexBufferOffset);
+        mesh->GetVertexBufferGPU(renderDef->StreamedMemory, &instance->VertexBuffer, &instance->VertexBufferOffset);
+        mesh->GetIndexBufferGPU(renderDef->StreamedMemory, &instance->IndexBuffer, &instance->IndexBufferOffset);
+        instance->IndexType = mesh->GetIndexType();
 
         instance->WeightsBuffer = nullptr;
         instance->WeightsBufferOffset = 0;
@@ -1141,11 +1600,12 @@ void RenderFrontend::AddProceduralMesh(ProceduralMeshComponent* InComponent)
         instance->StartIndexLocation = 0;
         instance->BaseVertexLocation = 0;
         instance->SkeletonOffset = 0;
-        instance->SkeletonOffsetMB = 0;
+        instance->Payload->SkeletonOffsetMB = 0;
         instance->SkeletonSize = 0;
-        instance->Matrix = instanceMatrix;
-        instance->MatrixP = instanceMatrixP;
-        instance->ModelNormalToViewSpace = m_RenderDef.View->NormalToViewMatrix * InComponent->GetWorldRotation().ToMatrix3x3();
+        instance->PackedVertices = nullptr;
+        instance->Payload->Matrix = instanceMatrix;
+        instance->Payload->MatrixP = instanceMatrixP;
+        instance->Payload->ModelNormalToViewSpace = renderDef->View->NormalToViewMatrix * InComponent->GetWorldRotation().ToMatrix3x3();
 
         uint8_t priority = material->GetRenderingPriority();
         if (InComponent->GetMotionBehavior() != MB_STATIC)
@@ -1155,7 +1615,7 @@ void RenderFrontend::AddProceduralMesh(ProceduralMeshComponent* InComponent)
 
         instance->GenerateSortKey(priority, (uint64_t)mesh);
 
-        m_RenderDef.PolyCount += instance->IndexCount / 3;
+        Batch.PolyCount += instance->IndexCount / 3;
     }
 }
 
@@ -1212,6 +1672,7 @@ void RenderFrontend::AddShadowmap_StaticMesh(LightShadowmap* ShadowMap, MeshComp
 
             mesh->GetVertexBufferGPU(&instance->VertexBuffer, &instance->VertexBufferOffset);
             mesh->GetIndexBufferGPU(&instance->IndexBuffer, &instance->IndexBufferOffset);
+            instance->IndexType = mesh->GetIndexType();
             mesh->GetWeightsBufferGPU(&instance->WeightsBuffer, &instance->WeightsBufferOffset);
 
             instance->IndexCount = subpart->GetIndexCount();
@@ -1219,6 +1680,7 @@ void RenderFrontend::AddShadowmap_StaticMesh(LightShadowmap* ShadowMap, MeshComp
             instance->BaseVertexLocation = subpart->GetBaseVertex() + InComponent->SubpartBaseVertexOffset;
             instance->SkeletonOffset = 0;
             instance->SkeletonSize = 0;
+            instance->PackedVertices = mesh->GetVertexQuantization();
             instance->WorldTransformMatrix = instanceMatrix;
             instance->CascadeMask = InComponent->CascadeMask;
 
@@ -1297,6 +1759,7 @@ void RenderFrontend::AddShadowmap_SkinnedMesh(LightShadowmap* ShadowMap, Skinned
 
             mesh->GetVertexBufferGPU(&instance->VertexBuffer, &instance->VertexBufferOffset);
             mesh->GetIndexBufferGPU(&instance->IndexBuffer, &instance->IndexBufferOffset);
+            instance->IndexType = mesh->GetIndexType();
             mesh->GetWeightsBufferGPU(&instance->WeightsBuffer, &instance->WeightsBufferOffset);
 
             instance->IndexCount = subpart->GetIndexCount();
@@ -1305,6 +1768,7 @@ void RenderFrontend::AddShadowmap_SkinnedMesh(LightShadowmap* ShadowMap, Skinned
 
             instance->SkeletonOffset = skeletonOffset;
             instance->SkeletonSize = skeletonSize;
+            instance->PackedVertices = mesh->GetVertexQuantization();
             instance->WorldTransformMatrix = instanceMatrix;
             instance->CascadeMask = InComponent->CascadeMask;
 
@@ -1376,6 +1840,7 @@ void RenderFrontend::AddShadowmap_ProceduralMesh(LightShadowmap* ShadowMap, Proc
 
         mesh->GetVertexBufferGPU(m_RenderDef.StreamedMemory, &instance->VertexBuffer, &instance->VertexBufferOffset);
         mesh->GetIndexBufferGPU(m_RenderDef.StreamedMemory, &instance->IndexBuffer, &instance->IndexBufferOffset);
+        instance->IndexType = mesh->GetIndexType();
 
         instance->WeightsBuffer = nullptr;
         instance->WeightsBufferOffset = 0;
@@ -1385,6 +1850,7 @@ void RenderFrontend::AddShadowmap_ProceduralMesh(LightShadowmap* ShadowMap, Proc
         instance->BaseVertexLocation = 0;
         instance->SkeletonOffset = 0;
         instance->SkeletonSize = 0;
+        instance->PackedVertices = nullptr;
         instance->WorldTransformMatrix = InComponent->GetWorldTransformMatrix();
         instance->CascadeMask = InComponent->CascadeMask;
 
@@ -1403,6 +1869,22 @@ void RenderFrontend::AddShadowmap_ProceduralMesh(LightShadowmap* ShadowMap, Proc
     }
 }
 
+struct ShadowCascadeCullWork
+{
+    BvFrustum const* Frustum;
+    BvAxisAlignedBoxSSE const* Boxes;
+    int Count;
+    int32_t* Result;
+    int CascadeIndex;
+};
+
+void RenderFrontend::CullShadowCascadeJob(void* Data)
+{
+    ShadowCascadeCullWork* work = static_cast<ShadowCascadeCullWork*>(Data);
+
+    work->Frustum->CullBox_SSE(work->Boxes, work->Count, work->Result);
+}
+
 void RenderFrontend::AddDirectionalShadowmapInstances(World* InWorld)
 {
     if (!m_RenderDef.View->NumShadowMapCascades)
@@ -1414,31 +1896,23 @@ void RenderFrontend::AddDirectionalShadowmapInstances(World* InWorld)
 
     // Create shadow instances
 
-    m_ShadowCasters.Clear();
-    m_ShadowBoxes.Clear();
-
     LightingSystem& lightingSystem = InWorld->LightingSystem;
 
-    for (TListIterator<Drawable> component(lightingSystem.ShadowCasters); component; component++)
-    {
-        if ((component->GetVisibilityGroup() & m_RenderDef.VisibilityMask) == 0)
-        {
-            continue;
-        }
-        //component->CascadeMask = 0;
-
-        m_ShadowCasters.Add(*component);
-        m_ShadowBoxes.Add(component->GetWorldBounds());
-    }
-
-    if (m_ShadowBoxes.IsEmpty())
+    TVector<Drawable*> const& shadowCasters = lightingSystem.GetShadowCasters();
+    if (shadowCasters.IsEmpty())
         return;
 
-    m_ShadowBoxes.Resize(Align(m_ShadowBoxes.Size(), 4));
+    const int numCasters = shadowCasters.Size();
+    BvAxisAlignedBoxSSE const* shadowBoxes = lightingSystem.GetShadowCasterBounds().ToPtr();
+    uint32_t const* moveStamps = lightingSystem.GetShadowCasterMoveStamps().ToPtr();
 
-    m_ShadowCasterCullResult.ResizeInvalidate(m_ShadowBoxes.Size() / 4);
+    if (lightingSystem.ShadowCascadeCaches.Size() < m_RenderDef.View->NumDirectionalLights)
+    {
+        lightingSystem.ShadowCascadeCaches.Resize(m_RenderDef.View->NumDirectionalLights);
+    }
 
-    BvFrustum frustum;
+    BvFrustum frustum[MAX_SHADOW_CASCADES];
+    ShadowCascadeCullWork works[MAX_SHADOW_CASCADES];
 
     for (int lightIndex = 0; lightIndex < m_RenderDef.View->NumDirectionalLights; lightIndex++)
     {
@@ -1462,33 +1936,109 @@ void RenderFrontend::AddDirectionalShadowmapInstances(World* InWorld)
 
         Float4x4* lightViewProjectionMatrices = (Float4x4*)streamedMemory->Map(lightDef->ViewProjStreamHandle);
 
-        // Perform culling for each cascade
-        // TODO: Do it parallel (jobs)
+        ShadowCascadeCache& cache = lightingSystem.ShadowCascadeCaches[lightIndex];
+
+        bool bValidCache = cache.Revision == lightingSystem.GetShadowCastersRevision();
+        if (!bValidCache)
+        {
+            cache.CascadeMasks.ResizeInvalidate(numCasters);
+            cache.CascadeMasks.ZeroMem();
+            cache.Revision = lightingSystem.GetShadowCastersRevision();
+        }
+
+        // Cull the cascades that have changed since the previous frame in parallel
+        uint32_t unchangedCascades = 0;
+        int numWorks = 0;
         for (int cascadeIndex = 0; cascadeIndex < lightDef->NumCascades; cascadeIndex++)
         {
-            frustum.FromMatrix(lightViewProjectionMatrices[cascadeIndex]);
+            frustum[cascadeIndex].FromMatrix(lightViewProjectionMatrices[cascadeIndex]);
 
-            m_ShadowCasterCullResult.ZeroMem();
+            if (bValidCache && cascadeIndex < cache.NumCascades && cache.ViewProjection[cascadeIndex] == lightViewProjectionMatrices[cascadeIndex])
+            {
+                // Cascade is unchanged, only moved casters need to be culled
+                unchangedCascades |= 1 << cascadeIndex;
+                continue;
+            }
 
-            frustum.CullBox_SSE(m_ShadowBoxes.ToPtr(), m_ShadowCasters.Size(), &m_ShadowCasterCullResult[0].Result[0]);
-            //frustum.CullBox_Generic( m_ShadowBoxes.ToPtr(), m_ShadowCasters.Size(), m_ShadowCasterCullResult.ToPtr() );
+            cache.ViewProjection[cascadeIndex] = lightViewProjectionMatrices[cascadeIndex];
+
+            m_ShadowCascadeCullResult[cascadeIndex].ResizeInvalidate(Align(numCasters, 4) / 4);
+
+            ShadowCascadeCullWork& work = works[numWorks++];
+            work.Frustum = &frustum[cascadeIndex];
+            work.Boxes = shadowBoxes;
+            work.Count = numCasters;
+            work.Result = &m_ShadowCascadeCullResult[cascadeIndex][0].Result[0];
+            work.CascadeIndex = cascadeIndex;
+
+            GEngine->pRenderFrontendJobList->AddJob(CullShadowCascadeJob, &work);
+        }
+
+        if (numWorks > 0)
+        {
+            GEngine->pRenderFrontendJobList->SubmitAndWait();
+        }
 
-            for (int n = 0, n2 = 0; n < m_ShadowCasters.Size(); n += 4, n2++)
+        // Merge culling results
+        const uint32_t cascadeBits = (1u << lightDef->NumCascades) - 1;
+        for (int w = 0; w < numWorks; w++)
+        {
+            const int cascadeIndex = works[w].CascadeIndex;
+            const uint32_t cascadeBit = 1u << cascadeIndex;
+            int32_t const* cullResult = works[w].Result;
+
+            for (int n = 0; n < numCasters; n++)
+            {
+                cache.CascadeMasks[n] = (cache.CascadeMasks[n] & ~cascadeBit) | (cullResult[n] == 0 ? cascadeBit : 0);
+            }
+        }
+
+        if (unchangedCascades && cache.MoveStamp != lightingSystem.GetShadowCastersMoveStamp())
+        {
+            for (int n = 0; n < numCasters; n++)
             {
-                for (int t = 0; t < 4 && n + t < m_ShadowCasters.Size(); t++)
-                    m_ShadowCasters[n + t]->CascadeMask |= (m_ShadowCasterCullResult[n2].Result[t] == 0) << cascadeIndex;
+                if (moveStamps[n] <= cache.MoveStamp)
+                {
+                    continue;
+                }
+
+                BvAxisAlignedBoxSSE const& box = shadowBoxes[n];
+
+                for (int cascadeIndex = 0; cascadeIndex < lightDef->NumCascades; cascadeIndex++)
+                {
+                    const uint32_t cascadeBit = 1u << cascadeIndex;
+
+                    if (unchangedCascades & cascadeBit)
+                    {
+                        bool bVisible = frustum[cascadeIndex].IsBoxVisible(box.Mins, box.Maxs);
+
+                        cache.CascadeMasks[n] = (cache.CascadeMasks[n] & ~cascadeBit) | (bVisible ? cascadeBit : 0);
+                    }
+                }
             }
         }
 
-        for (int n = 0; n < m_ShadowCasters.Size(); n++)
+        cache.NumCascades = lightDef->NumCascades;
+        cache.MoveStamp = lightingSystem.GetShadowCastersMoveStamp();
+
+        for (int n = 0; n < numCasters; n++)
         {
-            Drawable* component = m_ShadowCasters[n];
+            uint32_t cascadeMask = cache.CascadeMasks[n] & cascadeBits;
+
+            if (cascadeMask == 0)
+            {
+                continue;
+            }
+
+            Drawable* component = shadowCasters[n];
 
-            if (component->CascadeMask == 0)
+            if ((component->GetVisibilityGroup() & m_RenderDef.VisibilityMask) == 0)
             {
                 continue;
             }
 
+            component->CascadeMask = cascadeMask;
+
             switch (component->GetDrawableType())
             {
                 case DRAWABLE_STATIC_MESH:
@@ -1534,6 +2084,7 @@ void RenderFrontend::AddDirectionalShadowmapInstances(World* InWorld)
             instance->VertexBufferOffset = 0;
             instance->IndexBuffer = lighting->GetShadowCasterIB();
             instance->IndexBufferOffset = 0;
+            instance->IndexType = RenderCore::INDEX_TYPE_UINT32;
             instance->WeightsBuffer = nullptr;
             instance->WeightsBufferOffset = 0;
             instance->IndexCount = lighting->GetShadowCasterIndexCount();
@@ -1541,6 +2092,7 @@ void RenderFrontend::AddDirectionalShadowmapInstances(World* InWorld)
             instance->BaseVertexLocation = 0;
             instance->SkeletonOffset = 0;
             instance->SkeletonSize = 0;
+            instance->PackedVertices = nullptr;
             instance->WorldTransformMatrix.SetIdentity();
             instance->CascadeMask = 0xffff; // TODO: Calculate!!!
             instance->SortKey = 0;
@@ -1550,9 +2102,7 @@ void RenderFrontend::AddDirectionalShadowmapInstances(World* InWorld)
             m_RenderDef.ShadowMapPolyCount += instance->IndexCount / 3;
         }
 
-        std::sort(m_FrameData.ShadowInstances.Begin() + shadowMap->FirstShadowInstance,
-                  m_FrameData.ShadowInstances.Begin() + (shadowMap->FirstShadowInstance + shadowMap->ShadowInstanceCount),
-                  ShadowInstanceSortFunction);
+        SortByKey(m_FrameData.ShadowInstances.ToPtr() + shadowMap->FirstShadowInstance, shadowMap->ShadowInstanceCount);
 
         if (r_RenderLightPortals)
         {
@@ -1826,6 +2376,10 @@ void RenderFrontend::AddSurface(Level* Level, MaterialInstance* MaterialInstance
 
     // Add render instance
     RenderInstance* instance = (RenderInstance*)m_FrameLoop->AllocFrameMem(sizeof(RenderInstance));
+    RenderInstancePayload* payload = (RenderInstancePayload*)m_FrameLoop->AllocFrameMem(sizeof(RenderInstancePayload));
+
+    instance->Payload = payload;
+    instance->InstanceCount = 1;
 
     if (material->IsTranslucent())
     {
@@ -1850,13 +2404,14 @@ void RenderFrontend::AddSurface(Level* Level, MaterialInstance* MaterialInstance
 
     streamedMemory->GetPhysicalBufferAndOffset(SurfaceStream.VertexAddr, &instance->VertexBuffer, &instance->VertexBufferOffset);
     streamedMemory->GetPhysicalBufferAndOffset(SurfaceStream.IndexAddr, &instance->IndexBuffer, &instance->IndexBufferOffset);
+    instance->IndexType = RenderCore::INDEX_TYPE_UINT32;
 
     instance->WeightsBuffer = nullptr;
 
-    instance->LightmapOffset.X = 0;
-    instance->LightmapOffset.Y = 0;
-    instance->LightmapOffset.Z = 1;
-    instance->LightmapOffset.W = 1;
+    payload->LightmapOffset.X = 0;
+    payload->LightmapOffset.Y = 0;
+    payload->LightmapOffset.Z = 1;
+    payload->LightmapOffset.W = 1;
 
     LevelLighting* lighting = Level->Lighting;
     if (lighting && _LightmapBlock >= 0 && _LightmapBlock < lighting->Lightmaps.Size() && !r_VertexLight)
@@ -1877,11 +2432,13 @@ void RenderFrontend::AddSurface(Level* Level, MaterialInstance* MaterialInstance
     instance->StartIndexLocation = _FirstIndex;
     instance->BaseVertexLocation = 0;
     instance->SkeletonOffset = 0;
-    instance->SkeletonOffsetMB = 0;
     instance->SkeletonSize = 0;
-    instance->Matrix = m_RenderDef.View->ViewProjection;
-    instance->MatrixP = m_RenderDef.View->ViewProjectionP;
-    instance->ModelNormalToViewSpace = m_RenderDef.View->NormalToViewMatrix;
+    instance->PackedVertices = nullptr;
+
+    payload->SkeletonOffsetMB = 0;
+    payload->Matrix = m_RenderDef.View->ViewProjection;
+    payload->MatrixP = m_RenderDef.View->ViewProjectionP;
+    payload->ModelNormalToViewSpace = m_RenderDef.View->NormalToViewMatrix;
 
     uint8_t priority = material->GetRenderingPriority();
 
@@ -1910,6 +2467,7 @@ void RenderFrontend::AddShadowmapSurface(LightShadowmap* ShadowMap, MaterialInst
 
     streamedMemory->GetPhysicalBufferAndOffset(SurfaceStream.VertexAddr, &instance->VertexBuffer, &instance->VertexBufferOffset);
     streamedMemory->GetPhysicalBufferAndOffset(SurfaceStream.IndexAddr, &instance->IndexBuffer, &instance->IndexBufferOffset);
+    instance->IndexType = RenderCore::INDEX_TYPE_UINT32;
 
     instance->WeightsBuffer = nullptr;
     instance->WeightsBufferOffset = 0;
@@ -1919,6 +2477,7 @@ void RenderFrontend::AddShadowmapSurface(LightShadowmap* ShadowMap, MaterialInst
     instance->BaseVertexLocation = 0;
     instance->SkeletonOffset = 0;
     instance->SkeletonSize = 0;
+    instance->PackedVertices = nullptr;
     instance->CascadeMask = 0xffff; // TODO?
 
     uint8_t priority = material->GetRenderingPriority();
@@ -1978,59 +2537,46 @@ bool RenderFrontend::AddLightShadowmap(PunctualLightComponent* Light, float Radi
         shadowMap->LightPortalsCount = 0;
         shadowMap->LightPosition = lightPos;
 
-        for (PrimitiveDef* primitive : m_VisPrimitives)
+        for (PrimitiveDef* primitive : m_VisPrimitives[VSD_PRIMITIVE_KIND_DRAWABLE])
         {
-            // TODO: Replace upcasting by something better (virtual function?)
+            drawable = static_cast<Drawable*>(primitive->Owner);
 
-            if (nullptr != (drawable = Upcast<Drawable>(primitive->Owner)))
-            {
-                drawable->CascadeMask = 1 << faceIndex;
+            drawable->CascadeMask = 1 << faceIndex;
 
-                switch (drawable->GetDrawableType())
-                {
-                    case DRAWABLE_STATIC_MESH:
-                        AddShadowmap_StaticMesh(shadowMap, static_cast<MeshComponent*>(drawable));
-                        break;
-                    case DRAWABLE_SKINNED_MESH:
-                        AddShadowmap_SkinnedMesh(shadowMap, static_cast<SkinnedComponent*>(drawable));
-                        break;
-                    case DRAWABLE_PROCEDURAL_MESH:
-                        AddShadowmap_ProceduralMesh(shadowMap, static_cast<ProceduralMeshComponent*>(drawable));
-                        break;
-                    default:
-                        break;
-                }
+            switch (drawable->GetDrawableType())
+            {
+                case DRAWABLE_STATIC_MESH:
+                    AddShadowmap_StaticMesh(shadowMap, static_cast<MeshComponent*>(drawable));
+                    break;
+                case DRAWABLE_SKINNED_MESH:
+                    AddShadowmap_SkinnedMesh(shadowMap, static_cast<SkinnedComponent*>(drawable));
+                    break;
+                case DRAWABLE_PROCEDURAL_MESH:
+                    AddShadowmap_ProceduralMesh(shadowMap, static_cast<ProceduralMeshComponent*>(drawable));
+                    break;
+                default:
+                    break;
+            }
 
 #if 0
-                m_DebugDraw.SetDepthTest( false );
-                m_DebugDraw.SetColor( Color4( 0, 1, 0, 1 ) );
-                m_DebugDraw.DrawAABB( drawable->GetWorldBounds() );
+            m_DebugDraw.SetDepthTest( false );
+            m_DebugDraw.SetColor( Color4( 0, 1, 0, 1 ) );
+            m_DebugDraw.DrawAABB( drawable->GetWorldBounds() );
 #endif
 
-                drawable->CascadeMask = 0;
-            }
+            drawable->CascadeMask = 0;
         }
 
         if (r_RenderSurfaces && !m_VisSurfaces.IsEmpty())
         {
-            struct SortFunction
-            {
-                bool operator()(SurfaceDef const* _A, SurfaceDef const* _B)
-                {
-                    return (_A->SortKey < _B->SortKey);
-                }
-            } SortFunction;
-
-            std::sort(m_VisSurfaces.ToPtr(), m_VisSurfaces.ToPtr() + m_VisSurfaces.Size(), SortFunction);
+            SortByKey(m_VisSurfaces.ToPtr(), m_VisSurfaces.Size());
 
             AddShadowmapSurfaces(shadowMap, m_VisSurfaces.ToPtr(), m_VisSurfaces.Size());
 
             totalSurfaces += m_VisSurfaces.Size();
         }
 
-        std::sort(m_FrameData.ShadowInstances.Begin() + shadowMap->FirstShadowInstance,
-                  m_FrameData.ShadowInstances.Begin() + (shadowMap->FirstShadowInstance + shadowMap->ShadowInstanceCount),
-                  ShadowInstanceSortFunction);
+        SortByKey(m_FrameData.ShadowInstances.ToPtr() + shadowMap->FirstShadowInstance, shadowMap->ShadowInstanceCount);
 
         totalInstances += shadowMap->ShadowInstanceCount;
     }
@@ -37,6 +37,8 @@ SOFTWARE.
 #include "Terrain.h"
 #include "TerrainMesh.h"
 #include "LightVoxelizer.h"
+#include "OcclusionCuller.h"
+#include "RadixSort.h"
 #include "EnvironmentMap.h"
 #include "WorldRenderView.h"
 
@@ -56,6 +58,10 @@ struct RenderFrontendStat
     int PolyCount;
     int ShadowMapPolyCount;
     int FrontendTime;
+    int OccluderCount;
+    int OcclusionCulledCount;
+    int InstancedDrawCount;
+    int MergedDrawCount;
 };
 
 struct RenderFrontendDef
@@ -86,15 +92,21 @@ public:
 
 private:
     void RenderView(int _Index);
+    template <typename T>
+    void SortByKey(T** Objects, int Count);
+    void MergeRenderInstances(RenderViewData* View);
 
     void QueryVisiblePrimitives(World* InWorld);
-    void QueryShadowCasters(World* InWorld, Float4x4 const& LightViewProjection, Float3 const& LightPosition, Float3x3 const& LightBasis, TVector<PrimitiveDef*>& Primitives, TVector<SurfaceDef*>& Surfaces);
+    void CullOccludedPrimitives();
+    void QueryShadowCasters(World* InWorld, Float4x4 const& LightViewProjection, Float3 const& LightPosition, Float3x3 const& LightBasis, VisPrimitiveBuckets& Primitives, TVector<SurfaceDef*>& Surfaces);
     void AddRenderInstances(World* InWorld);
     void AddDrawable(Drawable* InComponent);
     void AddTerrain(TerrainComponent* InComponent);
-    void AddStaticMesh(MeshComponent* InComponent);
-    void AddSkinnedMesh(SkinnedComponent* InComponent);
-    void AddProceduralMesh(ProceduralMeshComponent* InComponent);
+    int PrepareMesh(MeshComponent* InComponent);
+    bool IsMeshRenderProxyValid(MeshComponent* InComponent);
+    void UpdateMeshRenderProxy(MeshComponent* InComponent);
+    int PrepareProceduralMesh(ProceduralMeshComponent* InComponent);
+    void GenerateRenderInstances();
     void AddDirectionalShadowmapInstances(World* InWorld);
     void AddShadowmap_StaticMesh(LightShadowmap* ShadowMap, MeshComponent* InComponent);
     void AddShadowmap_SkinnedMesh(LightShadowmap* ShadowMap, SkinnedComponent* InComponent);
@@ -114,22 +126,54 @@ private:
 
     RenderFrontendStat m_Stat;
 
-    TVector<PrimitiveDef*> m_VisPrimitives;
+    RadixSort m_RadixSort;
+
+    VisPrimitiveBuckets m_VisPrimitives;
     TVector<SurfaceDef*> m_VisSurfaces;
     TVector<PunctualLightComponent*> m_VisLights;
     TVector<EnvironmentProbe*> m_VisEnvProbes;
 
     int m_VisPass = 0;
 
-    // TODO: We can keep ready shadowCasters[] and boxes[]
-    TVector<Drawable*> m_ShadowCasters;
-    TVector<BvAxisAlignedBoxSSE> m_ShadowBoxes;
-
     struct alignas(16) CullResult
     {
         int32_t Result[4];
     };
-    TVector<CullResult> m_ShadowCasterCullResult;
+    TVector<CullResult> m_ShadowCascadeCullResult[MAX_SHADOW_CASCADES];
+
+    static void CullShadowCascadeJob(void* Data);
+
+    struct VisDrawable
+    {
+        Drawable* Component;
+        /** Offset of the first render instance reserved for the drawable */
+        int FirstInstance;
+    };
+
+    /** Visible drawables in the visibility query order. Render instances are generated for them in parallel. */
+    TVector<VisDrawable> m_VisDrawables;
+    int m_NumReservedInstances = 0;
+
+    /** Render instances generated by one job for a contiguous range of visible drawables */
+    struct RenderInstanceBatch
+    {
+        RenderFrontendDef const* RenderDef;
+        VisDrawable const* Drawables;
+        int DrawableCount;
+        RenderInstance* FreeInstance;
+        RenderInstancePayload* FreePayload;
+        TVector<RenderInstance*> Instances;
+        TVector<RenderInstance*> TranslucentInstances;
+        TVector<RenderInstance*> OutlineInstances;
+        int PolyCount;
+    };
+    TVector<RenderInstanceBatch> m_RenderInstanceBatches;
+
+    static void GenerateRenderInstancesJob(void* Data);
+    static void AddStaticMesh(RenderInstanceBatch& Batch, MeshComponent* InComponent);
+    static void AddSkinnedMesh(RenderInstanceBatch& Batch, SkinnedComponent* InComponent);
+    static void AddProceduralMesh(RenderInstanceBatch& Batch, ProceduralMeshComponent* InComponent);
+    static RenderInstance* AddRenderInstance(RenderInstanceBatch& Batch, Material* InMaterial, bool bOutline);
 
     struct SurfaceStream
     {
@@ -151,6 +195,9 @@ private:
 
     LightVoxelizer m_LightVoxelizer;
 
+    OcclusionCuller m_OcclusionCuller;
+    TVector<PrimitiveDef*> m_Occluders;
+
     FrameLoop* m_FrameLoop;
 };
 
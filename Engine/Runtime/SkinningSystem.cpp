@@ -29,14 +29,132 @@ SOFTWARE.
 */
 
 #include "SkinningSystem.h"
+#include "Engine.h"
+
+#include <Engine/Core/ConsoleVar.h>
 
 HK_NAMESPACE_BEGIN
 
+ConsoleVar com_SharedPoses("com_SharedPoses"s, "1"s, 0, "Evaluate identical poses of skinned meshes once per tick"s);
+
+namespace
+{
+
+constexpr int SKINNING_BATCH_SIZE = 8;
+
+struct SkinningBatch
+{
+    SkinnedComponent* const* Components;
+    int Count;
+};
+
+} // namespace
+
+void SkinningSystem::EvaluatePoses(SkinnedComponent* const* components, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        // Touches only the component, its controllers and shared read-only resources
+        components[i]->MergeJointAnimations();
+        components[i]->UpdateJointPalette();
+    }
+}
+
+void SkinningSystem::EvaluatePosesJob(void* data)
+{
+    SkinningBatch* batch = static_cast<SkinningBatch*>(data);
+
+    EvaluatePoses(batch->Components, batch->Count);
+}
+
 void SkinningSystem::Update()
 {
+    m_EvaluateList.Clear();
+    m_Followers.Clear();
+    m_PoseCache.Clear();
+
+    const bool bSharePoses = com_SharedPoses;
+
     for (TListIterator<SkinnedComponent> skinnedMesh(SkinnedMeshes); skinnedMesh; skinnedMesh++)
     {
+        skinnedMesh->m_SharedUpload = nullptr;
+
         skinnedMesh->UpdateBounds();
+
+        // Physics driven joints are updated lazily
+        if (skinnedMesh->m_bJointsSimulatedByPhysics)
+        {
+            continue;
+        }
+
+        if (!skinnedMesh->UpdateAnimationLod())
+        {
+            continue;
+        }
+
+        SkinnedPoseKey key;
+        if (bSharePoses && skinnedMesh->GetPoseKey(key))
+        {
+            auto it = m_PoseCache.Find(key);
+            if (it != m_PoseCache.End())
+            {
+                m_Followers.Add({*skinnedMesh, it->second});
+                continue;
+            }
+            m_PoseCache[key] = m_EvaluateList.Size();
+        }
+
+        m_EvaluateList.Add(*skinnedMesh);
+    }
+
+    int batchCount = (m_EvaluateList.Size() + SKINNING_BATCH_SIZE - 1) / SKINNING_BATCH_SIZE;
+
+    if (batchCount < 2)
+    {
+        EvaluatePoses(m_EvaluateList.ToPtr(), m_EvaluateList.Size());
+    }
+    else
+    {
+        TSmallVector<SkinningBatch, 64> batches;
+        batches.Resize(batchCount);
+
+        AsyncJobList* jobList = GEngine->pRenderFrontendJobList;
+
+        for (int i = 0; i < batchCount; i++)
+        {
+            int first = i * SKINNING_BATCH_SIZE;
+
+            batches[i].Components = m_EvaluateList.ToPtr() + first;
+            batches[i].Count = Math::Min(SKINNING_BATCH_SIZE, (int)m_EvaluateList.Size() - first);
+
+            jobList->AddJob(EvaluatePosesJob, &batches[i]);
+        }
+
+        jobList->SubmitAndWait();
+    }
+
+    if (m_Followers.IsEmpty())
+    {
+        return;
+    }
+
+    // Pointers to uploads stay valid until the next update
+    m_SharedUploads.Resize(m_EvaluateList.Size());
+
+    for (PoseFollower const& follower : m_Followers)
+    {
+        SkinnedComponent* leader = m_EvaluateList[follower.Leader];
+
+        SharedSkeletonUpload& upload = m_SharedUploads[follower.Leader];
+        if (leader->m_SharedUpload != &upload)
+        {
+            upload.pMesh = leader->GetMesh();
+            upload.FrameNumber = -1;
+            leader->m_SharedUpload = &upload;
+        }
+
+        follower.Component->CopyPose(leader);
+        follower.Component->m_SharedUpload = &upload;
     }
 }
 
@@ -32,16 +32,80 @@ SOFTWARE.
 
 #include <Engine/Core/Platform/BaseTypes.h>
 #include <Engine/Core/IntrusiveLinkedListMacro.h>
+#include <Engine/Core/Containers/Hash.h>
 #include "World/SkinnedComponent.h"
 
 HK_NAMESPACE_BEGIN
 
+class SkeletalAnimation;
+
+/** Identifies the pose of a skinned mesh driven by a single animation controller */
+struct SkinnedPoseKey
+{
+    Skeleton const* pSkeleton{};
+    SkeletalAnimation const* pAnimation{};
+    int Frame{};
+    int NextFrame{};
+    float Blend{};
+    int JointLodDepth{};
+
+    bool operator==(SkinnedPoseKey const& rhs) const
+    {
+        return pSkeleton == rhs.pSkeleton &&
+            pAnimation == rhs.pAnimation &&
+            Frame == rhs.Frame &&
+            NextFrame == rhs.NextFrame &&
+            Blend == rhs.Blend &&
+            JointLodDepth == rhs.JointLodDepth;
+    }
+
+    uint32_t Hash() const
+    {
+        uint32_t h = HashTraits::Hash((uint64_t)(size_t)pSkeleton);
+        h = HashTraits::HashCombine(h, (uint64_t)(size_t)pAnimation);
+        h = HashTraits::HashCombine(h, (uint32_t)Frame);
+        h = HashTraits::HashCombine(h, (uint32_t)NextFrame);
+        h = HashTraits::HashCombine(h, (uint32_t)(Blend * 65536.0f));
+        h = HashTraits::HashCombine(h, (uint32_t)JointLodDepth);
+        return h;
+    }
+};
+
+/** Joint palette uploaded once per frame for all skinned meshes sharing the pose */
+struct SharedSkeletonUpload
+{
+    IndexedMesh const* pMesh{};
+    int FrameNumber{-1};
+    size_t Offset{};
+};
+
 class SkinningSystem
 {
 public:
     TList<SkinnedComponent> SkinnedMeshes;
 
+    /** Update bounds and evaluate poses and joint palettes of the skinned meshes on the render frontend job list.
+    Off-screen meshes are skipped, small meshes are updated at a reduced rate (see com_AnimationLod).
+    Meshes playing the same animation frame on the same skeleton share a single evaluation (see com_SharedPoses). */
     void Update();
+
+    /** Number of meshes that reused a pose evaluated for another mesh during the last update */
+    int GetSharedPoseCount() const { return m_Followers.Size(); }
+
+private:
+    struct PoseFollower
+    {
+        SkinnedComponent* Component;
+        int Leader;
+    };
+
+    static void EvaluatePoses(SkinnedComponent* const* components, int count);
+    static void EvaluatePosesJob(void* data);
+
+    TVector<SkinnedComponent*> m_EvaluateList;
+    TVector<PoseFollower> m_Followers;
+    TVector<SharedSkeletonUpload> m_SharedUploads;
+    THashMap<SkinnedPoseKey, int> m_PoseCache;
 };
 
 HK_NAMESPACE_END
@@ -38,11 +38,21 @@ SOFTWARE.
 #include <Engine/Core/IntrusiveLinkedListMacro.h>
 #include <Engine/Core/ConsoleVar.h>
 
+#ifdef HK_COMPILER_MSVC
+#    include <intrin.h>
+#endif
+
 HK_NAMESPACE_BEGIN
 
 ConsoleVar com_DrawLevelAreaBounds("com_DrawLevelAreaBounds"s, "0"s, CVAR_CHEAT);
 ConsoleVar com_DrawLevelIndoorBounds("com_DrawLevelIndoorBounds"s, "0"s, CVAR_CHEAT);
 ConsoleVar com_DrawLevelPortals("com_DrawLevelPortals"s, "0"s, CVAR_CHEAT);
+ConsoleVar com_DrawDynamicPrimitives("com_DrawDynamicPrimitives"s, "0"s, CVAR_CHEAT);
+ConsoleVar vsd_DynamicPrimitives("vsd_DynamicPrimitives"s, "1"s, 0, "Keep moving primitives in the dynamic tree instead of the level areas"s);
+
+/** Primitive that was moved in this number of frames is considered dynamic */
+static constexpr int VSD_DYNAMIC_PRIMITIVE_MOVES = 2;
+static constexpr int VSD_DYNAMIC_PRIMITIVE_REST_FRAMES = 30;
 
 //ConsoleVar vsd_FrustumCullingType("vsd_FrustumCullingType"s, "0"s, 0, "0 - combined, 1 - separate, 2 - simple"s);
 
@@ -53,10 +63,52 @@ struct PortalHull
     Float3 Points[MAX_HULL_POINTS];
 };
 
-int VisibilityLevel::m_VisQueryMarker = 0;
-
 static const WorldRaycastFilter DefaultRaycastFilter;
 
+/** Busy query slots */
+static AtomicInt VisQuerySlotMask(0);
+
+/** Last visibility marker of each query slot. Only the slot owner touches it. */
+static int VisQuerySlotMarker[VSD_MAX_QUERY_SLOTS] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+static_assert(VSD_MAX_QUERY_SLOTS == HK_ARRAY_SIZE(VisQuerySlotMarker), "Update VisQuerySlotMarker initializer");
+static_assert((VSD_MAX_QUERY_SLOTS & (VSD_MAX_QUERY_SLOTS - 1)) == 0, "VSD_MAX_QUERY_SLOTS must be a power of two");
+
+/** Level raycasts keep their state in the level, so they are serialized. */
+static Mutex VisRaycastLock;
+
+/** Acquires a free query slot and a new visibility marker for the lifetime of a query or raycast. */
+struct VisQuerySlot
+{
+    int Slot;
+    int Marker;
+
+    VisQuerySlot()
+    {
+        for (;;)
+        {
+            int busy = VisQuerySlotMask.Load();
+            for (Slot = 0; Slot < VSD_MAX_QUERY_SLOTS; Slot++)
+            {
+                int bit = 1 << Slot;
+                if (!(busy & bit) && !(VisQuerySlotMask.FetchOr(bit) & bit))
+                {
+                    VisQuerySlotMarker[Slot] += VSD_MAX_QUERY_SLOTS;
+                    Marker = VisQuerySlotMarker[Slot];
+                    return;
+                }
+            }
+            // All slots are busy, wait for a running query
+            Thread::WaitMicroseconds(1);
+        }
+    }
+
+    ~VisQuerySlot()
+    {
+        VisQuerySlotMask.And(~(1 << Slot));
+    }
+};
+
 struct VisibilityQueryContext
 {
     enum
@@ -68,6 +120,16 @@ struct VisibilityQueryContext
     PortalStack PStack[MAX_PORTAL_STACK];
     int PortalStackPos;
 
+    int QuerySlot;
+    int QueryMarker;
+    int NodeViewMark;
+
+    PlaneF const* ViewFrustum;
+    int ViewFrustumPlanes;
+    int CachedSignBits[PortalStack::MAX_CULL_PLANES]; // sign bits of ViewFrustum planes
+
+    PortalHull Hulls[2];
+
     Float3 ViewPosition;
     Float3 ViewRightVec;
     Float3 ViewUpVec;
@@ -77,11 +139,8 @@ struct VisibilityQueryContext
 
     VSD_QUERY_MASK VisQueryMask = VSD_QUERY_MASK(0);
     VISIBILITY_GROUP VisibilityMask = VISIBILITY_GROUP(0);
-};
 
-struct VisibilityQueryResult
-{
-    TVector<PrimitiveDef*>* pVisPrimitives;
+    TVector<PrimitiveDef*>* pVisPrimitives[VSD_PRIMITIVE_KIND_MAX];
     TVector<SurfaceDef*>* pVisSurfs;
 };
 
@@ -91,6 +150,11 @@ VisibilityLevel::VisibilityLevel(VisibilitySystemCreateInfo const& CreateInfo)
 
     Platform::ZeroMem(&m_OutdoorArea, sizeof(m_OutdoorArea));
 
+    for (int i = 0; i < VSD_MAX_QUERY_SLOTS; i++)
+    {
+        m_ViewCluster[i] = -1;
+    }
+
     m_OutdoorArea.Bounds.Mins = -extents * 0.5f;
     m_OutdoorArea.Bounds.Maxs = extents * 0.5f;
 
@@ -124,7 +188,7 @@ VisibilityLevel::VisibilityLevel(VisibilitySystemCreateInfo const& CreateInfo)
         BinarySpaceNodeDef const& src = CreateInfo.Nodes[i];
 
         dst.Parent = src.Parent != -1 ? (m_Nodes.ToPtr() + src.Parent) : nullptr;
-        dst.ViewMark = 0;
+        Platform::ZeroMem(dst.ViewMark, sizeof(dst.ViewMark));
         dst.Bounds = src.Bounds;
         dst.Plane = m_SplitPlanes.ToPtr() + src.PlaneIndex;
         dst.ChildrenIdx[0] = src.ChildrenIdx[0];
@@ -138,7 +202,7 @@ VisibilityLevel::VisibilityLevel(VisibilitySystemCreateInfo const& CreateInfo)
         BinarySpaceLeafDef const& src = CreateInfo.Leafs[i];
 
         dst.Parent = src.Parent != -1 ? (m_Nodes.ToPtr() + src.Parent) : nullptr;
-        dst.ViewMark = 0;
+        Platform::ZeroMem(dst.ViewMark, sizeof(dst.ViewMark));
         dst.Bounds = src.Bounds;
         dst.PVSCluster = src.PVSCluster;
         dst.Visdata = nullptr;
@@ -180,8 +244,40 @@ VisibilityLevel::VisibilityLevel(VisibilitySystemCreateInfo const& CreateInfo)
 
     if (m_bCompressedVisData && m_Visdata && m_PVSClustersCount > 0)
     {
-        // Allocate decompressed vis data
-        m_DecompressedVisData = (byte*)Platform::GetHeapAllocator<HEAP_MISC>().Alloc((m_PVSClustersCount + 7) >> 3);
+        // Allocate decompressed vis data. Rows are padded with zeros to 64-bit words.
+        m_DecompressedRowSize = Align((m_PVSClustersCount + 7) >> 3, 8);
+        m_DecompressedVisData = (byte*)Platform::GetHeapAllocator<HEAP_MISC>().Alloc(m_DecompressedRowSize * VSD_PVS_CACHE_SIZE * VSD_MAX_QUERY_SLOTS, 16, MALLOC_ZERO);
+    }
+
+    if (m_VisibilityMethod == LEVEL_VISIBILITY_PVS && m_PVSClustersCount > 0)
+    {
+        // Group leafs by cluster to mark them by PVS bits
+        m_ClusterFirstLeaf.ResizeInvalidate(m_PVSClustersCount + 1);
+        m_ClusterFirstLeaf.ZeroMem();
+
+        for (BinarySpaceLeaf const& leaf : m_Leafs)
+        {
+            if (leaf.PVSCluster >= 0 && leaf.PVSCluster < m_PVSClustersCount)
+            {
+                m_ClusterFirstLeaf[leaf.PVSCluster + 1]++;
+            }
+        }
+        for (int i = 0; i < m_PVSClustersCount; i++)
+        {
+            m_ClusterFirstLeaf[i + 1] += m_ClusterFirstLeaf[i];
+        }
+
+        m_ClusterLeafs.ResizeInvalidate(m_ClusterFirstLeaf[m_PVSClustersCount]);
+
+        TVector<int> clusterFill(m_ClusterFirstLeaf.Begin(), m_ClusterFirstLeaf.End() - 1);
+        for (int i = 0; i < m_Leafs.Size(); i++)
+        {
+            int cluster = m_Leafs[i].PVSCluster;
+            if (cluster >= 0 && cluster < m_PVSClustersCount)
+            {
+                m_ClusterLeafs[clusterFill[cluster]++] = i;
+            }
+        }
     }
 
     m_AreaSurfaces.Resize(CreateInfo.NumAreaSurfaces);
@@ -213,6 +309,8 @@ void VisibilityLevel::CreatePortals(PortalDef const* InPortals, int InPortalsCou
         PortalDef const* def = InPortals + i;
         VisPortal& portal = m_Portals[i];
 
+        Platform::ZeroMem(portal.VisMark, sizeof(portal.VisMark));
+
         VisArea* a1 = def->Areas[0] >= 0 ? &m_Areas[def->Areas[0]] : m_pOutdoorArea;
         VisArea* a2 = def->Areas[1] >= 0 ? &m_Areas[def->Areas[1]] : m_pOutdoorArea;
 #if 0
@@ -331,12 +429,12 @@ VisArea* VisibilityLevel::FindArea(Float3 const& InPosition)
     return m_pOutdoorArea;
 }
 
-byte const* VisibilityLevel::DecompressVisdata(byte const* InCompressedData)
+void VisibilityLevel::DecompressVisdata(byte const* InCompressedData, byte* pDecompressedVisData) const
 {
     int count;
 
     int row = (m_PVSClustersCount + 7) >> 3;
-    byte* pDecompressed = m_DecompressedVisData;
+    byte* pDecompressed = pDecompressedVisData;
 
     do {
         // Copy raw data
@@ -350,9 +448,9 @@ byte const* VisibilityLevel::DecompressVisdata(byte const* InCompressedData)
         count = InCompressedData[1];
 
         // Clamp zeros count if invalid. This can be moved to preprocess stage.
-        if (pDecompressed - m_DecompressedVisData + count > row)
+        if (pDecompressed - pDecompressedVisData + count > row)
         {
-            count = row - (pDecompressed - m_DecompressedVisData);
+            count = row - (pDecompressed - pDecompressedVisData);
         }
 
         // Move to the next sequence
@@ -362,71 +460,128 @@ byte const* VisibilityLevel::DecompressVisdata(byte const* InCompressedData)
         {
             *pDecompressed++ = 0;
         }
-    } while (pDecompressed - m_DecompressedVisData < row);
-
-    return m_DecompressedVisData;
+    } while (pDecompressed - pDecompressedVisData < row);
 }
 
-byte const* VisibilityLevel::LeafPVS(BinarySpaceLeaf const* InLeaf)
+byte const* VisibilityLevel::LeafPVS(BinarySpaceLeaf const* InLeaf, int InQuerySlot)
 {
-    if (m_bCompressedVisData)
+    if (!m_bCompressedVisData)
     {
-        return InLeaf->Visdata ? DecompressVisdata(InLeaf->Visdata) : nullptr;
+        return InLeaf->Visdata;
     }
-    else
+
+    if (!InLeaf->Visdata)
     {
-        return InLeaf->Visdata;
+        return nullptr;
     }
+
+    // Find the row in the slot cache or replace least recently used one
+    PVSCacheEntry* cache = m_PVSCache[InQuerySlot];
+    uint32_t time = ++m_PVSCacheTime[InQuerySlot];
+    int entry = 0;
+
+    for (int i = 0; i < VSD_PVS_CACHE_SIZE; i++)
+    {
+        if (cache[i].Cluster == InLeaf->PVSCluster)
+        {
+            cache[i].LastUsed = time;
+            return m_DecompressedVisData + m_DecompressedRowSize * (InQuerySlot * VSD_PVS_CACHE_SIZE + i);
+        }
+        if (cache[i].LastUsed < cache[entry].LastUsed)
+        {
+            entry = i;
+        }
+    }
+
+    byte* pDecompressed = m_DecompressedVisData + m_DecompressedRowSize * (InQuerySlot * VSD_PVS_CACHE_SIZE + entry);
+
+    DecompressVisdata(InLeaf->Visdata, pDecompressed);
+
+    cache[entry].Cluster = InLeaf->PVSCluster;
+    cache[entry].LastUsed = time;
+
+    return pDecompressed;
+}
+
+static HK_FORCEINLINE void MarkLeafParents(NodeBase* Node, int QuerySlot, int ViewMark)
+{
+    do {
+        if (Node->ViewMark[QuerySlot] == ViewMark)
+        {
+            break;
+        }
+        Node->ViewMark[QuerySlot] = ViewMark;
+        Node = Node->Parent;
+    } while (Node);
+}
+
+static HK_FORCEINLINE int FindFirstBit(uint64_t Bits)
+{
+#ifdef HK_COMPILER_MSVC
+    unsigned long index;
+    _BitScanForward64(&index, Bits);
+    return index;
+#else
+    return __builtin_ctzll(Bits);
+#endif
 }
 
-int VisibilityLevel::MarkLeafs(int InViewLeaf)
+int VisibilityLevel::MarkLeafs(int InViewLeaf, int InQuerySlot)
 {
+    HK_ASSERT(InQuerySlot >= 0 && InQuerySlot < VSD_MAX_QUERY_SLOTS);
+
+    int& viewMark = m_ViewMark[InQuerySlot];
+
     if (m_VisibilityMethod != LEVEL_VISIBILITY_PVS)
     {
         LOG("Level::MarkLeafs: expect LEVEL_VISIBILITY_PVS\n");
-        return m_ViewMark;
+        return viewMark;
     }
 
     if (InViewLeaf < 0)
     {
-        return m_ViewMark;
+        return viewMark;
     }
 
     BinarySpaceLeaf* pLeaf = &m_Leafs[InViewLeaf];
 
-    if (m_ViewCluster == pLeaf->PVSCluster)
+    if (m_ViewCluster[InQuerySlot] == pLeaf->PVSCluster)
     {
-        return m_ViewMark;
+        return viewMark;
     }
 
-    m_ViewMark++;
-    m_ViewCluster = pLeaf->PVSCluster;
+    viewMark++;
+    m_ViewCluster[InQuerySlot] = pLeaf->PVSCluster;
 
-    byte const* pVisibility = LeafPVS(pLeaf);
+    byte const* pVisibility = LeafPVS(pLeaf, InQuerySlot);
     if (pVisibility)
     {
-        int cluster;
-        for (BinarySpaceLeaf& leaf : m_Leafs)
-        {
+        // Walk the PVS by 64-bit words and mark leafs of the visible clusters
+        const int rowSize = (m_PVSClustersCount + 7) >> 3;
+        const int numWords = (rowSize + 7) >> 3;
 
-            cluster = leaf.PVSCluster;
+        for (int w = 0; w < numWords; w++)
+        {
+            uint64_t bits = 0;
+            Platform::Memcpy(&bits, pVisibility + w * 8, Math::Min(8, rowSize - w * 8));
 
-            if (cluster < 0 || cluster >= m_PVSClustersCount || !(pVisibility[cluster >> 3] & (1 << (cluster & 7))))
+            while (bits)
             {
-                continue;
-            }
-
-            // TODO: check doors here
+                int cluster = w * 64 + FindFirstBit(bits);
+                bits &= bits - 1;
 
-            NodeBase* parent = &leaf;
-            do {
-                if (parent->ViewMark == m_ViewMark)
+                if (cluster >= m_PVSClustersCount)
                 {
                     break;
                 }
-                parent->ViewMark = m_ViewMark;
-                parent = parent->Parent;
-            } while (parent);
+
+                // TODO: check doors here
+
+                for (int i = m_ClusterFirstLeaf[cluster], last = m_ClusterFirstLeaf[cluster + 1]; i < last; i++)
+                {
+                    MarkLeafParents(&m_Leafs[m_ClusterLeafs[i]], InQuerySlot, viewMark);
+                }
+            }
         }
     }
     else
@@ -434,19 +589,11 @@ int VisibilityLevel::MarkLeafs(int InViewLeaf)
         // Mark all
         for (BinarySpaceLeaf& leaf : m_Leafs)
         {
-            NodeBase* parent = &leaf;
-            do {
-                if (parent->ViewMark == m_ViewMark)
-                {
-                    break;
-                }
-                parent->ViewMark = m_ViewMark;
-                parent = parent->Parent;
-            } while (parent);
+            MarkLeafParents(&leaf, InQuerySlot, viewMark);
         }
     }
 
-    return m_ViewMark;
+    return viewMark;
 }
 
 void VisibilityLevel::QueryOverplapAreas_r(int NodeIndex, BvAxisAlignedBox const& Bounds, TVector<VisArea*>& OverlappedAreas)
@@ -774,7 +921,7 @@ void VisibilityLevel::DrawDebug(DebugRenderer* InRenderer)
 #if 0
             for ( VisPortal & portal : m_Portals ) {
 
-                if ( portal.VisMark == InRenderer->GetVisPass() ) {
+                if ( portal.VisMark[VSD_QuerySlot(InRenderer->GetVisPass())] == InRenderer->GetVisPass() ) {
                     InRenderer->SetColor( Color4( 1,0,0,0.4f ) );
                 } else {
                     InRenderer->SetColor( Color4( 0,1,0,0.4f ) );
@@ -789,7 +936,7 @@ void VisibilityLevel::DrawDebug(DebugRenderer* InRenderer)
                 for (PortalLink* p = portals; p; p = p->Next)
                 {
 
-                    if (p->Portal->VisMark == InRenderer->GetVisPass())
+                    if (p->Portal->VisMark[VSD_QuerySlot(InRenderer->GetVisPass())] == InRenderer->GetVisPass())
                     {
                         InRenderer->SetColor(Color4(1, 0, 0, 0.4f));
                     }
@@ -809,7 +956,7 @@ void VisibilityLevel::DrawDebug(DebugRenderer* InRenderer)
                 for (PortalLink* p = portals; p; p = p->Next)
                 {
 
-                    if (p->Portal->VisMark == InRenderer->GetVisPass())
+                    if (p->Portal->VisMark[VSD_QuerySlot(InRenderer->GetVisPass())] == InRenderer->GetVisPass())
                     {
                         InRenderer->SetColor(Color4(1, 0, 0, 0.4f));
                     }
@@ -854,19 +1001,16 @@ void VisibilityLevel::DrawDebug(DebugRenderer* InRenderer)
 #endif
 }
 
-void VisibilityLevel::ProcessLevelVisibility(VisibilityQueryContext& QueryContext, VisibilityQueryResult& QueryResult)
+void VisibilityLevel::ProcessLevelVisibility(VisibilityQueryContext& QueryContext)
 {
-    m_pQueryContext = &QueryContext;
-    m_pQueryResult = &QueryResult;
-
-    m_ViewFrustum = QueryContext.PStack[0].AreaFrustum;
-    m_ViewFrustumPlanes = QueryContext.PStack[0].PlanesCount; // Can be 4 or 5
+    QueryContext.ViewFrustum = QueryContext.PStack[0].AreaFrustum;
+    QueryContext.ViewFrustumPlanes = QueryContext.PStack[0].PlanesCount; // Can be 4 or 5
 
     int cullBits = 0;
 
-    for (int i = 0; i < m_ViewFrustumPlanes; i++)
+    for (int i = 0; i < QueryContext.ViewFrustumPlanes; i++)
     {
-        m_CachedSignBits[i] = m_ViewFrustum[i].SignBits();
+        QueryContext.CachedSignBits[i] = QueryContext.ViewFrustum[i].SignBits();
 
         cullBits |= 1 << i;
     }
@@ -877,19 +1021,15 @@ void VisibilityLevel::ProcessLevelVisibility(VisibilityQueryContext& QueryContex
 
         int leaf = FindLeaf(QueryContext.ViewPosition);
 
-        m_NodeViewMark = MarkLeafs(leaf);
+        QueryContext.NodeViewMark = MarkLeafs(leaf, QueryContext.QuerySlot);
 
-        //DEBUG( "m_NodeViewMark {}\n", m_NodeViewMark );
-
-        //HK_ASSERT( m_NodeViewMark != 0 );
-
-        LevelTraverse_r(0, cullBits);
+        LevelTraverse_r(QueryContext, 0, cullBits);
     }
     else if (m_VisibilityMethod == LEVEL_VISIBILITY_PORTAL)
     {
         VisArea* area = FindArea(QueryContext.ViewPosition);
 
-        FlowThroughPortals_r(area);
+        FlowThroughPortals_r(QueryContext, area);
     }
 }
 
@@ -903,15 +1043,16 @@ static constexpr int CullIndices[8][6] = {
     {0, 1, 2, 3, 4, 5},
     {3, 1, 2, 0, 4, 5}};
 
-bool VisibilityLevel::CullNode(PlaneF const InFrustum[PortalStack::MAX_CULL_PLANES], BvAxisAlignedBox const& Bounds, int& InCullBits)
+bool VisibilityLevel::CullNode(VisibilityQueryContext const& QueryContext, BvAxisAlignedBox const& Bounds, int& InCullBits)
 {
+    PlaneF const* InFrustum = QueryContext.ViewFrustum;
     Float3 p;
 
     float const* pBounds = Bounds.ToPtr();
     int const* pIndices;
     if (InCullBits & 1)
     {
-        pIndices = CullIndices[m_CachedSignBits[0]];
+        pIndices = CullIndices[QueryContext.CachedSignBits[0]];
 
         p[0] = pBounds[pIndices[0]];
         p[1] = pBounds[pIndices[1]];
@@ -934,7 +1075,7 @@ bool VisibilityLevel::CullNode(PlaneF const InFrustum[PortalStack::MAX_CULL_PLAN
 
     if (InCullBits & 2)
     {
-        pIndices = CullIndices[m_CachedSignBits[1]];
+        pIndices = CullIndices[QueryContext.CachedSignBits[1]];
 
         p[0] = pBounds[pIndices[0]];
         p[1] = pBounds[pIndices[1]];
@@ -957,7 +1098,7 @@ bool VisibilityLevel::CullNode(PlaneF const InFrustum[PortalStack::MAX_CULL_PLAN
 
     if (InCullBits & 4)
     {
-        pIndices = CullIndices[m_CachedSignBits[2]];
+        pIndices = CullIndices[QueryContext.CachedSignBits[2]];
 
         p[0] = pBounds[pIndices[0]];
         p[1] = pBounds[pIndices[1]];
@@ -980,7 +1121,7 @@ bool VisibilityLevel::CullNode(PlaneF const InFrustum[PortalStack::MAX_CULL_PLAN
 
     if (InCullBits & 8)
     {
-        pIndices = CullIndices[m_CachedSignBits[3]];
+        pIndices = CullIndices[QueryContext.CachedSignBits[3]];
 
         p[0] = pBounds[pIndices[0]];
         p[1] = pBounds[pIndices[1]];
@@ -1003,7 +1144,7 @@ bool VisibilityLevel::CullNode(PlaneF const InFrustum[PortalStack::MAX_CULL_PLAN
 
     if (InCullBits & 16)
     {
-        pIndices = CullIndices[m_CachedSignBits[4]];
+        pIndices = CullIndices[QueryContext.CachedSignBits[4]];
 
         p[0] = pBounds[pIndices[0]];
         p[1] = pBounds[pIndices[1]];
@@ -1068,7 +1209,7 @@ HK_INLINE bool VSD_CullSphereSingle(PlaneF const* InCullPlanes, const int InCull
     return !inside;
 }
 
-void VisibilityLevel::LevelTraverse_r(int NodeIndex, int InCullBits)
+void VisibilityLevel::LevelTraverse_r(VisibilityQueryContext& QueryContext, int NodeIndex, int InCullBits)
 {
     NodeBase const* node;
 
@@ -1083,17 +1224,17 @@ void VisibilityLevel::LevelTraverse_r(int NodeIndex, int InCullBits)
             node = m_Nodes.ToPtr() + NodeIndex;
         }
 
-        if (node->ViewMark != m_NodeViewMark)
+        if (node->ViewMark[QueryContext.QuerySlot] != QueryContext.NodeViewMark)
             return;
 
-        if (CullNode(m_ViewFrustum, node->Bounds, InCullBits))
+        if (CullNode(QueryContext, node->Bounds, InCullBits))
         {
             //TotalCulled++;
             return;
         }
 
 #if 0
-        if ( VSD_CullBoxSingle( m_ViewFrustum, m_ViewFrustumPlanes, node->Bounds ) ) {
+        if ( VSD_CullBoxSingle( QueryContext.ViewFrustum, QueryContext.ViewFrustumPlanes, node->Bounds ) ) {
             Dbg_CullMiss++;
         }
 #endif
@@ -1104,30 +1245,30 @@ void VisibilityLevel::LevelTraverse_r(int NodeIndex, int InCullBits)
             break;
         }
 
-        LevelTraverse_r(static_cast<BinarySpaceNode const*>(node)->ChildrenIdx[0], InCullBits);
+        LevelTraverse_r(QueryContext, static_cast<BinarySpaceNode const*>(node)->ChildrenIdx[0], InCullBits);
 
         NodeIndex = static_cast<BinarySpaceNode const*>(node)->ChildrenIdx[1];
     }
 
     BinarySpaceLeaf const* pleaf = static_cast<BinarySpaceLeaf const*>(node);
 
-    CullPrimitives(pleaf->Area, m_ViewFrustum, m_ViewFrustumPlanes);
+    CullPrimitives(QueryContext, pleaf->Area, QueryContext.ViewFrustum, QueryContext.ViewFrustumPlanes);
 }
 
-void VisibilityLevel::FlowThroughPortals_r(VisArea const* InArea)
+void VisibilityLevel::FlowThroughPortals_r(VisibilityQueryContext& QueryContext, VisArea const* InArea)
 {
-    PortalStack* prevStack = &m_pQueryContext->PStack[m_pQueryContext->PortalStackPos];
+    PortalStack* prevStack = &QueryContext.PStack[QueryContext.PortalStackPos];
     PortalStack* stack = prevStack + 1;
 
-    CullPrimitives(InArea, prevStack->AreaFrustum, prevStack->PlanesCount);
+    CullPrimitives(QueryContext, InArea, prevStack->AreaFrustum, prevStack->PlanesCount);
 
-    if (m_pQueryContext->PortalStackPos == (VisibilityQueryContext::MAX_PORTAL_STACK - 1))
+    if (QueryContext.PortalStackPos == (VisibilityQueryContext::MAX_PORTAL_STACK - 1))
     {
         LOG("MAX_PORTAL_STACK hit\n");
         return;
     }
 
-    ++m_pQueryContext->PortalStackPos;
+    ++QueryContext.PortalStackPos;
 
 #ifdef DEBUG_TRAVERSING_COUNTERS
     Dbg_StackDeep = Math::Max(Dbg_StackDeep, PortalStackPos);
@@ -1136,7 +1277,7 @@ void VisibilityLevel::FlowThroughPortals_r(VisArea const* InArea)
     for (PortalLink const* portal = InArea->PortalList; portal; portal = portal->Next)
     {
 
-        //if ( portal->Portal->VisFrame == m_VisQueryMarker ) {
+        //if ( portal->Portal->VisFrame == QueryContext.QueryMarker ) {
         //    #ifdef DEBUG_TRAVERSING_COUNTERS
         //    Dbg_SkippedByVisFrame++;
         //    #endif
@@ -1149,23 +1290,23 @@ void VisibilityLevel::FlowThroughPortals_r(VisArea const* InArea)
             continue;
         }
 
-        if (!CalcPortalStack(stack, prevStack, portal))
+        if (!CalcPortalStack(QueryContext, stack, prevStack, portal))
         {
             continue;
         }
 
         // Mark visited
-        portal->Portal->VisMark = m_VisQueryMarker;
+        portal->Portal->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
-        FlowThroughPortals_r(portal->ToArea);
+        FlowThroughPortals_r(QueryContext, portal->ToArea);
     }
 
-    --m_pQueryContext->PortalStackPos;
+    --QueryContext.PortalStackPos;
 }
 
-bool VisibilityLevel::CalcPortalStack(PortalStack* OutStack, PortalStack const* InPrevStack, PortalLink const* InPortal)
+bool VisibilityLevel::CalcPortalStack(VisibilityQueryContext& QueryContext, PortalStack* OutStack, PortalStack const* InPrevStack, PortalLink const* InPortal)
 {
-    const float d = InPortal->Plane.DistanceToPoint(m_pQueryContext->ViewPosition);
+    const float d = InPortal->Plane.DistanceToPoint(QueryContext.ViewPosition);
     if (d <= 0.0f)
     {
 #ifdef DEBUG_TRAVERSING_COUNTERS
@@ -1174,7 +1315,7 @@ bool VisibilityLevel::CalcPortalStack(PortalStack* OutStack, PortalStack const*
         return false;
     }
 
-    if (d <= m_pQueryContext->ViewZNear)
+    if (d <= QueryContext.ViewZNear)
     {
         // View intersecting the portal
 
@@ -1194,7 +1335,7 @@ bool VisibilityLevel::CalcPortalStack(PortalStack* OutStack, PortalStack const*
         //    }
         //}
 
-        PortalHull* portalWinding = CalcPortalWinding(InPortal, InPrevStack);
+        PortalHull* portalWinding = CalcPortalWinding(QueryContext, InPortal, InPrevStack);
 
         if (portalWinding->NumPoints < 3)
         {
@@ -1205,7 +1346,7 @@ bool VisibilityLevel::CalcPortalStack(PortalStack* OutStack, PortalStack const*
             return false;
         }
 
-        CalcPortalScissor(OutStack->Scissor, portalWinding, InPrevStack);
+        CalcPortalScissor(QueryContext, OutStack->Scissor, portalWinding, InPrevStack);
 
         if (OutStack->Scissor.MinX >= OutStack->Scissor.MaxX || OutStack->Scissor.MinY >= OutStack->Scissor.MaxY)
         {
@@ -1228,7 +1369,7 @@ bool VisibilityLevel::CalcPortalStack(PortalStack* OutStack, PortalStack const*
                 //OutStack->AreaFrustum[ i ].FromPoints( ViewPosition, portalWinding->Points[ ( i + 1 ) % portalWinding->NumPoints ], portalWinding->Points[ i ] );
 
                 // CCW
-                OutStack->AreaFrustum[i].FromPoints(m_pQueryContext->ViewPosition, portalWinding->Points[i], portalWinding->Points[(i + 1) % portalWinding->NumPoints]);
+                OutStack->AreaFrustum[i].FromPoints(QueryContext.ViewPosition, portalWinding->Points[i], portalWinding->Points[(i + 1) % portalWinding->NumPoints]);
             }
 
             // Copy far plane
@@ -1237,10 +1378,10 @@ bool VisibilityLevel::CalcPortalStack(PortalStack* OutStack, PortalStack const*
         else
         {
             // Compute based on portal scissor
-            const Float3 rightMin = m_pQueryContext->ViewRightVec * OutStack->Scissor.MinX + m_pQueryContext->ViewCenter;
-            const Float3 rightMax = m_pQueryContext->ViewRightVec * OutStack->Scissor.MaxX + m_pQueryContext->ViewCenter;
-            const Float3 upMin = m_pQueryContext->ViewUpVec * OutStack->Scissor.MinY;
-            const Float3 upMax = m_pQueryContext->ViewUpVec * OutStack->Scissor.MaxY;
+            const Float3 rightMin = QueryContext.ViewRightVec * OutStack->Scissor.MinX + QueryContext.ViewCenter;
+            const Float3 rightMax = QueryContext.ViewRightVec * OutStack->Scissor.MaxX + QueryContext.ViewCenter;
+            const Float3 upMin = QueryContext.ViewUpVec * OutStack->Scissor.MinY;
+            const Float3 upMax = QueryContext.ViewUpVec * OutStack->Scissor.MaxY;
             const Float3 corners[4] =
                 {
                     rightMin + upMin,
@@ -1253,22 +1394,22 @@ bool VisibilityLevel::CalcPortalStack(PortalStack* OutStack, PortalStack const*
             // bottom
             p = Math::Cross(corners[1], corners[0]);
             OutStack->AreaFrustum[0].Normal = p * Math::RSqrt(Math::Dot(p, p));
-            OutStack->AreaFrustum[0].D = -Math::Dot(OutStack->AreaFrustum[0].Normal, m_pQueryContext->ViewPosition);
+            OutStack->AreaFrustum[0].D = -Math::Dot(OutStack->AreaFrustum[0].Normal, QueryContext.ViewPosition);
 
             // right
             p = Math::Cross(corners[2], corners[1]);
             OutStack->AreaFrustum[1].Normal = p * Math::RSqrt(Math::Dot(p, p));
-            OutStack->AreaFrustum[1].D = -Math::Dot(OutStack->AreaFrustum[1].Normal, m_pQueryContext->ViewPosition);
+            OutStack->AreaFrustum[1].D = -Math::Dot(OutStack->AreaFrustum[1].Normal, QueryContext.ViewPosition);
 
             // top
             p = Math::Cross(corners[3], corners[2]);
             OutStack->AreaFrustum[2].Normal = p * Math::RSqrt(Math::Dot(p, p));
-            OutStack->AreaFrustum[2].D = -Math::Dot(OutStack->AreaFrustum[2].Normal, m_pQueryContext->ViewPosition);
+            OutStack->AreaFrustum[2].D = -Math::Dot(OutStack->AreaFrustum[2].Normal, QueryContext.ViewPosition);
 
             // left
             p = Math::Cross(corners[0], corners[3]);
             OutStack->AreaFrustum[3].Normal = p * Math::RSqrt(Math::Dot(p, p));
-            OutStack->AreaFrustum[3].D = -Math::Dot(OutStack->AreaFrustum[3].Normal, m_pQueryContext->ViewPosition);
+            OutStack->AreaFrustum[3].D = -Math::Dot(OutStack->AreaFrustum[3].Normal, QueryContext.ViewPosition);
 
             //OutStack->PlanesCount = 4;
 
@@ -1296,11 +1437,10 @@ bool VisibilityLevel::CalcPortalStack(PortalStack* OutStack, PortalStack const*
 // Fast polygon clipping. Without memory allocations.
 //
 
-static float ClipDistances[MAX_HULL_POINTS];
-static PLANE_SIDE ClipSides[MAX_HULL_POINTS];
-
 static bool ClipPolygonFast(Float3 const* InPoints, const int InNumPoints, PortalHull* Out, PlaneF const& InClipPlane, const float InEpsilon)
 {
+    float ClipDistances[MAX_HULL_POINTS];
+    PLANE_SIDE ClipSides[MAX_HULL_POINTS];
     int front = 0;
     int back = 0;
     int i;
@@ -1383,9 +1523,9 @@ static bool ClipPolygonFast(Float3 const* InPoints, const int InNumPoints, Porta
     return true;
 }
 
-PortalHull* VisibilityLevel::CalcPortalWinding(PortalLink const* InPortal, PortalStack const* InStack)
+PortalHull* VisibilityLevel::CalcPortalWinding(VisibilityQueryContext& QueryContext, PortalLink const* InPortal, PortalStack const* InStack)
 {
-    static PortalHull PortalHull[2];
+    PortalHull* PortalHull = QueryContext.Hulls;
 
     int flip = 0;
 
@@ -1393,7 +1533,7 @@ PortalHull* VisibilityLevel::CalcPortalWinding(PortalLink const* InPortal, Porta
     int numPoints = InPortal->Hull->NumPoints();
 
     // Clip portal hull by view plane
-    if (!ClipPolygonFast(hullPoints, numPoints, &PortalHull[flip], m_pQueryContext->ViewPlane, 0.0f))
+    if (!ClipPolygonFast(hullPoints, numPoints, &PortalHull[flip], QueryContext.ViewPlane, 0.0f))
     {
         HK_ASSERT(numPoints <= MAX_HULL_POINTS);
 
@@ -1420,7 +1560,7 @@ PortalHull* VisibilityLevel::CalcPortalWinding(PortalLink const* InPortal, Porta
     return &PortalHull[flip];
 }
 
-void VisibilityLevel::CalcPortalScissor(PortalScissor& OutScissor, PortalHull const* InHull, PortalStack const* InStack)
+void VisibilityLevel::CalcPortalScissor(VisibilityQueryContext const& QueryContext, PortalScissor& OutScissor, PortalHull const* InHull, PortalStack const* InStack)
 {
     OutScissor.MinX = 99999999.0f;
     OutScissor.MinY = 99999999.0f;
@@ -1430,19 +1570,19 @@ void VisibilityLevel::CalcPortalScissor(PortalScissor& OutScissor, PortalHull co
     for (int i = 0; i < InHull->NumPoints; i++)
     {
         // Project portal vertex to view plane
-        const Float3 vec = InHull->Points[i] - m_pQueryContext->ViewPosition;
+        const Float3 vec = InHull->Points[i] - QueryContext.ViewPosition;
 
-        const float d = Math::Dot(m_pQueryContext->ViewPlane.Normal, vec);
+        const float d = Math::Dot(QueryContext.ViewPlane.Normal, vec);
 
         //if ( d < ViewZNear ) {
         //    HK_ASSERT(0);
         //}
 
-        const Float3 p = d < m_pQueryContext->ViewZNear ? vec : vec * (m_pQueryContext->ViewZNear / d);
+        const Float3 p = d < QueryContext.ViewZNear ? vec : vec * (QueryContext.ViewZNear / d);
 
         // Compute relative coordinates
-        const float x = Math::Dot(m_pQueryContext->ViewRightVec, p);
-        const float y = Math::Dot(m_pQueryContext->ViewUpVec, p);
+        const float x = Math::Dot(QueryContext.ViewRightVec, p);
+        const float y = Math::Dot(QueryContext.ViewUpVec, p);
 
         // Compute bounds
         OutScissor.MinX = Math::Min(x, OutScissor.MinX);
@@ -1459,17 +1599,17 @@ void VisibilityLevel::CalcPortalScissor(PortalScissor& OutScissor, PortalHull co
     OutScissor.MaxY = Math::Min(InStack->Scissor.MaxY, OutScissor.MaxY);
 }
 
-HK_FORCEINLINE bool VisibilityLevel::FaceCull(PrimitiveDef const* InPrimitive)
+HK_FORCEINLINE bool VisibilityLevel::FaceCull(VisibilityQueryContext const& QueryContext, PrimitiveDef const* InPrimitive)
 {
-    return InPrimitive->Face.DistanceToPoint(m_pQueryContext->ViewPosition) < 0.0f;
+    return InPrimitive->Face.DistanceToPoint(QueryContext.ViewPosition) < 0.0f;
 }
 
-HK_FORCEINLINE bool VisibilityLevel::FaceCull(SurfaceDef const* InSurface)
+HK_FORCEINLINE bool VisibilityLevel::FaceCull(VisibilityQueryContext const& QueryContext, SurfaceDef const* InSurface)
 {
-    return InSurface->Face.DistanceToPoint(m_pQueryContext->ViewPosition) < 0.0f;
+    return InSurface->Face.DistanceToPoint(QueryContext.ViewPosition) < 0.0f;
 }
 
-void VisibilityLevel::CullPrimitives(VisArea const* InArea, PlaneF const* InCullPlanes, const int InCullPlanesCount)
+void VisibilityLevel::CullPrimitives(VisibilityQueryContext& QueryContext, VisArea const* InArea, PlaneF const* InCullPlanes, const int InCullPlanesCount)
 {
     /*!!!
     if (vsd_FrustumCullingType.GetInteger() != FRUSTUM_CULLING_COMBINED)
@@ -1493,29 +1633,29 @@ void VisibilityLevel::CullPrimitives(VisArea const* InArea, PlaneF const* InCull
         {
             SurfaceDef* surf = &model->Surfaces[*pSurfaceIndex];
 
-            if (surf->VisMark == m_VisQueryMarker)
+            if (surf->VisMark[QueryContext.QuerySlot] == QueryContext.QueryMarker)
             {
                 // Surface visibility already processed
                 continue;
             }
 
             // Mark surface visibility processed
-            surf->VisMark = m_VisQueryMarker;
+            surf->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
             // Filter query group
-            if ((surf->QueryGroup & m_pQueryContext->VisQueryMask) != m_pQueryContext->VisQueryMask)
+            if ((surf->QueryGroup & QueryContext.VisQueryMask) != QueryContext.VisQueryMask)
             {
                 continue;
             }
 
             // Check surface visibility group is not visible
-            if ((surf->VisGroup & m_pQueryContext->VisibilityMask) == 0)
+            if ((surf->VisGroup & QueryContext.VisibilityMask) == 0)
             {
                 continue;
             }
 
             // Perform face culling
-            if ((surf->Flags & SURF_PLANAR_TWOSIDED_MASK) == SURF_PLANAR && FaceCull(surf))
+            if ((surf->Flags & SURF_PLANAR_TWOSIDED_MASK) == SURF_PLANAR && FaceCull(QueryContext, surf))
             {
                 continue;
             }
@@ -1531,9 +1671,9 @@ void VisibilityLevel::CullPrimitives(VisArea const* InArea, PlaneF const* InCull
             }
 
             // Mark as visible
-            surf->VisPass = m_VisQueryMarker;
+            surf->VisPass[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
-            m_pQueryResult->pVisSurfs->Add(surf);
+            QueryContext.pVisSurfs->Add(surf);
         }
     }
 
@@ -1543,35 +1683,35 @@ void VisibilityLevel::CullPrimitives(VisArea const* InArea, PlaneF const* InCull
 
         PrimitiveDef* primitive = link->Primitive;
 
-        if (primitive->VisMark == m_VisQueryMarker)
+        if (primitive->VisMark[QueryContext.QuerySlot] == QueryContext.QueryMarker)
         {
             // Primitive visibility already processed
             continue;
         }
 
         // Filter query group
-        if ((primitive->QueryGroup & m_pQueryContext->VisQueryMask) != m_pQueryContext->VisQueryMask)
+        if ((primitive->QueryGroup & QueryContext.VisQueryMask) != QueryContext.VisQueryMask)
         {
             // Mark primitive visibility processed
-            primitive->VisMark = m_VisQueryMarker;
+            primitive->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
             continue;
         }
 
         // Check primitive visibility group is not visible
-        if ((primitive->VisGroup & m_pQueryContext->VisibilityMask) == 0)
+        if ((primitive->VisGroup & QueryContext.VisibilityMask) == 0)
         {
             // Mark primitive visibility processed
-            primitive->VisMark = m_VisQueryMarker;
+            primitive->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
             continue;
         }
 
         if ((primitive->Flags & SURF_PLANAR_TWOSIDED_MASK) == SURF_PLANAR)
         {
             // Perform face culling
-            if (FaceCull(primitive))
+            if (FaceCull(QueryContext, primitive))
             {
                 // Face successfully culled
-                primitive->VisMark = m_VisQueryMarker;
+                primitive->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
 // Update debug counter
 #ifdef DEBUG_TRAVERSING_COUNTERS
@@ -1622,13 +1762,13 @@ void VisibilityLevel::CullPrimitives(VisArea const* InArea, PlaneF const* InCull
         }
 
         // Mark primitive visibility processed
-        primitive->VisMark = m_VisQueryMarker;
+        primitive->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
         // Mark primitive visible
-        primitive->VisPass = m_VisQueryMarker;
+        primitive->VisPass[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
         // Add primitive to vis list
-        m_pQueryResult->pVisPrimitives->Add(primitive);
+        QueryContext.pVisPrimitives[primitive->Kind]->Add(primitive);
     }
 
     /*!!!
@@ -1673,18 +1813,18 @@ void VisibilityLevel::CullPrimitives(VisArea const* InArea, PlaneF const* InCull
             {
                 PrimitiveDef* primitive = boxes[n];
 
-                if (primitive->VisMark != m_VisQueryMarker)
+                if (primitive->VisMark[QueryContext.QuerySlot] != QueryContext.QueryMarker)
                 {
 
                     if (!cullResult[n])
                     { // TODO: Use atomic increment and store only visible objects?
                         // Mark primitive visibility processed
-                        primitive->VisMark = m_VisQueryMarker;
+                        primitive->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
                         // Mark primitive visible
-                        primitive->VisPass = m_VisQueryMarker;
+                        primitive->VisPass[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
-                        m_pQueryResult->pVisPrimitives->Add(primitive);
+                        QueryContext.pVisPrimitives[primitive->Kind]->Add(primitive);
                     }
                     else
                     {
@@ -1699,27 +1839,98 @@ void VisibilityLevel::CullPrimitives(VisArea const* InArea, PlaneF const* InCull
 */
 }
 
-void VisibilityLevel::QueryVisiblePrimitives(TVector<VisibilityLevel*> const& m_Levels, TVector<PrimitiveDef*>& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& InQuery)
+void VisibilityLevel::CullDynamicPrimitives(VisibilityQueryContext& QueryContext, BvDynamicTree const& DynamicTree)
+{
+    // Dynamic primitives are not linked to the areas, so they are culled only by the view frustum
+    PlaneF const* cullPlanes = QueryContext.PStack[0].AreaFrustum;
+    const int cullPlanesCount = QueryContext.PStack[0].PlanesCount;
+
+    DynamicTree.Query(
+        [cullPlanes, cullPlanesCount](BvAxisAlignedBox const& Bounds)
+        {
+            return !VSD_CullBoxSingle(cullPlanes, cullPlanesCount, Bounds);
+        },
+        [&QueryContext, cullPlanes, cullPlanesCount](void* UserData)
+        {
+            PrimitiveDef* primitive = static_cast<PrimitiveDef*>(UserData);
+
+            if (primitive->VisMark[QueryContext.QuerySlot] == QueryContext.QueryMarker)
+            {
+                // Primitive visibility already processed
+                return;
+            }
+
+            // Mark primitive visibility processed
+            primitive->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
+
+            // Filter query group
+            if ((primitive->QueryGroup & QueryContext.VisQueryMask) != QueryContext.VisQueryMask)
+            {
+                return;
+            }
+
+            // Check primitive visibility group is not visible
+            if ((primitive->VisGroup & QueryContext.VisibilityMask) == 0)
+            {
+                return;
+            }
+
+            // Perform face culling
+            if ((primitive->Flags & SURF_PLANAR_TWOSIDED_MASK) == SURF_PLANAR && FaceCull(QueryContext, primitive))
+            {
+                return;
+            }
+
+            switch (primitive->Type)
+            {
+                case VSD_PRIMITIVE_BOX:
+                    if (VSD_CullBoxSingle(cullPlanes, cullPlanesCount, primitive->Box))
+                    {
+                        return;
+                    }
+                    break;
+                case VSD_PRIMITIVE_SPHERE:
+                    if (VSD_CullSphereSingle(cullPlanes, cullPlanesCount, primitive->Sphere))
+                    {
+                        return;
+                    }
+                    break;
+            }
+
+            // Mark primitive visible
+            primitive->VisPass[QueryContext.QuerySlot] = QueryContext.QueryMarker;
+
+            // Add primitive to vis list
+            QueryContext.pVisPrimitives[primitive->Kind]->Add(primitive);
+        });
+}
+
+void VisibilityLevel::QueryVisiblePrimitives(TVector<VisibilityLevel*> const& m_Levels, BvDynamicTree const& DynamicTree, TVector<PrimitiveDef*>* const* VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& InQuery)
 {
     //int QueryVisiblePrimitivesTime = GEngine->SysMicroseconds();
     VisibilityQueryContext QueryContext;
-    VisibilityQueryResult QueryResult;
 
-    ++m_VisQueryMarker;
+    VisQuerySlot querySlot;
+
+    QueryContext.QuerySlot = querySlot.Slot;
+    QueryContext.QueryMarker = querySlot.Marker;
 
     if (VisPass)
     {
-        *VisPass = m_VisQueryMarker;
+        *VisPass = querySlot.Marker;
     }
 
     QueryContext.VisQueryMask = InQuery.QueryMask;
     QueryContext.VisibilityMask = InQuery.VisibilityMask;
 
-    QueryResult.pVisPrimitives = &VisPrimitives;
-    QueryResult.pVisPrimitives->Clear();
+    for (int kind = 0; kind < VSD_PRIMITIVE_KIND_MAX; kind++)
+    {
+        QueryContext.pVisPrimitives[kind] = VisPrimitives[kind];
+        QueryContext.pVisPrimitives[kind]->Clear();
+    }
 
-    QueryResult.pVisSurfs = &VisSurfs;
-    QueryResult.pVisSurfs->Clear();
+    QueryContext.pVisSurfs = &VisSurfs;
+    QueryContext.pVisSurfs->Clear();
 
     /*!!!
     BoxPrimitives.Clear();
@@ -1780,8 +1991,10 @@ void VisibilityLevel::QueryVisiblePrimitives(TVector<VisibilityLevel*> const& m_
 
     for (VisibilityLevel* level : m_Levels)
     {
-        level->ProcessLevelVisibility(QueryContext, QueryResult);
+        level->ProcessLevelVisibility(QueryContext);
     }
+
+    CullDynamicPrimitives(QueryContext, DynamicTree);
     /*!!!
     if (vsd_FrustumCullingType.GetInteger() == FRUSTUM_CULLING_COMBINED)
     {
@@ -1811,18 +2024,18 @@ void VisibilityLevel::QueryVisiblePrimitives(TVector<VisibilityLevel*> const& m_
 
                 PrimitiveDef* primitive = boxes[n];
 
-                if (primitive->VisMark != m_VisQueryMarker)
+                if (primitive->VisMark[QueryContext.QuerySlot] != QueryContext.QueryMarker)
                 {
 
                     if (!cullResult[n])
                     { // TODO: Use atomic increment and store only visible objects?
                         // Mark primitive visibility processed
-                        primitive->VisMark = m_VisQueryMarker;
+                        primitive->VisMark[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
                         // Mark primitive visible
-                        primitive->VisPass = m_VisQueryMarker;
+                        primitive->VisPass[QueryContext.QuerySlot] = QueryContext.QueryMarker;
 
-                        QueryResult.pVisPrimitives->Add(primitive);
+                        QueryContext.pVisPrimitives[primitive->Kind]->Add(primitive);
                     }
                     else
                     {
@@ -1994,7 +2207,7 @@ void VisibilityLevel::RaycastSurface(SurfaceDef* Self)
                     m_pRaycast->NumHits++;
 
                     // Mark as visible
-                    Self->VisPass = m_VisQueryMarker;
+                    Self->VisPass[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
                     break;
                 }
@@ -2031,7 +2244,7 @@ void VisibilityLevel::RaycastSurface(SurfaceDef* Self)
                     rcPrimitive.NumHits = 1;
 
                     // Mark as visible
-                    Self->VisPass = m_VisQueryMarker;
+                    Self->VisPass[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
                     break;
                 }
@@ -2090,7 +2303,7 @@ void VisibilityLevel::RaycastSurface(SurfaceDef* Self)
                         m_pRaycast->Material = brushModel->SurfaceMaterials[Self->MaterialIndex];
 
                         // Mark as visible
-                        Self->VisPass = m_VisQueryMarker;
+                        Self->VisPass[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
                     }
                 }
             }
@@ -2125,7 +2338,7 @@ void VisibilityLevel::RaycastSurface(SurfaceDef* Self)
                         hitResult.Material = brushModel->SurfaceMaterials[Self->MaterialIndex];
 
                         // Mark as visible
-                        Self->VisPass = m_VisQueryMarker;
+                        Self->VisPass[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
                         // Find closest hit
                         if (d < m_pRaycastResult->Hits[closestHit].Distance)
@@ -2136,7 +2349,7 @@ void VisibilityLevel::RaycastSurface(SurfaceDef* Self)
                 }
             }
 
-            if (Self->VisPass == m_VisQueryMarker)
+            if (Self->VisPass[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
             {
                 WorldRaycastPrimitive& rcPrimitive = m_pRaycastResult->Primitives.Add();
                 rcPrimitive.Object = nullptr;
@@ -2148,66 +2361,66 @@ void VisibilityLevel::RaycastSurface(SurfaceDef* Self)
     }
 }
 
-void VisibilityLevel::RaycastPrimitive(PrimitiveDef* Self)
+void VisibilityLevel::RaycastPrimitive(VisRaycast& Raycast, WorldRaycastResult* Result, PrimitiveDef* Self)
 {
     // FIXME: What about two sided primitives? Use TwoSided flag directly from material or from primitive?
 
-    if (m_pRaycast->bClosest)
+    if (Raycast.bClosest)
     {
         TriangleHitResult hit;
 
-        if (Self->RaycastClosestCallback && Self->RaycastClosestCallback(Self, m_pRaycast->RayStart, m_pRaycast->HitLocation, hit, &m_pRaycast->pVertices))
+        if (Self->RaycastClosestCallback && Self->RaycastClosestCallback(Self, Raycast.RayStart, Raycast.HitLocation, hit, &Raycast.pVertices))
         {
-            m_pRaycast->HitProxyType = HIT_PROXY_PRIMITIVE;
-            m_pRaycast->HitPrimitive = Self;
-            m_pRaycast->HitLocation = hit.Location;
-            m_pRaycast->HitNormal = hit.Normal;
-            m_pRaycast->HitUV = hit.UV;
-            m_pRaycast->HitDistanceMin = hit.Distance;
-            m_pRaycast->Indices[0] = hit.Indices[0];
-            m_pRaycast->Indices[1] = hit.Indices[1];
-            m_pRaycast->Indices[2] = hit.Indices[2];
-            m_pRaycast->Material = hit.Material;
+            Raycast.HitProxyType = HIT_PROXY_PRIMITIVE;
+            Raycast.HitPrimitive = Self;
+            Raycast.HitLocation = hit.Location;
+            Raycast.HitNormal = hit.Normal;
+            Raycast.HitUV = hit.UV;
+            Raycast.HitDistanceMin = hit.Distance;
+            Raycast.Indices[0] = hit.Indices[0];
+            Raycast.Indices[1] = hit.Indices[1];
+            Raycast.Indices[2] = hit.Indices[2];
+            Raycast.Material = hit.Material;
 
             // TODO:
-            //m_pRaycast->pLightmapVerts = Self->Owner->LightmapUVChannel->GetVertices();
-            //m_pRaycast->LightmapBlock = Self->Owner->LightmapBlock;
-            //m_pRaycast->LightingLevel = Self->Owner->ParentLevel.GetObject();
+            //Raycast.pLightmapVerts = Self->Owner->LightmapUVChannel->GetVertices();
+            //Raycast.LightmapBlock = Self->Owner->LightmapBlock;
+            //Raycast.LightingLevel = Self->Owner->ParentLevel.GetObject();
 
             // Mark primitive visible
-            Self->VisPass = m_VisQueryMarker;
+            Self->VisPass[Raycast.QuerySlot] = Raycast.QueryMarker;
         }
     }
     else
     {
-        int firstHit = m_pRaycastResult->Hits.Size();
-        if (Self->RaycastCallback && Self->RaycastCallback(Self, m_pRaycast->RayStart, m_pRaycast->RayEnd, m_pRaycastResult->Hits))
+        int firstHit = Result->Hits.Size();
+        if (Self->RaycastCallback && Self->RaycastCallback(Self, Raycast.RayStart, Raycast.RayEnd, Result->Hits))
         {
 
-            int numHits = m_pRaycastResult->Hits.Size() - firstHit;
+            int numHits = Result->Hits.Size() - firstHit;
 
             // Find closest hit
             int closestHit = firstHit;
             for (int i = 0; i < numHits; i++)
             {
                 int hitNum = firstHit + i;
-                TriangleHitResult& hitResult = m_pRaycastResult->Hits[hitNum];
+                TriangleHitResult& hitResult = Result->Hits[hitNum];
 
-                if (hitResult.Distance < m_pRaycastResult->Hits[closestHit].Distance)
+                if (hitResult.Distance < Result->Hits[closestHit].Distance)
                 {
                     closestHit = hitNum;
                 }
             }
 
-            WorldRaycastPrimitive& rcPrimitive = m_pRaycastResult->Primitives.Add();
+            WorldRaycastPrimitive& rcPrimitive = Result->Primitives.Add();
 
             rcPrimitive.Object = Self->Owner;
             rcPrimitive.FirstHit = firstHit;
-            rcPrimitive.NumHits = m_pRaycastResult->Hits.Size() - firstHit;
+            rcPrimitive.NumHits = Result->Hits.Size() - firstHit;
             rcPrimitive.ClosestHit = closestHit;
 
             // Mark primitive visible
-            Self->VisPass = m_VisQueryMarker;
+            Self->VisPass[Raycast.QuerySlot] = Raycast.QueryMarker;
         }
     }
 }
@@ -2216,7 +2429,7 @@ void VisibilityLevel::RaycastArea(VisArea* InArea)
 {
     float boxMin, boxMax;
 
-    if (InArea->VisMark == m_VisQueryMarker)
+    if (InArea->VisMark[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
     {
         // Area raycast already processed
         //LOG( "Area raycast already processed\n" );
@@ -2224,7 +2437,7 @@ void VisibilityLevel::RaycastArea(VisArea* InArea)
     }
 
     // Mark area raycast processed
-    InArea->VisMark = m_VisQueryMarker;
+    InArea->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
     if (InArea->NumSurfaces > 0)
     {
@@ -2237,14 +2450,14 @@ void VisibilityLevel::RaycastArea(VisArea* InArea)
 
             SurfaceDef* surf = &model->Surfaces[*pSurfaceIndex];
 
-            if (surf->VisMark == m_VisQueryMarker)
+            if (surf->VisMark[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
             {
                 // Surface raycast already processed
                 continue;
             }
 
             // Mark surface raycast processed
-            surf->VisMark = m_VisQueryMarker;
+            surf->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
             // Filter query group
             if ((surf->QueryGroup & m_pRaycast->VisQueryMask) != m_pRaycast->VisQueryMask)
@@ -2274,7 +2487,7 @@ void VisibilityLevel::RaycastArea(VisArea* InArea)
     {
         PrimitiveDef* primitive = link->Primitive;
 
-        if (primitive->VisMark == m_VisQueryMarker)
+        if (primitive->VisMark[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
         {
             // Primitive raycast already processed
             continue;
@@ -2284,7 +2497,7 @@ void VisibilityLevel::RaycastArea(VisArea* InArea)
         if ((primitive->QueryGroup & m_pRaycast->VisQueryMask) != m_pRaycast->VisQueryMask)
         {
             // Mark primitive raycast processed
-            primitive->VisMark = m_VisQueryMarker;
+            primitive->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
             continue;
         }
 
@@ -2292,7 +2505,7 @@ void VisibilityLevel::RaycastArea(VisArea* InArea)
         if ((primitive->VisGroup & m_pRaycast->VisibilityMask) == 0)
         {
             // Mark primitive raycast processed
-            primitive->VisMark = m_VisQueryMarker;
+            primitive->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
             continue;
         }
 
@@ -2302,7 +2515,7 @@ void VisibilityLevel::RaycastArea(VisArea* InArea)
             if (primitive->Face.DistanceToPoint(m_pRaycast->RayStart) < 0.0f)
             {
                 // Face successfully culled
-                primitive->VisMark = m_VisQueryMarker;
+                primitive->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
                 continue;
             }
         }
@@ -2338,9 +2551,9 @@ void VisibilityLevel::RaycastArea(VisArea* InArea)
         }
 
         // Mark primitive raycast processed
-        primitive->VisMark = m_VisQueryMarker;
+        primitive->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
-        RaycastPrimitive(primitive);
+        RaycastPrimitive(*m_pRaycast, m_pRaycastResult, primitive);
 
 #ifdef CLOSE_ENOUGH_EARLY_OUT
         // hit is close enough to stop ray casting?
@@ -2356,7 +2569,7 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
 {
     float boxMin, boxMax;
 
-    if (InArea->VisMark == m_VisQueryMarker)
+    if (InArea->VisMark[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
     {
         // Area raycast already processed
         //DEBUG( "Area raycast already processed\n" );
@@ -2364,7 +2577,7 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
     }
 
     // Mark area raycast processed
-    InArea->VisMark = m_VisQueryMarker;
+    InArea->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
     if (InArea->NumSurfaces > 0)
     {
@@ -2377,14 +2590,14 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
 
             SurfaceDef* surf = &model->Surfaces[*pSurfaceIndex];
 
-            if (surf->VisMark == m_VisQueryMarker)
+            if (surf->VisMark[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
             {
                 // Surface raycast already processed
                 continue;
             }
 
             // Mark surface raycast processed
-            surf->VisMark = m_VisQueryMarker;
+            surf->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
             // Filter query group
             if ((surf->QueryGroup & m_pRaycast->VisQueryMask) != m_pRaycast->VisQueryMask)
@@ -2416,7 +2629,7 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
             }
 
             // Mark as visible
-            surf->VisPass = m_VisQueryMarker;
+            surf->VisPass[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
             if (m_pRaycast->bClosest)
             {
@@ -2450,7 +2663,7 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
     {
         PrimitiveDef* primitive = link->Primitive;
 
-        if (primitive->VisMark == m_VisQueryMarker)
+        if (primitive->VisMark[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
         {
             // Primitive raycast already processed
             continue;
@@ -2460,7 +2673,7 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
         if ((primitive->QueryGroup & m_pRaycast->VisQueryMask) != m_pRaycast->VisQueryMask)
         {
             // Mark primitive raycast processed
-            primitive->VisMark = m_VisQueryMarker;
+            primitive->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
             continue;
         }
 
@@ -2468,7 +2681,7 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
         if ((primitive->VisGroup & m_pRaycast->VisibilityMask) == 0)
         {
             // Mark primitive raycast processed
-            primitive->VisMark = m_VisQueryMarker;
+            primitive->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
             continue;
         }
 
@@ -2503,10 +2716,10 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
         }
 
         // Mark primitive raycast processed
-        primitive->VisMark = m_VisQueryMarker;
+        primitive->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
         // Mark primitive visible
-        primitive->VisPass = m_VisQueryMarker;
+        primitive->VisPass[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
         if (m_pRaycast->bClosest)
         {
@@ -2536,6 +2749,157 @@ void VisibilityLevel::RaycastPrimitiveBounds(VisArea* InArea)
     }
 }
 
+void VisibilityLevel::RaycastDynamicPrimitives(BvDynamicTree const& DynamicTree, VisRaycast& Raycast, WorldRaycastResult* Result)
+{
+    DynamicTree.Query(
+        [&Raycast](BvAxisAlignedBox const& Bounds)
+        {
+            float boxMin, boxMax;
+            return BvRayIntersectBox(Raycast.RayStart, Raycast.InvRayDir, Bounds, boxMin, boxMax) && boxMin < Raycast.HitDistanceMin;
+        },
+        [&Raycast, Result](void* UserData)
+        {
+            PrimitiveDef* primitive = static_cast<PrimitiveDef*>(UserData);
+            float boxMin, boxMax;
+
+            if (primitive->VisMark[Raycast.QuerySlot] == Raycast.QueryMarker)
+            {
+                // Primitive raycast already processed
+                return;
+            }
+
+            // Mark primitive raycast processed
+            primitive->VisMark[Raycast.QuerySlot] = Raycast.QueryMarker;
+
+            // Filter query group
+            if ((primitive->QueryGroup & Raycast.VisQueryMask) != Raycast.VisQueryMask)
+            {
+                return;
+            }
+
+            // Check primitive visibility group is not visible
+            if ((primitive->VisGroup & Raycast.VisibilityMask) == 0)
+            {
+                return;
+            }
+
+            // Perform face culling
+            if ((primitive->Flags & SURF_PLANAR_TWOSIDED_MASK) == SURF_PLANAR && primitive->Face.DistanceToPoint(Raycast.RayStart) < 0.0f)
+            {
+                return;
+            }
+
+            switch (primitive->Type)
+            {
+                case VSD_PRIMITIVE_BOX:
+                    if (!BvRayIntersectBox(Raycast.RayStart, Raycast.InvRayDir, primitive->Box, boxMin, boxMax))
+                    {
+                        return;
+                    }
+                    break;
+                case VSD_PRIMITIVE_SPHERE:
+                    if (!BvRayIntersectSphere(Raycast.RayStart, Raycast.RayDir, primitive->Sphere, boxMin, boxMax))
+                    {
+                        return;
+                    }
+                    break;
+                default:
+                    HK_ASSERT(0);
+                    return;
+            }
+
+            if (boxMin >= Raycast.HitDistanceMin)
+            {
+                // Ray intersects the box, but box is too far
+                return;
+            }
+
+            RaycastPrimitive(Raycast, Result, primitive);
+        });
+}
+
+void VisibilityLevel::RaycastDynamicPrimitiveBounds(BvDynamicTree const& DynamicTree, VisRaycast& Raycast, TVector<BoxHitResult>* Result)
+{
+    DynamicTree.Query(
+        [&Raycast](BvAxisAlignedBox const& Bounds)
+        {
+            float boxMin, boxMax;
+            return BvRayIntersectBox(Raycast.RayStart, Raycast.InvRayDir, Bounds, boxMin, boxMax) && boxMin < Raycast.HitDistanceMin;
+        },
+        [&Raycast, Result](void* UserData)
+        {
+            PrimitiveDef* primitive = static_cast<PrimitiveDef*>(UserData);
+            float boxMin, boxMax;
+
+            if (primitive->VisMark[Raycast.QuerySlot] == Raycast.QueryMarker)
+            {
+                // Primitive raycast already processed
+                return;
+            }
+
+            // Mark primitive raycast processed
+            primitive->VisMark[Raycast.QuerySlot] = Raycast.QueryMarker;
+
+            // Filter query group
+            if ((primitive->QueryGroup & Raycast.VisQueryMask) != Raycast.VisQueryMask)
+            {
+                return;
+            }
+
+            // Check primitive visibility group is not visible
+            if ((primitive->VisGroup & Raycast.VisibilityMask) == 0)
+            {
+                return;
+            }
+
+            switch (primitive->Type)
+            {
+                case VSD_PRIMITIVE_BOX:
+                    if (!BvRayIntersectBox(Raycast.RayStart, Raycast.InvRayDir, primitive->Box, boxMin, boxMax))
+                    {
+                        return;
+                    }
+                    break;
+                case VSD_PRIMITIVE_SPHERE:
+                    if (!BvRayIntersectSphere(Raycast.RayStart, Raycast.RayDir, primitive->Sphere, boxMin, boxMax))
+                    {
+                        return;
+                    }
+                    break;
+                default:
+                    HK_ASSERT(0);
+                    return;
+            }
+
+            if (boxMin >= Raycast.HitDistanceMin)
+            {
+                // Ray intersects the box, but box is too far
+                return;
+            }
+
+            // Mark primitive visible
+            primitive->VisPass[Raycast.QuerySlot] = Raycast.QueryMarker;
+
+            if (Raycast.bClosest)
+            {
+                Raycast.HitProxyType = HIT_PROXY_PRIMITIVE;
+                Raycast.HitPrimitive = primitive;
+                Raycast.HitDistanceMin = boxMin;
+                Raycast.HitDistanceMax = boxMax;
+            }
+            else
+            {
+                BoxHitResult& hitResult = Result->Add();
+
+                hitResult.Object = primitive->Owner;
+                hitResult.LocationMin = Raycast.RayStart + Raycast.RayDir * boxMin;
+                hitResult.LocationMax = Raycast.RayStart + Raycast.RayDir * boxMax;
+                hitResult.DistanceMin = boxMin;
+                hitResult.DistanceMax = boxMax;
+            }
+        });
+}
+
 #if 0
 void VisibilitySystem::LevelRaycast_r( int NodeIndex ) {
     NodeBase const * node;
@@ -2835,14 +3199,14 @@ void VisibilityLevel::LevelRaycastPortals_r(VisArea* InArea)
     for (PortalLink const* portal = InArea->PortalList; portal; portal = portal->Next)
     {
 
-        if (portal->Portal->VisMark == m_VisQueryMarker)
+        if (portal->Portal->VisMark[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
         {
             // Already visited
             continue;
         }
 
         // Mark visited
-        portal->Portal->VisMark = m_VisQueryMarker;
+        portal->Portal->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
         if (portal->Portal->bBlocked)
         {
@@ -2907,14 +3271,14 @@ void VisibilityLevel::LevelRaycastBoundsPortals_r(VisArea* InArea)
     for (PortalLink const* portal = InArea->PortalList; portal; portal = portal->Next)
     {
 
-        if (portal->Portal->VisMark == m_VisQueryMarker)
+        if (portal->Portal->VisMark[m_pRaycast->QuerySlot] == m_pRaycast->QueryMarker)
         {
             // Already visited
             continue;
         }
 
         // Mark visited
-        portal->Portal->VisMark = m_VisQueryMarker;
+        portal->Portal->VisMark[m_pRaycast->QuerySlot] = m_pRaycast->QueryMarker;
 
         if (portal->Portal->bBlocked)
         {
@@ -3088,11 +3452,16 @@ void VisibilityLevel::ProcessLevelRaycastClosestBounds(VisRaycast& Raycast)
     }
 }
 
-bool VisibilityLevel::RaycastTriangles(TVector<VisibilityLevel*> const& levels, WorldRaycastResult& Result, Float3 const& InRayStart, Float3 const& InRayEnd, WorldRaycastFilter const* InFilter)
+bool VisibilityLevel::RaycastTriangles(TVector<VisibilityLevel*> const& levels, BvDynamicTree const& DynamicTree, WorldRaycastResult& Result, Float3 const& InRayStart, Float3 const& InRayEnd, WorldRaycastFilter const* InFilter)
 {
     VisRaycast Raycast;
 
-    ++m_VisQueryMarker;
+    TLockGuard<Mutex> lock(VisRaycastLock);
+
+    VisQuerySlot querySlot;
+
+    Raycast.QuerySlot = querySlot.Slot;
+    Raycast.QueryMarker = querySlot.Marker;
 
     InFilter = InFilter ? InFilter : &DefaultRaycastFilter;
 
@@ -3126,6 +3495,8 @@ bool VisibilityLevel::RaycastTriangles(TVector<VisibilityLevel*> const& levels,
         level->ProcessLevelRaycast(Raycast, Result);
     }
 
+    RaycastDynamicPrimitives(DynamicTree, Raycast, &Result);
+
     if (Result.Primitives.IsEmpty())
     {
         return false;
@@ -3139,11 +3510,16 @@ bool VisibilityLevel::RaycastTriangles(TVector<VisibilityLevel*> const& levels,
     return true;
 }
 
-bool VisibilityLevel::RaycastClosest(TVector<VisibilityLevel*> const& levels, WorldRaycastClosestResult& Result, Float3 const& InRayStart, Float3 const& InRayEnd, WorldRaycastFilter const* InFilter)
+bool VisibilityLevel::RaycastClosest(TVector<VisibilityLevel*> const& levels, BvDynamicTree const& DynamicTree, WorldRaycastClosestResult& Result, Float3 const& InRayStart, Float3 const& InRayEnd, WorldRaycastFilter const* InFilter)
 {
     VisRaycast Raycast;
 
-    ++m_VisQueryMarker;
+    TLockGuard<Mutex> lock(VisRaycastLock);
+
+    VisQuerySlot querySlot;
+
+    Raycast.QuerySlot = querySlot.Slot;
+    Raycast.QueryMarker = querySlot.Marker;
 
     InFilter = InFilter ? InFilter : &DefaultRaycastFilter;
 
@@ -3188,6 +3564,8 @@ bool VisibilityLevel::RaycastClosest(TVector<VisibilityLevel*> const& levels, Wo
 #endif
     }
 
+    RaycastDynamicPrimitives(DynamicTree, Raycast, nullptr);
+
     //DEBUG( "NumHits %d\n", Raycast.NumHits );
 
     if (Raycast.HitProxyType == HIT_PROXY_PRIMITIVE)
@@ -3264,11 +3642,16 @@ bool VisibilityLevel::RaycastClosest(TVector<VisibilityLevel*> const& levels, Wo
     return true;
 }
 
-bool VisibilityLevel::RaycastBounds(TVector<VisibilityLevel*> const& levels, TVector<BoxHitResult>& Result, Float3 const& InRayStart, Float3 const& InRayEnd, WorldRaycastFilter const* InFilter)
+bool VisibilityLevel::RaycastBounds(TVector<VisibilityLevel*> const& levels, BvDynamicTree const& DynamicTree, TVector<BoxHitResult>& Result, Float3 const& InRayStart, Float3 const& InRayEnd, WorldRaycastFilter const* InFilter)
 {
     VisRaycast Raycast;
 
-    ++m_VisQueryMarker;
+    TLockGuard<Mutex> lock(VisRaycastLock);
+
+    VisQuerySlot querySlot;
+
+    Raycast.QuerySlot = querySlot.Slot;
+    Raycast.QueryMarker = querySlot.Marker;
 
     InFilter = InFilter ? InFilter : &DefaultRaycastFilter;
 
@@ -3302,6 +3685,8 @@ bool VisibilityLevel::RaycastBounds(TVector<VisibilityLevel*> const& levels, TVe
         level->ProcessLevelRaycastBounds(Raycast, Result);
     }
 
+    RaycastDynamicPrimitiveBounds(DynamicTree, Raycast, &Result);
+
     if (Result.IsEmpty())
     {
         return false;
@@ -3323,11 +3708,16 @@ bool VisibilityLevel::RaycastBounds(TVector<VisibilityLevel*> const& levels, TVe
     return true;
 }
 
-bool VisibilityLevel::RaycastClosestBounds(TVector<VisibilityLevel*> const& levels, BoxHitResult& Result, Float3 const& InRayStart, Float3 const& InRayEnd, WorldRaycastFilter const* InFilter)
+bool VisibilityLevel::RaycastClosestBounds(TVector<VisibilityLevel*> const& levels, BvDynamicTree const& DynamicTree, BoxHitResult& Result, Float3 const& InRayStart, Float3 const& InRayEnd, WorldRaycastFilter const* InFilter)
 {
     VisRaycast Raycast;
 
-    ++m_VisQueryMarker;
+    TLockGuard<Mutex> lock(VisRaycastLock);
+
+    VisQuerySlot querySlot;
+
+    Raycast.QuerySlot = querySlot.Slot;
+    Raycast.QueryMarker = querySlot.Marker;
 
     InFilter = InFilter ? InFilter : &DefaultRaycastFilter;
 
@@ -3370,6 +3760,8 @@ bool VisibilityLevel::RaycastClosestBounds(TVector<VisibilityLevel*> const& leve
 #endif
     }
 
+    RaycastDynamicPrimitiveBounds(DynamicTree, Raycast, nullptr);
+
     if (Raycast.HitProxyType == HIT_PROXY_PRIMITIVE)
     {
         Result.Object = Raycast.HitPrimitive->Owner;
@@ -3394,6 +3786,15 @@ bool VisibilityLevel::RaycastClosestBounds(TVector<VisibilityLevel*> const& leve
 }
 
 
+static BvAxisAlignedBox GetPrimitiveBounds(PrimitiveDef const* Primitive)
+{
+    if (Primitive->Type == VSD_PRIMITIVE_SPHERE)
+    {
+        return BvAxisAlignedBox(Primitive->Sphere.Center, Primitive->Sphere.Radius);
+    }
+    return Primitive->Box;
+}
+
 TPoolAllocator<PrimitiveDef> VisibilitySystem::PrimitivePool;
 TPoolAllocator<PrimitiveLink> VisibilitySystem::PrimitiveLinkPool;
 
@@ -3466,6 +3867,7 @@ void VisibilitySystem::RemovePrimitive(PrimitiveDef* Primitive)
     INTRUSIVE_REMOVE(Primitive, NextUpd, PrevUpd, m_PrimitiveDirtyList, m_PrimitiveDirtyListTail);
 
     UnlinkPrimitive(Primitive);
+    RemoveDynamicProxy(Primitive);
 }
 
 void VisibilitySystem::RemovePrimitives()
@@ -3477,11 +3879,18 @@ void VisibilitySystem::RemovePrimitives()
     {
         UnlinkPrimitive(primitive);
 
+        primitive->DynamicProxy = BvDynamicTree::NullNode;
+        primitive->PrevDyn = primitive->NextDyn = nullptr;
+        primitive->MoveCount = 0;
+
         next = primitive->Next;
         primitive->Prev = primitive->Next = nullptr;
     }
 
     m_PrimitiveList = m_PrimitiveListTail = nullptr;
+    m_DynamicPrimitiveList = m_DynamicPrimitiveListTail = nullptr;
+
+    m_DynamicTree.Clear();
 }
 
 void VisibilitySystem::MarkPrimitive(PrimitiveDef* Primitive)
@@ -3492,14 +3901,25 @@ void VisibilitySystem::MarkPrimitive(PrimitiveDef* Primitive)
         return;
     }
 
-    INTRUSIVE_ADD_UNIQUE(Primitive, NextUpd, PrevUpd, m_PrimitiveDirtyList, m_PrimitiveDirtyListTail);
+    if (INTRUSIVE_EXISTS(Primitive, NextUpd, PrevUpd, m_PrimitiveDirtyList, m_PrimitiveDirtyListTail))
+    {
+        // Already marked
+        return;
+    }
+
+    INTRUSIVE_ADD(Primitive, NextUpd, PrevUpd, m_PrimitiveDirtyList, m_PrimitiveDirtyListTail);
+
+    // Count consecutive frames of movement
+    Primitive->MoveCount = Primitive->LastMoveFrame + 1 == m_UpdateFrame ? Primitive->MoveCount + 1 : 1;
+    Primitive->LastMoveFrame = m_UpdateFrame;
 }
 
 void VisibilitySystem::MarkPrimitives()
 {
+    // Relink all primitives, but don't count it as a movement
     for (PrimitiveDef* primitive = m_PrimitiveList; primitive; primitive = primitive->Next)
     {
-        MarkPrimitive(primitive);
+        INTRUSIVE_ADD_UNIQUE(primitive, NextUpd, PrevUpd, m_PrimitiveDirtyList, m_PrimitiveDirtyListTail);
     }
 }
 
@@ -3518,22 +3938,62 @@ void VisibilitySystem::UpdatePrimitiveLinks()
 {
     PrimitiveDef* next;
 
+    const bool bDynamicPrimitives = vsd_DynamicPrimitives;
+
     // First Pass: remove primitives from the areas
     for (PrimitiveDef* primitive = m_PrimitiveDirtyList; primitive; primitive = primitive->NextUpd)
     {
+        if (primitive->DynamicProxy != BvDynamicTree::NullNode)
+        {
+            if (!bDynamicPrimitives)
+            {
+                RemoveDynamicProxy(primitive);
+            }
+            continue;
+        }
+
         UnlinkPrimitive(primitive);
+
+        if (bDynamicPrimitives && primitive->MoveCount >= VSD_DYNAMIC_PRIMITIVE_MOVES)
+        {
+            // Primitive keeps moving. Move it from the areas to the dynamic tree.
+            primitive->DynamicProxy = m_DynamicTree.CreateProxy(GetPrimitiveBounds(primitive), primitive);
+            INTRUSIVE_ADD(primitive, NextDyn, PrevDyn, m_DynamicPrimitiveList, m_DynamicPrimitiveListTail);
+        }
     }
 
-    // Second Pass: add primitives to the areas
+    // Second Pass: add primitives to the areas or refit the dynamic tree
     for (PrimitiveDef* primitive = m_PrimitiveDirtyList; primitive; primitive = next)
     {
-        VisibilityLevel::AddPrimitiveToLevelAreas(m_Levels, primitive);
+        if (primitive->DynamicProxy != BvDynamicTree::NullNode)
+        {
+            m_DynamicTree.MoveProxy(primitive->DynamicProxy, GetPrimitiveBounds(primitive));
+        }
+        else
+        {
+            VisibilityLevel::AddPrimitiveToLevelAreas(m_Levels, primitive);
+        }
 
         next = primitive->NextUpd;
         primitive->PrevUpd = primitive->NextUpd = nullptr;
     }
 
     m_PrimitiveDirtyList = m_PrimitiveDirtyListTail = nullptr;
+
+    // Third Pass: primitives in the dynamic tree lose PVS and portal culling, so return them to the areas when
+    // they stop moving
+    for (PrimitiveDef* primitive = m_DynamicPrimitiveList; primitive; primitive = next)
+    {
+        next = primitive->NextDyn;
+
+        if (!bDynamicPrimitives || m_UpdateFrame - primitive->LastMoveFrame >= VSD_DYNAMIC_PRIMITIVE_REST_FRAMES)
+        {
+            RemoveDynamicProxy(primitive);
+            VisibilityLevel::AddPrimitiveToLevelAreas(m_Levels, primitive);
+        }
+    }
+
+    m_UpdateFrame++;
 }
 
 void VisibilitySystem::UnlinkPrimitive(PrimitiveDef* Primitive)
@@ -3573,12 +4033,38 @@ void VisibilitySystem::UnlinkPrimitive(PrimitiveDef* Primitive)
     Primitive->Links = nullptr;
 }
 
+void VisibilitySystem::RemoveDynamicProxy(PrimitiveDef* Primitive)
+{
+    if (Primitive->DynamicProxy != BvDynamicTree::NullNode)
+    {
+        m_DynamicTree.DestroyProxy(Primitive->DynamicProxy);
+        Primitive->DynamicProxy = BvDynamicTree::NullNode;
+
+        INTRUSIVE_REMOVE(Primitive, NextDyn, PrevDyn, m_DynamicPrimitiveList, m_DynamicPrimitiveListTail);
+    }
+    Primitive->MoveCount = 0;
+}
+
 void VisibilitySystem::DrawDebug(DebugRenderer* Renderer)
 {
     for (VisibilityLevel* level : m_Levels)
     {
         level->DrawDebug(Renderer);
     }
+
+    if (com_DrawDynamicPrimitives)
+    {
+        Renderer->SetDepthTest(false);
+        Renderer->SetColor(Color4(1, 0, 1, 1));
+
+        for (PrimitiveDef* primitive = m_PrimitiveList; primitive; primitive = primitive->Next)
+        {
+            if (primitive->DynamicProxy != BvDynamicTree::NullNode)
+            {
+                Renderer->DrawAABB(m_DynamicTree.GetFatBounds(primitive->DynamicProxy));
+            }
+        }
+    }
 }
 
 void VisibilitySystem::QueryOverplapAreas(BvAxisAlignedBox const& Bounds, TVector<VisArea*>& m_Areas) const
@@ -3599,27 +4085,44 @@ void VisibilitySystem::QueryOverplapAreas(BvSphere const& Bounds, TVector<VisAre
 
 void VisibilitySystem::QueryVisiblePrimitives(TVector<PrimitiveDef*>& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& Query) const
 {
-    VisibilityLevel::QueryVisiblePrimitives(m_Levels, VisPrimitives, VisSurfs, VisPass, Query);
+    TVector<PrimitiveDef*>* lists[VSD_PRIMITIVE_KIND_MAX];
+    for (int kind = 0; kind < VSD_PRIMITIVE_KIND_MAX; kind++)
+    {
+        lists[kind] = &VisPrimitives;
+    }
+
+    VisibilityLevel::QueryVisiblePrimitives(m_Levels, m_DynamicTree, lists, VisSurfs, VisPass, Query);
+}
+
+void VisibilitySystem::QueryVisiblePrimitives(VisPrimitiveBuckets& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& Query) const
+{
+    TVector<PrimitiveDef*>* lists[VSD_PRIMITIVE_KIND_MAX];
+    for (int kind = 0; kind < VSD_PRIMITIVE_KIND_MAX; kind++)
+    {
+        lists[kind] = &VisPrimitives.Buckets[kind];
+    }
+
+    VisibilityLevel::QueryVisiblePrimitives(m_Levels, m_DynamicTree, lists, VisSurfs, VisPass, Query);
 }
 
 bool VisibilitySystem::RaycastTriangles(WorldRaycastResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter) const
 {
-    return VisibilityLevel::RaycastTriangles(m_Levels, Result, RayStart, RayEnd, Filter);
+    return VisibilityLevel::RaycastTriangles(m_Levels, m_DynamicTree, Result, RayStart, RayEnd, Filter);
 }
 
 bool VisibilitySystem::RaycastClosest(WorldRaycastClosestResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter) const
 {
-    return VisibilityLevel::RaycastClosest(m_Levels, Result, RayStart, RayEnd, Filter);
+    return VisibilityLevel::RaycastClosest(m_Levels, m_DynamicTree, Result, RayStart, RayEnd, Filter);
 }
 
 bool VisibilitySystem::RaycastBounds(TVector<BoxHitResult>& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter) const
 {
-    return VisibilityLevel::RaycastBounds(m_Levels, Result, RayStart, RayEnd, Filter);
+    return VisibilityLevel::RaycastBounds(m_Levels, m_DynamicTree, Result, RayStart, RayEnd, Filter);
 }
 
 bool VisibilitySystem::RaycastClosestBounds(BoxHitResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter) const
 {
-    return VisibilityLevel::RaycastClosestBounds(m_Levels, Result, RayStart, RayEnd, Filter);
+    return VisibilityLevel::RaycastClosestBounds(m_Levels, m_DynamicTree, Result, RayStart, RayEnd, Filter);
 }
 
 HK_NAMESPACE_END
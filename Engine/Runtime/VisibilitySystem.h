@@ -35,6 +35,7 @@ SOFTWARE.
 #include "HitTest.h"
 #include <Engine/Renderer/RenderDefs.h>
 #include <Engine/Core/Platform/Memory/PoolAllocator.h>
+#include <Engine/Geometry/BV/BvDynamicTree.h>
 
 HK_NAMESPACE_BEGIN
 
@@ -52,12 +53,36 @@ struct PrimitiveDef;
 struct PortalLink;
 struct PrimitiveLink;
 
+/** Maximum number of visibility queries/raycasts that can run concurrently. Must be a power of two. */
+constexpr int VSD_MAX_QUERY_SLOTS = 8;
+
+/** Decompressed PVS rows cached per query slot */
+constexpr int VSD_PVS_CACHE_SIZE = 4;
+
+/** Get query slot from the visibility marker. Markers of the slot are always equal to the slot index modulo VSD_MAX_QUERY_SLOTS. */
+HK_FORCEINLINE int VSD_QuerySlot(int VisMarker)
+{
+    return VisMarker & (VSD_MAX_QUERY_SLOTS - 1);
+}
+
 enum VSD_PRIMITIVE
 {
     VSD_PRIMITIVE_BOX,
     VSD_PRIMITIVE_SPHERE
 };
 
+/** Kind of the primitive owner. Allows to dispatch primitives without upcasting the owner. */
+enum VSD_PRIMITIVE_KIND : uint8_t
+{
+    VSD_PRIMITIVE_KIND_UNKNOWN,
+    VSD_PRIMITIVE_KIND_DRAWABLE,
+    VSD_PRIMITIVE_KIND_TERRAIN,
+    VSD_PRIMITIVE_KIND_PUNCTUAL_LIGHT,
+    VSD_PRIMITIVE_KIND_ENVIRONMENT_PROBE,
+
+    VSD_PRIMITIVE_KIND_MAX
+};
+
 enum VSD_QUERY_MASK : uint32_t
 {
     VSD_QUERY_MASK_VISIBLE = 0x00000001,
@@ -178,6 +203,21 @@ struct PrimitiveDef
     /** Prev primitive in update list */
     PrimitiveDef* PrevUpd{};
 
+    /** Next primitive in the dynamic tree */
+    PrimitiveDef* NextDyn{};
+
+    /** Prev primitive in the dynamic tree */
+    PrimitiveDef* PrevDyn{};
+
+    /** Proxy in the dynamic tree. BvDynamicTree::NullNode if the primitive is linked to the level areas. */
+    int DynamicProxy{BvDynamicTree::NullNode};
+
+    /** How many consecutive frames the primitive was marked dirty. Used to detect moving primitives. */
+    int MoveCount{};
+
+    /** Last frame the primitive was marked dirty */
+    int LastMoveFrame{-1};
+
     /** Callback for local raycast */
     PRIMITIVE_RAYCAST_CALLBACK RaycastCallback{};
 
@@ -189,6 +229,9 @@ struct PrimitiveDef
     /** Primitive type */
     VSD_PRIMITIVE Type{VSD_PRIMITIVE_BOX};
 
+    /** Kind of the owner component */
+    VSD_PRIMITIVE_KIND Kind{VSD_PRIMITIVE_KIND_UNKNOWN};
+
     /** Primitive bounding shape. Used if type = VSD_PRIMITIVE_BOX */
     BvAxisAlignedBox Box{BvAxisAlignedBox::Empty()};
 
@@ -204,11 +247,11 @@ struct PrimitiveDef
     /** Visibility group. See VISIBILITY_GROUP enum. */
     VISIBILITY_GROUP VisGroup{VISIBILITY_GROUP_DEFAULT};
 
-    /** Visibility/raycast processed marker. Used by VSD. */
-    int VisMark{};
+    /** Visibility/raycast processed marker per query slot. Used by VSD. */
+    int VisMark[VSD_MAX_QUERY_SLOTS]{};
 
-    /** Primitve marked as visible. Used by VSD. */
-    int VisPass{};
+    /** Primitve marked as visible per query slot. Used by VSD. */
+    int VisPass[VSD_MAX_QUERY_SLOTS]{};
 
     /** Surface flags (SURFACE_FLAGS) */
     SURFACE_FLAGS Flags{};
@@ -228,6 +271,28 @@ struct PrimitiveDef
     {
         return VisGroup;
     }
+
+    /** Is primitive marked as visible by the query with given vis pass */
+    bool IsVisibleInPass(int InVisPass) const
+    {
+        return VisPass[VSD_QuerySlot(InVisPass)] == InVisPass;
+    }
+};
+
+/** Visible primitives split by kind */
+struct VisPrimitiveBuckets
+{
+    TVector<PrimitiveDef*> Buckets[VSD_PRIMITIVE_KIND_MAX];
+
+    TVector<PrimitiveDef*>& operator[](VSD_PRIMITIVE_KIND Kind) { return Buckets[Kind]; }
+
+    TVector<PrimitiveDef*> const& operator[](VSD_PRIMITIVE_KIND Kind) const { return Buckets[Kind]; }
+
+    void Clear()
+    {
+        for (TVector<PrimitiveDef*>& bucket : Buckets)
+            bucket.Clear();
+    }
 };
 
 struct PrimitiveLink
@@ -262,8 +327,8 @@ struct VisPortal
     /** Portal to areas */
     PortalLink* Portals[2];
 
-    /** Visibility marker */
-    int VisMark;
+    /** Visibility marker per query slot */
+    int VisMark[VSD_MAX_QUERY_SLOTS];
 
     /** Block visibility (for doors) */
     bool bBlocked;
@@ -310,8 +375,8 @@ struct VisArea
     /** Count of the baked surfaces attached to the area */
     int NumSurfaces;
 
-    /** Visibility/raycast processed marker. Used by VSD. */
-    int VisMark;
+    /** Visibility/raycast processed marker per query slot. Used by VSD. */
+    int VisMark[VSD_MAX_QUERY_SLOTS];
 };
 
 struct VisibilityQuery
@@ -525,11 +590,11 @@ struct SurfaceDef
     /** Visibility group. See VISIBILITY_GROUP enum. */
     int VisGroup;
 
-    /** Visibility/raycast processed marker. Used by VSD. */
-    int VisMark;
+    /** Visibility/raycast processed marker per query slot. Used by VSD. */
+    int VisMark[VSD_MAX_QUERY_SLOTS];
 
-    /** Surface marked as visible. Used by VSD. */
-    int VisPass;
+    /** Surface marked as visible per query slot. Used by VSD. */
+    int VisPass[VSD_MAX_QUERY_SLOTS];
 
     /** Drawable rendering order */
     //uint8_t RenderingOrder;
@@ -560,8 +625,8 @@ struct NodeBase
     /** Parent node */
     struct BinarySpaceNode* Parent;
 
-    /** Visited mark */
-    int ViewMark;
+    /** Visited mark per query slot */
+    int ViewMark[VSD_MAX_QUERY_SLOTS];
 
     /** Node bounding box (for culling) */
     BvAxisAlignedBox Bounds;
@@ -787,6 +852,9 @@ public:
 
     void QueryVisiblePrimitives(TVector<PrimitiveDef*>& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& Query) const;
 
+    /** Query visible primitives sorted into buckets by primitive kind */
+    void QueryVisiblePrimitives(VisPrimitiveBuckets& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& Query) const;
+
     bool RaycastTriangles(WorldRaycastResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter) const;
 
     bool RaycastClosest(WorldRaycastClosestResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter) const;
@@ -797,6 +865,9 @@ public:
 
     TVector<VisibilityLevel*> const& GetLevels() const { return m_Levels; }
 
+    /** Moving primitives are kept in the dynamic tree instead of the level areas */
+    BvDynamicTree const& GetDynamicTree() const { return m_DynamicTree; }
+
     static TPoolAllocator<PrimitiveDef> PrimitivePool;
     static TPoolAllocator<PrimitiveLink> PrimitiveLinkPool;
 
@@ -807,14 +878,26 @@ private:
     /** Unlink primitive from the level areas */
     void UnlinkPrimitive(PrimitiveDef* Primitive);
 
+    /** Remove primitive from the dynamic tree */
+    void RemoveDynamicProxy(PrimitiveDef* Primitive);
+
     TVector<VisibilityLevel*> m_Levels;
 
+    BvDynamicTree m_DynamicTree;
+
     PrimitiveDef* m_PrimitiveList = nullptr;
     PrimitiveDef* m_PrimitiveListTail = nullptr;
     PrimitiveDef* m_PrimitiveDirtyList = nullptr;
     PrimitiveDef* m_PrimitiveDirtyListTail = nullptr;
+    PrimitiveDef* m_DynamicPrimitiveList = nullptr;
+    PrimitiveDef* m_DynamicPrimitiveListTail = nullptr;
+
+    /** Incremented on each UpdatePrimitiveLinks */
+    int m_UpdateFrame = 0;
 };
 
+struct VisibilityQueryContext;
+
 class VisibilityLevel : public RefCounted
 {
 public:
@@ -839,8 +922,8 @@ public:
     /** Find level area */
     VisArea* FindArea(Float3 const& _Position);
 
-    /** Mark potentially visible leafs. Uses PVS */
-    int MarkLeafs(int _ViewLeaf);
+    /** Mark potentially visible leafs for the query slot. Uses PVS */
+    int MarkLeafs(int _ViewLeaf, int QuerySlot = 0);
 
     /** BSP leafs */
     ArrayOfLeafs const& GetLeafs() const { return m_Leafs; }
@@ -856,22 +939,23 @@ public:
 
     void DrawDebug(DebugRenderer* Renderer);
 
-    static void QueryVisiblePrimitives(TVector<VisibilityLevel*> const& Levels, TVector<PrimitiveDef*>& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& Query);
+    /** VisPrimitives is an array of output lists indexed by primitive kind. The lists may point to the same vector. */
+    static void QueryVisiblePrimitives(TVector<VisibilityLevel*> const& Levels, BvDynamicTree const& DynamicTree, TVector<PrimitiveDef*>* const* VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& Query);
 
-    static bool RaycastTriangles(TVector<VisibilityLevel*> const& Levels, WorldRaycastResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter);
+    static bool RaycastTriangles(TVector<VisibilityLevel*> const& Levels, BvDynamicTree const& DynamicTree, WorldRaycastResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter);
 
-    static bool RaycastClosest(TVector<VisibilityLevel*> const& Levels, WorldRaycastClosestResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter);
+    static bool RaycastClosest(TVector<VisibilityLevel*> const& Levels, BvDynamicTree const& DynamicTree, WorldRaycastClosestResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter);
 
-    static bool RaycastBounds(TVector<VisibilityLevel*> const& Levels, TVector<BoxHitResult>& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter);
+    static bool RaycastBounds(TVector<VisibilityLevel*> const& Levels, BvDynamicTree const& DynamicTree, TVector<BoxHitResult>& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter);
 
-    static bool RaycastClosestBounds(TVector<VisibilityLevel*> const& Levels, BoxHitResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter);
+    static bool RaycastClosestBounds(TVector<VisibilityLevel*> const& Levels, BvDynamicTree const& DynamicTree, BoxHitResult& Result, Float3 const& RayStart, Float3 const& RayEnd, WorldRaycastFilter const* Filter);
 
 private:
     void CreatePortals(PortalDef const* Portals, int PortalsCount, Float3 const* HullVertices);
 
-    byte const* LeafPVS(BinarySpaceLeaf const* _Leaf);
+    byte const* LeafPVS(BinarySpaceLeaf const* _Leaf, int QuerySlot);
 
-    byte const* DecompressVisdata(byte const* _Data);
+    void DecompressVisdata(byte const* _Data, byte* _Decompressed) const;
 
     void QueryOverplapAreas_r(int NodeIndex, BvAxisAlignedBox const& Bounds, TVector<VisArea*>& Areas);
     void QueryOverplapAreas_r(int NodeIndex, BvSphere const& Bounds, TVector<VisArea*>& Areas);
@@ -881,24 +965,26 @@ private:
 
     void AddPrimitiveToArea(VisArea* Area, PrimitiveDef* Primitive);
 
-    void ProcessLevelVisibility(struct VisibilityQueryContext& QueryContext, struct VisibilityQueryResult& QueryResult);
+    void ProcessLevelVisibility(VisibilityQueryContext& QueryContext);
 
-    void LevelTraverse_r(int NodeIndex, int CullBits);
+    void LevelTraverse_r(VisibilityQueryContext& QueryContext, int NodeIndex, int CullBits);
 
-    bool CullNode(PlaneF const Frustum[PortalStack::MAX_CULL_PLANES], BvAxisAlignedBox const& Bounds, int& CullBits);
+    static bool CullNode(VisibilityQueryContext const& QueryContext, BvAxisAlignedBox const& Bounds, int& CullBits);
 
-    void FlowThroughPortals_r(VisArea const* Area);
+    void FlowThroughPortals_r(VisibilityQueryContext& QueryContext, VisArea const* Area);
 
-    bool CalcPortalStack(PortalStack* OutStack, PortalStack const* PrevStack, PortalLink const* Portal);
+    static bool CalcPortalStack(VisibilityQueryContext& QueryContext, PortalStack* OutStack, PortalStack const* PrevStack, PortalLink const* Portal);
 
-    struct PortalHull* CalcPortalWinding(PortalLink const* Portal, PortalStack const* Stack);
+    static struct PortalHull* CalcPortalWinding(VisibilityQueryContext& QueryContext, PortalLink const* Portal, PortalStack const* Stack);
 
-    void CalcPortalScissor(PortalScissor& OutScissor, PortalHull const* Hull, PortalStack const* Stack);
+    static void CalcPortalScissor(VisibilityQueryContext const& QueryContext, PortalScissor& OutScissor, PortalHull const* Hull, PortalStack const* Stack);
 
-    void CullPrimitives(VisArea const* Area, PlaneF const* CullPlanes, const int CullPlanesCount);
+    void CullPrimitives(VisibilityQueryContext& QueryContext, VisArea const* Area, PlaneF const* CullPlanes, const int CullPlanesCount);
 
-    bool FaceCull(PrimitiveDef const* Primitive);
-    bool FaceCull(SurfaceDef const* Surface);
+    static void CullDynamicPrimitives(VisibilityQueryContext& QueryContext, BvDynamicTree const& DynamicTree);
+
+    static bool FaceCull(VisibilityQueryContext const& QueryContext, PrimitiveDef const* Primitive);
+    static bool FaceCull(VisibilityQueryContext const& QueryContext, SurfaceDef const* Surface);
 
     enum HIT_PROXY_TYPE
     {
@@ -937,6 +1023,9 @@ private:
 
         bool bClosest;
 
+        int QuerySlot;
+        int QueryMarker;
+
         VSD_QUERY_MASK VisQueryMask;
         VISIBILITY_GROUP VisibilityMask;
     };
@@ -945,7 +1034,9 @@ private:
     void ProcessLevelRaycastBounds(VisRaycast& Raycast, TVector<BoxHitResult>& Result);
     void ProcessLevelRaycastClosestBounds(VisRaycast& Raycast);
     void RaycastSurface(SurfaceDef* Self);
-    void RaycastPrimitive(PrimitiveDef* Self);
+    static void RaycastPrimitive(VisRaycast& Raycast, WorldRaycastResult* Result, PrimitiveDef* Self);
+    static void RaycastDynamicPrimitives(BvDynamicTree const& DynamicTree, VisRaycast& Raycast, WorldRaycastResult* Result);
+    static void RaycastDynamicPrimitiveBounds(BvDynamicTree const& DynamicTree, VisRaycast& Raycast, TVector<BoxHitResult>* Result);
     void RaycastArea(VisArea* Area);
     void RaycastPrimitiveBounds(VisArea* Area);
     void LevelRaycast_r(int NodeIndex);
@@ -986,8 +1077,28 @@ private:
     /** PVS data */
     byte* m_Visdata = nullptr;
 
+    /** Decompressed PVS rows, VSD_PVS_CACHE_SIZE rows per query slot */
     byte* m_DecompressedVisData = nullptr;
 
+    /** Size of decompressed PVS row in bytes, aligned to 64-bit words */
+    int m_DecompressedRowSize = 0;
+
+    struct PVSCacheEntry
+    {
+        int Cluster = -1;
+        uint32_t LastUsed = 0;
+    };
+
+    /** LRU cache of decompressed PVS rows per query slot */
+    PVSCacheEntry m_PVSCache[VSD_MAX_QUERY_SLOTS][VSD_PVS_CACHE_SIZE];
+    uint32_t m_PVSCacheTime[VSD_MAX_QUERY_SLOTS]{};
+
+    /** Leafs sorted by PVS cluster */
+    TVector<int> m_ClusterLeafs;
+
+    /** First leaf in m_ClusterLeafs for each cluster. Contains m_PVSClustersCount + 1 elements. */
+    TVector<int> m_ClusterFirstLeaf;
+
     /** Is PVS data compressed or not (ZRLE) */
     bool m_bCompressedVisData = false;
 
@@ -997,11 +1108,11 @@ private:
     /** Visibility method */
     LEVEL_VISIBILITY_METHOD m_VisibilityMethod = LEVEL_VISIBILITY_PORTAL;
 
-    /** Node visitor mark */
-    int m_ViewMark = 0;
+    /** Node visitor mark per query slot */
+    int m_ViewMark[VSD_MAX_QUERY_SLOTS]{};
 
-    /** Cluster index for view origin */
-    int m_ViewCluster = -1;
+    /** Cluster index for view origin per query slot */
+    int m_ViewCluster[VSD_MAX_QUERY_SLOTS];
 
     /** Surface to area attachments */
     TVector<int> m_AreaSurfaces;
@@ -1009,16 +1120,7 @@ private:
     /** Baked surface data */
     TRef<BrushModel> m_Model;
 
-    // Visibility query temp vars:
-    static int m_VisQueryMarker;
-    int m_CachedSignBits[PortalStack::MAX_CULL_PLANES]; // sign bits of ViewFrustum planes
-    PlaneF* m_ViewFrustum;
-    int m_ViewFrustumPlanes;
-    int m_NodeViewMark;
-    VisibilityQueryContext* m_pQueryContext;
-    VisibilityQueryResult* m_pQueryResult;
-
-    //Raycast temp vars
+    //Raycast temp vars. Raycasts are serialized, see VisRaycastLock.
     VisRaycast* m_pRaycast;
     WorldRaycastResult* m_pRaycastResult;
     TVector<BoxHitResult>* m_pBoundsRaycastResult;
@@ -48,6 +48,7 @@ AnimationController::AnimationController()
     m_NextFrame = 0;
     m_PlayMode = ANIMATION_PLAY_CLAMP;
     m_bEnabled = true;
+    m_bAdditive = false;
 }
 
 void AnimationController::SetAnimation(SkeletalAnimation* _Animation)
@@ -122,4 +123,14 @@ void AnimationController::SetEnabled(bool _Enabled)
     }
 }
 
+void AnimationController::SetAdditive(bool _Additive)
+{
+    m_bAdditive = _Additive;
+
+    if (m_Owner)
+    {
+        m_Owner->m_bUpdateRelativeTransforms = true;
+    }
+}
+
 HK_NAMESPACE_END
@@ -105,6 +105,13 @@ public:
     /** Is controller enabled */
     bool IsEnabled() const { return m_bEnabled; }
 
+    /** Additive controllers are applied on top of the blended result of regular controllers.
+    The animation must store the difference to the reference pose. */
+    void SetAdditive(bool _Additive);
+
+    /** Is controller additive */
+    bool IsAdditive() const { return m_bAdditive; }
+
     AnimationController();
 
 private:
@@ -118,6 +125,7 @@ private:
     int m_NextFrame;
     ANIMATION_PLAY_MODE m_PlayMode;
     bool m_bEnabled;
+    bool m_bAdditive;
 };
 
 HK_NAMESPACE_END
@@ -92,6 +92,7 @@ Drawable::Drawable()
     m_Primitive = VisibilitySystem::AllocatePrimitive();
     m_Primitive->Owner = this;
     m_Primitive->Type = VSD_PRIMITIVE_BOX;
+    m_Primitive->Kind = VSD_PRIMITIVE_KIND_DRAWABLE;
     m_Primitive->VisGroup = VISIBILITY_GROUP_DEFAULT;
     m_Primitive->QueryGroup = VSD_QUERY_MASK_VISIBLE | VSD_QUERY_MASK_VISIBLE_IN_LIGHT_PASS | VSD_QUERY_MASK_SHADOW_CAST;
     m_Primitive->EvaluateRaycastResult = EvaluateRaycastResult;
@@ -219,7 +220,7 @@ void Drawable::InitializeComponent()
 
     if (m_bCastShadow)
     {
-        GetWorld()->LightingSystem.ShadowCasters.Add(this);
+        GetWorld()->LightingSystem.AddShadowCaster(this);
     }
 }
 
@@ -231,7 +232,7 @@ void Drawable::DeinitializeComponent()
 
     if (m_bCastShadow)
     {
-        GetWorld()->LightingSystem.ShadowCasters.Remove(this);
+        GetWorld()->LightingSystem.RemoveShadowCaster(this);
     }
 }
 
@@ -261,11 +262,11 @@ void Drawable::SetCastShadow(bool _CastShadow)
 
         if (m_bCastShadow)
         {
-            LightingSystem.ShadowCasters.Add(this);
+            LightingSystem.AddShadowCaster(this);
         }
         else
         {
-            LightingSystem.ShadowCasters.Remove(this);
+            LightingSystem.RemoveShadowCaster(this);
         }
     }
 }
@@ -281,6 +282,11 @@ void Drawable::UpdateWorldBounds()
     if (IsInitialized())
     {
         GetWorld()->VisibilitySystem.MarkPrimitive(m_Primitive);
+
+        if (m_bCastShadow)
+        {
+            GetWorld()->LightingSystem.UpdateShadowCaster(this);
+        }
     }
 }
 
@@ -59,7 +59,8 @@ class Drawable : public PhysicalBody
     HK_COMPONENT(Drawable, PhysicalBody)
 
 public:
-    TLink<Drawable> Link; // Shadow casters
+    /** Index in the lighting system shadow casters */
+    int ShadowCasterIndex = -1;
 
     /** Render mesh to custom depth-stencil buffer. Render target must have custom depth-stencil buffer enabled */
     bool bCustomDepthStencilPass = false;
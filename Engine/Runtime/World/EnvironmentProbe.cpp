@@ -51,6 +51,7 @@ EnvironmentProbe::EnvironmentProbe()
     m_Primitive = VisibilitySystem::AllocatePrimitive();
     m_Primitive->Owner = this;
     m_Primitive->Type = VSD_PRIMITIVE_SPHERE;
+    m_Primitive->Kind = VSD_PRIMITIVE_KIND_ENVIRONMENT_PROBE;
     m_Primitive->VisGroup = VISIBILITY_GROUP_DEFAULT;
     m_Primitive->QueryGroup = VSD_QUERY_MASK_VISIBLE | VSD_QUERY_MASK_VISIBLE_IN_LIGHT_PASS;
 
@@ -152,7 +153,7 @@ void EnvironmentProbe::DrawDebug(DebugRenderer* InRenderer)
 
     if (com_DrawEnvironmentProbes)
     {
-        if (m_Primitive->VisPass == InRenderer->GetVisPass())
+        if (m_Primitive->IsVisibleInPass(InRenderer->GetVisPass()))
         {
             Float3 pos = GetWorldPosition();
 
@@ -249,11 +249,16 @@ MeshComponent::~MeshComponent()
 void MeshComponent::InitializeComponent()
 {
     Super::InitializeComponent();
+
+    InvalidateRenderProxy();
 }
 
 void MeshComponent::DeinitializeComponent()
 {
     Super::DeinitializeComponent();
+
+    m_RenderProxy.Subparts.Free();
+    InvalidateRenderProxy();
 }
 
 void MeshComponent::SetAllowRaycast(bool _bAllowRaycast)
@@ -320,6 +325,8 @@ void MeshComponent::UpdateMesh()
     }
 
     m_RenderTransformMatrixFrame = 0;
+
+    InvalidateRenderProxy();
 }
 
 void MeshComponent::CopyMaterialsFromMeshResource()
@@ -333,6 +340,8 @@ void MeshComponent::ClearRenderViews()
     for (auto view : m_Views)
         view->RemoveRef();
     m_Views.Clear();
+
+    InvalidateRenderProxy();
 }
 
 void MeshComponent::SetRenderView(MeshRenderView* renderView)
@@ -346,7 +355,10 @@ void MeshComponent::AddRenderView(MeshRenderView* renderView)
     HK_ASSERT(renderView);
 
     if (m_Views.AddUnique(renderView))
+    {
         renderView->AddRef();
+        InvalidateRenderProxy();
+    }
 }
 
 void MeshComponent::RemoveRenderView(MeshRenderView* renderView)
@@ -358,6 +370,7 @@ void MeshComponent::RemoveRenderView(MeshRenderView* renderView)
     {
         m_Views.Remove(i);
         renderView->RemoveRef();
+        InvalidateRenderProxy();
     }
 }
 
@@ -421,7 +434,7 @@ void MeshComponent::DrawDebug(DebugRenderer* InRenderer)
 
     if (com_DrawIndexedMeshBVH)
     {
-        if (m_Primitive->VisPass == InRenderer->GetVisPass())
+        if (m_Primitive->IsVisibleInPass(InRenderer->GetVisPass()))
         {
             m_Mesh->DrawBVH(InRenderer, GetWorldTransformMatrix());
         }
@@ -429,7 +442,7 @@ void MeshComponent::DrawDebug(DebugRenderer* InRenderer)
 
     if (com_DrawMeshBounds)
     {
-        if (m_Primitive->VisPass == InRenderer->GetVisPass())
+        if (m_Primitive->IsVisibleInPass(InRenderer->GetVisPass()))
         {
             InRenderer->SetDepthTest(false);
 
@@ -639,7 +652,7 @@ void ProceduralMeshComponent::DrawDebug(DebugRenderer* InRenderer)
 
     if (com_DrawMeshBounds)
     {
-        if (m_Primitive->VisPass == InRenderer->GetVisPass())
+        if (m_Primitive->IsVisibleInPass(InRenderer->GetVisPass()))
         {
             InRenderer->SetDepthTest(false);
             InRenderer->SetColor(Color4(0.5f, 1, 0.5f, 1));
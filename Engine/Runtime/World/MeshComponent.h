@@ -38,6 +38,45 @@ SOFTWARE.
 
 HK_NAMESPACE_BEGIN
 
+class LevelLighting;
+
+/**
+
+MeshRenderProxy
+
+Camera independent part of the render instances of a mesh component. It is built by the render frontend
+and reused until the mesh, render views, materials, lighting or vertex memory layout change.
+
+*/
+struct MeshRenderProxy
+{
+    struct Subpart
+    {
+        MeshRenderView*   View;
+        int               SubpartIndex;
+        MaterialInstance* pMaterialInstance;
+        Material*         pMaterial;
+        /** Everything except matrices and material frame data */
+        RenderInstance    Instance;
+    };
+
+    TVector<Subpart> Subparts;
+
+    /** The state the proxy was built for */
+    IndexedMesh*   Mesh{};
+    LevelLighting* Lighting{};
+    uint32_t       LightmapBlock{};
+    uint32_t       VertexLightChannel{};
+    unsigned int   SubpartBaseVertexOffset{};
+    uint32_t       MeshRevision{};
+    uint32_t       VertexMemoryRevision{};
+    uint8_t        MotionBehavior{};
+    bool           bHasLightmap{};
+    bool           bHasVertexLight{};
+    bool           bVertexLight{};
+    bool           bValid{};
+};
+
 /**
 
 MeshComponent
@@ -65,6 +104,9 @@ public:
     /** Flipbook animation page offset */
     unsigned int SubpartBaseVertexOffset = 0;
 
+    /** Use mesh occluder for software occlusion culling (if the mesh has one) */
+    bool bOccluder = true;
+
     /** Allow raycasting */
     void SetAllowRaycast(bool bAllowRaycast) override;
 
@@ -100,6 +142,15 @@ public:
         m_RenderTransformMatrixFrame = 0;
     }
 
+    /** Render proxy is managed by the render frontend */
+    MeshRenderProxy& GetRenderProxy() { return m_RenderProxy; }
+
+    /** Force the render proxy to be rebuilt */
+    void InvalidateRenderProxy()
+    {
+        m_RenderProxy.bValid = false;
+    }
+
 protected:
     MeshComponent();
     ~MeshComponent();
@@ -124,6 +175,8 @@ private:
     /** Transform matrix used during last rendering */
     Float3x4 m_RenderTransformMatrix[2];
     int      m_RenderTransformMatrixFrame{0};
+
+    MeshRenderProxy m_RenderProxy;
 };
 
 class ProceduralMeshComponent : public Drawable
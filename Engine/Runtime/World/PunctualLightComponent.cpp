@@ -60,6 +60,7 @@ PunctualLightComponent::PunctualLightComponent()
     m_Primitive = VisibilitySystem::AllocatePrimitive();
     m_Primitive->Owner = this;
     m_Primitive->Type = VSD_PRIMITIVE_SPHERE;
+    m_Primitive->Kind = VSD_PRIMITIVE_KIND_PUNCTUAL_LIGHT;
     m_Primitive->VisGroup = VISIBILITY_GROUP_DEFAULT;
     m_Primitive->QueryGroup = VSD_QUERY_MASK_VISIBLE | VSD_QUERY_MASK_VISIBLE_IN_LIGHT_PASS;
 
@@ -303,7 +304,7 @@ void PunctualLightComponent::DrawDebug(DebugRenderer* InRenderer)
 
     if (com_DrawPunctualLights)
     {
-        if (m_Primitive->VisPass == InRenderer->GetVisPass())
+        if (m_Primitive->IsVisibleInPass(InRenderer->GetVisPass()))
         {
             Float3 pos = GetWorldPosition();
             if (m_InnerConeAngle < MaxConeAngle)
@@ -28,10 +28,6 @@ SOFTWARE.
 
 */
 
-/*
- TODO: Future optimizations: parallel, SSE
- */
-
 #include "SkinnedComponent.h"
 #include "AnimationController.h"
 #include "World.h"
@@ -39,7 +35,9 @@ SOFTWARE.
 #include <Engine/Runtime/DebugRenderer.h>
 #include <Engine/Runtime/ResourceManager.h>
 #include <Engine/Runtime/Animation.h>
+#include <Engine/Runtime/SkinningSystem.h>
 #include <Engine/Runtime/BulletCompatibility.h>
+#include <Engine/Geometry/SoaPose.h>
 #include <Engine/RenderCore/VertexMemoryGPU.h>
 
 #include <Engine/Assets/Asset.h>
@@ -50,6 +48,12 @@ SOFTWARE.
 HK_NAMESPACE_BEGIN
 
 ConsoleVar com_DrawSkeleton("com_DrawSkeleton"s, "0"s, CVAR_CHEAT);
+ConsoleVar com_AnimationLod("com_AnimationLod"s, "1"s, 0, "Reduce pose update rate and joint count by screen size"s);
+ConsoleVar com_AnimationLodScreenSize1("com_AnimationLodScreenSize1"s, "0.25"s, 0, "Screen size below which the pose is updated every second tick"s);
+ConsoleVar com_AnimationLodScreenSize2("com_AnimationLodScreenSize2"s, "0.08"s, 0, "Screen size below which the pose is updated every fourth tick with reduced joints"s);
+ConsoleVar com_AnimationLodJointDepth("com_AnimationLodJointDepth"s, "3"s, 0, "Max animated joint depth for the lowest animation LOD"s);
+ConsoleVar com_AnimationOffscreenTicks("com_AnimationOffscreenTicks"s, "2"s, 0, "Skip pose evaluation after this number of ticks without rendering"s);
+ConsoleVar com_AnimationReturnBlendTicks("com_AnimationReturnBlendTicks"s, "4"s, 0, "Number of ticks to blend from the last evaluated pose when an off-screen character becomes visible"s);
 
 HK_CLASS_META(SkinnedComponent)
 
@@ -60,6 +64,9 @@ SkinnedComponent::SkinnedComponent()
     m_bUpdateBounds = false;
     m_bUpdateControllers = true;
     m_bUpdateRelativeTransforms = false;
+    m_bUpdatePalette = true;
+    m_bAnimationThrottled = false;
+    m_bAnimationOffscreen = false;
     m_bUpdateAbsoluteTransforms = false;
     m_bJointsSimulatedByPhysics = false;
     m_bSkinnedMesh = true;
@@ -112,12 +119,15 @@ void SkinnedComponent::UpdateMesh()
     m_AbsoluteTransforms[0].SetIdentity();
 
     m_RelativeTransforms.ResizeInvalidate(numJoints);
+    m_JointDepth.ResizeInvalidate(numJoints);
     for (int i = 0; i < numJoints; i++)
     {
         m_RelativeTransforms[i] = joints[i].LocalTransform;
+        m_JointDepth[i] = joints[i].Parent >= 0 ? Math::Min(m_JointDepth[joints[i].Parent] + 1, 255) : 0;
     }
 
     m_bUpdateControllers = true;
+    m_bUpdatePalette = true;
 }
 
 void SkinnedComponent::AddAnimationController(AnimationController* controller)
@@ -213,6 +223,7 @@ void SkinnedComponent::MergeJointAnimations()
                 m_AbsoluteTransforms[j + 1].Compose(btVectorToFloat3(m_SoftBody->m_nodes[j].m_x), Float3x3::Identity());
             }
             m_bUpdateAbsoluteTransforms = false;
+            m_bUpdatePalette = true;
             //bWriteTransforms = true;
         }
     }
@@ -234,29 +245,79 @@ void SkinnedComponent::UpdateTransformsIfDirty()
     UpdateTransforms();
 }
 
+namespace
+{
+
+struct PoseBlendScratch
+{
+    SoaPose Frame;
+    SoaPose NextFrame;
+    SoaPose Result;
+    TVector<float> Weights;
+    TVector<float> WeightSums;
+};
+
+thread_local PoseBlendScratch PoseScratch;
+
+HK_FORCEINLINE void ResizePose(SoaPose& pose, int jointsCount)
+{
+    if (pose.GetJointsCount() != jointsCount)
+    {
+        pose.Resize(jointsCount);
+    }
+}
+
+} // namespace
+
 void SkinnedComponent::UpdateTransforms()
 {
     SkeletonJoint const* joints = m_Skeleton->GetJoints().ToPtr();
     int jointsCount = m_Skeleton->GetJoints().Size();
 
-    // TODO: Move tempTransform and weights to globals to minimize allocations
-    TSmallVector<Transform, 32> tempTransforms;
-    TSmallVector<float, 32> weights;
+    PoseBlendScratch& scratch = PoseScratch;
 
-    tempTransforms.Resize(m_AnimControllers.Size());
-    weights.Resize(m_AnimControllers.Size());
+    ResizePose(scratch.Frame, jointsCount);
+    ResizePose(scratch.NextFrame, jointsCount);
+    ResizePose(scratch.Result, jointsCount);
 
-    Platform::ZeroMem(m_RelativeTransforms.ToPtr(), sizeof(m_RelativeTransforms[0]) * jointsCount);
+    // Weights are padded to the SoA group size
+    int paddedCount = scratch.Result.GetGroupsCount() * 4;
+    scratch.Weights.Resize(paddedCount);
+    scratch.WeightSums.Resize(paddedCount);
+    Platform::ZeroMem(scratch.WeightSums.ToPtr(), sizeof(float) * paddedCount);
 
-    for (int jointIndex = 0; jointIndex < jointsCount; jointIndex++)
+    scratch.Result.SetZero();
+
+    bool bHasAdditive = false;
+
+    // Pass 0 blends regular controllers, pass 1 applies additive controllers on top
+    for (int pass = 0; pass < 2; pass++)
     {
-        float sumWeight = 0;
+        if (pass == 1)
+        {
+            Geometry::NormalizePose(scratch.Result, scratch.WeightSums.ToPtr());
 
-        int n = 0;
+            if (!bHasAdditive)
+            {
+                break;
+            }
 
-        for (int controllerId = 0, count = m_AnimControllers.Size(); controllerId < count; controllerId++)
+            // Additive layers need a base for joints without regular animation
+            for (int jointIndex = 0; jointIndex < jointsCount; jointIndex++)
+            {
+                if (scratch.WeightSums[jointIndex] == 0.0f)
+                {
+                    Transform transform;
+                    Float3x3 rotation;
+                    joints[jointIndex].LocalTransform.DecomposeAll(transform.Position, rotation, transform.Scale);
+                    transform.Rotation.FromMatrix(rotation);
+                    scratch.Result.SetJoint(jointIndex, transform);
+                }
+            }
+        }
+
+        for (AnimationController* controller : m_AnimControllers)
         {
-            AnimationController* controller = m_AnimControllers[controllerId];
             SkeletalAnimation* animation = controller->m_Animation;
 
             if (!controller->m_bEnabled || !animation || !animation->IsValid())
@@ -264,64 +325,89 @@ void SkinnedComponent::UpdateTransforms()
                 continue;
             }
 
-            // TODO: Enable/Disable joint animation?
-
-            unsigned short channelIndex = animation->GetChannelIndex(jointIndex);
-
-            if (channelIndex == (unsigned short)-1)
+            if (controller->m_bAdditive != (pass == 1))
             {
+                bHasAdditive |= controller->m_bAdditive;
                 continue;
             }
 
-            TVector<AnimationChannel> const& animJoints = animation->GetChannels();
-
-            AnimationChannel const& jointAnim = animJoints[channelIndex];
+            const float weight = controller->m_Weight;
+            const bool bInterpolate = controller->m_Frame != controller->m_NextFrame && controller->m_Blend >= 0.0001f;
 
-            TVector<Transform> const& transforms = animation->GetTransforms();
+            Platform::ZeroMem(scratch.Weights.ToPtr(), sizeof(float) * paddedCount);
 
-            Transform& transform = tempTransforms[n];
-            weights[n] = controller->m_Weight;
-            n++;
+            bool bAnimated = false;
 
-            if (controller->m_Frame == controller->m_NextFrame || controller->m_Blend < 0.0001f)
-            {
-                transform = transforms[jointAnim.TransformOffset + controller->m_Frame];
-            }
-            else
+            // TODO: Enable/Disable joint animation?
+            for (int jointIndex = 0; jointIndex < jointsCount; jointIndex++)
             {
-                Transform const& frame1 = transforms[jointAnim.TransformOffset + controller->m_Frame];
-                Transform const& frame2 = transforms[jointAnim.TransformOffset + controller->m_NextFrame];
+                unsigned short channelIndex = animation->GetChannelIndex(jointIndex);
 
-                transform.Position = Math::Lerp(frame1.Position, frame2.Position, controller->m_Blend);
-                transform.Rotation = Math::Slerp(frame1.Rotation, frame2.Rotation, controller->m_Blend);
-                transform.Scale = Math::Lerp(frame1.Scale, frame2.Scale, controller->m_Blend);
-            }
+                if (channelIndex == (unsigned short)-1)
+                {
+                    continue;
+                }
 
-            sumWeight += controller->m_Weight;
-        }
+                // Joints below the LOD depth keep the bind transform
+                if (m_JointLodDepth > 0 && m_JointDepth[jointIndex] > m_JointLodDepth)
+                {
+                    continue;
+                }
 
-        Float3x4& resultTransform = m_RelativeTransforms[jointIndex];
+                Transform transform;
 
-        if (n > 0)
-        {
-            Float3x4 m;
+                animation->SampleChannel(channelIndex, controller->m_Frame, controller->m_Frame, 0.0f, transform);
+                scratch.Frame.SetJoint(jointIndex, transform);
 
-            const float sumWeightReciprocal = (sumWeight == 0.0f) ? 0.0f : 1.0f / sumWeight;
+                if (bInterpolate)
+                {
+                    animation->SampleChannel(channelIndex, controller->m_NextFrame, controller->m_NextFrame, 0.0f, transform);
+                    scratch.NextFrame.SetJoint(jointIndex, transform);
+                }
 
-            for (int i = 0; i < n; i++)
+                scratch.Weights[jointIndex] = weight;
+                scratch.WeightSums[jointIndex] += pass == 0 ? weight : 0.0f;
+                bAnimated = true;
+            }
+
+            if (!bAnimated)
             {
-                const float weight = weights[i] * sumWeightReciprocal;
+                continue;
+            }
 
-                tempTransforms[i].ComputeTransformMatrix(m);
+            if (bInterpolate)
+            {
+                Geometry::SlerpPoses(scratch.Frame, scratch.NextFrame, controller->m_Blend, scratch.Frame);
+            }
 
-                resultTransform[0] += m[0] * weight;
-                resultTransform[1] += m[1] * weight;
-                resultTransform[2] += m[2] * weight;
+            if (pass == 0)
+            {
+                Geometry::AccumulatePose(scratch.Frame, scratch.Weights.ToPtr(), scratch.Result);
+            }
+            else
+            {
+                Geometry::AddPose(scratch.Frame, scratch.Weights.ToPtr(), scratch.Result);
             }
         }
-        else
+    }
+
+    if (m_ReturnBlendTicksLeft > 0 && m_ReturnPose.GetJointsCount() == jointsCount)
+    {
+        float t = 1.0f - (float)m_ReturnBlendTicksLeft / (m_ReturnBlendTicks + 1);
+        Geometry::SlerpPoses(m_ReturnPose, scratch.Result, t, scratch.Result);
+    }
+
+    Geometry::PoseToMatrices(scratch.Result, m_RelativeTransforms.ToPtr());
+
+    if (!bHasAdditive)
+    {
+        // Keep exact bind transforms for joints without animation
+        for (int jointIndex = 0; jointIndex < jointsCount; jointIndex++)
         {
-            resultTransform = joints[jointIndex].LocalTransform;
+            if (scratch.WeightSums[jointIndex] == 0.0f)
+            {
+                m_RelativeTransforms[jointIndex] = joints[jointIndex].LocalTransform;
+            }
         }
     }
 
@@ -338,19 +424,186 @@ void SkinnedComponent::UpdateAbsoluteTransformsIfDirty()
 
     TVector<SkeletonJoint> const& joints = m_Skeleton->GetJoints();
 
-    for (int j = 0; j < joints.Size(); j++)
+    // ... Update relative joints physics here ...
+
+    Geometry::LocalToModel(joints.ToPtr(), joints.Size(), m_RelativeTransforms.ToPtr(), m_AbsoluteTransforms.ToPtr());
+
+    // ... Update absolute joints physics here ...
+
+    m_bUpdateAbsoluteTransforms = false;
+    m_bUpdatePalette = true;
+    //m_bWriteTransforms = true;
+}
+
+void SkinnedComponent::UpdateJointPalette()
+{
+    if (!m_bUpdatePalette)
+    {
+        return;
+    }
+
+    MeshSkin const& skin = GetMesh()->GetSkin();
+
+    m_JointPalette.ResizeInvalidate(skin.JointIndices.Size());
+    for (int j = 0; j < skin.JointIndices.Size(); j++)
     {
-        SkeletonJoint const& joint = joints[j];
+        m_JointPalette[j] = m_AbsoluteTransforms[skin.JointIndices[j] + 1] * skin.OffsetMatrices[j];
+    }
 
-        // ... Update relative joints physics here ...
+    m_bUpdatePalette = false;
+}
 
-        m_AbsoluteTransforms[j + 1] = m_AbsoluteTransforms[joint.Parent + 1] * m_RelativeTransforms[j];
+bool SkinnedComponent::UpdateAnimationLod()
+{
+    if (!com_AnimationLod)
+    {
+        if (m_JointLodDepth != 0)
+        {
+            m_JointLodDepth = 0;
+            m_bUpdateRelativeTransforms = true;
+        }
+        m_AnimationLod = 0;
+        m_ReturnBlendTicksLeft = 0;
+        m_bAnimationThrottled = false;
+        m_bAnimationOffscreen = false;
+        return true;
+    }
+
+    // Counter is reset when the component is rendered
+    if (m_FramesSinceVisible++ > com_AnimationOffscreenTicks.GetInteger())
+    {
+        m_FramesSinceVisible = com_AnimationOffscreenTicks.GetInteger() + 1;
+        m_bAnimationThrottled = true;
+        m_bAnimationOffscreen = true;
+        return false;
+    }
+
+    int lod = 0;
+    if (m_ScreenSize < com_AnimationLodScreenSize2.GetFloat())
+    {
+        lod = 2;
+    }
+    else if (m_ScreenSize < com_AnimationLodScreenSize1.GetFloat())
+    {
+        lod = 1;
+    }
 
-        // ... Update absolute joints physics here ...
+    int jointDepth = lod == 2 ? Math::Max(com_AnimationLodJointDepth.GetInteger(), 1) : 0;
+    if (m_JointLodDepth != jointDepth)
+    {
+        m_JointLodDepth = jointDepth;
+        m_bUpdateRelativeTransforms = true;
     }
 
+    m_AnimationLod = lod;
+
+    // Blending from the pose the character had off screen is evaluated every tick
+    if (m_ReturnBlendTicksLeft > 0)
+    {
+        m_ReturnBlendTicksLeft--;
+        m_bUpdateRelativeTransforms = true;
+        m_FramesSinceUpdate = 0;
+        m_bAnimationThrottled = false;
+        return true;
+    }
+
+    if (++m_FramesSinceUpdate < (1 << lod))
+    {
+        m_bAnimationThrottled = true;
+        return false;
+    }
+
+    m_FramesSinceUpdate = 0;
+    m_bAnimationThrottled = false;
+    return true;
+}
+
+void SkinnedComponent::BeginReturnBlend()
+{
+    m_ReturnBlendTicks = m_ReturnBlendTicksLeft = Math::Max(com_AnimationReturnBlendTicks.GetInteger(), 0);
+    if (!m_ReturnBlendTicks)
+    {
+        return;
+    }
+
+    // The relative transforms are the last evaluated pose
+    int jointsCount = m_Skeleton->GetJoints().Size();
+
+    ResizePose(m_ReturnPose, jointsCount);
+    for (int jointIndex = 0; jointIndex < jointsCount; jointIndex++)
+    {
+        Transform transform;
+        Float3x3 rotation;
+        m_RelativeTransforms[jointIndex].DecomposeAll(transform.Position, rotation, transform.Scale);
+        transform.Rotation.FromMatrix(rotation);
+        m_ReturnPose.SetJoint(jointIndex, transform);
+    }
+
+    m_bUpdateRelativeTransforms = true;
+}
+
+bool SkinnedComponent::GetPoseKey(SkinnedPoseKey& key) const
+{
+    AnimationController const* active = nullptr;
+
+    // The pose depends on the state the component had off screen
+    if (m_ReturnBlendTicksLeft > 0)
+    {
+        return false;
+    }
+
+    for (AnimationController const* controller : m_AnimControllers)
+    {
+        if (!controller->m_bEnabled || !controller->m_Animation || !controller->m_Animation->IsValid())
+        {
+            continue;
+        }
+
+        if (active || controller->m_bAdditive || controller->m_Weight <= 0.0f)
+        {
+            return false;
+        }
+
+        active = controller;
+    }
+
+    if (!active)
+    {
+        return false;
+    }
+
+    bool bInterpolate = active->m_Frame != active->m_NextFrame && active->m_Blend >= 0.0001f;
+
+    key.pSkeleton = m_Skeleton;
+    key.pAnimation = active->m_Animation;
+    key.Frame = active->m_Frame;
+    key.NextFrame = bInterpolate ? active->m_NextFrame : active->m_Frame;
+    key.Blend = bInterpolate ? active->m_Blend : 0.0f;
+    key.JointLodDepth = m_JointLodDepth;
+    return true;
+}
+
+void SkinnedComponent::CopyPose(SkinnedComponent const* source)
+{
+    HK_ASSERT(m_Skeleton == source->m_Skeleton);
+
+    // Relative transforms are copied too: they are the last evaluated pose the return blend starts from
+    m_RelativeTransforms = source->m_RelativeTransforms;
+    m_AbsoluteTransforms = source->m_AbsoluteTransforms;
+
+    m_bUpdateRelativeTransforms = false;
     m_bUpdateAbsoluteTransforms = false;
-    //m_bWriteTransforms = true;
+
+    if (GetMesh() == source->GetMesh())
+    {
+        m_JointPalette = source->m_JointPalette;
+        m_bUpdatePalette = false;
+    }
+    else
+    {
+        m_bUpdatePalette = true;
+        UpdateJointPalette();
+    }
 }
 
 void SkinnedComponent::UpdateControllersIfDirty()
@@ -543,9 +796,41 @@ void SkinnedComponent::OnPreRenderUpdate(RenderFrontendDef const* def)
 {
     Super::OnPreRenderUpdate(def);
 
-    MergeJointAnimations();
+    RenderViewData const* view = def->View;
+    if (view->bPerspective)
+    {
+        BvAxisAlignedBox const& bounds = GetWorldBounds();
+        float distance = Math::Max(view->ViewPosition.Dist(bounds.Center()), 0.001f);
+        m_ScreenSize = bounds.Radius() / (distance * std::tan(view->ViewFovY * 0.5f));
+    }
+    else
+    {
+        m_ScreenSize = 1.0f;
+    }
+    m_FramesSinceVisible = 0;
+
+    bool bReturned = m_bAnimationOffscreen;
+
+    // Poses are evaluated by SkinningSystem. Throttled components keep their last pose, components returning
+    // on screen blend from the last evaluated pose to the current time over a few ticks.
+    if (bReturned)
+    {
+        BeginReturnBlend();
+    }
+
+    if (!m_bAnimationThrottled || bReturned)
+    {
+        MergeJointAnimations();
+    }
+    UpdateJointPalette();
+
+    m_bAnimationOffscreen = false;
+    if (bReturned)
+    {
+        m_bAnimationThrottled = false;
+        m_FramesSinceUpdate = 0;
+    }
 
-    MeshSkin const& skin = GetMesh()->GetSkin();
     TVector<SkeletonJoint> const& joints = m_Skeleton->GetJoints();
 
     m_SkeletonSize = joints.Size() * sizeof(Float3x4);
@@ -553,16 +838,39 @@ void SkinnedComponent::OnPreRenderUpdate(RenderFrontendDef const* def)
     {
         StreamedMemoryGPU* streamedMemory = def->StreamedMemory;
 
+        // Previous palette is from the last rendered frame, which was many ticks ago, so don't produce motion
+        // vectors from it
+        if (bReturned)
+        {
+            Platform::Memcpy(m_JointsBufferData, m_JointPalette.ToPtr(), m_JointPalette.Size() * sizeof(Float3x4));
+        }
+
         // Write joints from previous frame
         m_SkeletonOffsetMB = streamedMemory->AllocateJoint(m_SkeletonSize, m_JointsBufferData);
 
-        // Write joints from current frame
-        m_SkeletonOffset = streamedMemory->AllocateJoint(m_SkeletonSize, nullptr);
-        Float3x4* data = (Float3x4*)streamedMemory->Map(m_SkeletonOffset);
-        for (int j = 0; j < skin.JointIndices.Size(); j++)
+        bool bSharedUpload = m_SharedUpload && m_SharedUpload->pMesh == GetMesh();
+
+        if (bSharedUpload && m_SharedUpload->FrameNumber == def->FrameNumber)
+        {
+            // Joints of the current frame are already written by a mesh with the same pose
+            m_SkeletonOffset = m_SharedUpload->Offset;
+            Platform::Memcpy(m_JointsBufferData, m_JointPalette.ToPtr(), m_JointPalette.Size() * sizeof(Float3x4));
+        }
+        else
         {
-            int jointIndex = skin.JointIndices[j];
-            data[j] = m_JointsBufferData[j] = m_AbsoluteTransforms[jointIndex + 1] * skin.OffsetMatrices[j];
+            // Write joints from current frame
+            m_SkeletonOffset = streamedMemory->AllocateJoint(m_SkeletonSize, nullptr);
+            Float3x4* data = (Float3x4*)streamedMemory->Map(m_SkeletonOffset);
+            for (int j = 0; j < m_JointPalette.Size(); j++)
+            {
+                data[j] = m_JointsBufferData[j] = m_JointPalette[j];
+            }
+
+            if (bSharedUpload)
+            {
+                m_SharedUpload->FrameNumber = def->FrameNumber;
+                m_SharedUpload->Offset = m_SkeletonOffset;
+            }
         }
     }
     else
@@ -32,11 +32,14 @@ SOFTWARE.
 
 #include "MeshComponent.h"
 #include <Engine/Runtime/Skeleton.h>
+#include <Engine/Geometry/SoaPose.h>
 #include <Engine/Core/IntrusiveLinkedListMacro.h>
 
 HK_NAMESPACE_BEGIN
 
 class AnimationController;
+struct SkinnedPoseKey;
+struct SharedSkeletonUpload;
 
 /**
 
@@ -50,6 +53,7 @@ class SkinnedComponent : public MeshComponent
     HK_COMPONENT(SkinnedComponent, MeshComponent)
 
     friend class AnimationController;
+    friend class SkinningSystem;
 
 public:
     TLink<SkinnedComponent> Link;
@@ -86,6 +90,9 @@ public:
 
     void GetSkeletonHandle(size_t& skeletonOffset, size_t& skeletonOffsetMB, size_t& skeletonSize);
 
+    /** Current animation LOD. 0 - full update rate and all joints */
+    int GetAnimationLod() const { return m_AnimationLod; }
+
 protected:
     SkinnedComponent();
     ~SkinnedComponent();
@@ -113,14 +120,31 @@ private:
 
     void UpdateAbsoluteTransformsIfDirty();
 
+    void UpdateJointPalette();
+
     void MergeJointAnimations();
 
+    /** Select animation LOD by the screen size from the last rendered frame. Returns false if the pose
+    must not be evaluated this tick. */
+    bool UpdateAnimationLod();
+
+    /** Get the key of the pose if it depends only on a single animation frame */
+    bool GetPoseKey(SkinnedPoseKey& key) const;
+
+    /** Take the pose evaluated for another component with the same pose key */
+    void CopyPose(SkinnedComponent const* source);
+
+    /** Start blending from the last evaluated pose. Called when the component returns on screen. */
+    void BeginReturnBlend();
+
     TRef<Skeleton> m_Skeleton;
 
     TVector<AnimationController*> m_AnimControllers;
 
     TVector<Float3x4> m_AbsoluteTransforms;
     TVector<Float3x4> m_RelativeTransforms;
+    TVector<Float3x4> m_JointPalette;
+    TVector<uint8_t> m_JointDepth;
 
     alignas(16) Float3x4 m_JointsBufferData[MAX_SKELETON_JOINTS];
 
@@ -129,9 +153,27 @@ private:
     size_t m_SkeletonOffsetMB = 0;
     size_t m_SkeletonSize = 0;
 
+    // Animation LOD
+    float m_ScreenSize = 1.0f;
+    int m_FramesSinceVisible = 0;
+    int m_FramesSinceUpdate = 0;
+    int m_AnimationLod = 0;
+    int m_JointLodDepth = 0;
+
+    // Pose the component had when it went off screen and number of ticks left to blend from it
+    SoaPose m_ReturnPose;
+    int m_ReturnBlendTicks = 0;
+    int m_ReturnBlendTicksLeft = 0;
+
+    // Set by SkinningSystem for meshes sharing the pose, valid until the next update
+    SharedSkeletonUpload* m_SharedUpload = nullptr;
+
     bool m_bUpdateBounds : 1;
     bool m_bUpdateControllers : 1;
     bool m_bUpdateRelativeTransforms : 1;
+    bool m_bUpdatePalette : 1;
+    bool m_bAnimationThrottled : 1;
+    bool m_bAnimationOffscreen : 1;
     //bool m_bWriteTransforms : 1;
 
 protected:
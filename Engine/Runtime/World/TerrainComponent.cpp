@@ -193,6 +193,7 @@ TerrainComponent::TerrainComponent()
     Primitive                         = VisibilitySystem::AllocatePrimitive();
     Primitive->Owner                  = this;
     Primitive->Type                   = VSD_PRIMITIVE_BOX;
+    Primitive->Kind                   = VSD_PRIMITIVE_KIND_TERRAIN;
     Primitive->VisGroup               = VISIBILITY_GROUP_TERRAIN;
     Primitive->QueryGroup             = VSD_QUERY_MASK_VISIBLE | VSD_QUERY_MASK_VISIBLE_IN_LIGHT_PASS /* | VSD_QUERY_MASK_SHADOW_CAST*/;
     Primitive->bIsOutdoor             = true;
@@ -566,7 +567,7 @@ void TerrainComponent::DrawDebug(DebugRenderer* InRenderer)
 
     if (com_DrawTerrainBounds && m_Terrain)
     {
-        if (Primitive->VisPass == InRenderer->GetVisPass())
+        if (Primitive->IsVisibleInPass(InRenderer->GetVisPass()))
         {
             InRenderer->SetDepthTest(false);
             InRenderer->SetColor(Color4(1, 0, 0, 1));
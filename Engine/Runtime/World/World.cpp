@@ -1007,6 +1007,11 @@ void World::QueryVisiblePrimitives(TVector<PrimitiveDef*>& VisPrimitives, TVecto
     VisibilitySystem.QueryVisiblePrimitives(VisPrimitives, VisSurfs, VisPass, Query);
 }
 
+void World::QueryVisiblePrimitives(VisPrimitiveBuckets& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& Query)
+{
+    VisibilitySystem.QueryVisiblePrimitives(VisPrimitives, VisSurfs, VisPass, Query);
+}
+
 void World::QueryOverplapAreas(BvAxisAlignedBox const& Bounds, TVector<VisArea*>& Areas)
 {
     VisibilitySystem.QueryOverplapAreas(Bounds, Areas);
@@ -367,6 +367,9 @@ public:
     /** Query visible primitives */
     void QueryVisiblePrimitives(TVector<PrimitiveDef*>& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& InQuery);
 
+    /** Query visible primitives sorted into buckets by primitive kind */
+    void QueryVisiblePrimitives(VisPrimitiveBuckets& VisPrimitives, TVector<SurfaceDef*>& VisSurfs, int* VisPass, VisibilityQuery const& InQuery);
+
     /** Query vis areas by bounding box */
     void QueryOverplapAreas(BvAxisAlignedBox const& Bounds, TVector<VisArea*>& Areas);
 